@@ -46,6 +46,7 @@ RadvdInterface::RadvdInterface (uint32_t interface)
   m_homeAgentPreference = 0;
   m_mobRtrSupportFlag = false;
   m_intervalOpt = false;
+  m_generation = 0;
 }
 
 RadvdInterface::RadvdInterface (uint32_t interface, uint32_t maxRtrAdvInterval, uint32_t minRtrAdvInterval)
@@ -71,6 +72,7 @@ RadvdInterface::RadvdInterface (uint32_t interface, uint32_t maxRtrAdvInterval,
   m_homeAgentPreference = 0;
   m_mobRtrSupportFlag = false;
   m_intervalOpt = false;
+  m_generation = 0;
 }
 
 RadvdInterface::~RadvdInterface ()
@@ -86,6 +88,7 @@ RadvdInterface::~RadvdInterface ()
 void RadvdInterface::AddPrefix (Ptr<RadvdPrefix> routerPrefix)
 {
   m_prefixes.push_back (routerPrefix);
+  m_generation++;
 }
 
 
@@ -99,6 +102,18 @@ std::list<Ptr<RadvdPrefix> > RadvdInterface::GetPrefixes () const
   return m_prefixes;
 }
 
+uint32_t RadvdInterface::GetGeneration () const
+{
+  /* the counters only grow and prefixes are never removed, so any change moves the sum */
+  uint32_t generation = m_generation;
+
+  for (RadvdPrefixListCI it = m_prefixes.begin (); it != m_prefixes.end (); ++it)
+    {
+      generation += (*it)->GetGeneration ();
+    }
+  return generation;
+}
+
 bool RadvdInterface::IsSendAdvert () const
 {
   return m_sendAdvert;
@@ -107,6 +122,7 @@ bool RadvdInterface::IsSendAdvert () const
 void RadvdInterface::SetSendAdvert (bool sendAdvert)
 {
   m_sendAdvert = sendAdvert;
+  m_generation++;
 }
 
 uint32_t RadvdInterface::GetMaxRtrAdvInterval () const
@@ -117,6 +133,7 @@ uint32_t RadvdInterface::GetMaxRtrAdvInterval () const
 void RadvdInterface::SetMaxRtrAdvInterval (uint32_t maxRtrAdvInterval)
 {
   m_maxRtrAdvInterval = maxRtrAdvInterval;
+  m_generation++;
 }
 
 uint32_t RadvdInterface::GetMinRtrAdvInterval () const
@@ -127,6 +144,7 @@ uint32_t RadvdInterface::GetMinRtrAdvInterval () const
 void RadvdInterface::SetMinRtrAdvInterval (uint32_t minRtrAdvInterval)
 {
   m_minRtrAdvInterval = minRtrAdvInterval;
+  m_generation++;
 }
 
 uint32_t RadvdInterface::GetMinDelayBetweenRAs () const
@@ -137,6 +155,7 @@ uint32_t RadvdInterface::GetMinDelayBetweenRAs () const
 void RadvdInterface::SetMinDelayBetweenRAs (uint32_t minDelayBetweenRAs)
 {
   m_minDelayBetweenRAs = minDelayBetweenRAs;
+  m_generation++;
 }
 
 bool RadvdInterface::IsManagedFlag () const
@@ -147,6 +166,7 @@ bool RadvdInterface::IsManagedFlag () const
 void RadvdInterface::SetManagedFlag (bool managedFlag)
 {
   m_managedFlag = managedFlag;
+  m_generation++;
 }
 
 bool RadvdInterface::IsOtherConfigFlag () const
@@ -157,6 +177,7 @@ bool RadvdInterface::IsOtherConfigFlag () const
 void RadvdInterface::SetOtherConfigFlag (bool otherConfigFlag)
 {
   m_otherConfigFlag = otherConfigFlag;
+  m_generation++;
 }
 
 uint32_t RadvdInterface::GetLinkMtu () const
@@ -167,6 +188,7 @@ uint32_t RadvdInterface::GetLinkMtu () const
 void RadvdInterface::SetLinkMtu (uint32_t linkMtu)
 {
   m_linkMtu = linkMtu;
+  m_generation++;
 }
 
 uint32_t RadvdInterface::GetReachableTime () const
@@ -177,6 +199,7 @@ uint32_t RadvdInterface::GetReachableTime () const
 void RadvdInterface::SetReachableTime (uint32_t reachableTime)
 {
   m_reachableTime = reachableTime;
+  m_generation++;
 }
 
 uint32_t RadvdInterface::GetDefaultLifeTime () const
@@ -187,6 +210,7 @@ uint32_t RadvdInterface::GetDefaultLifeTime () const
 void RadvdInterface::SetDefaultLifeTime (uint32_t defaultLifeTime)
 {
   m_defaultLifeTime = defaultLifeTime;
+  m_generation++;
 }
 
 uint32_t RadvdInterface::GetRetransTimer () const
@@ -197,6 +221,7 @@ uint32_t RadvdInterface::GetRetransTimer () const
 void RadvdInterface::SetRetransTimer (uint32_t retransTimer)
 {
   m_retransTimer = retransTimer;
+  m_generation++;
 }
 
 uint8_t RadvdInterface::GetCurHopLimit () const
@@ -207,6 +232,7 @@ uint8_t RadvdInterface::GetCurHopLimit () const
 void RadvdInterface::SetCurHopLimit (uint8_t curHopLimit)
 {
   m_curHopLimit = curHopLimit;
+  m_generation++;
 }
 
 uint8_t RadvdInterface::GetDefaultPreference () const
@@ -217,6 +243,7 @@ uint8_t RadvdInterface::GetDefaultPreference () const
 void RadvdInterface::SetDefaultPreference (uint8_t defaultPreference)
 {
   m_defaultPreference = defaultPreference;
+  m_generation++;
 }
 
 bool RadvdInterface::IsSourceLLAddress () const
@@ -227,6 +254,7 @@ bool RadvdInterface::IsSourceLLAddress () const
 void RadvdInterface::SetSourceLLAddress (bool sourceLLAddress)
 {
   m_sourceLLAddress = sourceLLAddress;
+  m_generation++;
 }
 
 bool RadvdInterface::IsHomeAgentFlag () const
@@ -237,6 +265,7 @@ bool RadvdInterface::IsHomeAgentFlag () const
 void RadvdInterface::SetHomeAgentFlag (bool homeAgentFlag)
 {
   m_homeAgentFlag = homeAgentFlag;
+  m_generation++;
 }
 
 bool RadvdInterface::IsHomeAgentInfo () const
@@ -247,6 +276,7 @@ bool RadvdInterface::IsHomeAgentInfo () const
 void RadvdInterface::SetHomeAgentInfo (bool homeAgentInfo)
 {
   m_homeAgentInfo = homeAgentInfo;
+  m_generation++;
 }
 
 uint32_t RadvdInterface::GetHomeAgentLifeTime () const
@@ -257,6 +287,7 @@ uint32_t RadvdInterface::GetHomeAgentLifeTime () const
 void RadvdInterface::SetHomeAgentLifeTime (uint32_t homeAgentLifeTime)
 {
   m_homeAgentLifeTime = homeAgentLifeTime;
+  m_generation++;
 }
 
 uint32_t RadvdInterface::GetHomeAgentPreference () const
@@ -267,6 +298,7 @@ uint32_t RadvdInterface::GetHomeAgentPreference () const
 void RadvdInterface::SetHomeAgentPreference (uint32_t homeAgentPreference)
 {
   m_homeAgentPreference = homeAgentPreference;
+  m_generation++;
 }
 
 bool RadvdInterface::IsMobRtrSupportFlag () const
@@ -277,6 +309,7 @@ bool RadvdInterface::IsMobRtrSupportFlag () const
 void RadvdInterface::SetMobRtrSupportFlag (bool mobRtrSupportFlag)
 {
   m_mobRtrSupportFlag = mobRtrSupportFlag;
+  m_generation++;
 }
 
 bool RadvdInterface::IsIntervalOpt () const
@@ -287,6 +320,7 @@ bool RadvdInterface::IsIntervalOpt () const
 void RadvdInterface::SetIntervalOpt (bool intervalOpt)
 {
   m_intervalOpt = intervalOpt;
+  m_generation++;
 }
 } /* namespace ns3 */
 
@@ -73,6 +73,13 @@ public:
    */
   void AddPrefix (Ptr<RadvdPrefix> routerPrefix);
 
+  /**
+   * \brief Get the generation of the configuration.
+   * \return a number changed by every setter, AddPrefix and every
+   * change of a prefix, to tell whether a built RA is still valid
+   */
+  uint32_t GetGeneration () const;
+
   /**
    * \brief Is send advert enabled (periodic RA and reply to RS) ?
    * \return send advert flag
@@ -304,6 +311,7 @@ public:
 private:
   typedef std::list<Ptr<RadvdPrefix> > RadvdPrefixList;
   typedef std::list<Ptr<RadvdPrefix> >::iterator RadvdPrefixListI;
+  typedef std::list<Ptr<RadvdPrefix> >::const_iterator RadvdPrefixListCI;
 
   /**
    * \brief Interface to advertise RA.
@@ -413,6 +421,11 @@ private:
    * \brief Flag to add Advertisement Interval option in RA.
    */
   bool m_intervalOpt;
+
+  /**
+   * \brief Number of changes of the configuration.
+   */
+  uint32_t m_generation;
 };
 
 } /* namespace ns3 */
@@ -30,7 +30,8 @@ RadvdPrefix::RadvdPrefix (Ipv6Address network, uint8_t prefixLength, uint32_t pr
     m_validLifeTime (validLifeTime),
     m_onLinkFlag (onLinkFlag),
     m_autonomousFlag (autonomousFlag),
-    m_routerAddrFlag (routerAddrFlag)
+    m_routerAddrFlag (routerAddrFlag),
+    m_generation (0)
 {
 }
 
@@ -38,6 +39,11 @@ RadvdPrefix::~RadvdPrefix ()
 {
 }
 
+uint32_t RadvdPrefix::GetGeneration () const
+{
+  return m_generation;
+}
+
 Ipv6Address RadvdPrefix::GetNetwork () const
 {
   return m_network;
@@ -46,6 +52,7 @@ Ipv6Address RadvdPrefix::GetNetwork () const
 void RadvdPrefix::SetNetwork (Ipv6Address network)
 {
   m_network = network;
+  m_generation++;
 }
 
 uint8_t RadvdPrefix::GetPrefixLength () const
@@ -56,6 +63,7 @@ uint8_t RadvdPrefix::GetPrefixLength () const
 void RadvdPrefix::SetPrefixLength (uint8_t prefixLength)
 {
   m_prefixLength = prefixLength;
+  m_generation++;
 }
 
 uint32_t RadvdPrefix::GetValidLifeTime () const
@@ -66,6 +74,7 @@ uint32_t RadvdPrefix::GetValidLifeTime () const
 void RadvdPrefix::SetValidLifeTime (uint32_t validLifeTime)
 {
   m_validLifeTime = validLifeTime;
+  m_generation++;
 }
 
 uint32_t RadvdPrefix::GetPreferredLifeTime () const
@@ -76,6 +85,7 @@ uint32_t RadvdPrefix::GetPreferredLifeTime () const
 void RadvdPrefix::SetPreferredLifeTime (uint32_t preferredLifeTime)
 {
   m_preferredLifeTime = preferredLifeTime;
+  m_generation++;
 }
 
 bool RadvdPrefix::IsOnLinkFlag () const
@@ -86,6 +96,7 @@ bool RadvdPrefix::IsOnLinkFlag () const
 void RadvdPrefix::SetOnLinkFlag (bool onLinkFlag)
 {
   m_onLinkFlag = onLinkFlag;
+  m_generation++;
 }
 
 bool RadvdPrefix::IsAutonomousFlag () const
@@ -96,6 +107,7 @@ bool RadvdPrefix::IsAutonomousFlag () const
 void RadvdPrefix::SetAutonomousFlag (bool autonomousFlag)
 {
   m_autonomousFlag = autonomousFlag;
+  m_generation++;
 }
 
 bool RadvdPrefix::IsRouterAddrFlag () const
@@ -106,6 +118,7 @@ bool RadvdPrefix::IsRouterAddrFlag () const
 void RadvdPrefix::SetRouterAddrFlag (bool routerAddrFlag)
 {
   m_routerAddrFlag = routerAddrFlag;
+  m_generation++;
 }
 
 } /* namespace ns3 */
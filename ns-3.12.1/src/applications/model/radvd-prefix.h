@@ -54,6 +54,12 @@ public:
    */
   ~RadvdPrefix ();
 
+  /**
+   * \brief Get the generation of the prefix.
+   * \return a number changed by every setter
+   */
+  uint32_t GetGeneration () const;
+
   /**
    * \brief Get network prefix.
    * \return network prefix
@@ -174,6 +180,11 @@ private:
    * of network prefix as is required by Mobile IPv6.
    */
   bool m_routerAddrFlag;
+
+  /**
+   * \brief Number of changes of the prefix.
+   */
+  uint32_t m_generation;
 };
 
 } /* namespace ns3 */
@@ -0,0 +1,336 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "dary-heap-scheduler.h"
+#include "event-impl.h"
+#include "double.h"
+#include "assert.h"
+#include "log.h"
+#include <string.h>
+
+NS_LOG_COMPONENT_DEFINE ("DaryHeapScheduler");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (DaryHeapScheduler);
+
+TypeId
+DaryHeapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DaryHeapScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<DaryHeapScheduler> ()
+    .AddAttribute ("PurgeThreshold",
+                   "The fraction of cancelled events in the heap above which they are dropped.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&DaryHeapScheduler::m_purgeThreshold),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+  ;
+  return tid;
+}
+
+DaryHeapScheduler::DaryHeapScheduler ()
+  : m_buffer (0),
+    m_nodes (0),
+    m_size (0),
+    m_capacity (0),
+    m_nCancelled (0),
+    m_purgeThreshold (0.5)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DaryHeapScheduler::~DaryHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+  delete [] m_buffer;
+}
+
+bool
+DaryHeapScheduler::IsLess (const Node &a, const Node &b) const
+{
+  return a.m_ts < b.m_ts || (a.m_ts == b.m_ts && a.m_uid < b.m_uid);
+}
+
+DaryHeapScheduler::Node &
+DaryHeapScheduler::At (uint32_t i) const
+{
+  return m_nodes[i + OFFSET];
+}
+
+Scheduler::Event
+DaryHeapScheduler::GetEvent (const Node &node) const
+{
+  const Slot &slot = m_slots[node.m_slot];
+  Event ev;
+  ev.impl = slot.m_impl;
+  ev.key.m_ts = node.m_ts;
+  ev.key.m_uid = node.m_uid;
+  ev.key.m_context = slot.m_context;
+  return ev;
+}
+
+uint32_t
+DaryHeapScheduler::AllocateSlot (const Event &ev)
+{
+  Slot slot;
+  slot.m_impl = ev.impl;
+  slot.m_context = ev.key.m_context;
+  if (m_freeSlots.empty ())
+    {
+      m_slots.push_back (slot);
+      return m_slots.size () - 1;
+    }
+  uint32_t index = m_freeSlots.back ();
+  m_freeSlots.pop_back ();
+  m_slots[index] = slot;
+  return index;
+}
+
+void
+DaryHeapScheduler::Grow (void)
+{
+  uint32_t capacity = m_capacity == 0 ? 64 : m_capacity * 2;
+  // room for the unused head of the array, and to align its start
+  char *buffer = new char [(capacity + OFFSET) * sizeof (Node) + CACHE_LINE];
+  Node *nodes = reinterpret_cast<Node *> ((reinterpret_cast<uintptr_t> (buffer) + CACHE_LINE - 1)
+                                          & ~(uintptr_t)(CACHE_LINE - 1));
+  if (m_size > 0)
+    {
+      memcpy (nodes + OFFSET, m_nodes + OFFSET, m_size * sizeof (Node));
+    }
+  delete [] m_buffer;
+  m_buffer = buffer;
+  m_nodes = nodes;
+  m_capacity = capacity;
+}
+
+void
+DaryHeapScheduler::SiftUp (uint32_t i)
+{
+  Node node = At (i);
+  while (i > 0)
+    {
+      uint32_t parent = (i - 1) / ARITY;
+      if (!IsLess (node, At (parent)))
+        {
+          break;
+        }
+      At (i) = At (parent);
+      i = parent;
+    }
+  At (i) = node;
+}
+
+uint32_t
+DaryHeapScheduler::SmallestChild (uint32_t first) const
+{
+  if (first + ARITY <= m_size)
+    {
+      // all the children are there: pairwise, the two halves do not depend
+      // on each other
+      uint32_t a = IsLess (At (first + 1), At (first)) ? first + 1 : first;
+      uint32_t b = IsLess (At (first + 3), At (first + 2)) ? first + 3 : first + 2;
+      return IsLess (At (b), At (a)) ? b : a;
+    }
+  uint32_t smallest = first;
+  for (uint32_t child = first + 1; child < m_size; child++)
+    {
+      if (IsLess (At (child), At (smallest)))
+        {
+          smallest = child;
+        }
+    }
+  return smallest;
+}
+
+void
+DaryHeapScheduler::SiftDown (uint32_t i)
+{
+  Node node = At (i);
+  while (true)
+    {
+      uint32_t first = i * ARITY + 1;
+      if (first >= m_size)
+        {
+          break;
+        }
+      uint32_t smallest = SmallestChild (first);
+      if (!IsLess (At (smallest), node))
+        {
+          break;
+        }
+      At (i) = At (smallest);
+      i = smallest;
+    }
+  At (i) = node;
+}
+
+void
+DaryHeapScheduler::RemoveAt (uint32_t i)
+{
+  m_freeSlots.push_back (At (i).m_slot);
+  m_size--;
+  if (i == m_size)
+    {
+      return;
+    }
+  At (i) = At (m_size);
+  if (i > 0 && IsLess (At (i), At ((i - 1) / ARITY)))
+    {
+      SiftUp (i);
+    }
+  else
+    {
+      SiftDown (i);
+    }
+}
+
+void
+DaryHeapScheduler::Purge (void)
+{
+  NS_LOG_FUNCTION (this << m_size << m_nCancelled);
+
+  uint32_t kept = 0;
+  for (uint32_t i = 0; i < m_size; i++)
+    {
+      Node node = At (i);
+      EventImpl *impl = m_slots[node.m_slot].m_impl;
+      if (impl->IsCancelled ())
+        {
+          // the simulator will never see this event again
+          impl->Unref ();
+          m_freeSlots.push_back (node.m_slot);
+        }
+      else
+        {
+          At (kept++) = node;
+        }
+    }
+  m_size = kept;
+  m_nCancelled = 0;
+
+  // rebuild bottom-up from the last parent
+  if (m_size > 1)
+    {
+      for (uint32_t i = (m_size - 2) / ARITY + 1; i > 0; i--)
+        {
+          SiftDown (i - 1);
+        }
+    }
+}
+
+void
+DaryHeapScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  if (m_size == m_capacity)
+    {
+      Grow ();
+    }
+  Node &node = At (m_size);
+  node.m_ts = ev.key.m_ts;
+  node.m_uid = ev.key.m_uid;
+  node.m_slot = AllocateSlot (ev);
+  m_size++;
+  SiftUp (m_size - 1);
+
+  // cancelled before it came from another scheduler
+  if (ev.impl->IsCancelled ())
+    {
+      m_nCancelled++;
+    }
+}
+
+bool
+DaryHeapScheduler::IsEmpty (void) const
+{
+  return m_size == 0;
+}
+
+Scheduler::Event
+DaryHeapScheduler::PeekNext (void) const
+{
+  NS_ASSERT (m_size > 0);
+  return GetEvent (At (0));
+}
+
+Scheduler::Event
+DaryHeapScheduler::RemoveNext (void)
+{
+  NS_ASSERT (m_size > 0);
+  Event ev = GetEvent (At (0));
+  m_freeSlots.push_back (At (0).m_slot);
+  m_size--;
+  if (m_size > 0)
+    {
+      // move the hole down to a leaf along the smallest children, then
+      // sift the last node up from there: it usually belongs near the
+      // bottom, which saves most of the comparisons with it
+      Node last = At (m_size);
+      uint32_t i = 0;
+      uint32_t first = 1;
+      while (first < m_size)
+        {
+          uint32_t smallest = SmallestChild (first);
+          At (i) = At (smallest);
+          i = smallest;
+          first = i * ARITY + 1;
+        }
+      At (i) = last;
+      SiftUp (i);
+    }
+  if (ev.impl->IsCancelled () && m_nCancelled > 0)
+    {
+      m_nCancelled--;
+    }
+#ifdef __GNUC__
+  if (m_size > 0)
+    {
+      __builtin_prefetch (&m_slots[At (0).m_slot]);
+    }
+#endif
+  return ev;
+}
+
+void
+DaryHeapScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (m_size > 0);
+  for (uint32_t i = 0; i < m_size; i++)
+    {
+      if (At (i).m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (m_slots[At (i).m_slot].m_impl == ev.impl);
+          RemoveAt (i);
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+void
+DaryHeapScheduler::NotifyCancel (const Event &ev)
+{
+  m_nCancelled++;
+  if (m_size >= MIN_PURGE_SIZE && m_nCancelled > m_purgeThreshold * m_size)
+    {
+      Purge ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DARY_HEAP_SCHEDULER_H
+#define DARY_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a cache-conscious 4-ary heap event scheduler
+ *
+ * The heap is an implicit 4-ary heap of 16-byte nodes which hold the
+ * timestamp and uid of an event, the only fields compared, and the
+ * index of a side slot which holds its EventImpl and context. The
+ * array is laid out so that the four children of a node share one
+ * 64-byte cache line: a top-down heapify touches one line per level,
+ * and the tree is half as deep as a binary heap.
+ *
+ * Cancelled events are counted as the simulator reports them. Once they
+ * make up more than the PurgeThreshold fraction of the heap, they are
+ * dropped all at once and the heap is rebuilt bottom-up, so that timers
+ * cancelled and scheduled again do not grow the event list.
+ */
+class DaryHeapScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  DaryHeapScheduler ();
+  virtual ~DaryHeapScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+  virtual void NotifyCancel (const Event &ev);
+
+private:
+  enum
+  {
+    ARITY = 4,
+    /* the root is stored at this index, which aligns the children of
+     * every node on a multiple of ARITY */
+    OFFSET = ARITY - 1,
+    CACHE_LINE = 64,
+    /* smaller heaps are not worth purging */
+    MIN_PURGE_SIZE = 64
+  };
+
+  struct Node
+  {
+    uint64_t m_ts;
+    uint32_t m_uid;
+    uint32_t m_slot;
+  };
+  struct Slot
+  {
+    EventImpl *m_impl;
+    uint32_t m_context;
+  };
+
+  inline bool IsLess (const Node &a, const Node &b) const;
+  inline Node &At (uint32_t i) const;
+  Event GetEvent (const Node &node) const;
+  uint32_t SmallestChild (uint32_t first) const;
+  uint32_t AllocateSlot (const Event &ev);
+  void Grow (void);
+  void SiftUp (uint32_t i);
+  void SiftDown (uint32_t i);
+  void RemoveAt (uint32_t i);
+  void Purge (void);
+
+  DaryHeapScheduler (const DaryHeapScheduler &);
+  DaryHeapScheduler &operator = (const DaryHeapScheduler &);
+
+  char *m_buffer;
+  Node *m_nodes;
+  uint32_t m_size;
+  uint32_t m_capacity;
+  std::vector<Slot> m_slots;
+  std::vector<uint32_t> m_freeSlots;
+  uint32_t m_nCancelled;
+  double m_purgeThreshold;
+};
+
+} // namespace ns3
+
+#endif /* DARY_HEAP_SCHEDULER_H */
@@ -19,9 +19,120 @@
  */
 
 #include "event-impl.h"
+#include "ns3/core-config.h"
+#include <new>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 namespace ns3 {
 
+#ifdef EVENT_IMPL_USE_POOL
+
+enum
+{
+  POOL_ALIGN = 16,
+  POOL_MAX_SIZE = 256,
+  POOL_N_CLASSES = POOL_MAX_SIZE / POOL_ALIGN,
+  // a thread which frees more events than it allocates, such as the
+  // simulation thread with events scheduled by another one, gives the
+  // rest back to the heap
+  POOL_MAX_FREE = 4096
+};
+
+struct PoolNode
+{
+  PoolNode *m_next;
+};
+
+static __thread PoolNode *g_poolFree[POOL_N_CLASSES];
+static __thread uint32_t g_poolNFree[POOL_N_CLASSES];
+
+#ifdef HAVE_PTHREAD_H
+static __thread bool g_poolRegistered = false;
+static pthread_key_t g_poolKey;
+static pthread_once_t g_poolOnce = PTHREAD_ONCE_INIT;
+
+static void
+PoolRelease (void *)
+{
+  for (uint32_t i = 0; i < POOL_N_CLASSES; i++)
+    {
+      while (g_poolFree[i] != 0)
+        {
+          PoolNode *node = g_poolFree[i];
+          g_poolFree[i] = node->m_next;
+          ::operator delete (node);
+        }
+      g_poolNFree[i] = 0;
+    }
+}
+
+static void
+PoolCreateKey (void)
+{
+  pthread_key_create (&g_poolKey, &PoolRelease);
+}
+
+// the free lists of a thread go back to the heap when it exits
+static void
+PoolRegisterThread (void)
+{
+  pthread_once (&g_poolOnce, &PoolCreateKey);
+  pthread_setspecific (g_poolKey, &g_poolRegistered);
+  g_poolRegistered = true;
+}
+#endif /* HAVE_PTHREAD_H */
+
+#endif /* EVENT_IMPL_USE_POOL */
+
+void *
+EventImpl::operator new (size_t size)
+{
+#ifdef EVENT_IMPL_USE_POOL
+  if (size <= POOL_MAX_SIZE)
+    {
+      uint32_t i = (size - 1) / POOL_ALIGN;
+      PoolNode *node = g_poolFree[i];
+      if (node != 0)
+        {
+          g_poolFree[i] = node->m_next;
+          g_poolNFree[i]--;
+          return node;
+        }
+      // rounded up, so that any event of the same size class can reuse it
+      return ::operator new ((i + 1) * POOL_ALIGN);
+    }
+#endif /* EVENT_IMPL_USE_POOL */
+  return ::operator new (size);
+}
+
+void
+EventImpl::operator delete (void *p, size_t size)
+{
+#ifdef EVENT_IMPL_USE_POOL
+  if (p != 0 && size <= POOL_MAX_SIZE)
+    {
+      uint32_t i = (size - 1) / POOL_ALIGN;
+      if (g_poolNFree[i] < POOL_MAX_FREE)
+        {
+#ifdef HAVE_PTHREAD_H
+          if (!g_poolRegistered)
+            {
+              PoolRegisterThread ();
+            }
+#endif /* HAVE_PTHREAD_H */
+          PoolNode *node = static_cast<PoolNode *> (p);
+          node->m_next = g_poolFree[i];
+          g_poolFree[i] = node;
+          g_poolNFree[i]++;
+          return;
+        }
+    }
+#endif /* EVENT_IMPL_USE_POOL */
+  ::operator delete (p);
+}
+
 EventImpl::~EventImpl ()
 {
 }
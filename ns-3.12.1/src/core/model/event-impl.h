@@ -20,6 +20,7 @@
 #ifndef EVENT_IMPL_H
 #define EVENT_IMPL_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include "simple-ref-count.h"
 
@@ -35,12 +36,21 @@ namespace ns3 {
  * obviously (there are Ref and Unref methods) reference-counted and
  * most subclasses are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are allocated from per-thread free lists, one for each size class
+ * of 16 bytes up to 256 bytes. The subclasses created by MakeEvent hold the
+ * bound arguments inline, so scheduling a function or method with up to
+ * five arguments of a few words each does not go through the global heap
+ * once the simulation is warmed up. Larger events, and every event when
+ * ns-3 is configured with --disable-event-pool, use the global heap.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
 public:
   EventImpl ();
   virtual ~EventImpl () = 0;
+  static void *operator new (size_t size);
+  static void operator delete (void *p, size_t size);
   /**
    * Called by the simulation engine to notify the event that it has expired.
    */
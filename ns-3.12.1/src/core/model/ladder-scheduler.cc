@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+static bool
+IsLater (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return b < a;
+}
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_topMin (~(uint64_t)0),
+    m_topMax (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LadderScheduler::InitRung (Rung &rung, uint64_t start, uint64_t width, uint32_t nBuckets)
+{
+  NS_LOG_FUNCTION (this << start << width << nBuckets);
+  // the buckets of a rung dropped from the ladder are all empty
+  if (rung.m_buckets.size () < nBuckets)
+    {
+      rung.m_buckets.resize (nBuckets);
+    }
+  rung.m_nBuckets = nBuckets;
+  rung.m_start = start;
+  rung.m_width = width;
+  rung.m_current = 0;
+}
+
+void
+LadderScheduler::SpawnRung (const Bucket &events, uint64_t start, uint64_t end)
+{
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+  NS_ASSERT (!events.empty () && end > start);
+
+  // one event per bucket on average, but no bucket narrower than 1ns
+  uint64_t span = end - start;
+  uint32_t nBuckets = events.size ();
+  if (span < nBuckets)
+    {
+      nBuckets = span;
+    }
+  uint64_t width = (span + nBuckets - 1) / nBuckets;
+
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  InitRung (rung, start, width, nBuckets);
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); i++)
+    {
+      uint64_t index = (i->key.m_ts - start) / width;
+      NS_ASSERT (i->key.m_ts >= start && index < nBuckets);
+      rung.m_buckets[index].push_back (*i);
+    }
+}
+
+bool
+LadderScheduler::InsertInLadder (const Event &ev)
+{
+  uint64_t ts = ev.key.m_ts;
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      if (ts >= rung.m_start + rung.m_current * rung.m_width)
+        {
+          uint64_t index = (ts - rung.m_start) / rung.m_width;
+          NS_ASSERT (index < rung.m_nBuckets);
+          rung.m_buckets[index].push_back (ev);
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+LadderScheduler::InsertInBottom (const Event &ev)
+{
+  m_bottom.insert (std::upper_bound (m_bottom.begin (), m_bottom.end (), ev, IsLater), ev);
+
+  if (m_bottom.size () > THRESHOLD
+      && m_nRungs < MAX_RUNGS
+      && m_bottom.front ().key.m_ts > m_bottom.back ().key.m_ts)
+    {
+      // too many events were scheduled in the near future to keep them
+      // sorted: spread them over a rung below the ladder
+      uint64_t end = m_topStart;
+      if (m_nRungs > 0)
+        {
+          const Rung &rung = m_rungs[m_nRungs - 1];
+          end = rung.m_start + rung.m_current * rung.m_width;
+        }
+      m_spare.swap (m_bottom);
+      SpawnRung (m_spare, m_spare.back ().key.m_ts, end);
+      m_spare.clear ();
+      FillBottom ();
+    }
+}
+
+void
+LadderScheduler::FillBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          if (m_top.empty ())
+            {
+              return;
+            }
+          // start a new epoch with the events of Top
+          SpawnRung (m_top, m_topMin, m_topMax + 1);
+          m_top.clear ();
+          m_topStart = m_rungs[0].m_start + m_rungs[0].m_nBuckets * m_rungs[0].m_width;
+          m_topMin = ~(uint64_t)0;
+          m_topMax = 0;
+          continue;
+        }
+
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.m_current < rung.m_nBuckets
+             && rung.m_buckets[rung.m_current].empty ())
+        {
+          rung.m_current++;
+        }
+      if (rung.m_current == rung.m_nBuckets)
+        {
+          m_nRungs--;
+          continue;
+        }
+
+      Bucket &bucket = rung.m_buckets[rung.m_current];
+      uint64_t start = rung.m_start + rung.m_current * rung.m_width;
+      rung.m_current++;
+      if (bucket.size () > THRESHOLD && m_nRungs < MAX_RUNGS && rung.m_width > 1)
+        {
+          m_spare.swap (bucket);
+          SpawnRung (m_spare, start, start + rung.m_width);
+          m_spare.clear ();
+        }
+      else
+        {
+          m_bottom.swap (bucket);
+          std::sort (m_bottom.begin (), m_bottom.end (), IsLater);
+        }
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  m_size++;
+  if (ev.key.m_ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ev.key.m_ts);
+      m_topMax = std::max (m_topMax, ev.key.m_ts);
+    }
+  else if (!InsertInLadder (ev))
+    {
+      InsertInBottom (ev);
+    }
+  if (m_bottom.empty ())
+    {
+      FillBottom ();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_bottom.empty ());
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_bottom.empty ());
+  Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_size--;
+  if (m_bottom.empty ())
+    {
+      FillBottom ();
+    }
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket = &m_bottom;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      for (uint32_t i = 0; i < m_nRungs; i++)
+        {
+          Rung &rung = m_rungs[i];
+          if (ts >= rung.m_start + rung.m_current * rung.m_width)
+            {
+              bucket = &rung.m_buckets[(ts - rung.m_start) / rung.m_width];
+              break;
+            }
+        }
+    }
+
+  for (Bucket::iterator i = bucket->begin (); i != bucket->end (); i++)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (i->impl == ev.impl);
+          if (bucket == &m_bottom)
+            {
+              m_bottom.erase (i);
+            }
+          else
+            {
+              // the other buckets are not sorted
+              *i = bucket->back ();
+              bucket->pop_back ();
+            }
+          m_size--;
+          if (m_bottom.empty ())
+            {
+              FillBottom ();
+            }
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
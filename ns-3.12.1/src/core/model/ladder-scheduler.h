@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in "Ladder
+ * Queue: An O(1) Priority Queue Structure for Large-Scale Discrete Event
+ * Simulation" by Tang, Goh and Thng (2005). Events are kept in three tiers:
+ *  - Top, an unsorted list of the far-future events;
+ *  - the ladder, a few rungs of unsorted buckets. When the ladder runs
+ *    out, Top is spread over a new first rung whose bucket width is the
+ *    time span of Top divided by its number of events. A bucket which
+ *    holds too many events to be sorted is spread over a finer rung;
+ *  - Bottom, a short sorted list of the events due next, taken from the
+ *    first non-empty bucket of the finest rung.
+ *
+ * Most events are appended to a bucket or to Top and are only sorted once,
+ * in a small batch, so that insert and remove take O(1) amortized time
+ * whatever the distribution of the timestamps. Buckets are vectors which
+ * are reused from one rung to the next: once warmed up, the queue does not
+ * allocate memory per event.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LadderScheduler ();
+  virtual ~LadderScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+private:
+  enum
+  {
+    /* a bucket with more events than this is spread over a new rung
+     * rather than sorted into Bottom */
+    THRESHOLD = 50,
+    MAX_RUNGS = 8
+  };
+
+  typedef std::vector<Scheduler::Event> Bucket;
+  struct Rung
+  {
+    std::vector<Bucket> m_buckets;
+    // number of buckets in use
+    uint32_t m_nBuckets;
+    // timestamp at the start of the first bucket
+    uint64_t m_start;
+    // duration of a bucket
+    uint64_t m_width;
+    // first bucket which has not been moved down the ladder yet
+    uint32_t m_current;
+  };
+
+  void InitRung (Rung &rung, uint64_t start, uint64_t width, uint32_t nBuckets);
+  void SpawnRung (const Bucket &events, uint64_t start, uint64_t end);
+  bool InsertInLadder (const Event &ev);
+  void InsertInBottom (const Event &ev);
+  void FillBottom (void);
+
+  LadderScheduler (const LadderScheduler &);
+  LadderScheduler &operator = (const LadderScheduler &);
+
+  Bucket m_top;
+  // every event in Top is at or after m_topStart, every other one before
+  uint64_t m_topStart;
+  uint64_t m_topMin;
+  uint64_t m_topMax;
+
+  // rung 0 is the coarsest one
+  std::vector<Rung> m_rungs;
+  uint32_t m_nRungs;
+
+  // sorted in decreasing order, the next event is at the back
+  Bucket m_bottom;
+  // a spare bucket to swap with the one spread over a new rung
+  Bucket m_spare;
+
+  uint32_t m_size;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -316,7 +316,11 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     NS_ASSERT_MSG (m_events->IsEmpty () == false, 
                    "RealtimeSimulatorImpl::ProcessOneEvent(): event queue is empty");
     next = m_events->RemoveNext ();
-    m_unscheduledEvents--;
+    // cancelled events were accounted for by Cancel
+    if (!next.impl->IsCancelled ())
+      {
+        m_unscheduledEvents--;
+      }
 
     //
     // We cannot make any assumption that "next" is the same event we originally waited 
@@ -514,7 +518,11 @@ RealtimeSimulatorImpl::RunOneEvent (void)
     Scheduler::Event next = m_events->RemoveNext ();
 
     NS_ASSERT (next.key.m_ts >= m_currentTs);
-    m_unscheduledEvents--;
+    // cancelled events were accounted for by Cancel
+    if (!next.impl->IsCancelled ())
+      {
+        m_unscheduledEvents--;
+      }
 
     NS_LOG_LOGIC ("handle " << next.key.m_ts);
     m_currentTs = next.key.m_ts;
@@ -774,6 +782,21 @@ RealtimeSimulatorImpl::Cancel (const EventId &id)
   if (IsExpired (id) == false)
     {
       id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () == 2)
+        {
+          // destroy events are not in the event list
+          return;
+        }
+      Scheduler::Event event;
+      event.impl = id.PeekEventImpl ();
+      event.key.m_ts = id.GetTs ();
+      event.key.m_context = id.GetContext ();
+      event.key.m_uid = id.GetUid ();
+
+      CriticalSection cs (m_mutex);
+      // the scheduler may drop the event before it is due
+      m_unscheduledEvents--;
+      m_events->NotifyCancel (event);
     }
 }
 
@@ -23,6 +23,10 @@
 #include "rng-stream.h"
 #include "global-value.h"
 #include "integer.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 using namespace std;
 
 namespace
@@ -337,14 +341,25 @@ double RngStream::nextSeed[6] =
 //-------------------------------------------------------------------------
 // constructor
 //
+#ifdef HAVE_PTHREAD_H
+// streams may be created by the threads of a multi-threaded simulation
+static pthread_mutex_t g_nextSeedMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 RngStream::RngStream ()
 {
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&g_nextSeedMutex);
+#endif
   uint32_t run = EnsureGlobalInitialized ();
 
   anti = false;
   incPrec = false;
   // Stream initialization moved to separate method.
   InitializeStream ();
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&g_nextSeedMutex);
+#endif
   //move the state of this stream up
   ResetNthSubstream (run);
 }
@@ -38,4 +38,9 @@ Scheduler::GetTypeId (void)
   return tid;
 }
 
+void
+Scheduler::NotifyCancel (const Event &ev)
+{
+}
+
 } // namespace ns3
@@ -95,6 +95,15 @@ public:
    * This methods cannot be invoked if the list is empty.
    */
   virtual void Remove (const Event &ev) = 0;
+  /**
+   * \param ev an event of the event list which was just cancelled
+   *
+   * A cancelled event stays in the event list until it is removed as
+   * the next earliest event. A scheduler may instead drop it earlier,
+   * in which case it unrefs the EventImpl itself. The default
+   * implementation does nothing.
+   */
+  virtual void NotifyCancel (const Event &ev);
 };
 
 /* Note the invariants which this function must provide:
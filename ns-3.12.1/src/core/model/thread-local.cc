@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "thread-local.h"
+#include "assert.h"
+#include <stdint.h>
+#if defined (HAVE_PTHREAD_H) && defined (HAVE_TLS)
+#include <pthread.h>
+#endif
+
+namespace ns3 {
+
+#if defined (HAVE_PTHREAD_H) && defined (HAVE_TLS)
+
+enum
+{
+  MAX_CLEANUPS = 16
+};
+
+static NS_THREAD_LOCAL void (*g_cleanups[MAX_CLEANUPS])(void);
+static NS_THREAD_LOCAL uint32_t g_nCleanups;
+static pthread_key_t g_cleanupKey;
+static pthread_once_t g_cleanupOnce = PTHREAD_ONCE_INIT;
+
+static void
+RunThreadCleanups (void *)
+{
+  // the last one registered goes first
+  while (g_nCleanups > 0)
+    {
+      g_nCleanups--;
+      g_cleanups[g_nCleanups] ();
+    }
+}
+
+static void
+CreateCleanupKey (void)
+{
+  pthread_key_create (&g_cleanupKey, &RunThreadCleanups);
+}
+
+void
+RegisterThreadCleanup (void (*cleanup)(void))
+{
+  NS_ASSERT (g_nCleanups < MAX_CLEANUPS);
+  pthread_once (&g_cleanupOnce, &CreateCleanupKey);
+  // the key only needs a non-null value for its destructor to run
+  pthread_setspecific (g_cleanupKey, &g_nCleanups);
+  g_cleanups[g_nCleanups] = cleanup;
+  g_nCleanups++;
+}
+
+#else /* HAVE_PTHREAD_H && HAVE_TLS */
+
+void
+RegisterThreadCleanup (void (*)(void))
+{
+  // there is no thread but the main one
+}
+
+#endif /* HAVE_PTHREAD_H && HAVE_TLS */
+
+// only written while no simulation thread but the main one runs
+static bool (*g_otherThreadContext)(uint32_t context) = 0;
+
+bool
+IsOtherThreadContext (uint32_t context)
+{
+  return g_otherThreadContext != 0 && g_otherThreadContext (context);
+}
+
+void
+SetOtherThreadContextPredicate (bool (*predicate)(uint32_t context))
+{
+  g_otherThreadContext = predicate;
+}
+
+} // namespace ns3
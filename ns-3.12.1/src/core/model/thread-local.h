@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef THREAD_LOCAL_H
+#define THREAD_LOCAL_H
+
+#include "ns3/core-config.h"
+#include <stdint.h>
+
+/**
+ * \ingroup core
+ * \brief give each thread its own instance of a static variable
+ *
+ * The variable must be of a type without constructor nor destructor.
+ * Without compiler support for thread-local storage, there is a single
+ * instance which only one simulation thread may use.
+ */
+#ifdef HAVE_TLS
+#define NS_THREAD_LOCAL __thread
+#else
+#define NS_THREAD_LOCAL
+#endif
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \param cleanup the function to call when the calling thread exits
+ *
+ * The function is called from the exiting thread while its
+ * NS_THREAD_LOCAL variables are still valid, so that it can give the
+ * memory they hold back to the heap. It is not called for the main
+ * thread, whose variables are dealt with by static destructors.
+ */
+void RegisterThreadCleanup (void (*cleanup)(void));
+
+/**
+ * \ingroup core
+ * \param context the context of an event about to be scheduled
+ * \returns true if the event is to run on another thread than the
+ *          calling one.
+ *
+ * Such an event must not share any object with the caller but the
+ * receiving node itself: a channel uses this to hand a copy of the
+ * packet over instead of the packet. Always false unless a simulator
+ * implementation which runs nodes on several threads is running.
+ */
+bool IsOtherThreadContext (uint32_t context);
+
+/**
+ * \ingroup core
+ * \param predicate the function IsOtherThreadContext answers with,
+ *        0 for none
+ *
+ * Set by a simulator implementation before it starts its threads, and
+ * reset once they are joined.
+ */
+void SetOtherThreadContextPredicate (bool (*predicate)(uint32_t context));
+
+} // namespace ns3
+
+#endif /* THREAD_LOCAL_H */
@@ -78,6 +78,12 @@ public:
    * of the TracedCallback::Connect method.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * \returns true if no callback is connected.
+   *
+   * Lets a trace source skip the work it would only do to fire.
+   */
+  bool IsEmpty (void) const;
   void operator() (void) const;
   void operator() (T1 a1) const;
   void operator() (T1 a1, T2 a2) const;
@@ -162,6 +168,15 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callba
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
   DisconnectWithoutContext (realCb);
 }
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+  return m_callbackList.empty ();
+}
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
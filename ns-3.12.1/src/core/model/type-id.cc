@@ -20,8 +20,13 @@
 #include "type-id.h"
 #include "singleton.h"
 #include "trace-source-accessor.h"
+#include "sgi-hashmap.h"
+#include "ns3/core-config.h"
 #include <vector>
 #include <sstream>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 /*********************************************************************
  *         Helper code
@@ -29,6 +34,19 @@
 
 namespace {
 
+struct StringHash : public std::unary_function<std::string, size_t>
+{
+  size_t operator () (const std::string &s) const
+  {
+    return sgi::hash<const char *> () (s.c_str ());
+  }
+};
+
+#ifdef HAVE_PTHREAD_H
+// the threads of a multi-threaded simulation may build the same index
+static pthread_mutex_t g_indexMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 class IidManager
 {
 public:
@@ -65,11 +83,23 @@ public:
   uint32_t GetTraceSourceN (uint16_t uid) const;
   struct ns3::TypeId::TraceSourceInformation GetTraceSource(uint16_t uid, uint32_t i) const;
   bool MustHideFromDocumentation (uint16_t uid) const;
+  bool LookupAttribute (uint16_t uid, std::string name,
+                        struct ns3::TypeId::AttributeInformation *info) const;
+  ns3::Ptr<const ns3::TraceSourceAccessor> LookupTraceSource (uint16_t uid, std::string name) const;
 
 private:
   bool HasTraceSource (uint16_t uid, std::string name);
   bool HasAttribute (uint16_t uid, std::string name);
 
+  // an attribute or a trace source: the uid of the type which
+  // registered it and its index in the list of this type
+  struct Member {
+    uint16_t uid;
+    uint32_t index;
+  };
+  typedef sgi::hash_map<std::string, struct Member, StringHash> MemberMap;
+  typedef sgi::hash_map<std::string, uint16_t, StringHash> NameMap;
+
   struct IidInformation {
     std::string name;
     uint16_t parent;
@@ -79,30 +109,35 @@ private:
     bool mustHideFromDocumentation;
     std::vector<struct ns3::TypeId::AttributeInformation> attributes;
     std::vector<struct ns3::TypeId::TraceSourceInformation> traceSources;
+    // the attributes and trace sources of the type and of its parents by
+    // name, valid while indexGeneration is the generation of the manager
+    MemberMap attributeIndex;
+    MemberMap traceSourceIndex;
+    uint32_t indexGeneration;
   };
-  typedef std::vector<struct IidInformation>::const_iterator Iterator;
 
   struct IidManager::IidInformation *LookupInformation (uint16_t uid) const;
+  struct IidManager::IidInformation *LookupIndexedInformation (uint16_t uid) const;
 
   std::vector<struct IidInformation> m_information;
+  NameMap m_namemap;
+  // bumped when a type gets a parent, an attribute or a trace source,
+  // which may change the index of this type and of its children
+  uint32_t m_generation;
 };
 
 IidManager::IidManager ()
+  : m_generation (1)
 {
 }
 
 uint16_t
 IidManager::AllocateUid (std::string name)
 {
-  uint16_t j = 1;
-  for (Iterator i = m_information.begin (); i != m_information.end (); i++)
+  if (m_namemap.find (name) != m_namemap.end ())
     {
-      if (i->name == name)
-        {
-          NS_FATAL_ERROR ("Trying to allocate twice the same uid: " << name);
-          return 0;
-        }
-      j++;
+      NS_FATAL_ERROR ("Trying to allocate twice the same uid: " << name);
+      return 0;
     }
   struct IidInformation information;
   information.name = name;
@@ -110,9 +145,11 @@ IidManager::AllocateUid (std::string name)
   information.groupName = "";
   information.hasConstructor = false;
   information.mustHideFromDocumentation = false;
+  information.indexGeneration = 0;
   m_information.push_back (information);
   uint32_t uid = m_information.size ();
   NS_ASSERT (uid <= 0xffff);
+  m_namemap[name] = uid;
   return uid;
 }
 
@@ -129,6 +166,7 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
   information->parent = parent;
+  m_generation++;
 }
 void 
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -158,17 +196,12 @@ IidManager::AddConstructor (uint16_t uid, ns3::Callback<ns3::ObjectBase *> callb
 uint16_t 
 IidManager::GetUid (std::string name) const
 {
-  uint32_t j = 1;
-  for (Iterator i = m_information.begin (); i != m_information.end (); i++)
+  NameMap::const_iterator i = m_namemap.find (name);
+  if (i == m_namemap.end ())
     {
-      if (i->name == name)
-        {
-          NS_ASSERT (j <= 0xffff);
-          return j;
-        }
-      j++;
+      return 0;
     }
-  return 0;
+  return i->second;
 }
 std::string 
 IidManager::GetName (uint16_t uid) const
@@ -269,6 +302,7 @@ IidManager::AddAttribute (uint16_t uid,
   info.accessor = accessor;
   info.checker = checker;
   information->attributes.push_back (info);
+  m_generation++;
 }
 void 
 IidManager::SetAttributeInitialValue(uint16_t uid,
@@ -340,6 +374,7 @@ IidManager::AddTraceSource (uint16_t uid,
   source.help = help;
   source.accessor = accessor;
   information->traceSources.push_back (source);
+  m_generation++;
 }
 uint32_t 
 IidManager::GetTraceSourceN (uint16_t uid) const
@@ -361,6 +396,83 @@ IidManager::MustHideFromDocumentation (uint16_t uid) const
   return information->mustHideFromDocumentation;
 }
 
+struct IidManager::IidInformation *
+IidManager::LookupIndexedInformation (uint16_t uid) const
+{
+  struct IidInformation *information = LookupInformation (uid);
+  if (information->indexGeneration == m_generation)
+    {
+      return information;
+    }
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&g_indexMutex);
+#endif
+  if (information->indexGeneration != m_generation)
+    {
+      information->attributeIndex.clear ();
+      information->traceSourceIndex.clear ();
+      uint16_t current = uid;
+      while (true)
+        {
+          struct IidInformation *tmp = LookupInformation (current);
+          // insert does not replace a name already there: the attributes
+          // and trace sources of a child hide those of its parents
+          for (uint32_t i = 0; i < tmp->attributes.size (); i++)
+            {
+              struct Member member = { current, i };
+              information->attributeIndex.insert (std::make_pair (tmp->attributes[i].name, member));
+            }
+          for (uint32_t i = 0; i < tmp->traceSources.size (); i++)
+            {
+              struct Member member = { current, i };
+              information->traceSourceIndex.insert (std::make_pair (tmp->traceSources[i].name, member));
+            }
+          if (tmp->parent == current || tmp->parent == 0)
+            {
+              // top of inheritance tree
+              break;
+            }
+          current = tmp->parent;
+        }
+      // publish the index only once it is complete
+#ifdef __GNUC__
+      __sync_synchronize ();
+#endif
+      information->indexGeneration = m_generation;
+    }
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&g_indexMutex);
+#endif
+  return information;
+}
+
+bool
+IidManager::LookupAttribute (uint16_t uid, std::string name,
+                             struct ns3::TypeId::AttributeInformation *info) const
+{
+  struct IidInformation *information = LookupIndexedInformation (uid);
+  MemberMap::const_iterator i = information->attributeIndex.find (name);
+  if (i == information->attributeIndex.end ())
+    {
+      return false;
+    }
+  // the initial value may have changed since the index was built
+  *info = LookupInformation (i->second.uid)->attributes[i->second.index];
+  return true;
+}
+
+ns3::Ptr<const ns3::TraceSourceAccessor>
+IidManager::LookupTraceSource (uint16_t uid, std::string name) const
+{
+  struct IidInformation *information = LookupIndexedInformation (uid);
+  MemberMap::const_iterator i = information->traceSourceIndex.find (name);
+  if (i == information->traceSourceIndex.end ())
+    {
+      return 0;
+    }
+  return LookupInformation (i->second.uid)->traceSources[i->second.index].accessor;
+}
+
 } // anonymous namespace
 
 namespace ns3 {
@@ -414,22 +526,7 @@ TypeId::GetRegistered (uint32_t i)
 bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute(i);
-          if (tmp.name == name)
-            {
-              *info = tmp;
-              return true;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return false;
+  return Singleton<IidManager>::Get ()->LookupAttribute (m_tid, name, info);
 }
 
 TypeId 
@@ -588,21 +685,7 @@ TypeId::HideFromDocumentation (void)
 Ptr<const TraceSourceAccessor> 
 TypeId::LookupTraceSourceByName (std::string name) const
 {
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetTraceSourceN (); i++)
-        {
-          struct TypeId::TraceSourceInformation info = tid.GetTraceSource (i);
-          if (info.name == name)
-            {
-              return info.accessor;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return 0;
+  return Singleton<IidManager>::Get ()->LookupTraceSource (m_tid, name);
 }
 
 uint16_t 
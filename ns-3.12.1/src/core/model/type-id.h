@@ -281,6 +281,9 @@ public:
    * \param info a pointer to the TypeId::AttributeInformation data structure
    *        where the result value of this method will be stored.
    * \returns true if the requested attribute could be found, false otherwise.
+   *
+   * The attributes of this TypeId and of its parents are indexed by
+   * name in a hash table, built by the first lookup.
    */
   bool LookupAttributeByName (std::string name, struct AttributeInformation *info) const;
   /**
@@ -289,6 +292,7 @@ public:
    *          trace sinks with the requested trace source on an object instance.
    *
    * If no matching trace source is found, this method returns zero.
+   * The trace sources are indexed like the attributes.
    */
   Ptr<const TraceSourceAccessor> LookupTraceSourceByName (std::string name) const;
 
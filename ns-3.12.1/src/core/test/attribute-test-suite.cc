@@ -1102,6 +1102,75 @@ CallbackValueTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_gotCbValue, 2, "Callback Attribute set to null callback unexpectedly fired");
 }
 
+// ===========================================================================
+// Test the lookups of TypeIds, Attributes and trace sources by name.
+// ===========================================================================
+class TypeIdLookupTestCase : public TestCase
+{
+public:
+  TypeIdLookupTestCase (std::string description);
+  virtual ~TypeIdLookupTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+TypeIdLookupTestCase::TypeIdLookupTestCase (std::string description)
+  : TestCase (description)
+{
+}
+
+void
+TypeIdLookupTestCase::DoRun (void)
+{
+  TypeId parent = AttributeObjectTest::GetTypeId ();
+  TypeId tid;
+  struct TypeId::AttributeInformation info;
+  bool ok;
+
+  ok = TypeId::LookupByNameFailSafe ("ns3::AttributeObjectTest", &tid);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Could not look up a registered TypeId");
+  NS_TEST_ASSERT_MSG_EQ (tid, parent, "Looked up the wrong TypeId");
+  ok = TypeId::LookupByNameFailSafe ("ns3::AttributeObjectTestNotRegistered", &tid);
+  NS_TEST_ASSERT_MSG_EQ (ok, false, "Unexpectedly looked up an unregistered TypeId");
+
+  //
+  // A child type finds the Attributes and trace sources of its parents
+  //
+  bool created = !TypeId::LookupByNameFailSafe ("ns3::TypeIdLookupTest", &tid);
+  if (created)
+    {
+      tid = TypeId ("ns3::TypeIdLookupTest").SetParent (parent);
+    }
+  ok = tid.LookupAttributeByName ("TestInt16", &info);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Could not look up an Attribute of the parent");
+  NS_TEST_ASSERT_MSG_EQ (info.name, "TestInt16", "Looked up the wrong Attribute");
+  ok = tid.LookupAttributeByName ("TestInt17", &info);
+  NS_TEST_ASSERT_MSG_EQ (ok, false, "Unexpectedly looked up a missing Attribute");
+  NS_TEST_ASSERT_MSG_NE (tid.LookupTraceSourceByName ("Source1"), 0, "Could not look up a trace source of the parent");
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupTraceSourceByName ("Source3"), 0, "Unexpectedly looked up a missing trace source");
+
+  //
+  // An Attribute added after a lookup is found by the next one
+  //
+  tid.LookupAttributeByName ("TestInt16", &info);
+  if (created)
+    {
+      tid.AddAttribute ("TestInt16Late", "help text", IntegerValue (3), info.accessor, info.checker);
+    }
+  ok = tid.LookupAttributeByName ("TestInt16Late", &info);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Could not look up an Attribute added after a lookup");
+
+  //
+  // A lookup returns the current initial value of the Attribute
+  //
+  Config::SetDefault ("ns3::AttributeObjectTest::TestInt16", IntegerValue (-3));
+  tid.LookupAttributeByName ("TestInt16", &info);
+  NS_TEST_ASSERT_MSG_EQ (info.initialValue->SerializeToString (info.checker), "-3",
+                         "Looked up a stale initial value");
+  Config::SetDefault ("ns3::AttributeObjectTest::TestInt16", IntegerValue (-2));
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -1126,6 +1195,7 @@ AttributesTestSuite::AttributesTestSuite ()
   AddTestCase (new TracedCallbackTestCase ("Ensure TracedCallback<double, int, float> works as trace source"));
   AddTestCase (new PointerAttributeTestCase ("Check Attributes of type PointerValue"));
   AddTestCase (new CallbackValueTestCase ("Check Attributes of type CallbackValue"));
+  AddTestCase (new TypeIdLookupTestCase ("Check the lookups of TypeIds, Attributes and trace sources by name"));
 }
 
 static AttributesTestSuite attributesTestSuite;
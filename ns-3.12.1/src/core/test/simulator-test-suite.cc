@@ -24,6 +24,13 @@
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
 #include "ns3/ns2-calendar-scheduler.h"
+#include "ns3/dary-heap-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable.h"
+#include "ns3/make-event.h"
+#include "ns3/core-config.h"
+
+#include <vector>
 
 namespace ns3 {
 
@@ -169,6 +176,278 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SimulatorCancelTestCase : public TestCase
+{
+public:
+  SimulatorCancelTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void Expire (uint32_t i);
+  std::vector<EventId> m_ids;
+  std::vector<bool> m_cancelled;
+  uint32_t m_nExpired;
+  bool m_inOrder;
+  Time m_last;
+  ObjectFactory m_schedulerFactory;
+};
+
+SimulatorCancelTestCase::SimulatorCancelTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that cancelled events do not run with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SimulatorCancelTestCase::Expire (uint32_t i)
+{
+  m_nExpired++;
+  if (m_cancelled[i] || Simulator::Now () < m_last)
+    {
+      m_inOrder = false;
+    }
+  m_last = Simulator::Now ();
+
+  // a timer rescheduled on each expiry leaves its previous event cancelled
+  if (i % 5 == 0 && m_nExpired < 2000)
+    {
+      uint32_t victim = (i * 7 + 3) % m_ids.size ();
+      if (!m_ids[victim].IsExpired ())
+        {
+          m_ids[victim].Cancel ();
+          m_cancelled[victim] = true;
+        }
+    }
+}
+
+void
+SimulatorCancelTestCase::DoRun (void)
+{
+  m_nExpired = 0;
+  m_inOrder = true;
+  m_last = Seconds (0);
+
+  Simulator::SetScheduler (m_schedulerFactory);
+
+  UniformVariable delay (0, 1000);
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      m_ids.push_back (Simulator::Schedule (MicroSeconds (delay.GetInteger (0, 1000)),
+                                            &SimulatorCancelTestCase::Expire, this, i));
+      m_cancelled.push_back (false);
+    }
+
+  // most of the events are cancelled before the run: enough to purge them
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      if (i % 4 != 0)
+        {
+          m_ids[i].Cancel ();
+          m_cancelled[i] = true;
+        }
+    }
+
+  Simulator::Run ();
+
+  uint32_t nCancelled = 0;
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      if (m_cancelled[i])
+        {
+          nCancelled++;
+        }
+      NS_TEST_EXPECT_MSG_EQ (m_ids[i].IsExpired (), true, "Event " << i << " still pending");
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (m_inOrder, true, "Cancelled event run or events run out of order");
+  NS_TEST_EXPECT_MSG_EQ (m_nExpired + nCancelled, 2000, "Events lost");
+
+  Simulator::Destroy ();
+}
+
+class SimulatorHoldTestCase : public TestCase
+{
+public:
+  SimulatorHoldTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void Hold (uint32_t seq);
+  void ScheduleHold (void);
+  uint32_t m_seq;
+  uint32_t m_lastSeq;
+  uint32_t m_nHolds;
+  uint32_t m_nRemoved;
+  bool m_inOrder;
+  Time m_last;
+  std::vector<EventId> m_removable;
+  UniformVariable m_uniform;
+  ExponentialVariable m_exponential;
+  ObjectFactory m_schedulerFactory;
+};
+
+SimulatorHoldTestCase::SimulatorHoldTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the order of a hold model run with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_exponential (100.0),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SimulatorHoldTestCase::ScheduleHold (void)
+{
+  Time delay;
+  double choice = m_uniform.GetValue ();
+  if (choice < 0.4)
+    {
+      // on a slot boundary, shared with many other events
+      uint32_t slots = Simulator::Now ().GetMicroSeconds () / 1000 + m_uniform.GetInteger (1, 4);
+      delay = MicroSeconds (slots * 1000) - Simulator::Now ();
+    }
+  else if (choice < 0.9)
+    {
+      delay = NanoSeconds (m_exponential.GetInteger () * 1000);
+    }
+  else if (choice < 0.98)
+    {
+      delay = MicroSeconds (m_uniform.GetInteger (5000, 50000));
+    }
+  else
+    {
+      delay = Seconds (0);
+    }
+  EventId id = Simulator::Schedule (delay, &SimulatorHoldTestCase::Hold, this, m_seq);
+  m_seq++;
+  if (m_uniform.GetValue () < 0.05)
+    {
+      m_removable.push_back (id);
+    }
+}
+
+void
+SimulatorHoldTestCase::Hold (uint32_t seq)
+{
+  // events due at the same time run in the order they were scheduled
+  if (Simulator::Now () < m_last || (Simulator::Now () == m_last && seq < m_lastSeq))
+    {
+      m_inOrder = false;
+    }
+  m_last = Simulator::Now ();
+  m_lastSeq = seq;
+  m_nHolds++;
+
+  if (m_nHolds % 100 == 0 && !m_removable.empty ())
+    {
+      EventId id = m_removable.back ();
+      m_removable.pop_back ();
+      if (!id.IsExpired ())
+        {
+          Simulator::Remove (id);
+          m_nRemoved++;
+        }
+    }
+  if (m_seq < 50000)
+    {
+      ScheduleHold ();
+    }
+}
+
+void
+SimulatorHoldTestCase::DoRun (void)
+{
+  m_seq = 0;
+  m_lastSeq = 0;
+  m_nHolds = 0;
+  m_nRemoved = 0;
+  m_inOrder = true;
+  m_last = Seconds (0);
+
+  Simulator::SetScheduler (m_schedulerFactory);
+
+  for (uint32_t i = 0; i < 5000; i++)
+    {
+      ScheduleHold ();
+    }
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_inOrder, true, "Events run out of order");
+  NS_TEST_EXPECT_MSG_EQ (m_nHolds + m_nRemoved, m_seq, "Events lost");
+
+  Simulator::Destroy ();
+}
+
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+  virtual void DoRun (void);
+  struct Block
+  {
+    uint64_t m_data[8];
+  };
+  void Small (uint32_t a);
+  void Other (uint16_t a);
+  void Large (Block a, Block b, Block c, Block d, Block e);
+  uint32_t m_small;
+  uint64_t m_large;
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that events are recycled")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Small (uint32_t a)
+{
+  m_small += a;
+}
+
+void
+SimulatorEventPoolTestCase::Other (uint16_t a)
+{
+  m_small += a;
+}
+
+void
+SimulatorEventPoolTestCase::Large (Block a, Block b, Block c, Block d, Block e)
+{
+  m_large = a.m_data[0] + b.m_data[1] + c.m_data[2] + d.m_data[3] + e.m_data[7];
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  m_small = 0;
+  m_large = 0;
+
+#ifdef EVENT_IMPL_USE_POOL
+  // the last event released is the next one handed out in its size class
+  EventImpl *first = MakeEvent (&SimulatorEventPoolTestCase::Small, this, 1);
+  first->Unref ();
+  EventImpl *second = MakeEvent (&SimulatorEventPoolTestCase::Other, this, 2);
+  NS_TEST_EXPECT_MSG_EQ (second, first, "Event not recycled");
+  second->Invoke ();
+  second->Unref ();
+  NS_TEST_EXPECT_MSG_EQ (m_small, 2, "Recycled event not invoked");
+#endif /* EVENT_IMPL_USE_POOL */
+
+  Block block;
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      block.m_data[i] = i;
+    }
+  // too large for the pools
+  Simulator::Schedule (Seconds (1), &SimulatorEventPoolTestCase::Large, this,
+                       block, block, block, block, block);
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &SimulatorEventPoolTestCase::Small, this, 1);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_large, 13, "Large event not invoked");
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -478,6 +757,23 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory));
     factory.SetTypeId (Ns2CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory));
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory));
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory));
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelTestCase (factory));
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelTestCase (factory));
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelTestCase (factory));
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorHoldTestCase (factory));
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorHoldTestCase (factory));
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorHoldTestCase (factory));
+    AddTestCase (new SimulatorEventPoolTestCase ());
   }
 } g_simulatorTestSuite;
 
@@ -159,7 +159,25 @@ void Ipv6Interface::SetDown ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_ifup = false;
-  m_addresses.clear ();
+
+  Ipv6InterfaceAddressList addresses;
+  addresses.swap (m_addresses);
+
+  if (m_node == 0)
+    {
+      return;
+    }
+
+  Ptr<Ipv6L3Protocol> ipv6 = m_node->GetObject<Ipv6L3Protocol> ();
+  if (ipv6 == 0)
+    {
+      return;
+    }
+
+  for (Ipv6InterfaceAddressListCI it = addresses.begin (); it != addresses.end (); ++it)
+    {
+      ipv6->NotifyAddressRemoved (this, (*it).GetAddress ());
+    }
 }
 
 bool Ipv6Interface::IsForwarding () const
@@ -192,10 +210,22 @@ bool Ipv6Interface::AddAddress (Ipv6InterfaceAddress iface)
 
       m_addresses.push_back (iface);
 
+      Ptr<Ipv6L3Protocol> ipv6;
+      if (m_node != 0)
+        {
+          ipv6 = m_node->GetObject<Ipv6L3Protocol> ();
+        }
+      if (ipv6 == 0)
+        {
+          /* not attached to a stack yet, no index to update and no DAD */
+          return true;
+        }
+      ipv6->NotifyAddressAdded (this, addr);
+
       if (!addr.IsAny () || !addr.IsLocalhost ())
         {
           /* DAD handling */
-          Ptr<Icmpv6L4Protocol> icmpv6 = m_node->GetObject<Ipv6L3Protocol> ()->GetIcmpv6 ();
+          Ptr<Icmpv6L4Protocol> icmpv6 = ipv6->GetIcmpv6 ();
 
           if (icmpv6 && icmpv6->IsAlwaysDad ())
             {
@@ -271,6 +301,16 @@ Ipv6InterfaceAddress Ipv6Interface::RemoveAddress (uint32_t index)
         {
           Ipv6InterfaceAddress iface = (*it);
           m_addresses.erase (it);
+
+          Ptr<Ipv6L3Protocol> ipv6;
+          if (m_node != 0)
+            {
+              ipv6 = m_node->GetObject<Ipv6L3Protocol> ();
+            }
+          if (ipv6 != 0)
+            {
+              ipv6->NotifyAddressRemoved (this, iface.GetAddress ());
+            }
           return iface;
         }
 
@@ -75,7 +75,8 @@ TypeId Ipv6L3Protocol::GetTypeId ()
 }
 
 Ipv6L3Protocol::Ipv6L3Protocol ()
-  : m_nInterfaces (0)
+  : m_nInterfaces (0),
+    m_routeGeneration (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -102,6 +103,8 @@ void Ipv6L3Protocol::DoDispose ()
       *it = 0;
     }
   m_interfaces.clear ();
+  m_deviceIndex.clear ();
+  m_addressIndex.clear ();
 
   /* remove raw sockets */
   for (SocketList::iterator it = m_sockets.begin (); it != m_sockets.end (); ++it)
@@ -129,6 +132,7 @@ void Ipv6L3Protocol::SetRoutingProtocol (Ptr<Ipv6RoutingProtocol> routingProtoco
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
   m_routingProtocol->SetIpv6 (this);
+  m_routeGeneration++;
 }
 
 Ptr<Ipv6RoutingProtocol> Ipv6L3Protocol::GetRoutingProtocol () const 
@@ -137,6 +141,12 @@ Ptr<Ipv6RoutingProtocol> Ipv6L3Protocol::GetRoutingProtocol () const
   return m_routingProtocol;
 }
 
+uint32_t Ipv6L3Protocol::GetRouteGeneration () const
+{
+  /* both only grow, so their sum changes with either */
+  return m_routeGeneration + (m_routingProtocol != 0 ? m_routingProtocol->GetRouteGeneration () : 0);
+}
+
 uint32_t Ipv6L3Protocol::AddInterface (Ptr<NetDevice> device)
 {
   NS_LOG_FUNCTION (this << device);
@@ -157,21 +167,96 @@ uint32_t Ipv6L3Protocol::AddIpv6Interface (Ptr<Ipv6Interface> interface)
 
   m_interfaces.push_back (interface);
   m_nInterfaces++;
+
+  /* keep the first interface of a device, as the list walk did */
+  m_deviceIndex.insert (std::make_pair (PeekPointer (interface->GetDevice ()), index));
+  IndexAddresses (index);
   return index;
 }
 
-Ptr<Ipv6Interface> Ipv6L3Protocol::GetInterface (uint32_t index) const
+void Ipv6L3Protocol::NotifyAddressAdded (Ptr<Ipv6Interface> interface, Ipv6Address address)
 {
-  NS_LOG_FUNCTION (this << index);
-  uint32_t tmp = 0;
+  NS_LOG_FUNCTION (this << interface << address);
+  int32_t i = GetInterfaceForDevice (interface->GetDevice ());
 
-  for (Ipv6InterfaceList::const_iterator it = m_interfaces.begin (); it != m_interfaces.end (); it++)
+  /* not added yet: AddIpv6Interface indexes its addresses */
+  if (i >= 0 && m_interfaces[i] == interface)
+    {
+      IndexAddress (i, address);
+    }
+  m_routeGeneration++;
+}
+
+void Ipv6L3Protocol::NotifyAddressRemoved (Ptr<Ipv6Interface> interface, Ipv6Address address)
+{
+  NS_LOG_FUNCTION (this << interface << address);
+  int32_t i = GetInterfaceForDevice (interface->GetDevice ());
+
+  if (i >= 0 && m_interfaces[i] == interface)
+    {
+      UnindexAddress (i, address);
+    }
+  m_routeGeneration++;
+}
+
+void Ipv6L3Protocol::IndexAddresses (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  Ptr<Ipv6Interface> interface = m_interfaces[i];
+
+  for (uint32_t j = 0; j < interface->GetNAddresses (); j++)
+    {
+      IndexAddress (i, interface->GetAddress (j).GetAddress ());
+    }
+}
+
+void Ipv6L3Protocol::IndexAddress (uint32_t i, Ipv6Address address)
+{
+  NS_LOG_FUNCTION (this << i << address);
+  AddressIndexI it = m_addressIndex.find (address);
+
+  if (it == m_addressIndex.end ())
+    {
+      m_addressIndex[address] = i;
+    }
+  else if (it->second > i)
+    {
+      it->second = i;
+    }
+}
+
+void Ipv6L3Protocol::UnindexAddress (uint32_t i, Ipv6Address address)
+{
+  NS_LOG_FUNCTION (this << i << address);
+  AddressIndexI it = m_addressIndex.find (address);
+
+  if (it == m_addressIndex.end () || it->second != i)
+    {
+      return;
+    }
+  m_addressIndex.erase (it);
+
+  /* the address may still be on another interface */
+  for (uint32_t j = 0; j < m_nInterfaces; j++)
     {
-      if (index == tmp)
+      for (uint32_t k = 0; k < m_interfaces[j]->GetNAddresses (); k++)
         {
-          return *it;
+          if (m_interfaces[j]->GetAddress (k).GetAddress () == address)
+            {
+              m_addressIndex[address] = j;
+              return;
+            }
         }
-      tmp++;
+    }
+}
+
+Ptr<Ipv6Interface> Ipv6L3Protocol::GetInterface (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+
+  if (index < m_nInterfaces)
+    {
+      return m_interfaces[index];
     }
   return 0;
 }
@@ -185,21 +270,11 @@ uint32_t Ipv6L3Protocol::GetNInterfaces () const
 int32_t Ipv6L3Protocol::GetInterfaceForAddress (Ipv6Address address) const
 {
   NS_LOG_FUNCTION (this << address); 
-  int32_t index = 0;
+  AddressIndexCI it = m_addressIndex.find (address);
 
-  for (Ipv6InterfaceList::const_iterator it = m_interfaces.begin (); it != m_interfaces.end (); it++)
+  if (it != m_addressIndex.end ())
     {
-      uint32_t j = 0;
-      uint32_t max = (*it)->GetNAddresses ();
-
-      for (j = 0; j < max; j++)
-        {
-          if ((*it)->GetAddress (j).GetAddress () == address) 
-            {
-              return index;
-            }
-        }
-      index++;
+      return it->second;
     }
   return -1;
 }
@@ -233,15 +308,11 @@ Ptr<NetDevice> Ipv6L3Protocol::GetNetDevice (uint32_t i)
 int32_t Ipv6L3Protocol::GetInterfaceForDevice (Ptr<const NetDevice> device) const
 {
   NS_LOG_FUNCTION (this << device);
-  int32_t index = 0;
+  DeviceIndexCI it = m_deviceIndex.find (PeekPointer (device));
 
-  for (Ipv6InterfaceList::const_iterator it = m_interfaces.begin (); it != m_interfaces.end (); it++)
+  if (it != m_deviceIndex.end ())
     {
-      if ((*it)->GetDevice () == device)
-        {
-          return index;
-        }
-      index++;
+      return it->second;
     }
   return -1;
 }
@@ -331,6 +402,7 @@ bool Ipv6L3Protocol::AddAddress (uint32_t i, Ipv6InterfaceAddress address)
   NS_LOG_FUNCTION (this << i << address);
   Ptr<Ipv6Interface> interface = GetInterface (i);
   bool ret = interface->AddAddress (address);
+  m_routeGeneration++;
 
   if (m_routingProtocol != 0)
     {
@@ -361,6 +433,8 @@ bool Ipv6L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
 
   if (address != Ipv6InterfaceAddress ())
     {
+      m_routeGeneration++;
+
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
@@ -404,6 +478,7 @@ void Ipv6L3Protocol::SetUp (uint32_t i)
   Ptr<Ipv6Interface> interface = GetInterface (i);
 
   interface->SetUp ();
+  m_routeGeneration++;
 
   if (m_routingProtocol != 0)
     {
@@ -417,6 +492,7 @@ void Ipv6L3Protocol::SetDown (uint32_t i)
   Ptr<Ipv6Interface> interface = GetInterface (i);
 
   interface->SetDown ();
+  m_routeGeneration++;
 
   if (m_routingProtocol != 0)
     {
@@ -665,31 +741,23 @@ void Ipv6L3Protocol::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16
 {
   NS_LOG_FUNCTION (this << device << p << protocol << from << to << packetType);
   NS_LOG_LOGIC ("Packet from " << from << " received on node " << m_node->GetId ());
-  uint32_t interface = 0;
+  int32_t interface = GetInterfaceForDevice (device);
   Ptr<Packet> packet = p->Copy ();
-  Ptr<Ipv6Interface> ipv6Interface = 0;
 
-  for (Ipv6InterfaceList::const_iterator it = m_interfaces.begin (); it != m_interfaces.end (); it++)
+  if (interface >= 0)
     {
-      ipv6Interface = *it;
-
-      if (ipv6Interface->GetDevice () == device)
+      if (m_interfaces[interface]->IsUp ())
         {
-          if (ipv6Interface->IsUp ())
-            {
-              m_rxTrace (packet, m_node->GetObject<Ipv6> (), interface);
-              break;
-            }
-          else
-            {
-              NS_LOG_LOGIC ("Dropping received packet-- interface is down");
-              Ipv6Header hdr;
-              packet->RemoveHeader (hdr);
-              m_dropTrace (hdr, packet, DROP_INTERFACE_DOWN, m_node->GetObject<Ipv6> (), interface);
-              return;
-            }
+          m_rxTrace (packet, m_node->GetObject<Ipv6> (), interface);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Dropping received packet-- interface is down");
+          Ipv6Header hdr;
+          packet->RemoveHeader (hdr);
+          m_dropTrace (hdr, packet, DROP_INTERFACE_DOWN, m_node->GetObject<Ipv6> (), interface);
+          return;
         }
-      interface++;
     }
 
   Ipv6Header hdr;
@@ -22,11 +22,13 @@
 #define IPV6_L3_PROTOCOL_H
 
 #include <list>
+#include <vector>
 
 #include "ns3/traced-callback.h"
 #include "ns3/net-device.h"
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ns3/ipv6-header.h"
 
 namespace ns3
@@ -172,6 +174,16 @@ public:
    */
   Ptr<Ipv6RoutingProtocol> GetRoutingProtocol () const;
 
+  /**
+   * \brief Get the routing generation of the stack.
+   *
+   * Changes whenever an interface goes up or down, an address is added
+   * or removed, the routing protocol is replaced, or its own generation
+   * changes, so callers caching routes can tell when they are stale.
+   * \return routing generation
+   */
+  uint32_t GetRouteGeneration () const;
+
   /**
    * \brief Add IPv6 interface for a device.
    * \param device net device
@@ -213,6 +225,24 @@ public:
    */
   int32_t GetInterfaceForDevice (Ptr<const NetDevice> device) const;
 
+  /**
+   * \brief Notify that an address was added to an interface.
+   *
+   * Called by Ipv6Interface to keep the address index up to date.
+   * \param interface the interface
+   * \param address the address
+   */
+  void NotifyAddressAdded (Ptr<Ipv6Interface> interface, Ipv6Address address);
+
+  /**
+   * \brief Notify that an address was removed from an interface.
+   *
+   * Called by Ipv6Interface to keep the address index up to date.
+   * \param interface the interface
+   * \param address the address
+   */
+  void NotifyAddressRemoved (Ptr<Ipv6Interface> interface, Ipv6Address address);
+
   /**
    * \brief Add an address on interface.
    * \param i interface index
@@ -358,7 +388,7 @@ private:
   friend class Ipv6L3ProtocolTestCase;
   friend class Ipv6ExtensionLooseRouting;
 
-  typedef std::list<Ptr<Ipv6Interface> > Ipv6InterfaceList;
+  typedef std::vector<Ptr<Ipv6Interface> > Ipv6InterfaceList;
   typedef std::list<Ptr<Ipv6RawSocketImpl> > SocketList;
   typedef std::list<Ptr<Ipv6L4Protocol> > L4List_t;
 
@@ -478,6 +508,26 @@ private:
    */
   bool m_ipForward;
 
+  /**
+   * \brief Add the addresses of an interface to the address index.
+   * \param i interface index
+   */
+  void IndexAddresses (uint32_t i);
+
+  /**
+   * \brief Add an address of an interface to the address index.
+   * \param i interface index
+   * \param address the address
+   */
+  void IndexAddress (uint32_t i, Ipv6Address address);
+
+  /**
+   * \brief Remove an address of an interface from the address index.
+   * \param i interface index
+   * \param address the address
+   */
+  void UnindexAddress (uint32_t i, Ipv6Address address);
+
   /**
    * \brief List of transport protocol.
    */
@@ -493,6 +543,36 @@ private:
    */
   uint32_t m_nInterfaces;
 
+  /**
+   * \class NetDeviceHash
+   * \brief Hash function for NetDevice pointers.
+   */
+  class NetDeviceHash : public std::unary_function<const NetDevice *, size_t>
+  {
+public:
+    size_t operator () (const NetDevice *device) const
+    {
+      return reinterpret_cast<size_t> (device) >> 3;
+    }
+  };
+
+  typedef sgi::hash_map<const NetDevice *, uint32_t, NetDeviceHash> DeviceIndex;
+  typedef sgi::hash_map<const NetDevice *, uint32_t, NetDeviceHash>::const_iterator DeviceIndexCI;
+  typedef sgi::hash_map<Ipv6Address, uint32_t, Ipv6AddressHash> AddressIndex;
+  typedef sgi::hash_map<Ipv6Address, uint32_t, Ipv6AddressHash>::iterator AddressIndexI;
+  typedef sgi::hash_map<Ipv6Address, uint32_t, Ipv6AddressHash>::const_iterator AddressIndexCI;
+
+  /**
+   * \brief Interface index of each device.
+   */
+  DeviceIndex m_deviceIndex;
+
+  /**
+   * \brief Interface index of each address, the lowest one if an address
+   * is on several interfaces.
+   */
+  AddressIndex m_addressIndex;
+
   /**
    * \brief Default TTL for outgoing packets.
    */
@@ -503,6 +583,11 @@ private:
    */
   Ptr<Ipv6RoutingProtocol> m_routingProtocol;
 
+  /**
+   * \brief Interface and routing protocol changes.
+   */
+  uint32_t m_routeGeneration;
+
   /**
    * \brief List of IPv6 raw sockets.
    */
@@ -42,7 +42,8 @@ Ipv6ListRouting::GetTypeId (void)
 
 
 Ipv6ListRouting::Ipv6ListRouting () 
-  : m_ipv6 (0)
+  : m_generation (0),
+    m_ipv6 (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -290,12 +291,27 @@ Ipv6ListRouting::AddRoutingProtocol (Ptr<Ipv6RoutingProtocol> routingProtocol, i
   NS_LOG_FUNCTION (this << routingProtocol->GetInstanceTypeId () << priority);
   m_routingProtocols.push_back (std::make_pair (priority, routingProtocol));
   m_routingProtocols.sort ( Compare );
+  m_generation++;
   if (m_ipv6 != 0)
     {
       routingProtocol->SetIpv6 (m_ipv6);
     }
 }
 
+uint32_t 
+Ipv6ListRouting::GetRouteGeneration (void) const
+{
+  /* the generations only grow, so their sum changes with any of them */
+  uint32_t generation = m_generation;
+
+  for (Ipv6RoutingProtocolList::const_iterator i = m_routingProtocols.begin ();
+       i != m_routingProtocols.end (); i++)
+    {
+      generation += (*i).second->GetRouteGeneration ();
+    }
+  return generation;
+}
+
 uint32_t 
 Ipv6ListRouting::GetNRoutingProtocols (void) const
 {
@@ -104,6 +104,15 @@ public:
   virtual void NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse = Ipv6Address::GetZero ());
   virtual void SetIpv6 (Ptr<Ipv6> ipv6);
 
+  /**
+   * \brief Get the routing table generation.
+   *
+   * Changes when a protocol is added, and whenever the generation of
+   * one of the protocols changes.
+   * \return generation of the routing tables
+   */
+  virtual uint32_t GetRouteGeneration () const;
+
 protected:
   /**
    * \brief Dispose this object.
@@ -127,6 +136,11 @@ private:
    */
   Ipv6RoutingProtocolList m_routingProtocols;
 
+  /**
+   * \brief Number of protocols ever added.
+   */
+  uint32_t m_generation;
+
   /**
    * \brief Ipv6 reference.
    */
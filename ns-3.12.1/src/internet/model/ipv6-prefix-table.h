@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV6_PREFIX_TABLE_H
+#define IPV6_PREFIX_TABLE_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <list>
+#include <vector>
+
+#include "ns3/assert.h"
+#include "ns3/sgi-hashmap.h"
+#include "ns3/ipv6-address.h"
+
+namespace ns3
+{
+
+/**
+ * \ingroup internet
+ * \class Ipv6PrefixTable
+ * \brief Longest prefix match index over IPv6 networks.
+ *
+ * Items are kept in one hash table per prefix length, keyed by the masked
+ * network, so a lookup costs one probe per distinct prefix length in use,
+ * whatever the number of items. Used by the static routing tables to find
+ * the routes of an address, longest prefix first. The index does not own
+ * the items.
+ */
+template <typename T>
+class Ipv6PrefixTable
+{
+public:
+  typedef std::list<T *> Bucket;
+  typedef typename std::list<T *>::iterator BucketI;
+
+  Ipv6PrefixTable ();
+
+  /**
+   * \brief Index an item under a network.
+   * \param network the network
+   * \param prefix prefix of the network
+   * \param item the item
+   *
+   * Items of the same network are kept in insertion order.
+   */
+  void Add (Ipv6Address network, Ipv6Prefix prefix, T *item);
+
+  /**
+   * \brief Unindex an item.
+   * \param network the network it was added under
+   * \param prefix prefix of the network
+   * \param item the item
+   */
+  void Remove (Ipv6Address network, Ipv6Prefix prefix, T *item);
+
+  /**
+   * \brief Items of the network of an address, for one prefix length.
+   * \param address the address
+   * \param prefixLength the prefix length
+   * \return the items, 0 if none
+   */
+  Bucket *Find (Ipv6Address address, uint8_t prefixLength);
+
+  /**
+   * \return the prefix lengths in use, longest first
+   */
+  const std::vector<uint8_t> &GetPrefixLengths () const;
+
+  /**
+   * \brief Unindex all the items.
+   */
+  void Clear ();
+
+private:
+  typedef sgi::hash_map<Ipv6Address, Bucket, Ipv6AddressHash> Table;
+  typedef typename sgi::hash_map<Ipv6Address, Bucket, Ipv6AddressHash>::iterator TableI;
+
+  /**
+   * \brief Items keyed by masked network, one table per prefix length.
+   */
+  Table m_tables[129];
+
+  /**
+   * \brief Number of items per prefix length.
+   */
+  uint32_t m_nItems[129];
+
+  /**
+   * \brief Prefix lengths in use, longest first.
+   */
+  std::vector<uint8_t> m_prefixLengths;
+};
+
+template <typename T>
+Ipv6PrefixTable<T>::Ipv6PrefixTable ()
+{
+  std::fill (m_nItems, m_nItems + 129, 0);
+}
+
+template <typename T>
+void
+Ipv6PrefixTable<T>::Add (Ipv6Address network, Ipv6Prefix prefix, T *item)
+{
+  uint8_t prefixLength = prefix.GetPrefixLength ();
+
+  m_tables[prefixLength][network.CombinePrefix (prefix)].push_back (item);
+
+  if (m_nItems[prefixLength]++ == 0)
+    {
+      std::vector<uint8_t>::iterator it = m_prefixLengths.begin ();
+      while (it != m_prefixLengths.end () && *it > prefixLength)
+        {
+          it++;
+        }
+      m_prefixLengths.insert (it, prefixLength);
+    }
+}
+
+template <typename T>
+void
+Ipv6PrefixTable<T>::Remove (Ipv6Address network, Ipv6Prefix prefix, T *item)
+{
+  uint8_t prefixLength = prefix.GetPrefixLength ();
+  TableI table = m_tables[prefixLength].find (network.CombinePrefix (prefix));
+
+  NS_ASSERT (table != m_tables[prefixLength].end ());
+  table->second.remove (item);
+  if (table->second.empty ())
+    {
+      m_tables[prefixLength].erase (table);
+    }
+
+  if (--m_nItems[prefixLength] == 0)
+    {
+      m_prefixLengths.erase (std::find (m_prefixLengths.begin (), m_prefixLengths.end (), prefixLength));
+    }
+}
+
+template <typename T>
+typename Ipv6PrefixTable<T>::Bucket *
+Ipv6PrefixTable<T>::Find (Ipv6Address address, uint8_t prefixLength)
+{
+  TableI table = m_tables[prefixLength].find (address.CombinePrefix (Ipv6Prefix (prefixLength)));
+
+  if (table == m_tables[prefixLength].end ())
+    {
+      return 0;
+    }
+  return &table->second;
+}
+
+template <typename T>
+const std::vector<uint8_t> &
+Ipv6PrefixTable<T>::GetPrefixLengths () const
+{
+  return m_prefixLengths;
+}
+
+template <typename T>
+void
+Ipv6PrefixTable<T>::Clear ()
+{
+  for (std::vector<uint8_t>::const_iterator it = m_prefixLengths.begin (); it != m_prefixLengths.end (); it++)
+    {
+      m_tables[*it].clear ();
+      m_nItems[*it] = 0;
+    }
+  m_prefixLengths.clear ();
+}
+
+} /* namespace ns3 */
+
+#endif /* IPV6_PREFIX_TABLE_H */
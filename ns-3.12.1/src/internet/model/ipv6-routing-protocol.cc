@@ -36,5 +36,10 @@ TypeId Ipv6RoutingProtocol::GetTypeId ()
   return tid;
 }
 
+uint32_t Ipv6RoutingProtocol::GetRouteGeneration () const
+{
+  return 0;
+}
+
 } /* namespace ns3 */
 
@@ -171,6 +171,16 @@ public:
    * \param ipv6 the ipv6 object this routing protocol is being associated with
    */
   virtual void SetIpv6 (Ptr<Ipv6> ipv6) = 0;
+
+  /**
+   * \brief Get the routing table generation.
+   *
+   * The generation changes whenever the routes this protocol may return
+   * change, so callers caching lookup results can tell when their cache
+   * is stale. Protocols which do not keep track of it return 0.
+   * \return generation of the routing table
+   */
+  virtual uint32_t GetRouteGeneration () const;
 };
 
 } // namespace ns3
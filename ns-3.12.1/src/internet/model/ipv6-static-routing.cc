@@ -41,8 +41,16 @@ TypeId Ipv6StaticRouting::GetTypeId ()
   return tid;
 }
 
+Ipv6StaticRouting::NetworkRoute::NetworkRoute (const Ipv6RoutingTableEntry &entry, uint32_t metric)
+  : m_entry (entry),
+    m_metric (metric),
+    m_index (0)
+{
+}
+
 Ipv6StaticRouting::Ipv6StaticRouting ()
-  : m_ipv6 (0)
+  : m_routeGeneration (0),
+    m_ipv6 (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -87,25 +95,19 @@ void Ipv6StaticRouting::AddHostRouteTo (Ipv6Address dst, uint32_t interface, uin
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface, uint32_t metric)
 {
   NS_LOG_FUNCTION (this << network << networkPrefix << nextHop << interface << metric);
-  Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
-  *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface);
-  m_networkRoutes.push_back (std::make_pair (route, metric));
+  AddRoute (Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface), metric);
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
 {
   NS_LOG_FUNCTION (this << network << networkPrefix << nextHop << interface << prefixToUse << metric);
-  Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
-  *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface, prefixToUse);
-  m_networkRoutes.push_back (std::make_pair (route, metric));
+  AddRoute (Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface, prefixToUse), metric);
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface, uint32_t metric)
 {
   NS_LOG_FUNCTION (this << network << networkPrefix << interface);
-  Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
-  *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface);
-  m_networkRoutes.push_back (std::make_pair (route, metric));
+  AddRoute (Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface), metric);
 }
 
 void Ipv6StaticRouting::SetDefaultRoute (Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -125,11 +127,9 @@ void Ipv6StaticRouting::AddMulticastRoute (Ipv6Address origin, Ipv6Address group
 void Ipv6StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
 {
   NS_LOG_FUNCTION (this << outputInterface);
-  Ipv6RoutingTableEntry *route = new Ipv6RoutingTableEntry ();
   Ipv6Address network = Ipv6Address ("ff00::"); /* RFC 3513 */
   Ipv6Prefix networkMask = Ipv6Prefix (8);
-  *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkMask, outputInterface);
-  m_networkRoutes.push_back (std::make_pair (route, 0));
+  AddRoute (Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkMask, outputInterface), 0);
 }
 
 uint32_t Ipv6StaticRouting::GetNMulticastRoutes () const
@@ -193,20 +193,52 @@ void Ipv6StaticRouting::RemoveMulticastRoute (uint32_t index)
     }
 }
 
+void Ipv6StaticRouting::AddRoute (const Ipv6RoutingTableEntry &entry, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << metric);
+  NetworkRoute *route = new NetworkRoute (entry, metric);
+
+  route->m_index = m_networkRoutes.size ();
+  m_networkRoutes.push_back (route);
+  m_routeGeneration++;
+  m_prefixTable.Add (route->m_entry.GetDestNetwork (), route->m_entry.GetDestNetworkPrefix (), route);
+}
+
+void Ipv6StaticRouting::DeleteRoute (NetworkRoute *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  m_prefixTable.Remove (route->m_entry.GetDestNetwork (), route->m_entry.GetDestNetworkPrefix (), route);
+
+  /* keep indexes dense: the last route takes the freed slot */
+  NetworkRoute *last = m_networkRoutes.back ();
+  m_networkRoutes[route->m_index] = last;
+  last->m_index = route->m_index;
+  m_networkRoutes.pop_back ();
+  m_routeGeneration++;
+
+  delete route;
+}
+
 bool Ipv6StaticRouting::HasNetworkDest (Ipv6Address network, uint32_t interfaceIndex)
 {
   NS_LOG_FUNCTION (this << network << interfaceIndex);
 
   /* in the network table */
-  for (NetworkRoutesI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+  const std::vector<uint8_t> &prefixLengths = m_prefixTable.GetPrefixLengths ();
+  for (std::vector<uint8_t>::const_iterator it = prefixLengths.begin (); it != prefixLengths.end (); it++)
     {
-      Ipv6RoutingTableEntry* rtentry = j->first;
-      Ipv6Prefix prefix = rtentry->GetDestNetworkPrefix ();
-      Ipv6Address entry = rtentry->GetDestNetwork ();
+      RouteBucket *routes = m_prefixTable.Find (network, *it);
+      if (routes == 0)
+        {
+          continue;
+        }
 
-      if (prefix.IsMatch (network, entry) && rtentry->GetInterface () == interfaceIndex)
+      for (RouteBucketI j = routes->begin (); j != routes->end (); j++)
         {
-          return true;
+          if ((*j)->m_entry.GetInterface () == interfaceIndex)
+            {
+              return true;
+            }
         }
     }
 
@@ -218,8 +250,6 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
 {
   NS_LOG_FUNCTION (this << dst << interface);
   Ptr<Ipv6Route> rtentry = 0;
-  uint16_t longestMask = 0;
-  uint32_t shortestMetric = 0xffffffff;
 
   /* when sending on link-local multicast, there have to be interface specified */
   if (dst == Ipv6Address::GetAllNodesMulticast () || dst.IsSolicitedMulticast () || 
@@ -234,70 +264,66 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
       return rtentry;
     }
 
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+  /* longest prefix first, so the first table with a usable route wins */
+  const std::vector<uint8_t> &prefixLengths = m_prefixTable.GetPrefixLengths ();
+  for (std::vector<uint8_t>::const_iterator it = prefixLengths.begin (); it != prefixLengths.end (); it++)
     {
-      Ipv6RoutingTableEntry* j = it->first;
-      uint32_t metric = it->second;
-      Ipv6Prefix mask = j->GetDestNetworkPrefix ();
-      uint16_t maskLen = mask.GetPrefixLength ();
-      Ipv6Address entry = j->GetDestNetwork ();
-
-      NS_LOG_LOGIC ("Searching for route to " << dst << ", mask length " << maskLen << ", metric " << metric);
+      NS_LOG_LOGIC ("Searching for route to " << dst << ", mask length " << (uint16_t)*it);
 
-      if (mask.IsMatch (dst, entry))
+      RouteBucket *routes = m_prefixTable.Find (dst, *it);
+      if (routes == 0)
         {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << maskLen << ", metric " << metric);
+          continue;
+        }
 
+      /* equal mask length: lowest metric, the latest route on a tie */
+      NetworkRoute *best = 0;
+      for (RouteBucketI j = routes->begin (); j != routes->end (); j++)
+        {
           /* if interface is given, check the route will output on this interface */
-          if (!interface || interface == m_ipv6->GetNetDevice (j->GetInterface ()))
+          if (interface && interface != m_ipv6->GetNetDevice ((*j)->m_entry.GetInterface ()))
             {
-              if (maskLen < longestMask)
-                {
-                  NS_LOG_LOGIC ("Previous match longer, skipping");
-                  continue;
-                }
-
-              if (maskLen > longestMask)
-                {
-                  shortestMetric = 0xffffffff;
-                }
+              continue;
+            }
 
-              longestMask = maskLen;
-              if (metric > shortestMetric)
-                {
-                  NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
-                  continue;
-                }
+          if (best == 0 || (*j)->m_metric <= best->m_metric)
+            {
+              best = *j;
+            }
+        }
 
-              shortestMetric = metric;
-              Ipv6RoutingTableEntry* route = j;
-              uint32_t interfaceIdx = route->GetInterface ();
-              rtentry = Create<Ipv6Route> ();
+      if (best == 0)
+        {
+          NS_LOG_LOGIC ("No route through the requested interface, trying shorter prefixes");
+          continue;
+        }
+      NS_LOG_LOGIC ("Found global network route " << best << ", mask length " << (uint16_t)*it << ", metric " << best->m_metric);
 
-              if (route->GetGateway ().IsAny ())
-                {
-                  rtentry->SetSource (SourceAddressSelection (interfaceIdx, route->GetDest ()));
-                }
-              else if (route->GetDest ().IsAny ()) /* default route */
-                {
-                  rtentry->SetSource (SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? route->GetGateway () : route->GetPrefixToUse ()));
-                }
-              else
-                {
-                  rtentry->SetSource (SourceAddressSelection (interfaceIdx, route->GetGateway ()));
-                }
+      Ipv6RoutingTableEntry* route = &best->m_entry;
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv6Route> ();
 
-              rtentry->SetDestination (route->GetDest ());
-              rtentry->SetGateway (route->GetGateway ());
-              rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
-            }
+      if (route->GetGateway ().IsAny ())
+        {
+          rtentry->SetSource (SourceAddressSelection (interfaceIdx, route->GetDest ()));
+        }
+      else if (route->GetDest ().IsAny ()) /* default route */
+        {
+          rtentry->SetSource (SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? route->GetGateway () : route->GetPrefixToUse ()));
+        }
+      else
+        {
+          rtentry->SetSource (SourceAddressSelection (interfaceIdx, route->GetGateway ()));
         }
-    }
 
-  if(rtentry)
-    {
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
+
       NS_LOG_LOGIC ("Matching route via " << rtentry->GetDestination () << " (throught " << rtentry->GetGateway () << ") at the end");
+      return rtentry;
     }
+
   return rtentry;
 }
 
@@ -305,12 +331,14 @@ void Ipv6StaticRouting::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  for (NetworkRoutesI j = m_networkRoutes.begin ();  j != m_networkRoutes.end (); j = m_networkRoutes.erase (j))
+  for (NetworkRoutesI j = m_networkRoutes.begin ();  j != m_networkRoutes.end (); j++)
     {
-      delete j->first;
+      delete *j;
     }
   m_networkRoutes.clear ();
 
+  m_prefixTable.Clear ();
+
   for (MulticastRoutesI i = m_multicastRoutes.begin (); i != m_multicastRoutes.end (); i = m_multicastRoutes.erase (i))
     {
       delete (*i);
@@ -375,32 +403,30 @@ uint32_t Ipv6StaticRouting::GetNRoutes ()
   return m_networkRoutes.size ();
 }
 
+uint32_t Ipv6StaticRouting::GetRouteGeneration () const
+{
+  return m_routeGeneration;
+}
+
 Ipv6RoutingTableEntry Ipv6StaticRouting::GetDefaultRoute ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  Ipv6Address dst ("::");
-  uint32_t shortestMetric = 0xffffffff;
   Ipv6RoutingTableEntry* result = 0;
+  RouteBucket *routes = m_prefixTable.Find (Ipv6Address ("::"), 0);
 
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+  if (routes != 0)
     {
-      Ipv6RoutingTableEntry* j = it->first;
-      uint32_t metric = it->second;
-      Ipv6Prefix mask = j->GetDestNetworkPrefix ();
-      uint16_t maskLen = mask.GetPrefixLength ();
-      Ipv6Address entry = j->GetDestNetwork ();
-
-      if (maskLen)
-        {
-          continue;
-        }
+      uint32_t shortestMetric = 0xffffffff;
 
-      if (metric > shortestMetric)
+      for (RouteBucketI it = routes->begin (); it != routes->end (); it++)
         {
-          continue;
+          if ((*it)->m_metric > shortestMetric)
+            {
+              continue;
+            }
+          shortestMetric = (*it)->m_metric;
+          result = &(*it)->m_entry;
         }
-      shortestMetric = metric;
-      result = j;
     }
 
   if (result)
@@ -416,69 +442,41 @@ Ipv6RoutingTableEntry Ipv6StaticRouting::GetDefaultRoute ()
 Ipv6RoutingTableEntry Ipv6StaticRouting::GetRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
-  uint32_t tmp = 0;
-
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
-    {
-      if (tmp == index)
-        {
-          return it->first;
-        }
-      tmp++;
-    }
-  NS_ASSERT (false);
-  // quiet compiler.
-  return 0;
+  NS_ASSERT (index < m_networkRoutes.size ());
+  return m_networkRoutes[index]->m_entry;
 }
 
 uint32_t Ipv6StaticRouting::GetMetric (uint32_t index)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  uint32_t tmp = 0;
-
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
-    {
-      if (tmp == index)
-        {
-          return it->second;
-        }
-      tmp++;
-    }
-  NS_ASSERT (false);
-  // quiet compiler.
-  return 0;
+  NS_ASSERT (index < m_networkRoutes.size ());
+  return m_networkRoutes[index]->m_metric;
 }
 
 void Ipv6StaticRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
-  uint32_t tmp = 0;
-
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
-    {
-      if (tmp == index)
-        {
-          delete it->first;
-          m_networkRoutes.erase (it);
-          return;
-        }
-      tmp++;
-    }
-  NS_ASSERT (false);
+  NS_ASSERT (index < m_networkRoutes.size ());
+  DeleteRoute (m_networkRoutes[index]);
 }
 
 void Ipv6StaticRouting::RemoveRoute (Ipv6Address network, Ipv6Prefix prefix, uint32_t ifIndex, Ipv6Address prefixToUse)
 {
   NS_LOG_FUNCTION (this << network << prefix << ifIndex);
+  RouteBucket *routes = m_prefixTable.Find (network, prefix.GetPrefixLength ());
+
+  if (routes == 0)
+    {
+      return;
+    }
 
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+  for (RouteBucketI it = routes->begin (); it != routes->end (); it++)
     {
-      Ipv6RoutingTableEntry* rtentry = it->first;
+      Ipv6RoutingTableEntry* rtentry = &(*it)->m_entry;
       if (network == rtentry->GetDest () && rtentry->GetInterface () == ifIndex && 
           rtentry->GetPrefixToUse () == prefixToUse)
         {
-          delete it->first;
-          m_networkRoutes.erase (it);
+          DeleteRoute (*it);
           return;
         }
     }
@@ -548,28 +546,20 @@ bool Ipv6StaticRouting::RouteInput (Ptr<const Packet> p, const Ipv6Header &heade
   // a packet to one of our other interface addresses; that is, the
   // destination unicast address does not match one of the iif addresses,
   // but we check our other interfaces.  This could be an option
-  // (to remove the outer loop immediately below and just check iif).
-  for (uint32_t j = 0; j < m_ipv6->GetNInterfaces (); j++)
+  // (to check only the iif addresses instead of the whole stack).
+  int32_t j = m_ipv6->GetInterfaceForAddress (header.GetDestinationAddress ());
+  if (j >= 0)
     {
-      for (uint32_t i = 0; i < m_ipv6->GetNAddresses (j); i++)
+      if (static_cast<uint32_t> (j) == iif)
         {
-          Ipv6InterfaceAddress iaddr = m_ipv6->GetAddress (j, i);
-          Ipv6Address addr = iaddr.GetAddress ();
-          if (addr.IsEqual (header.GetDestinationAddress ()))
-            {
-              if (j == iif)
-                {
-                  NS_LOG_LOGIC ("For me (destination " << addr << " match)");
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("For me (destination " << addr << " match) on another interface " << header.GetDestinationAddress ());
-                }
-              lcb (p, header, iif);
-              return true;
-            }
-          NS_LOG_LOGIC ("Address "<< addr << " not a match");
+          NS_LOG_LOGIC ("For me (destination " << header.GetDestinationAddress () << " match)");
+        }
+      else
+        {
+          NS_LOG_LOGIC ("For me (destination " << header.GetDestinationAddress () << " match) on another interface " << j);
         }
+      lcb (p, header, iif);
+      return true;
     }
   // Check if input device supports IP forwarding
   if (m_ipv6->IsForwarding (iif) == false)
@@ -620,16 +610,13 @@ void Ipv6StaticRouting::NotifyInterfaceDown (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
   uint32_t j = 0;
-  uint32_t max = GetNRoutes ();
 
   /* remove all static routes that are going through this interface */
-  while (j < max)
+  while (j < m_networkRoutes.size ())
     {
-      Ipv6RoutingTableEntry route = GetRoute (j);
-
-      if (route.GetInterface () == i)
+      if (m_networkRoutes[j]->m_entry.GetInterface () == i)
         {
-          RemoveRoute (j);
+          DeleteRoute (m_networkRoutes[j]);
         }
       else
         {
@@ -640,6 +627,9 @@ void Ipv6StaticRouting::NotifyInterfaceDown (uint32_t i)
 
 void Ipv6StaticRouting::NotifyAddAddress (uint32_t interface, Ipv6InterfaceAddress address)
 {
+  /* source address selection may change */
+  m_routeGeneration++;
+
   if (!m_ipv6->IsUp (interface))
     {
       return;
@@ -656,6 +646,9 @@ void Ipv6StaticRouting::NotifyAddAddress (uint32_t interface, Ipv6InterfaceAddre
 
 void Ipv6StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAddress address)
 {
+  /* source address selection may change */
+  m_routeGeneration++;
+
   if (!m_ipv6->IsUp (interface))
     {
       return;
@@ -666,16 +659,23 @@ void Ipv6StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAd
 
   // Remove all static routes that are going through this interface
   // which reference this network
-  for (uint32_t j = 0; j < GetNRoutes (); j++)
+  RouteBucket *table = m_prefixTable.Find (networkAddress, networkMask.GetPrefixLength ());
+
+  if (table != 0)
     {
-      Ipv6RoutingTableEntry route = GetRoute (j);
+      RouteBucket routes = *table;
 
-      if (route.GetInterface () == interface &&
-          route.IsNetwork () &&
-          route.GetDestNetwork () == networkAddress &&
-          route.GetDestNetworkPrefix () == networkMask)
+      for (RouteBucketI j = routes.begin (); j != routes.end (); j++)
         {
-          RemoveRoute (j);
+          Ipv6RoutingTableEntry* route = &(*j)->m_entry;
+
+          if (route->GetInterface () == interface &&
+              route->IsNetwork () &&
+              route->GetDestNetwork () == networkAddress &&
+              route->GetDestNetworkPrefix () == networkMask)
+            {
+              DeleteRoute (*j);
+            }
         }
     }
 }
@@ -706,17 +706,23 @@ void Ipv6StaticRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv
   NS_LOG_FUNCTION (this << dst << mask << nextHop << interface);
   if (dst != Ipv6Address::GetZero ())
     {
-      for (NetworkRoutesI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+      RouteBucket *table = m_prefixTable.Find (dst, mask.GetPrefixLength ());
+
+      if (table != 0)
         {
-          Ipv6RoutingTableEntry* rtentry = j->first;
-          Ipv6Prefix prefix = rtentry->GetDestNetworkPrefix ();
-          Ipv6Address entry = rtentry->GetDestNetwork ();
+          RouteBucket routes = *table;
 
-          if (dst == entry && prefix == mask && rtentry->GetInterface () == interface)
+          for (RouteBucketI j = routes.begin (); j != routes.end (); j++)
             {
-              delete j->first;
-              m_networkRoutes.erase (j);
-            } 
+              Ipv6RoutingTableEntry* rtentry = &(*j)->m_entry;
+              Ipv6Prefix prefix = rtentry->GetDestNetworkPrefix ();
+              Ipv6Address entry = rtentry->GetDestNetwork ();
+
+              if (dst == entry && prefix == mask && rtentry->GetInterface () == interface)
+                {
+                  DeleteRoute (*j);
+                }
+            }
         }
     }
   else
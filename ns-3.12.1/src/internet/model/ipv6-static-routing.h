@@ -24,12 +24,15 @@
 #include <stdint.h>
 
 #include <list>
+#include <vector>
 
 #include "ns3/ptr.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/ipv6-routing-table-entry.h"
+#include "ns3/ipv6-prefix-table.h"
 
 namespace ns3
 {
@@ -39,7 +42,6 @@ class NetDevice;
 class Ipv6Interface;
 class Ipv6Route;
 class Node;
-class Ipv6RoutingTableEntry;
 class Ipv6MulticastRoutingTableEntry;
 
 /**
@@ -50,6 +52,13 @@ class Ipv6MulticastRoutingTableEntry;
  * \ingroup ipv6StaticRouting
  * \class Ipv6StaticRouting
  * \brief Static routing protocol for IP version 6 stack.
+ *
+ * Unicast routes are stored in one hash table per prefix length, keyed
+ * by the masked destination network. A lookup probes the tables from
+ * the longest prefix length in use to the shortest, so its cost depends
+ * on the number of distinct prefix lengths rather than on the number of
+ * routes, and adding or removing a route is O(1) amortized. Removing a
+ * route by index moves the last route into its index.
  * \see Ipv6RoutingProtocol
  * \see Ipv6ListRouting
  */
@@ -135,6 +144,16 @@ public:
    */
   uint32_t GetNRoutes ();
 
+  /**
+   * \brief Get the routing table generation.
+   *
+   * The generation changes whenever a unicast route is added or removed
+   * or an address is added to or removed from an interface, so callers
+   * caching lookup results can tell when their cache is stale.
+   * \return generation of the routing table
+   */
+  virtual uint32_t GetRouteGeneration () const;
+
   /**
    * \brief Get the default route.
    *
@@ -244,14 +263,55 @@ protected:
   void DoDispose ();
 
 private:
-  typedef std::list<std::pair <Ipv6RoutingTableEntry *, uint32_t> > NetworkRoutes;
-  typedef std::list<std::pair <Ipv6RoutingTableEntry *, uint32_t> >::const_iterator NetworkRoutesCI;
-  typedef std::list<std::pair <Ipv6RoutingTableEntry *, uint32_t> >::iterator NetworkRoutesI;
+  /**
+   * \class NetworkRoute
+   * \brief A unicast route and its metric.
+   */
+  class NetworkRoute
+  {
+public:
+    NetworkRoute (const Ipv6RoutingTableEntry &entry, uint32_t metric);
+
+    /**
+     * \brief The routing table entry.
+     */
+    Ipv6RoutingTableEntry m_entry;
+
+    /**
+     * \brief Metric of the route.
+     */
+    uint32_t m_metric;
+
+    /**
+     * \brief Position in m_networkRoutes.
+     */
+    uint32_t m_index;
+  };
+
+  typedef std::vector<NetworkRoute *> NetworkRoutes;
+  typedef std::vector<NetworkRoute *>::const_iterator NetworkRoutesCI;
+  typedef std::vector<NetworkRoute *>::iterator NetworkRoutesI;
+
+  typedef Ipv6PrefixTable<NetworkRoute>::Bucket RouteBucket;
+  typedef Ipv6PrefixTable<NetworkRoute>::BucketI RouteBucketI;
 
   typedef std::list<Ipv6MulticastRoutingTableEntry *> MulticastRoutes;
   typedef std::list<Ipv6MulticastRoutingTableEntry *>::const_iterator MulticastRoutesCI;
   typedef std::list<Ipv6MulticastRoutingTableEntry *>::iterator MulticastRoutesI;
 
+  /**
+   * \brief Insert a unicast route in the forwarding table.
+   * \param entry routing table entry
+   * \param metric metric of the route
+   */
+  void AddRoute (const Ipv6RoutingTableEntry &entry, uint32_t metric);
+
+  /**
+   * \brief Unlink a unicast route from the forwarding table and free it.
+   * \param route the route
+   */
+  void DeleteRoute (NetworkRoute *route);
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
@@ -278,10 +338,20 @@ private:
   Ipv6Address SourceAddressSelection (uint32_t interface, Ipv6Address dest);
 
   /**
-   * \brief the forwarding table for network.
+   * \brief the forwarding table for network, in index order.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief Routes indexed by destination network.
+   */
+  Ipv6PrefixTable<NetworkRoute> m_prefixTable;
+
+  /**
+   * \brief Routing table generation.
+   */
+  uint32_t m_routeGeneration;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -135,6 +135,12 @@ Ipv6L3ProtocolTestCase::DoRun ()
 
   index = ipv6->GetInterfaceForAddress ("2001:ffff:5678:9000::1"); /* address we just remove */
   NS_TEST_ASSERT_MSG_EQ (index, (uint32_t) -1, "Address should not be found??");
+
+  /* interface not attached to a node yet */
+  Ptr<Ipv6Interface> interface3 = CreateObject<Ipv6Interface> ();
+  NS_TEST_ASSERT_MSG_EQ (interface3->AddAddress (ifaceAddr1), true, "Address should be added without a node??");
+  interface3->RemoveAddress (0);
+  NS_TEST_ASSERT_MSG_EQ (interface3->GetNAddresses (), 0, "Address should be removed without a node??");
   Simulator::Destroy ();
 } //end DoRun
 static class IPv6L3ProtocolTestSuite : public TestSuite
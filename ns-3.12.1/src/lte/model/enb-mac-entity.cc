@@ -113,6 +113,14 @@ EnbMacEntity::ReceiveCqiIdealControlMessage  (Ptr<CqiIdealControlMessage> msg)
   Ptr<UeRecord> record = GetDevice ()->GetObject<EnbNetDevice> ()->GetUeManager ()->GetUeRecord (ue);
   UeRecord::CqiFeedbacks cqiFeedbacks;
 
+  // PMIPv6 Implementation by CHY {
+  if (record == 0)
+    {
+      NS_LOG_LOGIC ("CQI feedbacks from a UE no longer registered. Ignored.");
+      return;
+    }
+  //}
+
   // STORE RECEIVED CQI FEEDBACKS INTO A PROPER UeRecord
   for (CqiIdealControlMessage::CqiFeedbacks::iterator it = cqi->begin (); it != cqi->end (); it++)
     {
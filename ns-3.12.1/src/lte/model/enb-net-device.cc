@@ -48,6 +48,8 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED ( EnbNetDevice);
 
+const uint8_t EnbNetDevice::ACCESS_TECHNOLOGY_TYPE = 8;
+
 TypeId EnbNetDevice::GetTypeId (void)
 {
   static TypeId
@@ -86,6 +88,9 @@ EnbNetDevice::DoDispose ()
   m_macEntity->Dispose ();
   m_macEntity = 0;
 
+  m_newHostCallback = MakeNullCallback<void, Mac48Address, Mac48Address, uint8_t> ();
+  m_delHostCallback = MakeNullCallback<void, Mac48Address, Mac48Address, uint8_t> ();
+
   LteNetDevice::DoDispose ();
 }
 
@@ -133,6 +138,46 @@ EnbNetDevice::GetUeManager (void)
 }
 
 
+// PMIPv6 Implementation by CHY {
+void
+EnbNetDevice::SetNewHostCallback (Callback<void, Mac48Address, Mac48Address, uint8_t> newHost)
+{
+  NS_LOG_FUNCTION (this);
+  m_newHostCallback = newHost;
+}
+
+
+void
+EnbNetDevice::SetDelHostCallback (Callback<void, Mac48Address, Mac48Address, uint8_t> delHost)
+{
+  NS_LOG_FUNCTION (this);
+  m_delHostCallback = delHost;
+}
+
+
+void
+EnbNetDevice::NotifyNewHost (Mac48Address ue)
+{
+  NS_LOG_FUNCTION (this << ue);
+  if (!m_newHostCallback.IsNull ())
+    {
+      m_newHostCallback (ue, Mac48Address::ConvertFrom (GetAddress ()), ACCESS_TECHNOLOGY_TYPE);
+    }
+}
+
+
+void
+EnbNetDevice::NotifyDelHost (Mac48Address ue)
+{
+  NS_LOG_FUNCTION (this << ue);
+  if (!m_delHostCallback.IsNull ())
+    {
+      m_delHostCallback (ue, Mac48Address::ConvertFrom (GetAddress ()), ACCESS_TECHNOLOGY_TYPE);
+    }
+}
+//}
+
+
 void
 EnbNetDevice::SetMacEntity (Ptr<EnbMacEntity> m)
 {
@@ -120,6 +120,24 @@ public:
    */
   void SendIdealPdcchMessage (void);
 
+  // PMIPv6 Implementation by CHY {
+  /**
+   * \brief Access technology type passed to the host callbacks, 3GPP E-UTRAN (RFC 5213)
+   */
+  static const uint8_t ACCESS_TECHNOLOGY_TYPE;
+  /**
+   * \brief Set the callback invoked when a UE is registered to this eNB
+   * \param newHost called with the UE address, the eNB address and the access technology type
+   */
+  void SetNewHostCallback (Callback<void, Mac48Address, Mac48Address, uint8_t> newHost);
+  /**
+   * \brief Set the callback invoked when a UE is removed from this eNB
+   * \param delHost called with the same arguments as the new host callback
+   */
+  void SetDelHostCallback (Callback<void, Mac48Address, Mac48Address, uint8_t> delHost);
+  void NotifyNewHost (Mac48Address ue);
+  void NotifyDelHost (Mac48Address ue);
+  //}
 
 
 private:
@@ -133,6 +151,11 @@ private:
   Ptr<UeManager> m_ueManager;
 
   Ptr<EnbMacEntity> m_macEntity;
+
+  // PMIPv6 Implementation by CHY {
+  Callback<void, Mac48Address, Mac48Address, uint8_t> m_newHostCallback;
+  Callback<void, Mac48Address, Mac48Address, uint8_t> m_delHostCallback;
+  //}
 };
 
 } // namespace ns3
@@ -48,6 +48,10 @@ UeManager::CreateUeRecord (Ptr<UeNetDevice> ue, Ptr<EnbNetDevice> enb)
   NS_LOG_FUNCTION (this << ue << enb);
   Ptr<UeRecord> ueRecord = CreateObject<UeRecord> (ue, enb);
   m_ueRecords->push_back (ueRecord);
+
+  // PMIPv6 Implementation by CHY {
+  enb->NotifyNewHost (Mac48Address::ConvertFrom (ue->GetAddress ()));
+  //}
 }
 
 
@@ -130,7 +134,16 @@ UeManager::DeleteUeRecord (Ptr<UeNetDevice> ue)
     {
       if ((*iter)->GetUe ()->GetAddress () == ue->GetAddress ())
         {
+          // PMIPv6 Implementation by CHY {
+          Ptr<EnbNetDevice> enb = DynamicCast<EnbNetDevice> ((*iter)->GetEnb ());
+          //}
           m_ueRecords->erase (iter);
+          // PMIPv6 Implementation by CHY {
+          if (enb != 0)
+            {
+              enb->NotifyDelHost (Mac48Address::ConvertFrom (ue->GetAddress ()));
+            }
+          //}
           return;
         }
     }
@@ -237,7 +237,11 @@ DistributedSimulatorImpl::ProcessOneEvent (void)
   Scheduler::Event next = m_events->RemoveNext ();
 
   NS_ASSERT (next.key.m_ts >= m_currentTs);
-  m_unscheduledEvents--;
+  // cancelled events were accounted for by Cancel
+  if (!next.impl->IsCancelled ())
+    {
+      m_unscheduledEvents--;
+    }
 
   NS_LOG_LOGIC ("handle " << next.key.m_ts);
   m_currentTs = next.key.m_ts;
@@ -465,6 +469,19 @@ DistributedSimulatorImpl::Cancel (const EventId &id)
   if (!IsExpired (id))
     {
       id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () == 2)
+        {
+          // destroy events are not in the event list
+          return;
+        }
+      Scheduler::Event event;
+      event.impl = id.PeekEventImpl ();
+      event.key.m_ts = id.GetTs ();
+      event.key.m_context = id.GetContext ();
+      event.key.m_uid = id.GetUid ();
+      // the scheduler may drop the event before it is due
+      m_unscheduledEvents--;
+      m_events->NotifyCancel (event);
     }
 }
 
@@ -0,0 +1,877 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/uinteger.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <map>
+
+#if defined (HAVE_PTHREAD_H) && defined (HAVE_TLS)
+#define MULTITHREADED_SIMULATOR 1
+#include "ns3/system-thread.h"
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+NS_LOG_COMPONENT_DEFINE ("MultiThreadedSimulatorImpl");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (MultiThreadedSimulatorImpl);
+
+NS_THREAD_LOCAL MultiThreadedSimulatorImpl::Partition *MultiThreadedSimulatorImpl::m_current = 0;
+MultiThreadedSimulatorImpl *MultiThreadedSimulatorImpl::m_runningImpl = 0;
+
+#ifdef MULTITHREADED_SIMULATOR
+// the list of destroy events may be appended to by any thread
+static pthread_mutex_t g_destroyMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+class MultiThreadedSimulatorImpl::Worker
+{
+public:
+  Worker (MultiThreadedSimulatorImpl *impl, uint32_t partition)
+    : m_impl (impl),
+      m_partition (partition)
+  {
+  }
+  void Run (void)
+  {
+    m_impl->RunWorker (m_partition);
+  }
+private:
+  MultiThreadedSimulatorImpl *m_impl;
+  uint32_t m_partition;
+};
+
+static bool
+IsLarger (const std::vector<uint32_t> &a, const std::vector<uint32_t> &b)
+{
+  return a.size () > b.size ();
+}
+
+TypeId
+MultiThreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultiThreadedSimulatorImpl")
+    .SetParent<Object> ()
+    .AddConstructor<MultiThreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "The number of threads which run the simulation, "
+                   "zero for one per online processor.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultiThreadedSimulatorImpl::m_threadCount),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxLookAhead",
+                   "An upper bound to the lookahead, zero for none. The events "
+                   "which a node schedules for a node of another thread without "
+                   "going through a point-to-point link must be at least this "
+                   "far in the future.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MultiThreadedSimulatorImpl::m_maxLookAhead),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+MultiThreadedSimulatorImpl::MultiThreadedSimulatorImpl ()
+{
+#ifndef MULTITHREADED_SIMULATOR
+  NS_FATAL_ERROR ("Can't use the multi-threaded simulator without threads and thread-local storage");
+#endif
+
+  m_stop = false;
+  m_threadCount = 0;
+  m_global.m_index = 0;
+  m_global.m_events = 0;
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  m_global.m_uid = 4;
+  // before ::Run is entered, the m_currentUid will be zero
+  m_global.m_currentUid = 0;
+  m_global.m_currentTs = 0;
+  m_global.m_currentContext = 0xffffffff;
+  m_global.m_unscheduledEvents = 0;
+  m_partitioned = false;
+  m_lookAhead = ~(uint64_t)0;
+  m_windowEnd = 0;
+  m_running = false;
+  m_done = false;
+  m_arrived = 0;
+  m_generation = 0;
+}
+
+MultiThreadedSimulatorImpl::~MultiThreadedSimulatorImpl ()
+{
+}
+
+void
+MultiThreadedSimulatorImpl::DoDispose (void)
+{
+  for (uint32_t i = 0; i <= m_partitions.size (); i++)
+    {
+      Partition *partition = i < m_partitions.size () ? m_partitions[i] : &m_global;
+      while (!partition->m_events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->m_events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      partition->m_events = 0;
+    }
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      delete m_partitions[i];
+    }
+  m_partitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultiThreadedSimulatorImpl::Destroy ()
+{
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultiThreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  m_schedulerFactory = schedulerFactory;
+  for (uint32_t i = 0; i <= m_partitions.size (); i++)
+    {
+      Partition *partition = i < m_partitions.size () ? m_partitions[i] : &m_global;
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if (partition->m_events != 0)
+        {
+          while (!partition->m_events->IsEmpty ())
+            {
+              Scheduler::Event next = partition->m_events->RemoveNext ();
+              scheduler->Insert (next);
+            }
+        }
+      partition->m_events = scheduler;
+    }
+}
+
+MultiThreadedSimulatorImpl::Partition *
+MultiThreadedSimulatorImpl::PartitionOf (uint32_t context) const
+{
+  // the nodes created after the simulation was partitioned are run
+  // with the events of no node
+  if (context < m_partitionOf.size ())
+    {
+      return m_partitions[m_partitionOf[context]];
+    }
+  return const_cast<Partition *> (&m_global);
+}
+
+MultiThreadedSimulatorImpl::Partition *
+MultiThreadedSimulatorImpl::GetCurrentPartition (void) const
+{
+  if (m_current != 0)
+    {
+      return m_current;
+    }
+  return const_cast<Partition *> (&m_global);
+}
+
+bool
+MultiThreadedSimulatorImpl::IsCrossPartition (uint32_t context)
+{
+  Partition *current = m_current;
+  return current != 0
+         && current != &m_runningImpl->m_global
+         && m_runningImpl->PartitionOf (context) != current;
+}
+
+void
+MultiThreadedSimulatorImpl::InitPartition (Partition *partition)
+{
+  partition->m_events = m_schedulerFactory.Create<Scheduler> ();
+  // the uids of the events moved from the global partition stay unique
+  partition->m_uid = m_global.m_uid;
+  partition->m_currentUid = m_global.m_currentUid;
+  partition->m_currentTs = m_global.m_currentTs;
+  partition->m_currentContext = 0xffffffff;
+  partition->m_unscheduledEvents = 0;
+}
+
+void
+MultiThreadedSimulatorImpl::PartitionNodes (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nNodes = NodeList::GetNNodes ();
+
+  // group the nodes which share a channel, except for the point-to-point
+  // links with a delay: the nodes of a shared channel observe its state
+  // as soon as it changes
+  std::vector<uint32_t> group (nNodes);
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      group[i] = i;
+    }
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      Ptr<Node> node = NodeList::GetNode (i);
+      for (uint32_t j = 0; j < node->GetNDevices (); j++)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          TimeValue delay;
+          if (device->IsPointToPoint ()
+              && channel->GetNDevices () == 2
+              && channel->GetAttributeFailSafe ("Delay", delay)
+              && delay.Get ().IsStrictlyPositive ())
+            {
+              continue;
+            }
+          for (uint32_t k = 0; k < channel->GetNDevices (); k++)
+            {
+              uint32_t a = i;
+              uint32_t b = channel->GetDevice (k)->GetNode ()->GetId ();
+              while (group[a] != a)
+                {
+                  a = group[a];
+                }
+              while (group[b] != b)
+                {
+                  b = group[b];
+                }
+              group[std::max (a, b)] = std::min (a, b);
+            }
+        }
+    }
+
+  // the groups, largest first, by increasing node ids among equals
+  std::vector<std::vector<uint32_t> > groups;
+  std::map<uint32_t, uint32_t> groupIndex;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      uint32_t root = i;
+      while (group[root] != root)
+        {
+          root = group[root];
+        }
+      std::map<uint32_t, uint32_t>::iterator it = groupIndex.find (root);
+      if (it == groupIndex.end ())
+        {
+          it = groupIndex.insert (std::make_pair (root, groups.size ())).first;
+          groups.push_back (std::vector<uint32_t> ());
+        }
+      groups[it->second].push_back (i);
+    }
+  std::stable_sort (groups.begin (), groups.end (), IsLarger);
+
+  uint32_t nPartitions = m_threadCount;
+#ifdef MULTITHREADED_SIMULATOR
+  if (nPartitions == 0)
+    {
+      long n = sysconf (_SC_NPROCESSORS_ONLN);
+      nPartitions = n > 0 ? n : 1;
+    }
+#endif
+  nPartitions = std::max (std::min (nPartitions, (uint32_t)groups.size ()), 1U);
+
+  for (uint32_t i = 0; i < nPartitions; i++)
+    {
+      Partition *partition = new Partition ();
+      partition->m_index = i;
+      InitPartition (partition);
+      // one outbox per other partition, and one for the global events
+      partition->m_outbox.resize (nPartitions + 1);
+      m_partitions.push_back (partition);
+    }
+  m_global.m_index = nPartitions;
+
+  // each group goes to the partition with the fewest nodes so far
+  std::vector<uint32_t> load (nPartitions, 0);
+  m_partitionOf.resize (nNodes);
+  for (uint32_t i = 0; i < groups.size (); i++)
+    {
+      const std::vector<uint32_t> &nodes = groups[i];
+      uint32_t target = std::min_element (load.begin (), load.end ()) - load.begin ();
+      for (uint32_t j = 0; j < nodes.size (); j++)
+        {
+          m_partitionOf[nodes[j]] = target;
+        }
+      load[target] += nodes.size ();
+    }
+  m_partitioned = true;
+
+  // move the events scheduled so far to the partitions of their nodes
+  std::vector<Scheduler::Event> events;
+  while (!m_global.m_events->IsEmpty ())
+    {
+      events.push_back (m_global.m_events->RemoveNext ());
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin (); i != events.end (); i++)
+    {
+      Partition *partition = PartitionOf (i->key.m_context);
+      if (partition != &m_global && !i->impl->IsCancelled ())
+        {
+          m_global.m_unscheduledEvents--;
+          partition->m_unscheduledEvents++;
+        }
+      partition->m_events->Insert (*i);
+    }
+
+  CalculateLookAhead ();
+  NS_LOG_INFO (nNodes << " nodes in " << groups.size () << " groups over "
+                      << nPartitions << " partitions, lookahead=" << m_lookAhead);
+}
+
+void
+MultiThreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  m_lookAhead = ~(uint64_t)0;
+  if (m_maxLookAhead.IsStrictlyPositive ())
+    {
+      m_lookAhead = m_maxLookAhead.GetTimeStep ();
+    }
+  for (uint32_t i = 0; i < m_partitionOf.size (); i++)
+    {
+      Ptr<Node> node = NodeList::GetNode (i);
+      for (uint32_t j = 0; j < node->GetNDevices (); j++)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (!device->IsPointToPoint () || channel == 0)
+            {
+              continue;
+            }
+          for (uint32_t k = 0; k < channel->GetNDevices (); k++)
+            {
+              uint32_t remote = channel->GetDevice (k)->GetNode ()->GetId ();
+              if (m_partitionOf[remote] == m_partitionOf[i])
+                {
+                  continue;
+                }
+              // the link was cut, so it has a delay
+              TimeValue delay;
+              channel->GetAttribute ("Delay", delay);
+              m_lookAhead = std::min (m_lookAhead, (uint64_t)delay.Get ().GetTimeStep ());
+            }
+        }
+    }
+}
+
+void
+MultiThreadedSimulatorImpl::Insert (Partition *partition, const Scheduler::Event &ev)
+{
+  Scheduler::Event tmp = ev;
+  tmp.key.m_uid = partition->m_uid;
+  partition->m_uid++;
+  partition->m_unscheduledEvents++;
+  partition->m_events->Insert (tmp);
+}
+
+void
+MultiThreadedSimulatorImpl::DeliverOutboxes (void)
+{
+  // always in the same order, so that the uids do not depend on the
+  // order in which the threads ran
+  for (uint32_t i = 0; i <= m_partitions.size (); i++)
+    {
+      Partition *dst = i < m_partitions.size () ? m_partitions[i] : &m_global;
+      for (uint32_t j = 0; j < m_partitions.size (); j++)
+        {
+          std::vector<Scheduler::Event> &outbox = m_partitions[j]->m_outbox[i];
+          for (std::vector<Scheduler::Event>::const_iterator k = outbox.begin (); k != outbox.end (); k++)
+            {
+              Insert (dst, *k);
+            }
+          outbox.clear ();
+        }
+    }
+}
+
+void
+MultiThreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->m_events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->m_currentTs);
+  // cancelled events were accounted for by Cancel
+  if (!next.impl->IsCancelled ())
+    {
+      partition->m_unscheduledEvents--;
+    }
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->m_currentTs = next.key.m_ts;
+  partition->m_currentContext = next.key.m_context;
+  partition->m_currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultiThreadedSimulatorImpl::ProcessWindow (uint32_t index)
+{
+  Partition *partition = m_partitions[index];
+  m_current = partition;
+  while (!partition->m_events->IsEmpty ()
+         && NextTs (partition) < m_windowEnd)
+    {
+      ProcessOneEvent (partition);
+    }
+}
+
+void
+MultiThreadedSimulatorImpl::RunWorker (uint32_t index)
+{
+  while (true)
+    {
+      Synchronize ();
+      if (m_done)
+        {
+          break;
+        }
+      ProcessWindow (index);
+      Synchronize ();
+    }
+  m_current = 0;
+}
+
+void
+MultiThreadedSimulatorImpl::Synchronize (void)
+{
+#ifdef MULTITHREADED_SIMULATOR
+  uint32_t generation = m_generation;
+  if (__sync_add_and_fetch (&m_arrived, 1) == m_partitions.size ())
+    {
+      m_arrived = 0;
+      __sync_fetch_and_add (&m_generation, 1);
+    }
+  else
+    {
+      // the windows are short: spin a little before giving the
+      // processor away
+      uint32_t spins = 0;
+      while (m_generation == generation)
+        {
+          spins++;
+          if (spins > 1000)
+            {
+              sched_yield ();
+            }
+        }
+    }
+  __sync_synchronize ();
+#endif
+}
+
+bool
+MultiThreadedSimulatorImpl::IsFinished (void) const
+{
+  return m_stop || NextPartition () == 0;
+}
+
+uint64_t
+MultiThreadedSimulatorImpl::NextTs (const Partition *partition) const
+{
+  NS_ASSERT (!partition->m_events->IsEmpty ());
+  Scheduler::Event ev = partition->m_events->PeekNext ();
+  return ev.key.m_ts;
+}
+
+MultiThreadedSimulatorImpl::Partition *
+MultiThreadedSimulatorImpl::NextPartition (void) const
+{
+  // the global events go first among those of the same timestamp
+  const Partition *next = 0;
+  if (!m_global.m_events->IsEmpty ())
+    {
+      next = &m_global;
+    }
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      const Partition *partition = m_partitions[i];
+      if (!partition->m_events->IsEmpty ()
+          && (next == 0 || NextTs (partition) < NextTs (next)))
+        {
+          next = partition;
+        }
+    }
+  return const_cast<Partition *> (next);
+}
+
+Time
+MultiThreadedSimulatorImpl::Next (void) const
+{
+  return TimeStep (NextTs (NextPartition ()));
+}
+
+void
+MultiThreadedSimulatorImpl::Run (void)
+{
+#ifdef MULTITHREADED_SIMULATOR
+  if (!m_partitioned)
+    {
+      PartitionNodes ();
+    }
+  m_stop = false;
+  m_done = false;
+  m_arrived = 0;
+  m_running = true;
+  m_runningImpl = this;
+  SetOtherThreadContextPredicate (&MultiThreadedSimulatorImpl::IsCrossPartition);
+
+  // this thread runs the first partition
+  std::vector<Worker *> workers;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < m_partitions.size (); i++)
+    {
+      Worker *worker = new Worker (this, i);
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&Worker::Run, worker));
+      thread->Start ();
+      workers.push_back (worker);
+      threads.push_back (thread);
+    }
+
+  while (!m_stop)
+    {
+      DeliverOutboxes ();
+      Partition *next = NextPartition ();
+      if (next == 0)
+        {
+          break;
+        }
+      if (next == &m_global)
+        {
+          m_current = &m_global;
+          ProcessOneEvent (&m_global);
+          continue;
+        }
+      uint64_t start = NextTs (next);
+      m_windowEnd = start + std::min (m_lookAhead, ~(uint64_t)0 - start);
+      if (!m_global.m_events->IsEmpty ())
+        {
+          m_windowEnd = std::min (m_windowEnd, NextTs (&m_global));
+        }
+      Synchronize ();
+      ProcessWindow (0);
+      Synchronize ();
+    }
+
+  m_done = true;
+  Synchronize ();
+  for (uint32_t i = 0; i < threads.size (); i++)
+    {
+      threads[i]->Join ();
+      delete workers[i];
+    }
+  m_current = 0;
+  m_running = false;
+  m_runningImpl = 0;
+  SetOtherThreadContextPredicate (0);
+
+  // the time of the main program is that of the last event
+  int unscheduledEvents = m_global.m_unscheduledEvents;
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      m_global.m_currentTs = std::max (m_global.m_currentTs, m_partitions[i]->m_currentTs);
+      unscheduledEvents += m_partitions[i]->m_unscheduledEvents;
+    }
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (NextPartition () != 0 || unscheduledEvents == 0);
+#else
+  NS_FATAL_ERROR ("Can't use the multi-threaded simulator without threads and thread-local storage");
+#endif
+}
+
+uint32_t
+MultiThreadedSimulatorImpl::GetSystemId () const
+{
+  return 0;
+}
+
+void
+MultiThreadedSimulatorImpl::RunOneEvent (void)
+{
+  Partition *next = NextPartition ();
+  m_current = next;
+  ProcessOneEvent (next);
+  m_current = 0;
+  m_global.m_currentTs = std::max (m_global.m_currentTs, next->m_currentTs);
+}
+
+void
+MultiThreadedSimulatorImpl::Stop (void)
+{
+  m_stop = true;
+}
+
+void
+MultiThreadedSimulatorImpl::Stop (Time const &time)
+{
+  Simulator::Schedule (time, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultiThreadedSimulatorImpl::Schedule (Time const &time, EventImpl *event)
+{
+  Partition *partition = GetCurrentPartition ();
+  Time tAbsolute = time + TimeStep (partition->m_currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (partition->m_currentTs));
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = static_cast<uint64_t> (tAbsolute.GetTimeStep ());
+  ev.key.m_context = partition->m_currentContext;
+  ev.key.m_uid = partition->m_uid;
+  partition->m_uid++;
+  partition->m_unscheduledEvents++;
+  partition->m_events->Insert (ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultiThreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event)
+{
+  Partition *src = GetCurrentPartition ();
+  NS_LOG_FUNCTION (this << context << time.GetTimeStep () << src->m_currentTs << event);
+
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = src->m_currentTs + time.GetTimeStep ();
+  ev.key.m_context = context;
+  ev.key.m_uid = 0;
+
+  Partition *dst = PartitionOf (context);
+  if (dst == src || src == &m_global || !m_running)
+    {
+      // the other threads wait while the global events run
+      Insert (dst, ev);
+      return;
+    }
+  if (ev.key.m_ts < m_windowEnd)
+    {
+      NS_FATAL_ERROR ("Event for context " << context << " at " << ev.key.m_ts
+                      << " scheduled by another thread before the end of the window at "
+                      << m_windowEnd << ": the MaxLookAhead attribute is too large");
+    }
+  // the uid is allocated when the event is delivered
+  src->m_outbox[dst->m_index].push_back (ev);
+}
+
+EventId
+MultiThreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  Partition *partition = GetCurrentPartition ();
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = partition->m_currentTs;
+  ev.key.m_context = partition->m_currentContext;
+  ev.key.m_uid = partition->m_uid;
+  partition->m_uid++;
+  partition->m_unscheduledEvents++;
+  partition->m_events->Insert (ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+EventId
+MultiThreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), GetCurrentPartition ()->m_currentTs, 0xffffffff, 2);
+#ifdef MULTITHREADED_SIMULATOR
+  pthread_mutex_lock (&g_destroyMutex);
+#endif
+  m_destroyEvents.push_back (id);
+#ifdef MULTITHREADED_SIMULATOR
+  pthread_mutex_unlock (&g_destroyMutex);
+#endif
+  return id;
+}
+
+Time
+MultiThreadedSimulatorImpl::Now (void) const
+{
+  return TimeStep (GetCurrentPartition ()->m_currentTs);
+}
+
+Time
+MultiThreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrentPartition ()->m_currentTs);
+    }
+}
+
+void
+MultiThreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+#ifdef MULTITHREADED_SIMULATOR
+      pthread_mutex_lock (&g_destroyMutex);
+#endif
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+#ifdef MULTITHREADED_SIMULATOR
+      pthread_mutex_unlock (&g_destroyMutex);
+#endif
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = PartitionOf (id.GetContext ());
+  NS_ASSERT_MSG (!m_running || partition == GetCurrentPartition () || GetCurrentPartition () == &m_global,
+                 "Event removed by another thread than the one which runs it");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->m_events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->m_unscheduledEvents--;
+}
+
+void
+MultiThreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () == 2)
+        {
+          // destroy events are not in the event list
+          return;
+        }
+      Partition *partition = PartitionOf (id.GetContext ());
+      NS_ASSERT_MSG (!m_running || partition == GetCurrentPartition () || GetCurrentPartition () == &m_global,
+                     "Event cancelled by another thread than the one which runs it");
+      Scheduler::Event event;
+      event.impl = id.PeekEventImpl ();
+      event.key.m_ts = id.GetTs ();
+      event.key.m_context = id.GetContext ();
+      event.key.m_uid = id.GetUid ();
+      // the scheduler may drop the event before it is due
+      partition->m_unscheduledEvents--;
+      partition->m_events->NotifyCancel (event);
+    }
+}
+
+bool
+MultiThreadedSimulatorImpl::IsExpired (const EventId &ev) const
+{
+  if (ev.GetUid () == 2)
+    {
+      if (ev.PeekEventImpl () == 0
+          || ev.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      bool expired = true;
+#ifdef MULTITHREADED_SIMULATOR
+      pthread_mutex_lock (&g_destroyMutex);
+#endif
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == ev)
+            {
+              expired = false;
+              break;
+            }
+        }
+#ifdef MULTITHREADED_SIMULATOR
+      pthread_mutex_unlock (&g_destroyMutex);
+#endif
+      return expired;
+    }
+  const Partition *partition = PartitionOf (ev.GetContext ());
+  if (ev.PeekEventImpl () == 0
+      || ev.GetTs () < partition->m_currentTs
+      || (ev.GetTs () == partition->m_currentTs
+          && ev.GetUid () <= partition->m_currentUid)
+      || ev.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultiThreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  // XXX: I am fairly certain other compilers use other non-standard
+  // post-fixes to indicate 64 bit constants.
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultiThreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrentPartition ()->m_currentContext;
+}
+
+} // namespace ns3
@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/object-factory.h"
+#include "ns3/thread-local.h"
+
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief conservative parallel simulator implementation on shared memory
+ *
+ * The nodes are split into partitions, each one with its own event list,
+ * which are run by as many threads of the process, without MPI. When the
+ * simulation starts, the nodes attached to a CSMA, wifi or any other
+ * shared channel are grouped together, and so are the two ends of a
+ * point-to-point link without delay; the groups are then spread over the
+ * partitions. Only point-to-point links are cut, and the smallest delay
+ * of a cut link is the lookahead of the simulation.
+ *
+ * The threads advance in windows: each one runs the events of its
+ * partition up to the earliest pending event plus the lookahead, then
+ * waits for the others. An event scheduled for a node of another partition
+ * is handed over at the end of the window, which the lookahead guarantees
+ * is early enough. The events which belong to no node, such as those
+ * scheduled from the main program, are run by the main thread between two
+ * windows while the other threads wait.
+ *
+ * The events of a partition are run in the same order as with the
+ * DefaultSimulatorImpl, but the packet uids and the random streams
+ * created while the simulation runs depend on the interleaving of the
+ * threads. A trace sink connected to the nodes of several partitions must
+ * do its own locking. Simulator::Stop called by the event of a node takes
+ * effect at the end of the current window.
+ */
+class MultiThreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  MultiThreadedSimulatorImpl ();
+  ~MultiThreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual Time Next (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &time);
+  virtual EventId Schedule (Time const &time, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &ev);
+  virtual void Cancel (const EventId &ev);
+  virtual bool IsExpired (const EventId &ev) const;
+  virtual void Run (void);
+  virtual void RunOneEvent (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * \param context the context of an event about to be scheduled
+   * \returns true if the calling thread runs a MultiThreadedSimulatorImpl
+   *          and the event goes to a node simulated by another thread.
+   *
+   * Installed as the IsOtherThreadContext predicate while running.
+   */
+  static bool IsCrossPartition (uint32_t context);
+
+private:
+  struct Partition
+  {
+    uint32_t m_index;
+    Ptr<Scheduler> m_events;
+    uint32_t m_uid;
+    uint32_t m_currentUid;
+    uint64_t m_currentTs;
+    uint32_t m_currentContext;
+    // number of events that have been inserted but not yet scheduled,
+    // not counting the "destroy" events; this is used for validation
+    int m_unscheduledEvents;
+    // the events for the other partitions, indexed by destination
+    std::vector<std::vector<Scheduler::Event> > m_outbox;
+  };
+  class Worker;
+
+  virtual void DoDispose (void);
+
+  Partition *PartitionOf (uint32_t context) const;
+  Partition *GetCurrentPartition (void) const;
+  void InitPartition (Partition *partition);
+  void PartitionNodes (void);
+  void CalculateLookAhead (void);
+  void Insert (Partition *partition, const Scheduler::Event &ev);
+  void DeliverOutboxes (void);
+  void ProcessOneEvent (Partition *partition);
+  void ProcessWindow (uint32_t partition);
+  void RunWorker (uint32_t partition);
+  void Synchronize (void);
+  uint64_t NextTs (const Partition *partition) const;
+  Partition *NextPartition (void) const;
+
+  typedef std::list<EventId> DestroyEvents;
+
+  // the partition whose events the calling thread runs, if any
+  static NS_THREAD_LOCAL Partition *m_current;
+  static MultiThreadedSimulatorImpl *m_runningImpl;
+
+  DestroyEvents m_destroyEvents;
+  ObjectFactory m_schedulerFactory;
+  volatile bool m_stop;
+  uint32_t m_threadCount;
+  Time m_maxLookAhead;
+
+  // the events of no node, and of every node until the first Run
+  Partition m_global;
+  std::vector<Partition *> m_partitions;
+  // partition of each node, indexed by node id
+  std::vector<uint32_t> m_partitionOf;
+  bool m_partitioned;
+  uint64_t m_lookAhead;
+
+  // the threads run the events before this timestamp
+  uint64_t m_windowEnd;
+  bool m_running;
+  volatile bool m_done;
+  volatile uint32_t m_arrived;
+  volatile uint32_t m_generation;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -46,7 +46,7 @@ static struct Zeroes
 namespace ns3 {
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+NS_THREAD_LOCAL uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -71,11 +71,17 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
+NS_THREAD_LOCAL uint32_t Buffer::g_maxSize = 0;
+NS_THREAD_LOCAL Buffer::FreeList *Buffer::g_freeList = 0;
 struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
+{
+  Buffer::DestroyFreeList ();
+}
+
+void
+Buffer::DestroyFreeList (void)
 {
   if (IS_INITIALIZED (g_freeList))
     {
@@ -93,11 +99,10 @@ void
 Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
   g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
+  /* feed into free list, unless this thread has never created a buffer */
   if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
+      !IS_INITIALIZED (g_freeList) ||
       g_freeList->size () > 1000)
     {
       Buffer::Deallocate (data);
@@ -116,6 +121,7 @@ Buffer::Create (uint32_t dataSize)
   if (IS_UNINITIALIZED (g_freeList))
     {
       g_freeList = new Buffer::FreeList ();
+      RegisterThreadCleanup (&Buffer::DestroyFreeList);
     }
   else if (IS_INITIALIZED (g_freeList))
     {
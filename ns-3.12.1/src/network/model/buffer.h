@@ -24,6 +24,7 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "ns3/thread-local.h"
 
 #define noBUFFER_FREE_LIST 1
 
@@ -590,9 +591,9 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value. Each thread keeps its own.
    */
-  static uint32_t g_recommendedStart;
+  static NS_THREAD_LOCAL uint32_t g_recommendedStart;
 
   /* offset to the start of the virtual zero area from the start 
    * of m_data->m_data
@@ -617,8 +618,10 @@ private:
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize;
-  static FreeList *g_freeList;
+  static void DestroyFreeList (void);
+  // each thread recycles the buffers it frees
+  static NS_THREAD_LOCAL uint32_t g_maxSize;
+  static NS_THREAD_LOCAL FreeList *g_freeList;
   static struct LocalStaticDestructor g_localStaticDestructor;
 #endif
 };
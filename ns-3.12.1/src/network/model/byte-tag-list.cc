@@ -19,6 +19,7 @@
  */
 #include "byte-tag-list.h"
 #include "ns3/log.h"
+#include "ns3/thread-local.h"
 #include <vector>
 #include <string.h>
 
@@ -38,22 +39,36 @@ struct ByteTagListData {
 };
 
 #ifdef USE_FREE_LIST
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
+typedef std::vector<struct ByteTagListData *> ByteTagListDataFreeList;
+// each thread recycles the tag lists it frees
+static NS_THREAD_LOCAL ByteTagListDataFreeList *g_freeList = 0;
+static NS_THREAD_LOCAL uint32_t g_maxSize = 0;
+static bool g_freeListDestroyed = false;
+
+static void
+DestroyFreeList (void)
 {
-public:
-  ~ByteTagListDataFreeList ();
-} g_freeList;
-static uint32_t g_maxSize = 0;
-
-ByteTagListDataFreeList::~ByteTagListDataFreeList ()
-{
-  for (ByteTagListDataFreeList::iterator i = begin ();
-       i != end (); i++)
+  if (g_freeList != 0)
     {
-      uint8_t *buffer = (uint8_t *)(*i);
-      delete [] buffer;
+      for (ByteTagListDataFreeList::iterator i = g_freeList->begin ();
+           i != g_freeList->end (); i++)
+        {
+          uint8_t *buffer = (uint8_t *)(*i);
+          delete [] buffer;
+        }
+      delete g_freeList;
+      g_freeList = 0;
     }
 }
+
+static struct LocalStaticDestructor
+{
+  ~LocalStaticDestructor ()
+  {
+    DestroyFreeList ();
+    g_freeListDestroyed = true;
+  }
+} g_localStaticDestructor;
 #endif /* USE_FREE_LIST */
 
 ByteTagList::Iterator::Item::Item (TagBuffer buf_)
@@ -339,10 +354,10 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  while (g_freeList != 0 && !g_freeList->empty ())
     {
-      struct ByteTagListData *data = g_freeList.back ();
-      g_freeList.pop_back ();
+      struct ByteTagListData *data = g_freeList->back ();
+      g_freeList->pop_back ();
       NS_ASSERT (data != 0);
       if (data->size >= size)
         {
@@ -373,7 +388,13 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
+      if (g_freeList == 0 && !g_freeListDestroyed)
+        {
+          g_freeList = new ByteTagListDataFreeList ();
+          RegisterThreadCleanup (&DestroyFreeList);
+        }
+      if (g_freeList == 0 ||
+          g_freeList->size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
@@ -381,7 +402,7 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
         }
       else
         {
-          g_freeList.push_back (data);
+          g_freeList->push_back (data);
         }
     }
 }
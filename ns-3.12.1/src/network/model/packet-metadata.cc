@@ -34,17 +34,41 @@ namespace ns3 {
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
+NS_THREAD_LOCAL uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+NS_THREAD_LOCAL PacketMetadata::DataFreeList *PacketMetadata::m_freeList = 0;
+struct PacketMetadata::LocalStaticDestructor PacketMetadata::m_localStaticDestructor;
 
-PacketMetadata::DataFreeList::~DataFreeList ()
+PacketMetadata::LocalStaticDestructor::~LocalStaticDestructor ()
 {
-  for (iterator i = begin (); i != end (); i++)
+  PacketMetadata::DestroyFreeList ();
+  // the packets freed after this point are not recycled
+  PacketMetadata::m_enable = false;
+}
+
+uint16_t
+PacketMetadata::NextChunkUid (void)
+{
+#ifdef __GNUC__
+  // the threads of a multi-threaded simulation add headers concurrently
+  return __sync_fetch_and_add (&m_chunkUid, 1);
+#else
+  return m_chunkUid++;
+#endif
+}
+
+void
+PacketMetadata::DestroyFreeList (void)
+{
+  if (m_freeList != 0)
     {
-      PacketMetadata::Deallocate (*i);
+      for (DataFreeList::iterator i = m_freeList->begin (); i != m_freeList->end (); i++)
+        {
+          PacketMetadata::Deallocate (*i);
+        }
+      delete m_freeList;
+      m_freeList = 0;
     }
-  PacketMetadata::m_enable = false;
 }
 
 void 
@@ -570,10 +594,10 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
+  while (m_freeList != 0 && !m_freeList->empty ()) 
     {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
+      struct PacketMetadata::Data *data = m_freeList->back ();
+      m_freeList->pop_back ();
       if (data->m_size >= size) 
         {
           NS_LOG_LOGIC ("create found size="<<data->m_size);
@@ -595,16 +619,21 @@ PacketMetadata::Recycle (struct PacketMetadata::Data *data)
       PacketMetadata::Deallocate (data);
       return;
     } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
+  if (m_freeList == 0)
+    {
+      m_freeList = new DataFreeList ();
+      RegisterThreadCleanup (&PacketMetadata::DestroyFreeList);
+    }
+  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList->size ());
   NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
+  if (m_freeList->size () > 1000 ||
       data->m_size < m_maxSize) 
     {
       PacketMetadata::Deallocate (data);
     } 
   else 
     {
-      m_freeList.push_back (data);
+      m_freeList->push_back (data);
     }
 }
 
@@ -664,8 +693,7 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
   item.prev = 0xffff;
   item.typeUid = uid;
   item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
+  item.chunkUid = NextChunkUid ();
   uint16_t written = AddSmall (&item);
   UpdateHead (written);
 }
@@ -733,8 +761,7 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   item.prev = m_tail;
   item.typeUid = uid;
   item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
+  item.chunkUid = NextChunkUid ();
   uint16_t written = AddSmall (&item);
   UpdateTail (written);
   NS_ASSERT (IsStateOk ());
@@ -25,6 +25,7 @@
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
+#include "ns3/thread-local.h"
 #include "buffer.h"
 
 namespace ns3 {
@@ -284,13 +285,13 @@ private:
     uint64_t packetUid;
   };
 
-  class DataFreeList : public std::vector<struct Data *>
+  typedef std::vector<struct Data *> DataFreeList;
+  struct LocalStaticDestructor
   {
-public:
-    ~DataFreeList ();
+    ~LocalStaticDestructor ();
   };
 
-  friend DataFreeList::~DataFreeList ();
+  friend struct LocalStaticDestructor;
   friend class ItemIterator;
 
   PacketMetadata ();
@@ -326,8 +327,12 @@ public:
   static void Recycle (struct PacketMetadata::Data *data);
   static struct PacketMetadata::Data *Allocate (uint32_t n);
   static void Deallocate (struct PacketMetadata::Data *data);
+  static void DestroyFreeList (void);
+  static uint16_t NextChunkUid (void);
 
-  static DataFreeList m_freeList;
+  // each thread recycles the metadata it frees
+  static NS_THREAD_LOCAL DataFreeList *m_freeList;
+  static struct LocalStaticDestructor m_localStaticDestructor;
   static bool m_enable;
   static bool m_enableChecking;
 
@@ -336,7 +341,7 @@ public:
   // middle of a simulation, which isn't allowed.
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize;
+  static NS_THREAD_LOCAL uint32_t m_maxSize;
   static uint16_t m_chunkUid;
 
   struct Data *m_data;
@@ -125,6 +125,17 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+uint32_t
+Packet::AllocateUid (void)
+{
+#ifdef __GNUC__
+  // packets may be created by the threads of a multi-threaded simulation
+  return __sync_fetch_and_add (&m_globalUid, 1);
+#else
+  return m_globalUid++;
+#endif
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -135,10 +146,9 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -177,10 +187,9 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -203,10 +212,9 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -812,6 +820,17 @@ Packet::AddByteTag (const Tag &tag) const
                                 m_buffer.GetCurrentEndOffset ());
   tag.Serialize (buffer);
 }
+void
+Packet::AddByteTag (const Tag &tag, uint32_t start, uint32_t end) const
+{
+  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ().GetName () << tag.GetSerializedSize () << start << end);
+  NS_ASSERT (start <= end && end <= GetSize ());
+  ByteTagList *list = const_cast<ByteTagList *> (&m_byteTagList);
+  int32_t offset = m_buffer.GetCurrentStartOffset ();
+  TagBuffer buffer = list->Add (tag.GetInstanceTypeId (), tag.GetSerializedSize (), 
+                                offset + start, offset + end);
+  tag.Serialize (buffer);
+}
 ByteTagIterator 
 Packet::GetByteTagIterator (void) const
 {
@@ -468,6 +468,15 @@ public:
    * packet).
    */
   void AddByteTag (const Tag &tag) const;
+  /**
+   * \param tag the new tag to add to this packet
+   * \param start the offset of the first byte to tag
+   * \param end the offset past the last byte to tag
+   *
+   * Tag the bytes [start, end) of this packet only, the range
+   * ByteTagIterator::Item reports for the tags of another packet.
+   */
+  void AddByteTag (const Tag &tag, uint32_t start, uint32_t end) const;
   /**
    * \returns an iterator over the set of byte tags included in this packet.
    */
@@ -566,6 +575,8 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector;
 
+  static uint32_t AllocateUid (void);
+
   static uint32_t m_globalUid;
 };
 
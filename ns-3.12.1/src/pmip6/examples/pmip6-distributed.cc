@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * A PMIPv6 domain split across logical processors. The LMA runs on
+ * rank 0 and the MAGs are dealt round-robin to the other ranks, each
+ * MAG hanging off the LMA by a point-to-point link.
+ *
+ *                 RANK 0  |  RANK 1..N-1
+ *                         |
+ *                    /----|---- MAG0 -- (MNs)
+ *                 LMA ----|---- MAG1 -- (MNs)
+ *                    \----|---- MAG2 -- (MNs)
+ *                         |
+ *
+ * Every rank builds the whole topology and its own replica of the MN
+ * profiles, the helpers only install the agents of the local nodes.
+ * The MNs attach through the MAG notifier at 1s, and at 3s each one
+ * moves to the next MAG, which usually lives on another rank. The PBUs
+ * and PBAs cross the ranks as MPI messages.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/pmip6-module.h"
+
+#include <stdio.h>
+
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Pmip6Distributed");
+
+#ifdef NS3_MPI
+
+static Ipv6Address
+LinkAddress (uint16_t subnet, uint8_t host)
+{
+  uint8_t buf[16];
+  memset (buf, 0, 16);
+  buf[0] = 0x20;
+  buf[1] = 0x01;
+  buf[2] = 0x0d;
+  buf[3] = 0xb8;
+  buf[6] = subnet >> 8;
+  buf[7] = subnet & 0xff;
+  buf[15] = host;
+  return Ipv6Address (buf);
+}
+
+static void
+Attach (Ptr<Node> mag, uint32_t ifIndex, Mac48Address mn)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  Pmipv6MagNotifyHeader header;
+
+  header.SetMacAddress (mn);
+  header.SetAccessTechnologyType (Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+  packet->AddHeader (header);
+
+  mag->GetObject<Pmipv6MagNotifier> ()->Receive (packet, Ipv6Address::GetAny (), Ipv6Address::GetAny (),
+                                                  mag->GetObject<Ipv6L3Protocol> ()->GetInterface (ifIndex));
+}
+
+#endif
+
+int
+main (int argc, char *argv[])
+{
+#ifdef NS3_MPI
+  // Distributed simulation setup
+  MpiInterface::Enable (&argc, &argv);
+  GlobalValue::Bind ("SimulatorImplementationType",
+                     StringValue ("ns3::DistributedSimulatorImpl"));
+
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  uint32_t systemCount = MpiInterface::GetSize ();
+
+  if (systemCount < 2)
+    {
+      std::cout << "This simulation requires at least 2 logical processors." << std::endl;
+      return 1;
+    }
+
+  uint32_t nMags = 4;
+  uint32_t nMns = 10;
+
+  CommandLine cmd;
+  cmd.AddValue ("mags", "Number of MAGs", nMags);
+  cmd.AddValue ("mns", "Number of MNs attached to each MAG", nMns);
+  cmd.Parse (argc, argv);
+
+  Ptr<Node> lma = CreateObject<Node> (0);
+  NodeContainer mags;
+  for (uint32_t i = 0; i < nMags; i++)
+    {
+      mags.Add (CreateObject<Node> (1 + i % (systemCount - 1)));
+    }
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (lma);
+  internet.Install (mags);
+
+  // The MAGs send router advertisements on packet sockets
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (mags);
+
+  // The lookahead of the distributed simulator is the link delay
+  PointToPointHelper backbone;
+  backbone.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  backbone.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6StaticRoutingHelper routingHelper;
+  std::vector<uint32_t> accessIf;
+
+  for (uint32_t i = 0; i < nMags; i++)
+    {
+      Ptr<Node> mag = mags.Get (i);
+      NetDeviceContainer devices = backbone.Install (lma, mag);
+      uint32_t ifIndex = 0;
+
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          Ptr<Ipv6> ipv6 = devices.Get (j)->GetNode ()->GetObject<Ipv6> ();
+          ifIndex = ipv6->AddInterface (devices.Get (j));
+          ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (LinkAddress (i, j + 1), Ipv6Prefix (64)));
+          ipv6->SetForwarding (ifIndex, true);
+          ipv6->SetUp (ifIndex);
+        }
+
+      // The profiles name the LMA by its address on the first link
+      routingHelper.GetStaticRouting (mag->GetObject<Ipv6> ())->SetDefaultRoute (LinkAddress (i, 1), ifIndex);
+
+      // Access link, the MNs only exist in the MAG notifications
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (CreateObject<SimpleChannel> ());
+      mag->AddDevice (device);
+
+      Ptr<Ipv6> ipv6 = mag->GetObject<Ipv6> ();
+      ifIndex = ipv6->AddInterface (device);
+      ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (LinkAddress (0x100 + i, 1), Ipv6Prefix (64)));
+      ipv6->SetForwarding (ifIndex, true);
+      ipv6->SetUp (ifIndex);
+      accessIf.push_back (ifIndex);
+    }
+
+  // Every rank builds the same replica of the profiles
+  Pmip6ProfileHelper profile;
+  std::list<Ipv6Address> hnps;
+  std::vector<Mac48Address> mns;
+
+  for (uint32_t n = 0; n < nMags * nMns; n++)
+    {
+      char nai[64];
+      Mac48Address mn = Mac48Address::Allocate ();
+
+      sprintf (nai, "mn%u@pmip6.example.org", n);
+      profile.AddProfile (Identifier (nai), Identifier (mn), LinkAddress (0, 1), hnps);
+      mns.push_back (mn);
+    }
+
+  Pmip6LmaHelper lmaHelper;
+  lmaHelper.SetProfileHelper (&profile);
+  lmaHelper.Install (lma);
+
+  Pmip6MagHelper magHelper;
+  magHelper.SetProfileHelper (&profile);
+  for (uint32_t i = 0; i < nMags; i++)
+    {
+      magHelper.Install (mags.Get (i), LinkAddress (i, 2), NodeContainer ());
+    }
+
+  // Only the rank owning a MAG drives its attachments
+  for (uint32_t n = 0; n < mns.size (); n++)
+    {
+      uint32_t from = n / nMns;
+      uint32_t to = (from + 1) % nMags;
+
+      if (mags.Get (from)->GetSystemId () == systemId)
+        {
+          Simulator::Schedule (Seconds (1.0) + MicroSeconds (100 * n), &Attach, mags.Get (from), accessIf[from], mns[n]);
+        }
+      if (mags.Get (to)->GetSystemId () == systemId)
+        {
+          Simulator::Schedule (Seconds (3.0) + MicroSeconds (100 * n), &Attach, mags.Get (to), accessIf[to], mns[n]);
+        }
+    }
+
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+
+  if (systemId == lma->GetSystemId ())
+    {
+      Ptr<Pmipv6Lma> agent = lma->GetObject<Pmipv6Lma> ();
+      std::cout << "rank " << systemId << ": LMA handled " << agent->GetRxMessages ()
+                << " PBUs, " << agent->GetNBindings () << " bindings" << std::endl;
+    }
+  for (uint32_t i = 0; i < nMags; i++)
+    {
+      if (mags.Get (i)->GetSystemId () == systemId)
+        {
+          std::cout << "rank " << systemId << ": MAG" << i << " received "
+                    << mags.Get (i)->GetObject<Pmipv6Mag> ()->GetRxMessages () << " PBAs" << std::endl;
+        }
+    }
+
+  Simulator::Destroy ();
+  // Exit the MPI execution environment
+  MpiInterface::Disable ();
+  return 0;
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
@@ -0,0 +1,316 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * Handover interruption of a wifi MN moving between the access points
+ * of two MAGs, with and without predictive pre-registration.
+ *
+ *   CN -- LMA ==(backbone)== MAG1 (AP1)     MAG2 (AP2)
+ *                                 MN ---->
+ *
+ * The CN sends a UDP flow to the MN while it drives from AP1 to AP2.
+ * Without --predictive=1 the MAG2 registers the MN once it is associated
+ * with AP2. With --predictive=1 a link trigger on the MN hands it over to
+ * MAG2 when AP2 gets stronger than the fading AP1: MAG2 registers the MN
+ * ahead of the move and holds its downlink until the association.
+ *
+ * The program prints the time between the association with AP2 and the
+ * first packet received through it, the longest gap of the flow and the
+ * packets lost.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/pmip6-module.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Pmip6FastHandover");
+
+static uint32_t g_sent = 0;
+static uint32_t g_received = 0;
+static Time g_lastRx;
+static Time g_maxGap;
+static Time g_handoverAssoc;
+static Time g_firstRxAfterAssoc;
+static Mac48Address g_ap2;
+
+static void
+CnTx (Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  Ipv6Header header;
+  packet->PeekHeader (header);
+
+  if (header.GetNextHeader () == 17)
+    {
+      g_sent++;
+    }
+}
+
+static void
+MnRx (Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  Ipv6Header header;
+  packet->PeekHeader (header);
+
+  if (header.GetNextHeader () != 17)
+    {
+      return;
+    }
+
+  Time now = Simulator::Now ();
+
+  if (g_received++ > 0 && now - g_lastRx > g_maxGap)
+    {
+      g_maxGap = now - g_lastRx;
+    }
+
+  g_lastRx = now;
+
+  if (!g_handoverAssoc.IsZero () && g_firstRxAfterAssoc.IsZero ())
+    {
+      g_firstRxAfterAssoc = now;
+    }
+}
+
+static void
+MnAssoc (Mac48Address bssid)
+{
+  if (bssid == g_ap2)
+    {
+      g_handoverAssoc = Simulator::Now ();
+    }
+}
+
+static void
+StartBeacons (Ptr<WifiMac> mac)
+{
+  mac->SetAttribute ("BeaconGeneration", BooleanValue (true));
+}
+
+static uint32_t
+AddInterface (Ptr<NetDevice> device, const char *address, bool forwarding = true)
+{
+  Ptr<Ipv6> ipv6 = device->GetNode ()->GetObject<Ipv6> ();
+  uint32_t ifIndex = ipv6->AddInterface (device);
+
+  if (address != 0)
+    {
+      ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (Ipv6Address (address), Ipv6Prefix (64)));
+    }
+  ipv6->SetForwarding (ifIndex, forwarding);
+  ipv6->SetUp (ifIndex);
+  return ifIndex;
+}
+
+int
+main (int argc, char *argv[])
+{
+  bool predictive = false;
+  double speed = 20.0;
+  double distance = 180.0;
+  double threshold = -90.0;
+  Time interval = MilliSeconds (10);
+
+  CommandLine cmd;
+  cmd.AddValue ("predictive", "Pre-register the MN with the next MAG on a link trigger", predictive);
+  cmd.AddValue ("speed", "Speed of the MN in m/s", speed);
+  cmd.AddValue ("distance", "Distance between the access points in m", distance);
+  cmd.AddValue ("threshold", "Signal of the serving access point triggering a handover, in dBm", threshold);
+  cmd.AddValue ("interval", "Interval between the downlink packets", interval);
+  cmd.Parse (argc, argv);
+
+  SeedManager::SetSeed (123456);
+
+  // Held packets must cover the flow from the trigger to the association
+  Config::SetDefault ("ns3::Pmipv6Mag::HoldLimit", UintegerValue (512));
+
+  NodeContainer backbone;
+  backbone.Create (3);
+  Ptr<Node> lma = backbone.Get (0);
+  NodeContainer mags (backbone.Get (1), backbone.Get (2));
+  Ptr<Node> cn = CreateObject<Node> ();
+  Ptr<Node> mn = CreateObject<Node> ();
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (backbone);
+  internet.Install (cn);
+  internet.Install (mn);
+
+  // The MAGs send router advertisements on packet sockets
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (mags);
+
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", DataRateValue (DataRate (100000000)));
+  csma.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (2)));
+
+  NetDeviceContainer outerDevs = csma.Install (NodeContainer (cn, lma));
+  uint32_t cnIf = AddInterface (outerDevs.Get (0), "3ffe:2::2");
+  AddInterface (outerDevs.Get (1), "3ffe:2::1");
+
+  NetDeviceContainer backboneDevs = csma.Install (backbone);
+  AddInterface (backboneDevs.Get (0), "3ffe:1::1");
+  AddInterface (backboneDevs.Get (1), "3ffe:1::2");
+  AddInterface (backboneDevs.Get (2), "3ffe:1::3");
+
+  Ipv6StaticRoutingHelper routingHelper;
+  routingHelper.GetStaticRouting (cn->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("3ffe:2::1"), cnIf);
+
+  // Both access points share the SSID and the channel, the MN hears the beacons of both
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (distance, 0.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (mags);
+
+  positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (10.0, 10.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (mn);
+  mn->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (Vector (speed, 0.0, 0.0));
+
+  Ssid ssid = Ssid ("pmip6");
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
+  wifiPhy.SetChannel (wifiChannel.Create ());
+
+  WifiHelper wifi = WifiHelper::Default ();
+  NqosWifiMacHelper wifiMac = NqosWifiMacHelper::Default ();
+
+  wifiMac.SetType ("ns3::ApWifiMac",
+                   "Ssid", SsidValue (ssid),
+                   "BeaconGeneration", BooleanValue (true),
+                   "BeaconInterval", TimeValue (MicroSeconds (102400)));
+  NetDeviceContainer apDevs = wifi.Install (wifiPhy, wifiMac, mags.Get (0));
+
+  // The beacons of the two access points would collide at the MN if sent together
+  wifiMac.SetType ("ns3::ApWifiMac",
+                   "Ssid", SsidValue (ssid),
+                   "BeaconGeneration", BooleanValue (false),
+                   "BeaconInterval", TimeValue (MicroSeconds (102400)));
+  apDevs.Add (wifi.Install (wifiPhy, wifiMac, mags.Get (1)));
+  Simulator::Schedule (MicroSeconds (51200), &StartBeacons, apDevs.Get (1)->GetObject<WifiNetDevice> ()->GetMac ());
+
+  AddInterface (apDevs.Get (0), "3ffe:1:1::1");
+  AddInterface (apDevs.Get (1), "3ffe:1:2::1");
+
+  wifiMac.SetType ("ns3::StaWifiMac",
+                   "Ssid", SsidValue (ssid),
+                   "ActiveProbing", BooleanValue (false),
+                   "MaxMissedBeacons", UintegerValue (4));
+  NetDeviceContainer staDevs = wifi.Install (wifiPhy, wifiMac, mn);
+
+  // A host interface, the MN autoconfigures its address from the RAs of the MAGs
+  AddInterface (staDevs.Get (0), 0, false);
+
+  Mac48Address mnMac = Mac48Address::ConvertFrom (staDevs.Get (0)->GetAddress ());
+  Mac48Address ap1 = Mac48Address::ConvertFrom (apDevs.Get (0)->GetAddress ());
+  g_ap2 = Mac48Address::ConvertFrom (apDevs.Get (1)->GetAddress ());
+
+  // PMIPv6 domain, the MN keeps its home network prefix on both access links
+  Pmip6ProfileHelper profile;
+  std::list<Ipv6Address> hnps;
+  hnps.push_back (Ipv6Address ("3ffe:1:4:1::"));
+  profile.AddProfile (Identifier ("mn@pmip6.example.org"), Identifier (mnMac), Ipv6Address ("3ffe:1::1"), hnps);
+
+  Pmip6LmaHelper lmaHelper;
+  lmaHelper.SetProfileHelper (&profile);
+  lmaHelper.Install (lma);
+
+  Pmip6MagHelper magHelper;
+  magHelper.SetProfileHelper (&profile);
+  magHelper.Install (mags.Get (0));
+  magHelper.Install (mags.Get (1));
+
+  Ptr<Pmipv6Mag> mag1 = mags.Get (0)->GetObject<Pmipv6Mag> ();
+  Ptr<Pmipv6Mag> mag2 = mags.Get (1)->GetObject<Pmipv6Mag> ();
+  Ptr<Pmipv6LinkTrigger> trigger;
+
+  if (predictive)
+    {
+      mag1->AddNeighbor (g_ap2, Ipv6Address ("3ffe:1::3"));
+      mag2->AddNeighbor (ap1, Ipv6Address ("3ffe:1::2"));
+
+      trigger = CreateObject<Pmipv6LinkTrigger> ();
+      trigger->SetAttribute ("Threshold", DoubleValue (threshold));
+      trigger->SetAttribute ("Hysteresis", DoubleValue (1.0));
+      trigger->AddAccessPoint (ap1, mag1);
+      trigger->AddAccessPoint (g_ap2, mag2);
+      trigger->Install (staDevs.Get (0)->GetObject<WifiNetDevice> ());
+    }
+
+  // Downlink flow to the address the MN forms from its prefix
+  Ipv6Address mnAddress = Ipv6Address::MakeAutoconfiguredAddress (mnMac, Ipv6Address ("3ffe:1:4:1::"));
+
+  Udp6ServerHelper udpServer (6000);
+  ApplicationContainer apps = udpServer.Install (mn);
+  apps.Start (Seconds (1.0));
+
+  Udp6ClientHelper udpClient (mnAddress, 6000);
+  udpClient.SetAttribute ("Interval", TimeValue (interval));
+  udpClient.SetAttribute ("PacketSize", UintegerValue (512));
+  udpClient.SetAttribute ("MaxPackets", UintegerValue (0xffffffff));
+  apps = udpClient.Install (cn);
+  apps.Start (Seconds (1.5));
+
+  Time stop = Seconds ((distance - 10.0) / speed);
+  apps.Stop (stop - Seconds (1.0));
+
+  cn->GetObject<Ipv6L3Protocol> ()->TraceConnectWithoutContext ("Tx", MakeCallback (&CnTx));
+  mn->GetObject<Ipv6L3Protocol> ()->TraceConnectWithoutContext ("Rx", MakeCallback (&MnRx));
+  staDevs.Get (0)->GetObject<WifiNetDevice> ()->GetMac ()->TraceConnectWithoutContext ("Assoc", MakeCallback (&MnAssoc));
+
+  Simulator::Stop (stop);
+  Simulator::Run ();
+
+  std::cout << (predictive ? "predictive" : "reactive") << " handover at " << speed << " m/s" << std::endl;
+
+  if (g_handoverAssoc.IsZero ())
+    {
+      std::cout << "  no handover to AP2" << std::endl;
+    }
+  else
+    {
+      std::cout << "  associated with AP2 at " << g_handoverAssoc.GetSeconds () << "s" << std::endl;
+      std::cout << "  association to first packet: "
+                << (g_firstRxAfterAssoc - g_handoverAssoc).GetMicroSeconds () / 1000.0 << "ms" << std::endl;
+    }
+
+  std::cout << "  longest gap of the flow: " << g_maxGap.GetMicroSeconds () / 1000.0 << "ms" << std::endl;
+  std::cout << "  packets sent " << g_sent << ", received " << g_received
+            << ", lost " << (g_sent - g_received) << std::endl;
+
+  if (predictive)
+    {
+      std::cout << "  triggers " << trigger->GetNTriggers ()
+                << ", held by MAG2 " << mag2->GetNHeldPackets ()
+                << ", dropped " << mag2->GetNHeldDrops () << std::endl;
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
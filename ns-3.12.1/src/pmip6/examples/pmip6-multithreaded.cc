@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * The PMIPv6 domain of pmip6-distributed, run by the threads of a single
+ * process instead of MPI ranks. Each MAG hangs off the LMA by a
+ * point-to-point link, so the multi-threaded simulator can put every node
+ * in a partition of its own, with the link delay as lookahead.
+ *
+ *                    /-------- MAG0 -- (MNs)
+ *                 LMA -------- MAG1 -- (MNs)
+ *                    \-------- MAG2 -- (MNs)
+ *
+ * The MNs attach through the MAG notifier at 1s, and at 3s each one
+ * moves to the next MAG. With --threads=0 the same simulation runs on
+ * the default simulator, which prints the same counts.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/pmip6-module.h"
+
+#include <stdio.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Pmip6MultiThreaded");
+
+static Ipv6Address
+LinkAddress (uint16_t subnet, uint8_t host)
+{
+  uint8_t buf[16];
+  memset (buf, 0, 16);
+  buf[0] = 0x20;
+  buf[1] = 0x01;
+  buf[2] = 0x0d;
+  buf[3] = 0xb8;
+  buf[6] = subnet >> 8;
+  buf[7] = subnet & 0xff;
+  buf[15] = host;
+  return Ipv6Address (buf);
+}
+
+static void
+Attach (Ptr<Node> mag, uint32_t ifIndex, Mac48Address mn)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  Pmipv6MagNotifyHeader header;
+
+  header.SetMacAddress (mn);
+  header.SetAccessTechnologyType (Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+  packet->AddHeader (header);
+
+  mag->GetObject<Pmipv6MagNotifier> ()->Receive (packet, Ipv6Address::GetAny (), Ipv6Address::GetAny (),
+                                                  mag->GetObject<Ipv6L3Protocol> ()->GetInterface (ifIndex));
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nMags = 4;
+  uint32_t nMns = 10;
+  uint32_t nThreads = 4;
+
+  CommandLine cmd;
+  cmd.AddValue ("mags", "Number of MAGs", nMags);
+  cmd.AddValue ("mns", "Number of MNs attached to each MAG", nMns);
+  cmd.AddValue ("threads", "Number of threads, 0 for the default simulator", nThreads);
+  cmd.Parse (argc, argv);
+
+  if (nThreads > 0)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType",
+                         StringValue ("ns3::MultiThreadedSimulatorImpl"));
+      Config::SetDefault ("ns3::MultiThreadedSimulatorImpl::ThreadCount", UintegerValue (nThreads));
+    }
+
+  Ptr<Node> lma = CreateObject<Node> ();
+  NodeContainer mags;
+  mags.Create (nMags);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (lma);
+  internet.Install (mags);
+
+  // The MAGs send router advertisements on packet sockets
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (mags);
+
+  // The lookahead of the multi-threaded simulator is the link delay
+  PointToPointHelper backbone;
+  backbone.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  backbone.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6StaticRoutingHelper routingHelper;
+  std::vector<uint32_t> accessIf;
+
+  for (uint32_t i = 0; i < nMags; i++)
+    {
+      Ptr<Node> mag = mags.Get (i);
+      NetDeviceContainer devices = backbone.Install (lma, mag);
+      uint32_t ifIndex = 0;
+
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          Ptr<Ipv6> ipv6 = devices.Get (j)->GetNode ()->GetObject<Ipv6> ();
+          ifIndex = ipv6->AddInterface (devices.Get (j));
+          ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (LinkAddress (i, j + 1), Ipv6Prefix (64)));
+          ipv6->SetForwarding (ifIndex, true);
+          ipv6->SetUp (ifIndex);
+        }
+
+      // The profiles name the LMA by its address on the first link
+      routingHelper.GetStaticRouting (mag->GetObject<Ipv6> ())->SetDefaultRoute (LinkAddress (i, 1), ifIndex);
+
+      // Access link, the MNs only exist in the MAG notifications
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (CreateObject<SimpleChannel> ());
+      mag->AddDevice (device);
+
+      Ptr<Ipv6> ipv6 = mag->GetObject<Ipv6> ();
+      ifIndex = ipv6->AddInterface (device);
+      ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (LinkAddress (0x100 + i, 1), Ipv6Prefix (64)));
+      ipv6->SetForwarding (ifIndex, true);
+      ipv6->SetUp (ifIndex);
+      accessIf.push_back (ifIndex);
+    }
+
+  // One profile per agent, the last one for the LMA: the agents run in
+  // different threads and must not share the entries of a profile
+  std::vector<Pmip6ProfileHelper *> profiles;
+  std::list<Ipv6Address> hnps;
+  std::vector<Mac48Address> mns;
+
+  for (uint32_t i = 0; i <= nMags; i++)
+    {
+      profiles.push_back (new Pmip6ProfileHelper ());
+    }
+
+  for (uint32_t n = 0; n < nMags * nMns; n++)
+    {
+      char nai[64];
+      Mac48Address mn = Mac48Address::Allocate ();
+
+      sprintf (nai, "mn%u@pmip6.example.org", n);
+      for (uint32_t i = 0; i <= nMags; i++)
+        {
+          profiles[i]->AddProfile (Identifier (nai), Identifier (mn), LinkAddress (0, 1), hnps);
+        }
+      mns.push_back (mn);
+    }
+
+  Pmip6LmaHelper lmaHelper;
+  lmaHelper.SetProfileHelper (profiles[nMags]);
+  lmaHelper.Install (lma);
+
+  Pmip6MagHelper magHelper;
+  for (uint32_t i = 0; i < nMags; i++)
+    {
+      magHelper.SetProfileHelper (profiles[i]);
+      magHelper.Install (mags.Get (i), LinkAddress (i, 2), NodeContainer ());
+    }
+
+  // The attachments run in the context of their MAG, hence in its thread
+  for (uint32_t n = 0; n < mns.size (); n++)
+    {
+      uint32_t from = n / nMns;
+      uint32_t to = (from + 1) % nMags;
+
+      Simulator::ScheduleWithContext (mags.Get (from)->GetId (), Seconds (1.0) + MicroSeconds (100 * n),
+                                      &Attach, mags.Get (from), accessIf[from], mns[n]);
+      Simulator::ScheduleWithContext (mags.Get (to)->GetId (), Seconds (3.0) + MicroSeconds (100 * n),
+                                      &Attach, mags.Get (to), accessIf[to], mns[n]);
+    }
+
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+
+  Ptr<Pmipv6Lma> agent = lma->GetObject<Pmipv6Lma> ();
+  std::cout << "LMA handled " << agent->GetRxMessages ()
+            << " PBUs, " << agent->GetNBindings () << " bindings" << std::endl;
+  for (uint32_t i = 0; i < nMags; i++)
+    {
+      std::cout << "MAG" << i << " received "
+                << mags.Get (i)->GetObject<Pmipv6Mag> ()->GetRxMessages () << " PBAs" << std::endl;
+    }
+
+  Simulator::Destroy ();
+
+  for (uint32_t i = 0; i <= nMags; i++)
+    {
+      delete profiles[i];
+    }
+  return 0;
+}
@@ -36,6 +36,9 @@
 #include "ns3/callback.h"
 #include "ns3/node.h"
 #include "ns3/core-config.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
 #include "ns3/arp-l3-protocol.h"
 #include "ns3/ipv6-mobility-l4-protocol.h"
 #include "ns3/ipv6-mobility-header.h"
@@ -49,6 +52,7 @@
 #include "ns3/identifier.h"
 #include "ns3/ipv6-tunnel-l4-protocol.h"
 #include "ns3/pmipv6-prefix-pool.h"
+#include "ns3/pmipv6-lma-cluster.h"
 
 #include "ns3/ipv6-list-routing.h"
 #include "ns3/ipv6-static-source-routing.h"
@@ -61,10 +65,23 @@ NS_LOG_COMPONENT_DEFINE ("Pmip6Helper");
 
 namespace ns3 {
 
+//under the distributed simulator, the agents of a node run on the rank owning it
+static bool
+IsLocalNode (Ptr<Node> node)
+{
+#ifdef NS3_MPI
+  return !MpiInterface::IsEnabled () || node->GetSystemId () == MpiInterface::GetSystemId ();
+#else
+  return true;
+#endif
+}
+
 Pmip6LmaHelper::Pmip6LmaHelper()
  : m_profile(0),
    m_prefixBegin("3ffe:1:4::"),
-   m_prefixBeginLen(48)
+   m_prefixBeginLen(48),
+   m_prefixFirst(1),
+   m_prefixCount(0)
 {
 }
 
@@ -75,6 +92,11 @@ Pmip6LmaHelper::~Pmip6LmaHelper()
 void
 Pmip6LmaHelper::Install (Ptr<Node> node) const
 {
+  if (!IsLocalNode (node))
+    {
+      return;
+    }
+
   Ptr<Ipv6MobilityL4Protocol> mipv6 = node->GetObject<Ipv6MobilityL4Protocol>();
 
   if(mipv6 == 0)
@@ -109,7 +131,14 @@ Pmip6LmaHelper::Install (Ptr<Node> node) const
 	  lma->SetProfile (CreateObject<Pmipv6Profile> ());
 	}  
 	
-  lma->SetPrefixPool (Create<Pmipv6PrefixPool> (m_prefixBegin, m_prefixBeginLen));
+  if (m_prefixCount > 0)
+    {
+      lma->SetPrefixPool (Create<Pmipv6PrefixPool> (m_prefixBegin, m_prefixBeginLen, m_prefixFirst, m_prefixCount));
+    }
+  else
+    {
+      lma->SetPrefixPool (Create<Pmipv6PrefixPool> (m_prefixBegin, m_prefixBeginLen));
+    }
   
   node->AggregateObject(lma);
 }
@@ -125,8 +154,15 @@ void Pmip6LmaHelper::SetPrefixPoolBase(Ipv6Address prefixBegin, uint8_t prefixLe
   m_prefixBeginLen = prefixLen;
 }
 
+void Pmip6LmaHelper::SetPrefixPoolRange(uint64_t first, uint64_t size)
+{
+  m_prefixFirst = first;
+  m_prefixCount = size;
+}
+
 Pmip6MagHelper::Pmip6MagHelper()
-: m_profile(0)
+: m_profile(0),
+  m_lmaCluster(0)
 {
 }
 
@@ -137,6 +173,11 @@ Pmip6MagHelper::~Pmip6MagHelper()
 void
 Pmip6MagHelper::Install (Ptr<Node> node) const
 {
+  if (!IsLocalNode (node))
+    {
+      return;
+    }
+
   Ptr<Ipv6MobilityL4Protocol> mipv6 = node->GetObject<Ipv6MobilityL4Protocol>();
 
   if(mipv6 == 0)
@@ -163,6 +204,7 @@ Pmip6MagHelper::Install (Ptr<Node> node) const
   Ptr<Pmipv6Mag> mag = CreateObject<Pmipv6Mag>();
   
   mag->UseRemoteAP(false);
+  mag->SetLmaCluster(m_lmaCluster);
 
   if(m_profile != 0)
     {
@@ -193,6 +235,28 @@ Pmip6MagHelper::Install (Ptr<Node> node) const
 void
 Pmip6MagHelper::Install (Ptr<Node> node, Ipv6Address target, NodeContainer aps) const
 {
+  Ptr<Pmipv6MagNotifier> noti;
+
+  //setup notifier sender
+  for (NodeContainer::Iterator i = aps.Begin (); i != aps.End (); ++i)
+    {
+      if (!IsLocalNode (*i))
+        {
+          continue;
+        }
+
+	  noti = CreateObject<Pmipv6MagNotifier>();
+	  
+	  noti->SetTargetAddress(target);
+	  
+	  (*i)->AggregateObject(noti);
+    }
+
+  if (!IsLocalNode (node))
+    {
+      return;
+    }
+
   Ptr<Ipv6MobilityL4Protocol> mipv6 = node->GetObject<Ipv6MobilityL4Protocol>();
 
   if(mipv6 == 0)
@@ -217,23 +281,14 @@ Pmip6MagHelper::Install (Ptr<Node> node, Ipv6Address target, NodeContainer aps)
 	}
 	
   //setup notifier receiver
-  Ptr<Pmipv6MagNotifier> noti = CreateObject<Pmipv6MagNotifier>();
+  noti = CreateObject<Pmipv6MagNotifier>();
   node->AggregateObject(noti);
-  
-  //setup notifier sender
-  for (NodeContainer::Iterator i = aps.Begin (); i != aps.End (); ++i)
-    {
-	  noti = CreateObject<Pmipv6MagNotifier>();
-	  
-	  noti->SetTargetAddress(target);
-	  
-	  (*i)->AggregateObject(noti);
-    }
 
   //----------------------
   Ptr<Pmipv6Mag> mag = CreateObject<Pmipv6Mag>();
   
   mag->UseRemoteAP(true);
+  mag->SetLmaCluster(m_lmaCluster);
   
   if(m_profile != 0)
     {
@@ -268,6 +323,12 @@ Pmip6MagHelper::SetProfileHelper(Pmip6ProfileHelper *pf)
   m_profile = pf;
 }
 
+void
+Pmip6MagHelper::SetLmaCluster(Ptr<Pmipv6LmaCluster> cluster)
+{
+  m_lmaCluster = cluster;
+}
+
 Pmip6ProfileHelper::Pmip6ProfileHelper()
 {
   m_profile = CreateObject<Pmipv6Profile>();
@@ -286,19 +347,15 @@ void Pmip6ProfileHelper::AddProfile(Identifier mnId, Identifier mnLinkId, Ipv6Ad
 {
   Pmipv6Profile::Entry *entry;
   
-  entry = m_profile->Add(mnId);
+  entry = m_profile->Add(mnId, mnLinkId);
   
-  entry->SetMnIdentifier(mnId);
-  entry->SetMnLinkIdentifier(mnLinkId);
-  entry->SetLmaAddress(lmaa);
-  entry->SetHomeNetworkPrefixes(hnps);
-  
-  entry = m_profile->Add(mnLinkId);
-  
-  entry->SetMnIdentifier(mnId);
-  entry->SetMnLinkIdentifier(mnLinkId);
   entry->SetLmaAddress(lmaa);
   entry->SetHomeNetworkPrefixes(hnps);
 }
 
+bool Pmip6ProfileHelper::LoadProfiles(std::string filename)
+{
+  return m_profile->Load(filename);
+}
+
 } // namespace ns3
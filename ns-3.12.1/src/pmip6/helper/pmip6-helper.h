@@ -41,6 +41,7 @@ namespace ns3 {
 class Node;
 class Pmip6ProfileHelper;
 class Pmipv6Profile;
+class Pmipv6LmaCluster;
 
 class Pmip6LmaHelper {
 public:
@@ -49,12 +50,24 @@ public:
   /**
    * 
    * \param node The node on which to install the stack.
+   *
+   * Under the distributed simulator, a node owned by another rank is left
+   * alone, the rank owning it installs the LMA.
    */
   void Install (Ptr<Node> node) const;
   
   void SetProfileHelper(Pmip6ProfileHelper *pf);
   
   void SetPrefixPoolBase(Ipv6Address prefixBegin, uint8_t prefixLen);
+  
+  /**
+   * \brief Restrict the pools of the LMAs installed from now on to a range of prefixes.
+   * \param first number of the first prefix after the pool base
+   * \param size number of prefixes, 0 for all the prefixes of the base
+   *
+   * LMAs given disjoint ranges of the same base never assign the same prefix.
+   */
+  void SetPrefixPoolRange(uint64_t first, uint64_t size);
 
 protected:
 
@@ -63,6 +76,9 @@ private:
   
   Ipv6Address m_prefixBegin;
   uint8_t m_prefixBeginLen;
+  
+  uint64_t m_prefixFirst;
+  uint64_t m_prefixCount;
 };
 
 class Pmip6MagHelper {
@@ -73,16 +89,28 @@ public:
   /**
    * 
    * \param node The node on which to install the stack.
+   *
+   * Under the distributed simulator, only the nodes of this rank get the
+   * stack. The APs reporting to a MAG of another rank still get their
+   * notifiers, the notifications cross the ranks as packets.
    */
   void Install (Ptr<Node> node) const;
   void Install (Ptr<Node> node, Ipv6Address target, NodeContainer aps) const;
   
   void SetProfileHelper(Pmip6ProfileHelper *pf);
   
+  /**
+   * \brief Have the MAGs installed from now on select the LMA of the MNs from a cluster.
+   * \param cluster the LMA cluster, shared by the MAGs
+   */
+  void SetLmaCluster(Ptr<Pmipv6LmaCluster> cluster);
+  
 protected:
 
 private:
   Pmip6ProfileHelper *m_profile;
+  
+  Ptr<Pmipv6LmaCluster> m_lmaCluster;
 };
 
 class Pmip6ProfileHelper {
@@ -93,6 +121,19 @@ public:
   Ptr<Pmipv6Profile> GetProfile();
   
   void AddProfile(Identifier mnId, Identifier mnLinkId, Ipv6Address lmaa, std::list<Ipv6Address> hnps);
+  
+  /**
+   * \brief Add the subscribers of a binary profile file, see Pmipv6Profile.
+   * \param filename name of the file
+   * \return false if the file cannot be loaded
+   *
+   * All the agents installed with this helper share the loaded subscribers.
+   * Under the distributed simulator, every rank loads its own replica of
+   * the file. The LMA keeps the prefixes it assigns in the replica of its
+   * rank only, a MAG of another rank then registers the MN with an
+   * all-zero prefix and the LMA finds the binding by MN link identifier.
+   */
+  bool LoadProfiles(std::string filename);
 protected:
 
 private:
@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/mac48-address.h"
+#include "ns3/pmipv6-mag.h"
+#include "ns3/unicast-radvd.h"
+#include "ns3/ipv6-mobility-header.h"
+
+#include "pmip6-latency-helper.h"
+
+NS_LOG_COMPONENT_DEFINE ("Pmip6LatencyHelper");
+
+namespace ns3 {
+
+Pmip6LatencyHelper::Histogram::Histogram ()
+  : m_binWidth (MilliSeconds (1).GetTimeStep ()),
+    m_count (0),
+    m_sum (0),
+    m_max (0)
+{
+}
+
+Pmip6LatencyHelper::Histogram::Histogram (Time binWidth)
+  : m_binWidth (binWidth.GetTimeStep ()),
+    m_count (0),
+    m_sum (0),
+    m_max (0)
+{
+  NS_ASSERT (m_binWidth > 0);
+}
+
+void Pmip6LatencyHelper::Histogram::AddValue (Time value)
+{
+  int64_t v = value.GetTimeStep ();
+  
+  NS_ASSERT (v >= 0);
+  
+  uint32_t index = v / m_binWidth;
+  
+  if (index >= m_bins.size ())
+    {
+      m_bins.resize (index + 1, 0);
+    }
+  
+  m_bins[index]++;
+  m_count++;
+  m_sum += v;
+  
+  if (v > m_max)
+    {
+      m_max = v;
+    }
+}
+
+uint32_t Pmip6LatencyHelper::Histogram::GetNBins () const
+{
+  return m_bins.size ();
+}
+
+Time Pmip6LatencyHelper::Histogram::GetBinWidth () const
+{
+  return TimeStep (m_binWidth);
+}
+
+Time Pmip6LatencyHelper::Histogram::GetBinStart (uint32_t index) const
+{
+  return TimeStep (m_binWidth * index);
+}
+
+uint32_t Pmip6LatencyHelper::Histogram::GetBinCount (uint32_t index) const
+{
+  NS_ASSERT (index < m_bins.size ());
+  
+  return m_bins[index];
+}
+
+uint32_t Pmip6LatencyHelper::Histogram::GetCount () const
+{
+  return m_count;
+}
+
+Time Pmip6LatencyHelper::Histogram::GetMax () const
+{
+  return TimeStep (m_max);
+}
+
+Time Pmip6LatencyHelper::Histogram::GetMean () const
+{
+  return TimeStep (m_count == 0 ? 0 : m_sum / m_count);
+}
+
+void Pmip6LatencyHelper::Histogram::Print (std::ostream &os) const
+{
+  os << "count=" << m_count
+     << " mean=" << GetMean ().GetSeconds ()
+     << " max=" << GetMax ().GetSeconds () << std::endl;
+  
+  for (uint32_t i = 0; i < m_bins.size (); i++)
+    {
+      if (m_bins[i] != 0)
+        {
+          os << "  [" << GetBinStart (i).GetSeconds () << ", "
+             << GetBinStart (i + 1).GetSeconds () << ") " << m_bins[i] << std::endl;
+        }
+    }
+}
+
+Pmip6LatencyHelper::Pmip6LatencyHelper ()
+  : m_binWidth (MilliSeconds (1)),
+    m_pbaLatency (m_binWidth),
+    m_raLatency (m_binWidth)
+{
+}
+
+Pmip6LatencyHelper::~Pmip6LatencyHelper ()
+{
+}
+
+void Pmip6LatencyHelper::SetBinWidth (Time binWidth)
+{
+  NS_ASSERT_MSG (m_pbaLatency.GetCount () == 0 && m_raLatency.GetCount () == 0,
+                 "The bin width can only be changed before collecting values");
+  
+  m_binWidth = binWidth;
+  m_pbaLatency = Histogram (binWidth);
+  m_raLatency = Histogram (binWidth);
+}
+
+void Pmip6LatencyHelper::Install (Ptr<Node> node)
+{
+  Ptr<Pmipv6Mag> mag = node->GetObject<Pmipv6Mag> ();
+  
+  NS_ASSERT_MSG (mag != 0, "No MAG installed on node " << node->GetId ());
+  
+  mag->TraceConnectWithoutContext ("Attach", MakeCallback (&Pmip6LatencyHelper::Attach, this));
+  mag->TraceConnectWithoutContext ("RxPba", MakeCallback (&Pmip6LatencyHelper::RxPba, this));
+  
+  for (uint32_t i = 0; i < node->GetNApplications (); i++)
+    {
+      Ptr<UnicastRadvd> radvd = DynamicCast<UnicastRadvd> (node->GetApplication (i));
+      
+      if (radvd != 0)
+        {
+          radvd->TraceConnectWithoutContext ("Tx", MakeCallback (&Pmip6LatencyHelper::TxRa, this));
+        }
+    }
+}
+
+void Pmip6LatencyHelper::Install (NodeContainer c)
+{
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Install (*i);
+    }
+}
+
+const Pmip6LatencyHelper::Histogram &Pmip6LatencyHelper::GetPbaLatency () const
+{
+  return m_pbaLatency;
+}
+
+const Pmip6LatencyHelper::Histogram &Pmip6LatencyHelper::GetRaLatency () const
+{
+  return m_raLatency;
+}
+
+Pmip6LatencyHelper::Histogram Pmip6LatencyHelper::GetPbaLatency (const Identifier &mnId) const
+{
+  MnLatencyMap::const_iterator it = m_mnLatency.find (mnId);
+  
+  return it == m_mnLatency.end () ? Histogram (m_binWidth) : it->second.m_pba;
+}
+
+Pmip6LatencyHelper::Histogram Pmip6LatencyHelper::GetRaLatency (const Identifier &mnId) const
+{
+  MnLatencyMap::const_iterator it = m_mnLatency.find (mnId);
+  
+  return it == m_mnLatency.end () ? Histogram (m_binWidth) : it->second.m_ra;
+}
+
+void Pmip6LatencyHelper::Print (std::ostream &os) const
+{
+  os << "attach-to-pba ";
+  m_pbaLatency.Print (os);
+  os << "attach-to-ra ";
+  m_raLatency.Print (os);
+}
+
+void Pmip6LatencyHelper::Attach (const Identifier &mnId, const Identifier &mnLinkId)
+{
+  NS_LOG_FUNCTION (this << mnId << mnLinkId);
+  
+  //a new attach restarts the measurement, the former one never completed
+  Pending &pending = m_pending[mnId];
+  
+  pending.m_attachTime = Simulator::Now ();
+  pending.m_waitPba = true;
+  pending.m_waitRa = true;
+  
+  m_links[mnLinkId] = mnId;
+}
+
+void Pmip6LatencyHelper::RxPba (const Identifier &mnId, uint8_t status, uint16_t lifetime)
+{
+  NS_LOG_FUNCTION (this << mnId << (uint32_t)status << lifetime);
+  
+  //error codes start at 128, and a zero lifetime acknowledges a deregistration
+  if (status >= Ipv6MobilityHeader::BA_STATUS_REASON_UNSPECIFIED || lifetime == 0)
+    {
+      return;
+    }
+  
+  PendingMap::iterator it = m_pending.find (mnId);
+  
+  if (it == m_pending.end () || !it->second.m_waitPba)
+    {
+      return;
+    }
+  
+  Time delay = Simulator::Now () - it->second.m_attachTime;
+  
+  m_pbaLatency.AddValue (delay);
+  GetMnLatency (mnId).m_pba.AddValue (delay);
+  
+  it->second.m_waitPba = false;
+  Complete (it);
+}
+
+void Pmip6LatencyHelper::TxRa (Ptr<const Packet> p, Address to)
+{
+  NS_LOG_FUNCTION (this << p << to);
+  
+  if (!Mac48Address::IsMatchingType (to))
+    {
+      return;
+    }
+  
+  LinkMap::iterator l = m_links.find (Identifier (Mac48Address::ConvertFrom (to)));
+  
+  if (l == m_links.end ())
+    {
+      return;
+    }
+  
+  PendingMap::iterator it = m_pending.find (l->second);
+  
+  if (it == m_pending.end () || !it->second.m_waitRa)
+    {
+      return;
+    }
+  
+  Time delay = Simulator::Now () - it->second.m_attachTime;
+  
+  m_raLatency.AddValue (delay);
+  GetMnLatency (l->second).m_ra.AddValue (delay);
+  
+  it->second.m_waitRa = false;
+  Complete (it);
+}
+
+Pmip6LatencyHelper::MnLatency &Pmip6LatencyHelper::GetMnLatency (const Identifier &mnId)
+{
+  MnLatencyMap::iterator it = m_mnLatency.find (mnId);
+  
+  if (it == m_mnLatency.end ())
+    {
+      MnLatency latency;
+      
+      latency.m_pba = Histogram (m_binWidth);
+      latency.m_ra = Histogram (m_binWidth);
+      
+      it = m_mnLatency.insert (std::make_pair (mnId, latency)).first;
+    }
+  
+  return it->second;
+}
+
+void Pmip6LatencyHelper::Complete (PendingMap::iterator it)
+{
+  if (!it->second.m_waitPba && !it->second.m_waitRa)
+    {
+      m_pending.erase (it);
+    }
+}
+
+} // namespace ns3
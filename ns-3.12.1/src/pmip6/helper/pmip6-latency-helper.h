@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PMIP6_LATENCY_HELPER_H
+#define PMIP6_LATENCY_HELPER_H
+
+#include <stdint.h>
+
+#include <ostream>
+#include <vector>
+
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/address.h"
+#include "ns3/packet.h"
+#include "ns3/node-container.h"
+#include "ns3/sgi-hashmap.h"
+#include "ns3/identifier.h"
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * \brief Collect the handover latencies of the MNs attaching to a set of MAGs.
+ *
+ * Two delays are measured from the moment a MAG sees an MN with a profile
+ * attach (the "Attach" trace of Pmipv6Mag):
+ *  - to the accepted PBA completing the registration ("RxPba"),
+ *  - to the first router advertisement unicast to the MN ("Tx" of the
+ *    UnicastRadvd of the MAG).
+ *
+ * Samples are kept both for the whole domain and per MN identifier. Only
+ * the MAGs passed to Install are instrumented, the agents of the others
+ * keep empty trace sources and pay nothing. The helper must outlive the
+ * simulation since the traces call back into it.
+ */
+class Pmip6LatencyHelper {
+public:
+  /**
+   * \brief Fixed bin width histogram of delays.
+   */
+  class Histogram
+  {
+  public:
+    Histogram ();
+    Histogram (Time binWidth);
+    
+    void AddValue (Time value);
+    
+    /**
+     * \return the number of bins, up to the one of the largest value
+     */
+    uint32_t GetNBins () const;
+    
+    Time GetBinWidth () const;
+    
+    Time GetBinStart (uint32_t index) const;
+    
+    uint32_t GetBinCount (uint32_t index) const;
+    
+    /**
+     * \return the number of values added
+     */
+    uint32_t GetCount () const;
+    
+    /**
+     * \return the largest value added, zero if none
+     */
+    Time GetMax () const;
+    
+    /**
+     * \return the mean of the values added, zero if none
+     */
+    Time GetMean () const;
+    
+    void Print (std::ostream &os) const;
+    
+  private:
+    std::vector<uint32_t> m_bins;
+    int64_t m_binWidth;
+    uint32_t m_count;
+    int64_t m_sum;
+    int64_t m_max;
+  };
+  
+  Pmip6LatencyHelper ();
+  ~Pmip6LatencyHelper ();
+  
+  /**
+   * \brief Set the bin width of the histograms, 1ms by default.
+   *
+   * Must be called before any value is collected.
+   */
+  void SetBinWidth (Time binWidth);
+  
+  /**
+   * \param node a node on which a MAG is installed
+   */
+  void Install (Ptr<Node> node);
+  
+  void Install (NodeContainer c);
+  
+  /**
+   * \return the attach to PBA delays of all the MNs
+   */
+  const Histogram &GetPbaLatency () const;
+  
+  /**
+   * \return the attach to first RA delays of all the MNs
+   */
+  const Histogram &GetRaLatency () const;
+  
+  /**
+   * \return the attach to PBA delays of one MN, empty if it never registered
+   */
+  Histogram GetPbaLatency (const Identifier &mnId) const;
+  
+  /**
+   * \return the attach to first RA delays of one MN, empty if it never got an RA
+   */
+  Histogram GetRaLatency (const Identifier &mnId) const;
+  
+  /**
+   * \brief Print the domain-wide histograms.
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  struct Pending
+  {
+    Time m_attachTime;
+    bool m_waitPba;
+    bool m_waitRa;
+  };
+  
+  struct MnLatency
+  {
+    Histogram m_pba;
+    Histogram m_ra;
+  };
+  
+  typedef sgi::hash_map<Identifier, Pending, IdentifierHash> PendingMap;
+  typedef sgi::hash_map<Identifier, Identifier, IdentifierHash> LinkMap;
+  typedef sgi::hash_map<Identifier, MnLatency, IdentifierHash> MnLatencyMap;
+  
+  void Attach (const Identifier &mnId, const Identifier &mnLinkId);
+  void RxPba (const Identifier &mnId, uint8_t status, uint16_t lifetime);
+  void TxRa (Ptr<const Packet> p, Address to);
+  
+  MnLatency &GetMnLatency (const Identifier &mnId);
+  void Complete (PendingMap::iterator it);
+  
+  Time m_binWidth;
+  
+  PendingMap m_pending;
+  LinkMap m_links;
+  
+  Histogram m_pbaLatency;
+  Histogram m_raLatency;
+  MnLatencyMap m_mnLatency;
+};
+
+} // namespace ns3
+
+#endif /* PMIP6_LATENCY_HELPER_H */
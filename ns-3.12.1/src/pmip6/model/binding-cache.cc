@@ -26,6 +26,8 @@
 #include "ns3/uinteger.h"
 #include "ns3/node.h"
 
+#include "entry-pool.h"
+
 #include "ipv6-mobility-header.h"
 #include "ipv6-mobility.h"
 
@@ -52,6 +54,7 @@ TypeId BindingCache::GetTypeId ()
 } 
 
 BindingCache::BindingCache ()
+  : m_nEntries (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -66,6 +69,7 @@ void BindingCache::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   Flush ();
+  m_timerWheel = 0;
   Object::DoDispose ();
 }
 
@@ -73,45 +77,50 @@ BindingCache::Entry *BindingCache::Lookup(Identifier mnId, std::list<Ipv6Address
 {
   NS_LOG_FUNCTION (this << mnId);
   
-  if ( m_bCache.find (mnId) != m_bCache.end ())
+  BindingCache::Entry* partial = 0;
+  bool matchtemp;
+  
+  //only the entries owning one of the requested prefixes can match
+  for (std::list<Ipv6Address>::const_iterator i = hnpList.begin (); i != hnpList.end (); i++)
     {
-      BindingCache::Entry* entry = m_bCache[mnId];
-	  
-	  BindingCache::Entry* partial = 0;
-	  bool matchtemp;
-	  
-	  while ( entry )
-	    {
-		  matchtemp = false;
-		  if( entry->Match(mnId, hnpList, matchtemp) )
-		    {
-			  if ( matchtemp )
-			    {
-				  allMatched = true;
-				  return entry;
-				}
-			  
-			  if(partial == 0)
-			    {
-			      partial = entry;
-				}
-			}
-		  entry = entry->GetNext();
-		}
-		
-	  allMatched = false;
-	  return partial;
+      AddressIndexI it = m_hnpIndex.find (*i);
+      
+      if (it == m_hnpIndex.end () || it->second->GetMnIdentifier () != mnId)
+        {
+          continue;
+        }
+      
+      BindingCache::Entry* entry = it->second;
+      
+      matchtemp = false;
+      if (entry->Match (mnId, hnpList, matchtemp))
+        {
+          if (matchtemp)
+            {
+              allMatched = true;
+              return entry;
+            }
+          
+          if (partial == 0)
+            {
+              partial = entry;
+            }
+        }
     }
-  return 0;
+  
+  allMatched = false;
+  return partial;
 }
 
 BindingCache::Entry *BindingCache::Lookup(Identifier mnId, uint8_t att, Identifier mnLinkId)
 {
   NS_LOG_FUNCTION (this << mnId << mnLinkId);
   
-  if ( m_bCache.find (mnId) != m_bCache.end ())
+  BCacheI it = m_bCache.find (mnId);
+  
+  if (it != m_bCache.end ())
     {
-      BindingCache::Entry* entry = m_bCache[mnId];
+      BindingCache::Entry* entry = it->second;
 	  
 	  while ( entry )
 	    {
@@ -129,48 +138,119 @@ BindingCache::Entry *BindingCache::Lookup(Identifier mnId)
 {
   NS_LOG_FUNCTION (this << mnId );
   
-  if ( m_bCache.find (mnId) != m_bCache.end ())
+  BCacheI it = m_bCache.find (mnId);
+  
+  if (it != m_bCache.end ())
     {
-      BindingCache::Entry* entry = m_bCache[mnId];
-	  
-	  return entry;
+      return it->second;
+    }
+  return 0;
+}
+
+BindingCache::Entry *BindingCache::LookupByHomeNetworkPrefix(Ipv6Address hnp)
+{
+  NS_LOG_FUNCTION (this << hnp);
+  
+  AddressIndexI it = m_hnpIndex.find (hnp);
+  
+  if (it != m_hnpIndex.end ())
+    {
+      return it->second;
     }
   return 0;
 }
 
+std::list<BindingCache::Entry *> BindingCache::LookupByProxyCoa(Ipv6Address pcoa)
+{
+  NS_LOG_FUNCTION (this << pcoa);
+  
+  std::list<BindingCache::Entry *> entries;
+  AddressIndexI it = m_pcoaIndex.find (pcoa);
+  
+  if (it != m_pcoaIndex.end ())
+    {
+      for (BindingCache::Entry *entry = it->second; entry != 0; entry = entry->m_pcoaNext)
+        {
+          entries.push_back (entry);
+        }
+    }
+  return entries;
+}
+
 BindingCache::Entry* BindingCache::Add (Identifier mnId)
 {
   NS_LOG_FUNCTION (this << mnId );
   
-  BindingCache::Entry* entry = new BindingCache::Entry (this);
+  BindingCache::Entry* entry = NewEntry ();
   
   entry->SetMnIdentifier(mnId);
   
-  if( m_bCache.find (mnId) != m_bCache.end ())
+  BCacheI it = m_bCache.find (mnId);
+  
+  if (it != m_bCache.end ())
     {
-	  BindingCache::Entry* entry2 = m_bCache[mnId];
+	  BindingCache::Entry* entry2 = it->second;
 	  
 	  entry->SetNext(entry2);
+	  entry2->SetPrev(entry);
+	  
+	  it->second = entry;
 	}
-
-  m_bCache[mnId] = entry;
+  else
+    {
+      m_bCache[mnId] = entry;
+    }
+  
+  entry->m_indexed = true;
+  m_nEntries++;
+  
+  //a fresh entry has no prefix yet, but is indexed by its (unspecified) Proxy-CoA
+  //until the first SetProxyCoa moves it
+  IndexProxyCoa (entry);
   
   return entry;
 }
 
 void BindingCache::Remove (BindingCache::Entry* entry)
 {
-  NS_LOG_FUNCTION_NOARGS ();
+  NS_LOG_FUNCTION (this << entry);
+  NS_ASSERT (entry->m_indexed);
 
-  for (BCacheI i = m_bCache.begin () ; i != m_bCache.end () ; i++)
+  UnindexHomeNetworkPrefixes (entry);
+  UnindexProxyCoa (entry);
+  
+  BindingCache::Entry *prev = entry->GetPrev ();
+  BindingCache::Entry *next = entry->GetNext ();
+  
+  if (next)
+    {
+      next->SetPrev (prev);
+    }
+  
+  if (prev)
     {
-      if ((*i).second == entry)
+      prev->SetNext (next);
+    }
+  else
+    {
+      //head of the per-MN chain
+      BCacheI it = m_bCache.find (entry->GetMnIdentifier ());
+      NS_ASSERT (it != m_bCache.end () && it->second == entry);
+      
+      if (next)
+        {
+          it->second = next;
+        }
+      else
         {
-          m_bCache.erase (i);
-          delete entry;
-          return;
+          m_bCache.erase (it);
         }
     }
+  
+  entry->m_indexed = false;
+  m_nEntries--;
+  
+  DeleteEntry (entry);
 }
 
 void BindingCache::Flush ()
@@ -179,10 +259,130 @@ void BindingCache::Flush ()
 
   for (BCacheI i = m_bCache.begin () ; i != m_bCache.end () ; i++)
     {
-      delete (*i).second; /* delete the pointer BindingCache::Entry */
+      BindingCache::Entry *entry = (*i).second;
+      
+      while (entry)
+        {
+          BindingCache::Entry *next = entry->GetNext ();
+          
+          entry->m_indexed = false;
+          DeleteEntry (entry); /* delete the pointer BindingCache::Entry */
+          
+          entry = next;
+        }
     }
 
   m_bCache.erase (m_bCache.begin (), m_bCache.end ());
+  m_hnpIndex.erase (m_hnpIndex.begin (), m_hnpIndex.end ());
+  m_pcoaIndex.erase (m_pcoaIndex.begin (), m_pcoaIndex.end ());
+  
+  m_nEntries = 0;
+}
+
+uint32_t BindingCache::GetNEntries () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  return m_nEntries;
+}
+
+void BindingCache::IndexHomeNetworkPrefixes (BindingCache::Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  
+  for (std::list<Ipv6Address>::const_iterator i = entry->m_homeNetworkPrefixes.begin (); i != entry->m_homeNetworkPrefixes.end (); i++)
+    {
+      m_hnpIndex[(*i)] = entry;
+    }
+}
+
+void BindingCache::UnindexHomeNetworkPrefixes (BindingCache::Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  
+  for (std::list<Ipv6Address>::const_iterator i = entry->m_homeNetworkPrefixes.begin (); i != entry->m_homeNetworkPrefixes.end (); i++)
+    {
+      AddressIndexI it = m_hnpIndex.find (*i);
+      
+      //the prefix may have been taken over by another entry
+      if (it != m_hnpIndex.end () && it->second == entry)
+        {
+          m_hnpIndex.erase (it);
+        }
+    }
+}
+
+void BindingCache::IndexProxyCoa (BindingCache::Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  
+  AddressIndexI it = m_pcoaIndex.find (entry->m_proxyCoa);
+  
+  entry->m_pcoaPrev = 0;
+  
+  if (it != m_pcoaIndex.end ())
+    {
+      entry->m_pcoaNext = it->second;
+      it->second->m_pcoaPrev = entry;
+      it->second = entry;
+    }
+  else
+    {
+      entry->m_pcoaNext = 0;
+      m_pcoaIndex[entry->m_proxyCoa] = entry;
+    }
+}
+
+void BindingCache::UnindexProxyCoa (BindingCache::Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  
+  if (entry->m_pcoaNext)
+    {
+      entry->m_pcoaNext->m_pcoaPrev = entry->m_pcoaPrev;
+    }
+  
+  if (entry->m_pcoaPrev)
+    {
+      entry->m_pcoaPrev->m_pcoaNext = entry->m_pcoaNext;
+    }
+  else
+    {
+      AddressIndexI it = m_pcoaIndex.find (entry->m_proxyCoa);
+      NS_ASSERT (it != m_pcoaIndex.end () && it->second == entry);
+      
+      if (entry->m_pcoaNext)
+        {
+          it->second = entry->m_pcoaNext;
+        }
+      else
+        {
+          m_pcoaIndex.erase (it);
+        }
+    }
+  
+  entry->m_pcoaNext = 0;
+  entry->m_pcoaPrev = 0;
+}
+
+void BindingCache::DeleteEntry (BindingCache::Entry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  
+  //tentative entries are never linked in the cache
+  if (entry->GetTentativeEntry ())
+    {
+      m_entryPool.Delete (entry->GetTentativeEntry ());
+    }
+  
+  m_entryPool.Delete (entry);
+}
+
+BindingCache::Entry *BindingCache::NewEntry ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  return new (m_entryPool.Allocate ()) BindingCache::Entry (this);
 }
 
 Ptr<Node> BindingCache::GetNode() const
@@ -199,24 +399,43 @@ void BindingCache::SetNode(Ptr<Node> node)
   m_node = node;
 }
 
+void BindingCache::SetTimerWheel(Ptr<BindingTimerWheel> wheel)
+{
+  NS_LOG_FUNCTION ( this << wheel );
+  
+  m_timerWheel = wheel;
+}
+
+Ptr<BindingTimerWheel> BindingCache::GetTimerWheel() const
+{
+  NS_LOG_FUNCTION_NOARGS();
+  
+  return m_timerWheel;
+}
+
 BindingCache::Entry::Entry (Ptr<BindingCache> bcache)
   : m_bCache (bcache),
     m_state (UNREACHABLE),
     m_tunnelIfIndex (-1),
-    m_reachableTimer(Timer::CANCEL_ON_DESTROY),
-	m_deregisterTimer(Timer::CANCEL_ON_DESTROY),
-	m_registerTimer(Timer::CANCEL_ON_DESTROY),
     m_next (0),
+    m_prev (0),
+    m_pcoaNext (0),
+    m_pcoaPrev (0),
+    m_indexed (false),
 	m_tentativeEntry (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  
+  m_reachableTimer.SetWheel (bcache->GetTimerWheel ());
+  m_deregisterTimer.SetWheel (bcache->GetTimerWheel ());
+  m_registerTimer.SetWheel (bcache->GetTimerWheel ());
 }
 
 BindingCache::Entry *BindingCache::Entry::Copy()
 {
   NS_LOG_FUNCTION_NOARGS ();
   
-  Entry *bce = new Entry(this->m_bCache);
+  Entry *bce = m_bCache->NewEntry ();
 
   bce->SetMnIdentifier(this->GetMnIdentifier());
   bce->SetMnLinkIdentifier(this->GetMnLinkIdentifier());
@@ -230,7 +449,6 @@ BindingCache::Entry *BindingCache::Entry::Copy()
   bce->SetReachableTime(this->GetReachableTime());
   bce->SetLastBindingUpdateSequence(this->GetLastBindingUpdateSequence());
   
-  bce->SetNext(0);
   bce->SetTentativeEntry(0);
 
   return bce;
@@ -295,15 +513,21 @@ void BindingCache::Entry::MarkReachable()
 void BindingCache::Entry::FunctionReachableTimeout()
 {
   NS_LOG_FUNCTION_NOARGS();
-//  Ptr<Pmipv6Lma> lma = m_bCache->GetNode()->GetObject<Pmipv6Lma>();
+  Ptr<Pmipv6Lma> lma = m_bCache->GetNode()->GetObject<Pmipv6Lma>();
 
+  NS_LOG_LOGIC ("Binding lifetime expired");
+  
+  lma->RemoveBinding(this);
 }
 
 void BindingCache::Entry::FunctionDeregisterTimeout()
 {
   NS_LOG_FUNCTION_NOARGS();
-//  Ptr<Pmipv6Lma> lma = m_bCache->GetNode()->GetObject<Pmipv6Lma>();
+  Ptr<Pmipv6Lma> lma = m_bCache->GetNode()->GetObject<Pmipv6Lma>();
 
+  NS_LOG_LOGIC ("MinDelayBeforeBCEDelete elapsed after de-registration");
+  
+  lma->RemoveBinding(this);
 }
 
 void BindingCache::Entry::FunctionRegisterTimeout()
@@ -457,6 +681,15 @@ void BindingCache::Entry::SetHomeNetworkPrefixes(std::list<Ipv6Address> hnpList)
 {
   NS_LOG_FUNCTION_NOARGS ();
   
+  if (m_indexed)
+    {
+      m_bCache->UnindexHomeNetworkPrefixes (this);
+      m_homeNetworkPrefixes = hnpList;
+      m_bCache->IndexHomeNetworkPrefixes (this);
+      
+      return;
+    }
+  
   m_homeNetworkPrefixes = hnpList;
 }
 
@@ -485,6 +718,16 @@ void BindingCache::Entry::SetProxyCoa(Ipv6Address pcoa)
 {
   NS_LOG_FUNCTION ( this << pcoa );
 
+  if (m_indexed && m_proxyCoa != pcoa)
+    {
+      m_bCache->UnindexProxyCoa (this);
+      m_oldProxyCoa = m_proxyCoa;
+      m_proxyCoa = pcoa;
+      m_bCache->IndexProxyCoa (this);
+      
+      return;
+    }
+
   m_oldProxyCoa = m_proxyCoa;
   m_proxyCoa = pcoa;
 }
@@ -587,6 +830,20 @@ void BindingCache::Entry::SetNext(BindingCache::Entry *entry)
   m_next = entry;
 }
 	
+BindingCache::Entry *BindingCache::Entry::GetPrev() const
+{
+  NS_LOG_FUNCTION_NOARGS();
+  
+  return m_prev;
+}
+
+void BindingCache::Entry::SetPrev(BindingCache::Entry *entry)
+{
+  NS_LOG_FUNCTION ( this << entry );
+  
+  m_prev = entry;
+}
+	
 BindingCache::Entry *BindingCache::Entry::GetTentativeEntry() const
 {
   NS_LOG_FUNCTION_NOARGS();
@@ -34,10 +34,12 @@
 #include "ns3/net-device.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ptr.h"
-#include "ns3/timer.h"
 #include "ns3/sgi-hashmap.h"
 #include "ns3/identifier.h"
 
+#include "binding-timer-wheel.h"
+#include "entry-pool.h"
+
 namespace ns3
 {
 
@@ -56,15 +58,43 @@ public:
   BindingCache::Entry *Lookup(Identifier mnId, uint8_t att, Identifier mnLinkId);
   BindingCache::Entry *Lookup(Identifier mnId);
   
+  /**
+   * \brief Lookup the entry owning a home network prefix.
+   * \param hnp the home network prefix
+   * \return the entry, or 0 if the prefix is not bound
+   */
+  BindingCache::Entry *LookupByHomeNetworkPrefix(Ipv6Address hnp);
+  
+  /**
+   * \brief Lookup all the entries registered by a MAG.
+   * \param pcoa the Proxy-CoA of the MAG
+   * \return the entries bound to this Proxy-CoA
+   */
+  std::list<BindingCache::Entry *> LookupByProxyCoa(Ipv6Address pcoa);
+  
   BindingCache::Entry *Add(Identifier mnId);
   
   void Remove(BindingCache::Entry *entry);
   
+  /**
+   * \brief Delete an entry which is not linked in the cache, e.g. a tentative entry.
+   */
+  void DeleteEntry(BindingCache::Entry *entry);
+  
   void Flush();
   
+  uint32_t GetNEntries() const;
+  
   Ptr<Node> GetNode() const;
   void SetNode(Ptr<Node> node);
   
+  /**
+   * \brief Drive the timers of the entries created from now on by a shared wheel.
+   * \param wheel the wheel, or 0 for one simulator event per timer
+   */
+  void SetTimerWheel(Ptr<BindingTimerWheel> wheel);
+  Ptr<BindingTimerWheel> GetTimerWheel() const;
+  
   class Entry
   {
   public:
@@ -134,12 +164,17 @@ public:
     Entry *GetNext() const;
     void SetNext(Entry *entry);
     
+    Entry *GetPrev() const;
+    void SetPrev(Entry *entry);
+    
     Entry *GetTentativeEntry() const;
     void SetTentativeEntry(Entry *entry);
     
     Ipv6Address GetOldProxyCoa() const;
     
   private:
+    friend class BindingCache;
+    
     Ptr<BindingCache> m_bCache;
     
     enum BindingCacheState_e {
@@ -171,11 +206,19 @@ public:
     uint16_t m_lastBindingUpdateSequence;
     
     Time m_reachableTime;
-    Timer m_reachableTimer;
-    Timer m_deregisterTimer;
-    Timer m_registerTimer;
+    BindingTimer m_reachableTimer;
+    BindingTimer m_deregisterTimer;
+    BindingTimer m_registerTimer;
     
     Entry *m_next;
+    Entry *m_prev;
+    
+    //Proxy-CoA index chain
+    Entry *m_pcoaNext;
+    Entry *m_pcoaPrev;
+    
+    //true while the entry is linked in the cache and its indexes
+    bool m_indexed;
     
     //internal
     
@@ -189,12 +232,44 @@ protected:
 private:
   typedef sgi::hash_map<Identifier, BindingCache::Entry *, IdentifierHash> BCache;
   typedef sgi::hash_map<Identifier, BindingCache::Entry *, IdentifierHash>::iterator BCacheI;
+  typedef sgi::hash_map<Ipv6Address, BindingCache::Entry *, Ipv6AddressHash> AddressIndex;
+  typedef sgi::hash_map<Ipv6Address, BindingCache::Entry *, Ipv6AddressHash>::iterator AddressIndexI;
   
   void DoDispose();
   
+  void IndexHomeNetworkPrefixes(BindingCache::Entry *entry);
+  void UnindexHomeNetworkPrefixes(BindingCache::Entry *entry);
+  
+  void IndexProxyCoa(BindingCache::Entry *entry);
+  void UnindexProxyCoa(BindingCache::Entry *entry);
+  
+  BindingCache::Entry *NewEntry();
+  
+  /**
+   * \brief Primary index, MN-Identifier to the head of the per-MN chain.
+   */
   BCache m_bCache;
   
+  /**
+   * \brief Secondary index, home network prefix to its owning entry.
+   */
+  AddressIndex m_hnpIndex;
+  
+  /**
+   * \brief Secondary index, Proxy-CoA to the head of the per-MAG chain.
+   */
+  AddressIndex m_pcoaIndex;
+  
+  uint32_t m_nEntries;
+  
+  /**
+   * \brief Storage of the entries, tentative ones included.
+   */
+  EntryPool<BindingCache::Entry> m_entryPool;
+  
   Ptr<Node> m_node;
+  
+  Ptr<BindingTimerWheel> m_timerWheel;
 };
 
 } /* ns3 */
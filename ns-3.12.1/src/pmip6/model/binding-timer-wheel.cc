@@ -0,0 +1,346 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <string.h>
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+
+#include "binding-timer-wheel.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE ("BindingTimerWheel");
+
+NS_OBJECT_ENSURE_REGISTERED (BindingTimerWheel);
+
+BindingTimer::BindingTimer ()
+  : m_wheel (0),
+    m_expires (0),
+    m_next (0),
+    m_prev (0),
+    m_slot (0)
+{
+}
+
+BindingTimer::~BindingTimer ()
+{
+  Cancel ();
+  m_wheel = 0;
+}
+
+void BindingTimer::SetWheel (Ptr<BindingTimerWheel> wheel)
+{
+  NS_ASSERT (!IsRunning ());
+  
+  m_wheel = wheel;
+}
+
+void BindingTimer::SetDelay (const Time &delay)
+{
+  m_delay = delay;
+}
+
+Time BindingTimer::GetDelay () const
+{
+  return m_delay;
+}
+
+void BindingTimer::Schedule ()
+{
+  NS_ASSERT (!IsRunning ());
+  
+  if (m_wheel != 0)
+    {
+      m_wheel->Add (this);
+    }
+  else
+    {
+      m_event = Simulator::Schedule (m_delay, &BindingTimer::Expire, this);
+    }
+}
+
+void BindingTimer::Cancel ()
+{
+  if (m_slot != 0)
+    {
+      m_wheel->Remove (this);
+    }
+  
+  Simulator::Cancel (m_event);
+}
+
+bool BindingTimer::IsRunning () const
+{
+  return m_slot != 0 || m_event.IsRunning ();
+}
+
+void BindingTimer::Expire ()
+{
+  //the handler may delete the owner of the timer
+  Callback<void> function = m_function;
+  
+  function ();
+}
+
+TypeId BindingTimerWheel::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::BindingTimerWheel")
+    .SetParent<Object> ()
+    ;
+  return tid;
+}
+
+BindingTimerWheel::BindingTimerWheel ()
+  : m_granularity (MilliSeconds (10)),
+    m_nextTick (0),
+    m_ticking (false),
+    m_nTimers (0),
+    m_nTicks (0)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  memset (m_root, 0, sizeof (m_root));
+  memset (m_levels, 0, sizeof (m_levels));
+}
+
+BindingTimerWheel::~BindingTimerWheel ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+void BindingTimerWheel::DoDispose ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  Simulator::Cancel (m_tickEvent);
+  
+  //the timers are owned by the binding entries, only unlink them
+  for (uint32_t i = 0; i < ROOT_SIZE; i++)
+    {
+      while (m_root[i])
+        {
+          Remove (m_root[i]);
+        }
+    }
+  
+  for (uint32_t l = 0; l < LEVELS; l++)
+    {
+      for (uint32_t i = 0; i < LEVEL_SIZE; i++)
+        {
+          while (m_levels[l][i])
+            {
+              Remove (m_levels[l][i]);
+            }
+        }
+    }
+  
+  Object::DoDispose ();
+}
+
+Time BindingTimerWheel::GetGranularity () const
+{
+  return m_granularity;
+}
+
+void BindingTimerWheel::SetGranularity (Time granularity)
+{
+  NS_LOG_FUNCTION (this << granularity);
+  NS_ASSERT_MSG (m_nTimers == 0, "Cannot change the granularity of a running wheel");
+  NS_ASSERT (granularity.IsStrictlyPositive ());
+  
+  m_granularity = granularity;
+}
+
+uint32_t BindingTimerWheel::GetNTimers () const
+{
+  return m_nTimers;
+}
+
+uint64_t BindingTimerWheel::GetNTicks () const
+{
+  return m_nTicks;
+}
+
+void BindingTimerWheel::Add (BindingTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer);
+  
+  int64_t gran = m_granularity.GetTimeStep ();
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  
+  if (m_nTimers == 0 && !m_ticking)
+    {
+      //idle wheel, resynchronize with the simulation clock
+      Simulator::Cancel (m_tickEvent);
+      m_nextTick = now / gran + 1;
+    }
+  
+  //round up, a binding timer must never fire early
+  uint64_t expires = (now + timer->m_delay.GetTimeStep () + gran - 1) / gran;
+  
+  //a timer re-armed by a handler goes to a later tick than the one
+  //being processed, even with a zero delay
+  uint64_t first = m_ticking ? m_nextTick + 1 : m_nextTick;
+  
+  timer->m_expires = (expires < first) ? first : expires;
+  
+  Insert (timer);
+  m_nTimers++;
+  
+  //the tick being processed schedules the next one when it is done
+  if (!m_ticking && !m_tickEvent.IsRunning ())
+    {
+      ScheduleTick ();
+    }
+}
+
+void BindingTimerWheel::Remove (BindingTimer *timer)
+{
+  NS_LOG_FUNCTION (this << timer);
+  NS_ASSERT (timer->m_slot != 0);
+  
+  if (timer->m_next)
+    {
+      timer->m_next->m_prev = timer->m_prev;
+    }
+  
+  if (timer->m_prev)
+    {
+      timer->m_prev->m_next = timer->m_next;
+    }
+  else
+    {
+      *timer->m_slot = timer->m_next;
+    }
+  
+  timer->m_next = 0;
+  timer->m_prev = 0;
+  timer->m_slot = 0;
+  
+  m_nTimers--;
+}
+
+void BindingTimerWheel::Insert (BindingTimer *timer)
+{
+  uint64_t expires = timer->m_expires;
+  uint64_t idx = (expires > m_nextTick) ? expires - m_nextTick : 0;
+  BindingTimer **slot;
+  
+  if (idx < ROOT_SIZE)
+    {
+      slot = &m_root[expires & (ROOT_SIZE - 1)];
+    }
+  else
+    {
+      uint32_t level = 0;
+      
+      while (level < LEVELS - 1 && idx >= ((uint64_t)1 << (ROOT_BITS + (level + 1) * LEVEL_BITS)))
+        {
+          level++;
+        }
+      
+      //beyond the wheel range, park in the farthest slot and re-cascade later
+      if (idx >= ((uint64_t)1 << (ROOT_BITS + LEVELS * LEVEL_BITS)))
+        {
+          expires = m_nextTick + ((uint64_t)1 << (ROOT_BITS + LEVELS * LEVEL_BITS)) - 1;
+        }
+      
+      slot = &m_levels[level][(expires >> (ROOT_BITS + level * LEVEL_BITS)) & (LEVEL_SIZE - 1)];
+    }
+  
+  timer->m_slot = slot;
+  timer->m_prev = 0;
+  timer->m_next = *slot;
+  
+  if (*slot)
+    {
+      (*slot)->m_prev = timer;
+    }
+  
+  *slot = timer;
+}
+
+uint32_t BindingTimerWheel::Cascade (uint32_t level, uint32_t index)
+{
+  BindingTimer *timer = m_levels[level][index];
+  
+  m_levels[level][index] = 0;
+  
+  while (timer)
+    {
+      BindingTimer *next = timer->m_next;
+      
+      Insert (timer);
+      timer = next;
+    }
+  
+  return index;
+}
+
+void BindingTimerWheel::Tick ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  m_nTicks++;
+  
+  uint32_t index = m_nextTick & (ROOT_SIZE - 1);
+  
+  //root wrapped, pull the timers of the next upper slots down
+  if (index == 0)
+    {
+      for (uint32_t level = 0; level < LEVELS; level++)
+        {
+          if (Cascade (level, (m_nextTick >> (ROOT_BITS + level * LEVEL_BITS)) & (LEVEL_SIZE - 1)) != 0)
+            {
+              break;
+            }
+        }
+    }
+  
+  //expire the slot, handlers may re-arm timers in the same wheel. The
+  //current tick only moves on afterwards, so that a timer re-armed 256
+  //ticks ahead is not inserted back into the slot being drained
+  m_ticking = true;
+  while (m_root[index])
+    {
+      BindingTimer *timer = m_root[index];
+      
+      Remove (timer);
+      timer->Expire ();
+    }
+  m_ticking = false;
+  
+  m_nextTick++;
+  
+  if (m_nTimers > 0)
+    {
+      ScheduleTick ();
+    }
+}
+
+void BindingTimerWheel::ScheduleTick ()
+{
+  Time at = TimeStep (m_nextTick * m_granularity.GetTimeStep ());
+  
+  m_tickEvent = Simulator::Schedule (at - Simulator::Now (), &BindingTimerWheel::Tick, this);
+}
+
+} /* namespace ns3 */
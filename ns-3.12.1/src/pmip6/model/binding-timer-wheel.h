@@ -0,0 +1,167 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINDING_TIMER_WHEEL_H
+#define BINDING_TIMER_WHEEL_H
+
+#include <stdint.h>
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+
+namespace ns3
+{
+
+class BindingTimerWheel;
+
+/**
+ * \class BindingTimer
+ * \brief One-shot timer of a binding entry.
+ *
+ * Without a wheel, the timer schedules its own simulator event like
+ * ns3::Timer. Once attached to a BindingTimerWheel, it is linked in a
+ * wheel slot and fired by the wheel tick instead, so that re-arming it
+ * costs no simulator event. The timer is cancelled on destruction.
+ */
+class BindingTimer
+{
+public:
+  BindingTimer ();
+  ~BindingTimer ();
+  
+  void SetWheel (Ptr<BindingTimerWheel> wheel);
+  
+  template <typename MEM_PTR, typename OBJ_PTR>
+  void SetFunction (MEM_PTR memPtr, OBJ_PTR objPtr);
+  
+  void SetDelay (const Time &delay);
+  Time GetDelay () const;
+  
+  void Schedule ();
+  void Cancel ();
+  
+  bool IsRunning () const;
+  
+private:
+  friend class BindingTimerWheel;
+  
+  BindingTimer (const BindingTimer &o);
+  BindingTimer &operator = (const BindingTimer &o);
+  
+  void Expire ();
+  
+  Callback<void> m_function;
+  Time m_delay;
+  
+  //per-entry mode
+  EventId m_event;
+  
+  //wheel mode
+  Ptr<BindingTimerWheel> m_wheel;
+  uint64_t m_expires;
+  BindingTimer *m_next;
+  BindingTimer *m_prev;
+  BindingTimer **m_slot;
+};
+
+/**
+ * \class BindingTimerWheel
+ * \brief Hierarchical timer wheel shared by all the bindings of an agent.
+ *
+ * The wheel has a 256-slot root level and three 64-slot upper levels
+ * which are cascaded down as the root wraps, covering 2^26 ticks. A single
+ * periodic tick event drives it while at least one timer is pending.
+ * Timers never fire early: the expiration is rounded up to the next tick.
+ */
+class BindingTimerWheel : public Object
+{
+public:
+  static TypeId GetTypeId ();
+  
+  BindingTimerWheel ();
+  virtual ~BindingTimerWheel ();
+  
+  Time GetGranularity () const;
+  void SetGranularity (Time granularity);
+  
+  /**
+   * \return the number of pending timers
+   */
+  uint32_t GetNTimers () const;
+  
+  /**
+   * \return the number of tick events processed so far
+   */
+  uint64_t GetNTicks () const;
+  
+protected:
+  virtual void DoDispose ();
+  
+private:
+  friend class BindingTimer;
+  
+  enum WheelSize_e {
+    ROOT_BITS = 8,
+    LEVEL_BITS = 6,
+    ROOT_SIZE = 1 << ROOT_BITS,
+    LEVEL_SIZE = 1 << LEVEL_BITS,
+    LEVELS = 3
+  };
+  
+  void Add (BindingTimer *timer);
+  void Remove (BindingTimer *timer);
+  
+  void Insert (BindingTimer *timer);
+  uint32_t Cascade (uint32_t level, uint32_t index);
+  void Tick ();
+  void ScheduleTick ();
+  
+  Time m_granularity;
+  
+  BindingTimer *m_root[ROOT_SIZE];
+  BindingTimer *m_levels[LEVELS][LEVEL_SIZE];
+  
+  /**
+   * \brief Next tick to be processed.
+   */
+  uint64_t m_nextTick;
+  
+  /**
+   * \brief True while the handlers of a tick run.
+   */
+  bool m_ticking;
+  
+  EventId m_tickEvent;
+  
+  uint32_t m_nTimers;
+  uint64_t m_nTicks;
+};
+
+template <typename MEM_PTR, typename OBJ_PTR>
+void
+BindingTimer::SetFunction (MEM_PTR memPtr, OBJ_PTR objPtr)
+{
+  m_function = MakeCallback (memPtr, objPtr);
+}
+
+} /* namespace ns3 */
+
+#endif /* BINDING_TIMER_WHEEL_H */
@@ -26,6 +26,8 @@
 #include "ns3/uinteger.h"
 #include "ns3/node.h"
 
+#include "entry-pool.h"
+
 #include "binding-update-list.h"
 
 #include "ipv6-mobility-l4-protocol.h"
@@ -66,6 +68,7 @@ void BindingUpdateList::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   Flush ();
+  m_timerWheel = 0;
   Object::DoDispose ();
 }
 
@@ -87,7 +90,7 @@ BindingUpdateList::Entry* BindingUpdateList::Add (Identifier mnId)
   NS_LOG_FUNCTION (this << mnId );
   NS_ASSERT( Lookup(mnId) == 0 );
   
-  BindingUpdateList::Entry* entry = new BindingUpdateList::Entry (this);
+  BindingUpdateList::Entry* entry = new (m_entryPool.Allocate ()) BindingUpdateList::Entry (this);
   
   entry->SetMnIdentifier(mnId);
   
@@ -112,19 +115,33 @@ void BindingUpdateList::Remove (BindingUpdateList::Entry* entry)
       if ((*i).second == entry)
         {
           m_buList.erase (i);
-          delete entry;
+          m_entryPool.Delete (entry);
           return;
         }
     }
 }
 
+std::list<BindingUpdateList::Entry *> BindingUpdateList::GetEntries () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  std::list<BindingUpdateList::Entry *> entries;
+  
+  for (BUListCI i = m_buList.begin () ; i != m_buList.end () ; i++)
+    {
+      entries.push_back ((*i).second);
+    }
+  
+  return entries;
+}
+
 void BindingUpdateList::Flush ()
 {
   NS_LOG_FUNCTION_NOARGS ();
 
   for (BUListI i = m_buList.begin () ; i != m_buList.end () ; i++)
     {
-      delete (*i).second; /* delete the pointer BindingUpdateList::Entry */
+      m_entryPool.Delete ((*i).second); /* delete the pointer BindingUpdateList::Entry */
     }
 
   m_buList.erase (m_buList.begin (), m_buList.end ());
@@ -144,18 +161,34 @@ void BindingUpdateList::SetNode(Ptr<Node> node)
   m_node = node;
 }
 
+void BindingUpdateList::SetTimerWheel(Ptr<BindingTimerWheel> wheel)
+{
+  NS_LOG_FUNCTION ( this << wheel );
+  
+  m_timerWheel = wheel;
+}
+
+Ptr<BindingTimerWheel> BindingUpdateList::GetTimerWheel() const
+{
+  NS_LOG_FUNCTION_NOARGS();
+  
+  return m_timerWheel;
+}
+
 BindingUpdateList::Entry::Entry (Ptr<BindingUpdateList> bul)
   : m_buList (bul),
   m_state (UNREACHABLE),
   m_ifIndex(-1),
   m_tunnelIfIndex(-1),
-  m_retransTimer (Timer::CANCEL_ON_DESTROY),
-  m_reachableTimer (Timer::CANCEL_ON_DESTROY),
-  m_refreshTimer (Timer::CANCEL_ON_DESTROY),
   m_radvdIfIndex (-1),
+  m_predictive (false),
   m_next (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  
+  m_retransTimer.SetWheel (bul->GetTimerWheel ());
+  m_reachableTimer.SetWheel (bul->GetTimerWheel ());
+  m_refreshTimer.SetWheel (bul->GetTimerWheel ());
 }
 
 void BindingUpdateList::Entry::FunctionRefreshTimeout ()
@@ -179,11 +212,11 @@ void BindingUpdateList::Entry::FunctionRefreshTimeout ()
   
   ResetRetryCount();
   
-  mag->SendMessage(p->Copy(), GetLmaAddress(), 64);
+  Time hold = mag->SendMessage(p->Copy(), GetLmaAddress(), 64);
   
   MarkRefreshing();
   
-  StartRetransTimer();
+  StartRetransTimer(hold);
 }
 
 void BindingUpdateList::Entry::FunctionReachableTimeout()
@@ -243,9 +276,9 @@ void BindingUpdateList::Entry::FunctionRetransTimeout()
       return;
     }
   
-  mag->SendMessage(GetPbuPacket ()->Copy (), GetLmaAddress (), 64);
+  Time hold = mag->RetransmitPbu(this);
   
-  StartRetransTimer();  
+  StartRetransTimer(hold);
 }
 
 bool BindingUpdateList::Entry::IsUnreachable() const
@@ -320,18 +353,18 @@ void BindingUpdateList::Entry::StopReachableTimer ()
   m_reachableTimer.Cancel ();
 }
 
-void BindingUpdateList::Entry::StartRetransTimer ()
+void BindingUpdateList::Entry::StartRetransTimer (Time hold)
 {
-  NS_LOG_FUNCTION_NOARGS ();
+  NS_LOG_FUNCTION (hold);
   m_retransTimer.SetFunction (&BindingUpdateList::Entry::FunctionRetransTimeout, this);
   
   if (GetRetryCount () == 0)
     {
-      m_retransTimer.SetDelay (Seconds (Ipv6MobilityL4Protocol::INITIAL_BINDING_ACK_TIMEOUT_FIRSTREG));
+      m_retransTimer.SetDelay (hold + Seconds (Ipv6MobilityL4Protocol::INITIAL_BINDING_ACK_TIMEOUT_FIRSTREG));
     }
   else
     {
-      m_retransTimer.SetDelay (Seconds (Ipv6MobilityL4Protocol::INITIAL_BINDING_ACK_TIMEOUT_REREG));
+      m_retransTimer.SetDelay (hold + Seconds (Ipv6MobilityL4Protocol::INITIAL_BINDING_ACK_TIMEOUT_REREG));
     }
     
   m_retransTimer.Schedule ();
@@ -600,4 +633,18 @@ void BindingUpdateList::Entry::SetRadvdIfIndex(int32_t ifIndex)
   m_radvdIfIndex = ifIndex;
 }
 
+bool BindingUpdateList::Entry::IsPredictive() const
+{
+  NS_LOG_FUNCTION_NOARGS();
+  
+  return m_predictive;
+}
+
+void BindingUpdateList::Entry::SetPredictive(bool predictive)
+{
+  NS_LOG_FUNCTION ( this << predictive );
+  
+  m_predictive = predictive;
+}
+
 } /* namespace ns3 */
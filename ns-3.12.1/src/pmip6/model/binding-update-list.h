@@ -34,10 +34,11 @@
 #include "ns3/net-device.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ptr.h"
-#include "ns3/timer.h"
 #include "ns3/sgi-hashmap.h"
 
 #include "identifier.h"
+#include "binding-timer-wheel.h"
+#include "entry-pool.h"
 
 namespace ns3
 {
@@ -61,9 +62,21 @@ public:
   
   void Flush();
   
+  /**
+   * \return all the entries of the list
+   */
+  std::list<BindingUpdateList::Entry *> GetEntries() const;
+  
   Ptr<Node> GetNode() const;
   void SetNode(Ptr<Node> node);
   
+  /**
+   * \brief Drive the timers of the entries created from now on by a shared wheel.
+   * \param wheel the wheel, or 0 for one simulator event per timer
+   */
+  void SetTimerWheel(Ptr<BindingTimerWheel> wheel);
+  Ptr<BindingTimerWheel> GetTimerWheel() const;
+  
   class Entry
   {
   public:
@@ -80,7 +93,10 @@ public:
 	void MarkReachable();
 	
 	//timer processing
-	void StartRetransTimer();
+	/**
+	 * \param hold time the PBU is held before it leaves, when bulked
+	 */
+	void StartRetransTimer(Time hold = Seconds (0));
 	void StopRetransTimer();
 	
 	void StartReachableTimer();
@@ -144,6 +160,12 @@ public:
 	int32_t GetRadvdIfIndex() const;
 	void SetRadvdIfIndex(int32_t ifIndex);
 	
+	/**
+	 * \return whether the MN was registered on a Handover Initiate and has not attached yet
+	 */
+	bool IsPredictive() const;
+	void SetPredictive(bool predictive);
+	
   private:
 	enum BindingUpdateState_e {
       UNREACHABLE,
@@ -178,11 +200,11 @@ public:
 	
 	Time m_reachableTime;
 	
-	Timer m_retransTimer;
+	BindingTimer m_retransTimer;
 	
-	Timer m_reachableTimer;
+	BindingTimer m_reachableTimer;
 	
-	Timer m_refreshTimer;
+	BindingTimer m_refreshTimer;
 	
 	uint16_t m_lastBindingUpdateSequence;
 	Ptr<Packet> m_pktPbu;
@@ -192,6 +214,8 @@ public:
 	//internal
 	int32_t m_radvdIfIndex; //Radvd Interface Index
 	
+	bool m_predictive;
+	
 	Entry *m_next;
   };
   
@@ -200,12 +224,17 @@ protected:
 private:
   typedef sgi::hash_map<Identifier, BindingUpdateList::Entry *, IdentifierHash> BUList;
   typedef sgi::hash_map<Identifier, BindingUpdateList::Entry *, IdentifierHash>::iterator BUListI;
+  typedef sgi::hash_map<Identifier, BindingUpdateList::Entry *, IdentifierHash>::const_iterator BUListCI;
   
   void DoDispose();
   
   BUList m_buList;
   
+  EntryPool<BindingUpdateList::Entry> m_entryPool;
+  
   Ptr<Node> m_node;
+  
+  Ptr<BindingTimerWheel> m_timerWheel;
 };
 
 } /* ns3 */
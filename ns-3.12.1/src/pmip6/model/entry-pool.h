@@ -0,0 +1,183 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ENTRY_POOL_H
+#define ENTRY_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <vector>
+
+#include "ns3/assert.h"
+
+namespace ns3
+{
+
+/**
+ * \class EntryPool
+ * \brief Free-list allocator for the fixed-size entries of the PMIPv6 tables.
+ *
+ * Each table owns its pool. Entries are carved out of blocks that grow with
+ * the table, and released entries are kept on a free list and handed out
+ * again by the next allocation, so binding churn does not go through the
+ * global heap. The blocks go back to the heap with the pool, when its
+ * table is destroyed: every entry must have been deleted by then.
+ *
+ * A pool is used from the simulation thread of its owner only and takes
+ * no lock.
+ */
+template <typename T>
+class EntryPool
+{
+public:
+  EntryPool ();
+  ~EntryPool ();
+
+  /**
+   * \brief Storage for one entry, to construct with placement new.
+   */
+  void *Allocate (void);
+
+  /**
+   * \brief Destroy an entry and give its storage back.
+   */
+  void Delete (T *entry);
+
+  /**
+   * \brief Make sure at least n entries are waiting on the free list.
+   * \param n number of entries
+   *
+   * The missing entries are carved out of a single block, for tables that
+   * are bulk-loaded up front.
+   */
+  void Reserve (size_t n);
+
+private:
+  enum
+  {
+    MIN_BLOCK = 16,
+    MAX_BLOCK = 1024
+  };
+
+  struct FreeNode
+  {
+    FreeNode *m_next;
+  };
+
+  EntryPool (const EntryPool &);
+  EntryPool &operator = (const EntryPool &);
+
+  void Grow (size_t n);
+  void Recycle (void *p);
+
+  std::vector<uint8_t *> m_blocks;
+  FreeNode *m_freeList;
+  size_t m_nFreeEntries;
+  size_t m_nEntries;
+};
+
+template <typename T>
+EntryPool<T>::EntryPool ()
+  : m_freeList (0),
+    m_nFreeEntries (0),
+    m_nEntries (0)
+{
+}
+
+template <typename T>
+EntryPool<T>::~EntryPool ()
+{
+  for (std::vector<uint8_t *>::iterator i = m_blocks.begin (); i != m_blocks.end (); i++)
+    {
+      ::operator delete (*i);
+    }
+}
+
+template <typename T>
+void *
+EntryPool<T>::Allocate (void)
+{
+  if (m_freeList == 0)
+    {
+      //grow with the table, by bounded steps
+      size_t n = m_nEntries;
+      n = (n < MIN_BLOCK) ? MIN_BLOCK : n;
+      n = (n > MAX_BLOCK) ? MAX_BLOCK : n;
+      Grow (n);
+    }
+
+  FreeNode *node = m_freeList;
+  m_freeList = node->m_next;
+  m_nFreeEntries--;
+  return node;
+}
+
+template <typename T>
+void
+EntryPool<T>::Delete (T *entry)
+{
+  if (entry == 0)
+    {
+      return;
+    }
+
+  entry->~T ();
+  Recycle (entry);
+}
+
+template <typename T>
+void
+EntryPool<T>::Reserve (size_t n)
+{
+  if (n > m_nFreeEntries)
+    {
+      Grow (n - m_nFreeEntries);
+    }
+}
+
+template <typename T>
+void
+EntryPool<T>::Grow (size_t n)
+{
+  NS_ASSERT (sizeof (T) >= sizeof (FreeNode));
+
+  uint8_t *block = static_cast<uint8_t *> (::operator new (n * sizeof (T)));
+  m_blocks.push_back (block);
+  m_nEntries += n;
+
+  /* thread the block backwards so the entries are handed out in address order */
+  for (size_t i = n; i > 0; i--)
+    {
+      Recycle (block + (i - 1) * sizeof (T));
+    }
+}
+
+template <typename T>
+void
+EntryPool<T>::Recycle (void *p)
+{
+  FreeNode *node = static_cast<FreeNode *> (p);
+  node->m_next = m_freeList;
+  m_freeList = node;
+  m_nFreeEntries++;
+}
+
+} /* namespace ns3 */
+
+#endif /* ENTRY_POOL_H */
@@ -0,0 +1,197 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include "entry-pool.h"
+#include "handover-buffer.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE ("HandoverBuffer");
+
+HandoverBuffer::HandoverBuffer (HandoverBufferPool *pool, uint32_t maxPackets, uint32_t maxBytes)
+  : m_pool (pool),
+    m_maxPackets (maxPackets),
+    m_maxBytes (maxBytes),
+    m_nPackets (0),
+    m_nBytes (0),
+    m_nSegments (0),
+    m_head (0),
+    m_headSlot (0),
+    m_tail (0),
+    m_tailSlot (0)
+{
+  NS_LOG_FUNCTION (this << maxPackets << maxBytes);
+}
+
+HandoverBuffer::~HandoverBuffer ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  Clear ();
+
+  if (m_head == 0)
+    {
+      return;
+    }
+
+  //open the ring, then give its segments back
+  Segment *segment = m_head->m_next;
+  m_head->m_next = 0;
+
+  while (segment)
+    {
+      Segment *next = segment->m_next;
+      m_pool->m_segments.Delete (segment);
+      segment = next;
+    }
+}
+
+HandoverBuffer::Segment *HandoverBuffer::NewSegment ()
+{
+  return new (m_pool->m_segments.Allocate ()) Segment;
+}
+
+bool HandoverBuffer::Enqueue (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+
+  uint32_t size = packet->GetSize ();
+
+  if (m_nPackets >= m_maxPackets || size > m_maxBytes - m_nBytes)
+    {
+      NS_LOG_LOGIC ("Buffer full, " << m_nPackets << " packets " << m_nBytes << " bytes");
+
+      return false;
+    }
+
+  if (m_tail == 0)
+    {
+      m_tail = NewSegment ();
+      m_tail->m_next = m_tail;
+      m_head = m_tail;
+      m_nSegments++;
+    }
+  else if (m_tailSlot == SEGMENT_SLOTS)
+    {
+      //the next segment is still being read, put a new one in between
+      if (m_tail->m_next == m_head)
+        {
+          Segment *segment = NewSegment ();
+
+          segment->m_next = m_head;
+          m_tail->m_next = segment;
+          m_nSegments++;
+        }
+
+      m_tail = m_tail->m_next;
+      m_tailSlot = 0;
+    }
+
+  m_tail->m_slots[m_tailSlot++] = packet;
+
+  m_nPackets++;
+  m_nBytes += size;
+
+  return true;
+}
+
+Ptr<Packet> HandoverBuffer::Dequeue ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  if (m_nPackets == 0)
+    {
+      return 0;
+    }
+
+  Ptr<Packet> packet = m_head->m_slots[m_headSlot];
+
+  m_head->m_slots[m_headSlot++] = 0;
+
+  m_nPackets--;
+  m_nBytes -= packet->GetSize ();
+
+  if (m_nPackets == 0)
+    {
+      //start over at the segment written last
+      m_head = m_tail;
+      m_headSlot = 0;
+      m_tailSlot = 0;
+    }
+  else if (m_headSlot == SEGMENT_SLOTS)
+    {
+      m_head = m_head->m_next;
+      m_headSlot = 0;
+    }
+
+  return packet;
+}
+
+uint32_t HandoverBuffer::Clear ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  uint32_t n = m_nPackets;
+
+  while (m_nPackets > 0)
+    {
+      Dequeue ();
+    }
+
+  return n;
+}
+
+bool HandoverBuffer::IsEmpty () const
+{
+  return m_nPackets == 0;
+}
+
+uint32_t HandoverBuffer::GetNPackets () const
+{
+  return m_nPackets;
+}
+
+uint32_t HandoverBuffer::GetNBytes () const
+{
+  return m_nBytes;
+}
+
+uint32_t HandoverBuffer::GetNSegments () const
+{
+  return m_nSegments;
+}
+
+HandoverBuffer *HandoverBufferPool::Create (uint32_t maxPackets, uint32_t maxBytes)
+{
+  NS_LOG_FUNCTION (this << maxPackets << maxBytes);
+
+  return new (m_buffers.Allocate ()) HandoverBuffer (this, maxPackets, maxBytes);
+}
+
+void HandoverBufferPool::Destroy (HandoverBuffer *buffer)
+{
+  NS_LOG_FUNCTION (this << buffer);
+
+  m_buffers.Delete (buffer);
+}
+
+} /* namespace ns3 */
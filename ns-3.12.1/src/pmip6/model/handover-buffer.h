@@ -0,0 +1,154 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HANDOVER_BUFFER_H
+#define HANDOVER_BUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+
+#include "entry-pool.h"
+
+namespace ns3
+{
+
+class HandoverBufferPool;
+
+/**
+ * \class HandoverBuffer
+ * \brief Bounded FIFO of the downlink packets of one binding during a handover.
+ *
+ * The packets are kept in a ring of fixed-size segments. The ring grows a
+ * segment at a time when the writer catches up with the reader, and the
+ * segments it drained are written again, so a buffer filled and flushed
+ * over and over reuses the same slots. Segments and buffers come from the
+ * HandoverBufferPool of their agent: handovers do not go through the global
+ * heap once warmed up.
+ */
+class HandoverBuffer
+{
+public:
+  /**
+   * \brief Append a packet.
+   * \return false, leaving the buffer as it is, if the packet does not fit the limits
+   */
+  bool Enqueue (Ptr<Packet> packet);
+
+  /**
+   * \brief Take the oldest packet out.
+   * \return the packet, 0 if the buffer is empty
+   */
+  Ptr<Packet> Dequeue ();
+
+  /**
+   * \brief Drop all the packets held.
+   * \return number of packets dropped
+   */
+  uint32_t Clear ();
+
+  bool IsEmpty () const;
+  uint32_t GetNPackets () const;
+  uint32_t GetNBytes () const;
+
+  /**
+   * \return number of segments of the ring
+   */
+  uint32_t GetNSegments () const;
+
+private:
+  enum
+  {
+    SEGMENT_SLOTS = 16
+  };
+
+  struct Segment
+  {
+    Ptr<Packet> m_slots[SEGMENT_SLOTS];
+    Segment *m_next;
+  };
+
+  friend class HandoverBufferPool;
+  friend class EntryPool<HandoverBuffer>;
+
+  /**
+   * \param pool pool of the segments
+   * \param maxPackets maximum number of packets held
+   * \param maxBytes maximum number of bytes held
+   */
+  HandoverBuffer (HandoverBufferPool *pool, uint32_t maxPackets, uint32_t maxBytes);
+
+  ~HandoverBuffer ();
+
+  HandoverBuffer (const HandoverBuffer &);
+  HandoverBuffer &operator = (const HandoverBuffer &);
+
+  Segment *NewSegment ();
+
+  HandoverBufferPool *m_pool;
+
+  uint32_t m_maxPackets;
+  uint32_t m_maxBytes;
+
+  uint32_t m_nPackets;
+  uint32_t m_nBytes;
+  uint32_t m_nSegments;
+
+  //oldest packet
+  Segment *m_head;
+  uint32_t m_headSlot;
+
+  //next free slot
+  Segment *m_tail;
+  uint32_t m_tailSlot;
+};
+
+/**
+ * \class HandoverBufferPool
+ * \brief Storage of the handover buffers of one agent, and of their segments.
+ *
+ * The buffers created by a pool must be destroyed by it, before the pool
+ * itself goes away.
+ */
+class HandoverBufferPool
+{
+public:
+  /**
+   * \param maxPackets maximum number of packets held
+   * \param maxBytes maximum number of bytes held
+   * \return a new empty buffer
+   */
+  HandoverBuffer *Create (uint32_t maxPackets, uint32_t maxBytes);
+
+  /**
+   * \brief Drop the packets of a buffer, and give the buffer back.
+   */
+  void Destroy (HandoverBuffer *buffer);
+
+private:
+  friend class HandoverBuffer;
+
+  EntryPool<HandoverBuffer> m_buffers;
+  EntryPool<HandoverBuffer::Segment> m_segments;
+};
+
+} /* namespace ns3 */
+
+#endif /* HANDOVER_BUFFER_H */
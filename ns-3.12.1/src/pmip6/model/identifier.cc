@@ -31,102 +31,6 @@
 
 namespace ns3 {
 
-Identifier::Identifier()
-  : m_len(0)
-{
-  memset (m_identifier, 0, MAX_SIZE);
-}
-
-Identifier::Identifier(const uint8_t *identifier, uint8_t len)
-  : m_len(len)
-{
-  memcpy(m_identifier, identifier, m_len);
-}
-
-Identifier::Identifier(const char *str)
-{
-  m_len = strlen(str);
-  memcpy(m_identifier, str, m_len);
-}
-
-Identifier::Identifier(Mac48Address addr)
- : m_len(6)
-{
-  addr.CopyTo(m_identifier);
-}
-
-Identifier::Identifier(const Identifier &identifier)
-  : m_len(identifier.m_len)
-{
-  memcpy(m_identifier, identifier.m_identifier, m_len);
-}
-
-Identifier &
-Identifier::operator = (const Identifier &identifier)
-{
-  m_len = identifier.m_len;
-  memcpy(m_identifier, identifier.m_identifier, m_len);
-  return *this;
-}
-
-uint8_t
-Identifier::GetLength (void) const
-{
-  return m_len;
-}
-
-uint32_t
-Identifier::CopyTo (uint8_t *buffer, uint8_t len) const
-{
-  NS_ASSERT (len >= m_len);
-  
-  memcpy (buffer, m_identifier, m_len);
-  return m_len;
-}
-
-uint32_t
-Identifier::CopyFrom (const uint8_t *buffer, uint8_t len)
-{
-  memcpy (m_identifier, buffer, len);
-  m_len = len;
-  
-  return m_len;
-}
-
-bool Identifier::IsEmpty () const
-{
-  return (m_len == 0);
-}
-
-bool operator == (const Identifier &a, const Identifier &b)
-{
-  if(a.m_len != b.m_len)
-    {
-	  return false;
-	}
-  return memcmp (a.m_identifier, b.m_identifier, a.m_len) == 0;
-}
-
-bool operator != (const Identifier &a, const Identifier &b)
-{
-  return !(a == b);
-}
-
-std::ostream& operator<< (std::ostream& os, const Identifier & identifier)
-{
-  os.setf (std::ios::hex, std::ios::basefield);
-  os.fill('0');
-  for (uint8_t i = 0; i < (identifier.m_len-1); ++i)
-    {
-	  os << std::setw(2) << (uint32_t)identifier.m_identifier[i] << ":";
-	}
-  os << std::setw(2) << (uint32_t)identifier.m_identifier[identifier.m_len-1];
-  os.setf (std::ios::dec, std::ios::basefield);
-  os.fill(' ');
-  return os;
-}
-
-
 #ifdef __cplusplus
 extern "C"
 { /* } */
@@ -140,7 +44,7 @@ extern "C"
  * \return hash
  * \note Adapted from Jens Jakobsen implementation (chillispot).
  */
-static uint32_t lookuphash (unsigned char* k, uint32_t length, uint32_t level)
+static uint32_t lookuphash (const unsigned char* k, uint32_t length, uint32_t level)
 {
 #define mix(a, b, c) \
   ({ \
@@ -207,13 +111,228 @@ static uint32_t lookuphash (unsigned char* k, uint32_t length, uint32_t level)
 }
 #endif
 
-size_t IdentifierHash::operator () (Identifier const &x) const
+/**
+ * \brief Take one more reference to a shared buffer.
+ */
+static inline void
+AddReference (uint32_t *count)
 {
-  uint8_t buf[Identifier::MAX_SIZE];
+#ifdef __GNUC__
+  // the threads of a multi-threaded simulation copy the same identifiers
+  __sync_fetch_and_add (count, 1);
+#else
+  (*count)++;
+#endif
+}
+
+/**
+ * \brief Drop one reference to a shared buffer.
+ * \return true if it was the last one
+ */
+static inline bool
+DropReference (uint32_t *count)
+{
+#ifdef __GNUC__
+  return __sync_sub_and_fetch (count, 1) == 0;
+#else
+  return --(*count) == 0;
+#endif
+}
 
-  x.CopyTo (buf, Identifier::MAX_SIZE);
+Identifier::Identifier()
+  : m_hash(0),
+    m_len(0)
+{
+}
+
+Identifier::Identifier(const uint8_t *identifier, uint8_t len)
+  : m_len(0)
+{
+  Assign(identifier, len);
+}
+
+Identifier::Identifier(const char *str)
+  : m_len(0)
+{
+  size_t len = strlen(str);
+  NS_ASSERT (len <= MAX_SIZE);
+  
+  Assign((const uint8_t *)str, len);
+}
+
+Identifier::Identifier(Mac48Address addr)
+ : m_len(0)
+{
+  uint8_t buf[6];
+  
+  addr.CopyTo(buf);
+  Assign(buf, 6);
+}
 
-  return lookuphash (buf, x.GetLength(), 0);
+Identifier::Identifier(const Identifier &identifier)
+  : m_hash(identifier.m_hash),
+    m_len(identifier.m_len)
+{
+  if (m_len > INLINE_SIZE)
+    {
+      m_shared = identifier.m_shared;
+      AddReference (&m_shared->m_count);
+    }
+  else
+    {
+      memcpy(m_inline, identifier.m_inline, m_len);
+    }
+}
+
+Identifier &
+Identifier::operator = (const Identifier &identifier)
+{
+  if (this == &identifier)
+    {
+      return *this;
+    }
+  
+  Release();
+  
+  m_hash = identifier.m_hash;
+  m_len = identifier.m_len;
+  
+  if (m_len > INLINE_SIZE)
+    {
+      m_shared = identifier.m_shared;
+      AddReference (&m_shared->m_count);
+    }
+  else
+    {
+      memcpy(m_inline, identifier.m_inline, m_len);
+    }
+  return *this;
+}
+
+Identifier::~Identifier()
+{
+  Release();
+}
+
+const uint8_t *
+Identifier::GetBuffer (void) const
+{
+  return (m_len > INLINE_SIZE) ? m_shared->m_data : m_inline;
+}
+
+void
+Identifier::Assign (const uint8_t *buffer, uint8_t len)
+{
+  m_len = len;
+  
+  if (m_len > INLINE_SIZE)
+    {
+      m_shared = (SharedBuffer *) new uint8_t[sizeof (SharedBuffer) + m_len];
+      m_shared->m_count = 1;
+      memcpy(m_shared->m_data, buffer, m_len);
+    }
+  else
+    {
+      memcpy(m_inline, buffer, m_len);
+    }
+  
+  m_hash = Hash (buffer, m_len);
+}
+
+void
+Identifier::Release (void)
+{
+  if (m_len > INLINE_SIZE)
+    {
+      if (DropReference (&m_shared->m_count))
+        {
+          delete [] (uint8_t *) m_shared;
+        }
+    }
+  m_len = 0;
+}
+
+uint8_t
+Identifier::GetLength (void) const
+{
+  return m_len;
+}
+
+uint32_t
+Identifier::CopyTo (uint8_t *buffer, uint8_t len) const
+{
+  NS_ASSERT (len >= m_len);
+  
+  memcpy (buffer, GetBuffer (), m_len);
+  return m_len;
+}
+
+uint32_t
+Identifier::CopyFrom (const uint8_t *buffer, uint8_t len)
+{
+  Release ();
+  Assign (buffer, len);
+  
+  return m_len;
+}
+
+bool Identifier::IsEmpty () const
+{
+  return (m_len == 0);
+}
+
+uint32_t Identifier::GetHash () const
+{
+  return m_hash;
+}
+
+uint32_t Identifier::Hash (const uint8_t *buffer, uint8_t len)
+{
+  if (len == 0)
+    {
+      return 0;
+    }
+  return lookuphash (buffer, len, 0);
+}
+
+bool operator == (const Identifier &a, const Identifier &b)
+{
+  if(a.m_len != b.m_len || a.m_hash != b.m_hash)
+    {
+	  return false;
+	}
+  if (a.m_len > Identifier::INLINE_SIZE && a.m_shared == b.m_shared)
+    {
+      return true;
+    }
+  return memcmp (a.GetBuffer (), b.GetBuffer (), a.m_len) == 0;
+}
+
+bool operator != (const Identifier &a, const Identifier &b)
+{
+  return !(a == b);
+}
+
+std::ostream& operator<< (std::ostream& os, const Identifier & identifier)
+{
+  const uint8_t *buf = identifier.GetBuffer ();
+  
+  os.setf (std::ios::hex, std::ios::basefield);
+  os.fill('0');
+  for (uint8_t i = 0; i < (identifier.m_len-1); ++i)
+    {
+	  os << std::setw(2) << (uint32_t)buf[i] << ":";
+	}
+  os << std::setw(2) << (uint32_t)buf[identifier.m_len-1];
+  os.setf (std::ios::dec, std::ios::basefield);
+  os.fill(' ');
+  return os;
+}
+
+
+size_t IdentifierHash::operator () (Identifier const &x) const
+{
+  return x.GetHash ();
 }
 
 } /* namespace ns3 */
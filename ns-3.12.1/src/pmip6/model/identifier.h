@@ -40,6 +40,11 @@ class Mac48Address;
 /**
  * \class Identifier
  * \brief Identifier.
+ *
+ * Identifiers up to INLINE_SIZE bytes (MAC addresses, short NAIs) are
+ * stored inline, longer ones in a shared reference-counted buffer, so
+ * that copying an Identifier never copies more than a few words. The
+ * hash is computed once when the value is set.
  */
 class Identifier
 {
@@ -48,12 +53,17 @@ public:
     MAX_SIZE = 255
   };
   
+  enum InlineSize_e {
+    INLINE_SIZE = 24
+  };
+  
   Identifier();
   Identifier(const uint8_t *buffer, uint8_t len);
   Identifier(const char *str);
   Identifier(Mac48Address addr);
   Identifier(const Identifier & identifier);
   Identifier &operator = (const Identifier &identifier);
+  ~Identifier();
   
   uint8_t GetLength (void) const;
   
@@ -62,6 +72,19 @@ public:
   uint32_t CopyFrom (const uint8_t *buffer, uint8_t len);
   
   bool IsEmpty() const;
+  
+  /**
+   * \return the precomputed hash of the identifier bytes
+   */
+  uint32_t GetHash (void) const;
+
+  /**
+   * \param buffer the identifier bytes
+   * \param len the number of bytes
+   * \return the hash kept by an identifier holding these bytes; 0 for an
+   *         empty one, as for a default-constructed identifier
+   */
+  static uint32_t Hash (const uint8_t *buffer, uint8_t len);
 
 protected:
 
@@ -70,8 +93,25 @@ private:
   friend bool operator != (const Identifier &a, const Identifier &b);
   friend std::ostream& operator<< (std::ostream& os, const Identifier & identifier);
   
+  /**
+   * \brief Out-of-line storage for identifiers longer than INLINE_SIZE.
+   */
+  struct SharedBuffer
+  {
+    uint32_t m_count;
+    uint8_t m_data[1];
+  };
+  
+  const uint8_t *GetBuffer (void) const;
+  void Assign (const uint8_t *buffer, uint8_t len);
+  void Release (void);
+  
+  uint32_t m_hash;
   uint8_t m_len;
-  uint8_t m_identifier[MAX_SIZE];
+  union {
+    uint8_t m_inline[INLINE_SIZE];
+    SharedBuffer *m_shared;
+  };
 };
 
 ATTRIBUTE_HELPER_HEADER (Identifier);
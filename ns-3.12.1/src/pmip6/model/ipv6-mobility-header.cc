@@ -678,10 +678,273 @@ uint32_t Ipv6MobilityBindingAckHeader::Deserialize (Buffer::Iterator start)
   m_sequence = i.ReadNtohU16 ();
   m_lifetime = i.ReadNtohU16 ();
 
-  MobilityOptionField::Deserialize(i, (( GetHeaderLen() + 1 ) << 3 ) - 16 );
+  MobilityOptionField::Deserialize(i, (( GetHeaderLen() + 1 ) << 3 ) - GetOptionsOffset() );
   
   return GetSerializedSize ();
 }
 
-} /* namespace ns3 */
+NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityHandoverInitiateHeader);
+
+TypeId Ipv6MobilityHandoverInitiateHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::Ipv6MobilityHandoverInitiateHeader")
+    .SetParent<Ipv6MobilityHeader> ()
+    .AddConstructor<Ipv6MobilityHandoverInitiateHeader> ()
+    ;
+  return tid;
+}
+
+TypeId Ipv6MobilityHandoverInitiateHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+Ipv6MobilityHandoverInitiateHeader::Ipv6MobilityHandoverInitiateHeader ()
+: MobilityOptionField(10)
+{
+  SetHeaderLen(0);
+  SetMhType(IPV6_MOBILITY_HANDOVER_INITIATE);
+  SetReserved(0);
+  SetChecksum(0);
+  
+  SetSequence(0);
+  SetFlagP(0);
+  SetFlagU(0);
+  SetCode(0);
+}
+
+Ipv6MobilityHandoverInitiateHeader::~Ipv6MobilityHandoverInitiateHeader ()
+{
+}
+
+uint16_t Ipv6MobilityHandoverInitiateHeader::GetSequence () const
+{
+  return m_sequence;
+}
+
+void Ipv6MobilityHandoverInitiateHeader::SetSequence (uint16_t sequence)
+{
+  m_sequence = sequence;
+}
+
+bool Ipv6MobilityHandoverInitiateHeader::GetFlagP () const
+{
+  return m_flagP;
+}
+
+void Ipv6MobilityHandoverInitiateHeader::SetFlagP (bool p)
+{
+  m_flagP = p;
+}
+
+bool Ipv6MobilityHandoverInitiateHeader::GetFlagU () const
+{
+  return m_flagU;
+}
+
+void Ipv6MobilityHandoverInitiateHeader::SetFlagU (bool u)
+{
+  m_flagU = u;
+}
+
+uint8_t Ipv6MobilityHandoverInitiateHeader::GetCode () const
+{
+  return m_code;
+}
+
+void Ipv6MobilityHandoverInitiateHeader::SetCode (uint8_t code)
+{
+  m_code = code;
+}
+
+void Ipv6MobilityHandoverInitiateHeader::Print (std::ostream& os) const
+{
+  os << "( payload_proto = " << (uint32_t)GetPayloadProto() << " header_len = " << (uint32_t)GetHeaderLen() << " mh_type = " << (uint32_t)GetMhType() << " checksum = " << (uint32_t)GetChecksum();
+  os << " sequence = " << (uint32_t)GetSequence () << " code = " << (uint32_t)GetCode () << ")";
+}
+
+uint32_t Ipv6MobilityHandoverInitiateHeader::GetSerializedSize () const
+{
+  return 10 + MobilityOptionField::GetSerializedSize();
+}
+
+void Ipv6MobilityHandoverInitiateHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  uint8_t flags = 0;
+
+  i.WriteU8 (GetPayloadProto());
+  
+  i.WriteU8 ((uint8_t) (( GetSerializedSize() >> 3) - 1));
+  i.WriteU8 (GetMhType());
+  i.WriteU8 (GetReserved());
+  
+  i.WriteU16 (0);
+  
+  i.WriteHtonU16 (m_sequence);
+  
+  if (m_flagU) {
+    flags |= (uint8_t)(1 << 6);
+  }
+  
+  if (m_flagP) {
+    flags |= (uint8_t)(1 << 5);
+  }
+  
+  i.WriteU8 (flags);
+  i.WriteU8 (m_code);
+  
+  MobilityOptionField::Serialize(i);
+}
+
+uint32_t Ipv6MobilityHandoverInitiateHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  uint8_t flags;
+
+  SetPayloadProto(i.ReadU8 ());
+  SetHeaderLen(i.ReadU8 ());
+  SetMhType(i.ReadU8 ());
+  SetReserved(i.ReadU8 ());
+  
+  SetChecksum(i.ReadU16 ());
+  
+  m_sequence = i.ReadNtohU16 ();
+  
+  flags = i.ReadU8 ();
+  
+  m_flagU = (flags & (1 << 6)) != 0;
+  m_flagP = (flags & (1 << 5)) != 0;
+  
+  m_code = i.ReadU8 ();
 
+  MobilityOptionField::Deserialize(i, (( GetHeaderLen() + 1 ) << 3 ) - 10 );
+  
+  return GetSerializedSize ();
+}
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityHandoverAckHeader);
+
+TypeId Ipv6MobilityHandoverAckHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::Ipv6MobilityHandoverAckHeader")
+    .SetParent<Ipv6MobilityHeader> ()
+    .AddConstructor<Ipv6MobilityHandoverAckHeader> ()
+    ;
+  return tid;
+}
+
+TypeId Ipv6MobilityHandoverAckHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+Ipv6MobilityHandoverAckHeader::Ipv6MobilityHandoverAckHeader ()
+: MobilityOptionField(10)
+{
+  SetHeaderLen(0);
+  SetMhType(IPV6_MOBILITY_HANDOVER_ACKNOWLEDGE);
+  SetReserved(0);
+  SetChecksum(0);
+  
+  SetSequence(0);
+  SetFlagP(0);
+  SetCode(0);
+}
+
+Ipv6MobilityHandoverAckHeader::~Ipv6MobilityHandoverAckHeader ()
+{
+}
+
+uint16_t Ipv6MobilityHandoverAckHeader::GetSequence () const
+{
+  return m_sequence;
+}
+
+void Ipv6MobilityHandoverAckHeader::SetSequence (uint16_t sequence)
+{
+  m_sequence = sequence;
+}
+
+bool Ipv6MobilityHandoverAckHeader::GetFlagP () const
+{
+  return m_flagP;
+}
+
+void Ipv6MobilityHandoverAckHeader::SetFlagP (bool p)
+{
+  m_flagP = p;
+}
+
+uint8_t Ipv6MobilityHandoverAckHeader::GetCode () const
+{
+  return m_code;
+}
+
+void Ipv6MobilityHandoverAckHeader::SetCode (uint8_t code)
+{
+  m_code = code;
+}
+
+void Ipv6MobilityHandoverAckHeader::Print (std::ostream& os) const
+{
+  os << "( payload_proto = " << (uint32_t)GetPayloadProto() << " header_len = " << (uint32_t)GetHeaderLen() << " mh_type = " << (uint32_t)GetMhType() << " checksum = " << (uint32_t)GetChecksum();
+  os << " sequence = " << (uint32_t)GetSequence () << " code = " << (uint32_t)GetCode () << ")";
+}
+
+uint32_t Ipv6MobilityHandoverAckHeader::GetSerializedSize () const
+{
+  return 10 + MobilityOptionField::GetSerializedSize();
+}
+
+void Ipv6MobilityHandoverAckHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  uint8_t flags = 0;
+
+  i.WriteU8 (GetPayloadProto());
+  
+  i.WriteU8 ((uint8_t) (( GetSerializedSize() >> 3) - 1));
+  i.WriteU8 (GetMhType());
+  i.WriteU8 (GetReserved());
+  
+  i.WriteU16 (0);
+  
+  i.WriteHtonU16 (m_sequence);
+  
+  if (m_flagP) {
+    flags |= (uint8_t)(1 << 6);
+  }
+  
+  i.WriteU8 (flags);
+  i.WriteU8 (m_code);
+  
+  MobilityOptionField::Serialize(i);
+}
+
+uint32_t Ipv6MobilityHandoverAckHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  uint8_t flags;
+
+  SetPayloadProto(i.ReadU8 ());
+  SetHeaderLen(i.ReadU8 ());
+  SetMhType(i.ReadU8 ());
+  SetReserved(i.ReadU8 ());
+  
+  SetChecksum(i.ReadU16 ());
+  
+  m_sequence = i.ReadNtohU16 ();
+  
+  flags = i.ReadU8 ();
+  
+  m_flagP = (flags & (1 << 6)) != 0;
+  
+  m_code = i.ReadU8 ();
+
+  MobilityOptionField::Deserialize(i, (( GetHeaderLen() + 1 ) << 3 ) - 10 );
+  
+  return GetSerializedSize ();
+}
+
+} /* namespace ns3 */
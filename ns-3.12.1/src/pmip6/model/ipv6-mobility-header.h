@@ -55,6 +55,11 @@ public:
 	IPV6_MOBILITY_BINDING_UPDATE,
 	IPV6_MOBILITY_BINDING_ACKNOWLEDGEMENT,
 	IPV6_MOBILITY_BINDING_ERROR
+	
+	/* PFMIPv6 (RFC5949) */
+	,
+	IPV6_MOBILITY_HANDOVER_INITIATE = 14,
+	IPV6_MOBILITY_HANDOVER_ACKNOWLEDGE
   };
    
    enum OptionType_e
@@ -65,6 +70,7 @@ public:
 	IPV6_MOBILITY_OPT_ALTERNATE_CARE_OF_ADDRESS,
 	IPV6_MOBILITY_OPT_NONCE_INDICES,
 	IPV6_MOBILITY_OPT_BINDING_AUTHORIZATION_DATA,
+	IPV6_MOBILITY_OPT_LINK_LAYER_ADDRESS = 7,
 	
 	IPV6_MOBILITY_OPT_MOBILE_NODE_IDENTIFIER = 8
 	
@@ -99,6 +105,19 @@ public:
 	BA_STATUS_MISSING_ACCESS_TECH_TYPE_OPTION
   };
   
+  enum HAckCode_e {
+    HACK_CODE_HANDOVER_ACCEPTED = 0,
+	HACK_CODE_HANDOVER_NOT_ACCEPTED = 128,
+	HACK_CODE_ADMINISTRATIVELY_PROHIBITED,
+	HACK_CODE_INSUFFICIENT_RESOURCES
+  };
+  
+  enum OptionLinkLayerAddressCode_e {
+    OPT_LLA_WILDCARD = 0,
+	OPT_LLA_NEW_ACCESS_POINT,
+	OPT_LLA_MOBILE_NODE
+  };
+  
   enum OptionHandoffIndicator_e {
     OPT_HI_RESERVED = 0,
 	OPT_HI_ATTACH_OVER_NEW_INTERFACE,
@@ -114,7 +133,10 @@ public:
 	OPT_ATT_PPP,
 	OPT_ATT_IEEE_802_3,
 	OPT_ATT_IEEE_802_11ABG,
-	OPT_ATT_IEEE_802_16E
+	OPT_ATT_IEEE_802_16E,
+	OPT_ATT_3GPP_GERAN,
+	OPT_ATT_3GPP_UTRAN,
+	OPT_ATT_3GPP_EUTRAN
   };
   
   /**
@@ -737,6 +759,242 @@ private:
   uint16_t m_lifetime;
 };
 
+/**
+ * \class Ipv6MobilityHandoverInitiateHeader
+ * \brief Ipv6 Mobility Handover Initiate header (RFC5949).
+ *
+ * Sent by the previous MAG to the new MAG of an MN about to move, with
+ * the context of the MN in its options.
+ */
+class Ipv6MobilityHandoverInitiateHeader : public Ipv6MobilityHeader, public MobilityOptionField
+{
+public:
+  /**
+   * \brief Get the UID of this class.
+   * \return UID
+   */
+  static TypeId GetTypeId ();
+
+  /**
+   * \brief Get the instance type ID.
+   * \return instance type ID
+   */
+  virtual TypeId GetInstanceTypeId () const;
+
+  /**
+   * \brief Constructor.
+   */
+  Ipv6MobilityHandoverInitiateHeader ();
+
+  /**
+   * \brief Destructor.
+   */
+  virtual ~Ipv6MobilityHandoverInitiateHeader ();
+
+  /**
+   * \brief Get the Sequence field.
+   * \return sequence value
+   */
+  uint16_t GetSequence () const;
+
+  /**
+   * \brief Set the sequence field.
+   * \param sequence the sequence value
+   */
+  void SetSequence (uint16_t sequence);
+
+  /**
+   * \brief Get the P (proxy) flag.
+   * \return P flag
+   */
+  bool GetFlagP() const;
+  
+  /**
+   * \brief Set the P (proxy) flag.
+   * \param p value
+   */
+  void SetFlagP(bool p);
+
+  /**
+   * \brief Get the U (buffer) flag.
+   * \return U flag
+   */
+  bool GetFlagU() const;
+  
+  /**
+   * \brief Set the U (buffer) flag.
+   * \param u value
+   */
+  void SetFlagU(bool u);
+
+  /**
+   * \brief Get the Code field.
+   * \return code value
+   */
+  uint8_t GetCode () const;
+
+  /**
+   * \brief Set the code field.
+   * \param code the code value
+   */
+  void SetCode (uint8_t code);
+
+  /**
+   * \brief Print informations.
+   * \param os output stream
+   */
+  virtual void Print (std::ostream& os) const;
+
+  /**
+   * \brief Get the serialized size.
+   * \return serialized size
+   */
+  virtual uint32_t GetSerializedSize () const;
+
+  /**
+   * \brief Serialize the packet.
+   * \param start start offset
+   */
+  virtual void Serialize (Buffer::Iterator start) const;
+
+  /**
+   * \brief Deserialize the packet.
+   * \param start start offset
+   * \return length of packet
+   */
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+
+  /**
+   * \brief The Sequence field
+   */
+  uint16_t m_sequence;
+
+  /**
+   * \brief The P flag.
+   */
+  bool m_flagP;
+
+  /**
+   * \brief The U flag.
+   */
+  bool m_flagU;
+
+  /**
+   * \brief The code value.
+   */
+  uint8_t m_code;
+};
+
+/**
+ * \class Ipv6MobilityHandoverAckHeader
+ * \brief Ipv6 Mobility Handover Acknowledge header (RFC5949).
+ */
+class Ipv6MobilityHandoverAckHeader : public Ipv6MobilityHeader, public MobilityOptionField
+{
+public:
+  /**
+   * \brief Get the UID of this class.
+   * \return UID
+   */
+  static TypeId GetTypeId ();
+
+  /**
+   * \brief Get the instance type ID.
+   * \return instance type ID
+   */
+  virtual TypeId GetInstanceTypeId () const;
+
+  /**
+   * \brief Constructor.
+   */
+  Ipv6MobilityHandoverAckHeader ();
+
+  /**
+   * \brief Destructor.
+   */
+  virtual ~Ipv6MobilityHandoverAckHeader ();
+
+  /**
+   * \brief Get the Sequence field.
+   * \return sequence value
+   */
+  uint16_t GetSequence () const;
+
+  /**
+   * \brief Set the sequence field.
+   * \param sequence the sequence value
+   */
+  void SetSequence (uint16_t sequence);
+
+  /**
+   * \brief Get the P (proxy) flag.
+   * \return P flag
+   */
+  bool GetFlagP() const;
+  
+  /**
+   * \brief Set the P (proxy) flag.
+   * \param p value
+   */
+  void SetFlagP(bool p);
+
+  /**
+   * \brief Get the Code field.
+   * \return code value, see HAckCode_e
+   */
+  uint8_t GetCode () const;
+
+  /**
+   * \brief Set the code field.
+   * \param code the code value
+   */
+  void SetCode (uint8_t code);
+
+  /**
+   * \brief Print informations.
+   * \param os output stream
+   */
+  virtual void Print (std::ostream& os) const;
+
+  /**
+   * \brief Get the serialized size.
+   * \return serialized size
+   */
+  virtual uint32_t GetSerializedSize () const;
+
+  /**
+   * \brief Serialize the packet.
+   * \param start start offset
+   */
+  virtual void Serialize (Buffer::Iterator start) const;
+
+  /**
+   * \brief Deserialize the packet.
+   * \param start start offset
+   * \return length of packet
+   */
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+
+  /**
+   * \brief The Sequence field
+   */
+  uint16_t m_sequence;
+
+  /**
+   * \brief The P flag.
+   */
+  bool m_flagP;
+
+  /**
+   * \brief The code value.
+   */
+  uint8_t m_code;
+};
+
 } /* namespace ns3 */
 
 #endif /* IPV6_MOBILITY_HEADER_H */
@@ -193,6 +193,15 @@ void Ipv6MobilityL4Protocol::RegisterMobility()
   Ptr<Ipv6MobilityBindingAck> ba = CreateObject<Ipv6MobilityBindingAck>();
   ba->SetNode(m_node);
   ipv6MobilityDemux->Insert(ba);  
+  
+  //for PFMIPv6
+  Ptr<Ipv6MobilityHandoverInitiate> hi = CreateObject<Ipv6MobilityHandoverInitiate>();
+  hi->SetNode(m_node);
+  ipv6MobilityDemux->Insert(hi);
+  
+  Ptr<Ipv6MobilityHandoverAck> hack = CreateObject<Ipv6MobilityHandoverAck>();
+  hack->SetNode(m_node);
+  ipv6MobilityDemux->Insert(hack);
 }
 
 void Ipv6MobilityL4Protocol::RegisterMobilityOptions()
@@ -238,6 +247,11 @@ void Ipv6MobilityL4Protocol::RegisterMobilityOptions()
   Ptr<Ipv6MobilityOptionTimestamp> timestamp = CreateObject<Ipv6MobilityOptionTimestamp>();
   timestamp->SetNode(m_node);
   ipv6MobilityOptionDemux->Insert(timestamp);
+  
+  //for PFMIPv6
+  Ptr<Ipv6MobilityOptionLinkLayerAddress> mhlla = CreateObject<Ipv6MobilityOptionLinkLayerAddress>();
+  mhlla->SetNode(m_node);
+  ipv6MobilityOptionDemux->Insert(mhlla);
 }
 
 } /* namespace ns3 */
@@ -909,4 +909,99 @@ Ipv6MobilityOptionHeader::Alignment Ipv6MobilityOptionTimestampHeader::GetAlignm
   return (Alignment){8,6}; //8n+6
 }
 
+NS_OBJECT_ENSURE_REGISTERED(Ipv6MobilityOptionLinkLayerAddressHeader);
+
+TypeId Ipv6MobilityOptionLinkLayerAddressHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::Ipv6MobilityOptionLinkLayerAddressHeader")
+    .SetParent<Ipv6MobilityOptionHeader> ()
+    .AddConstructor<Ipv6MobilityOptionLinkLayerAddressHeader> ()
+    ;
+  return tid;
+}
+
+TypeId Ipv6MobilityOptionLinkLayerAddressHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+Ipv6MobilityOptionLinkLayerAddressHeader::Ipv6MobilityOptionLinkLayerAddressHeader()
+{
+  SetType(Ipv6MobilityHeader::IPV6_MOBILITY_OPT_LINK_LAYER_ADDRESS);
+  SetLength(7);
+  
+  m_optionCode = Ipv6MobilityHeader::OPT_LLA_WILDCARD;
+}
+
+Ipv6MobilityOptionLinkLayerAddressHeader::Ipv6MobilityOptionLinkLayerAddressHeader(uint8_t code, Mac48Address lla)
+{
+  SetType(Ipv6MobilityHeader::IPV6_MOBILITY_OPT_LINK_LAYER_ADDRESS);
+  SetLength(7);
+  
+  m_optionCode = code;
+  m_linkLayerAddress = lla;
+}
+
+Ipv6MobilityOptionLinkLayerAddressHeader::~Ipv6MobilityOptionLinkLayerAddressHeader()
+{
+}
+
+uint8_t Ipv6MobilityOptionLinkLayerAddressHeader::GetOptionCode() const
+{
+  return m_optionCode;
+}
+
+void Ipv6MobilityOptionLinkLayerAddressHeader::SetOptionCode(uint8_t code)
+{
+  m_optionCode = code;
+}
+
+Mac48Address Ipv6MobilityOptionLinkLayerAddressHeader::GetLinkLayerAddress() const
+{
+  return m_linkLayerAddress;
+}
+
+void Ipv6MobilityOptionLinkLayerAddressHeader::SetLinkLayerAddress(Mac48Address lla)
+{
+  m_linkLayerAddress = lla;
+}
+
+void Ipv6MobilityOptionLinkLayerAddressHeader::Print (std::ostream& os) const
+{
+  os << "( type=" << (uint32_t)GetType() << ", length(excluding TL)=" << (uint32_t)GetLength() << ", option_code=" << (uint32_t)GetOptionCode() << ", link_layer_address=" << GetLinkLayerAddress() << ")";
+}
+
+uint32_t Ipv6MobilityOptionLinkLayerAddressHeader::GetSerializedSize () const
+{
+  return GetLength()+2;
+}
+
+void Ipv6MobilityOptionLinkLayerAddressHeader::Serialize (Buffer::Iterator start) const
+{
+  uint8_t buf_lla[6];
+  Buffer::Iterator i = start;
+
+  i.WriteU8(GetType());
+  i.WriteU8(GetLength());
+  i.WriteU8(m_optionCode);
+
+  m_linkLayerAddress.CopyTo(buf_lla);
+  i.Write(buf_lla, 6);
+}
+
+uint32_t Ipv6MobilityOptionLinkLayerAddressHeader::Deserialize (Buffer::Iterator start)
+{
+  uint8_t buf_lla[6];
+  Buffer::Iterator i = start;
+  
+  SetType(i.ReadU8());
+  SetLength(i.ReadU8());
+  m_optionCode = i.ReadU8();
+  
+  i.Read(buf_lla, 6);
+  m_linkLayerAddress.CopyFrom(buf_lla);
+  
+  return GetSerializedSize();
+}
+
 } /* namespace ns3 */
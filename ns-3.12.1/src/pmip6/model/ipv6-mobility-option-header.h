@@ -29,6 +29,7 @@
 
 #include "ns3/header.h"
 #include "ns3/ipv6-address.h"
+#include "ns3/mac48-address.h"
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
 #include "ns3/identifier.h"
@@ -399,6 +400,39 @@ private:
   Time m_timestamp;
 };
 
+/**
+ * \brief Link-layer address option (RFC5568), giving the new access point
+ * of an MN in a Handover Initiate.
+ */
+class Ipv6MobilityOptionLinkLayerAddressHeader : public Ipv6MobilityOptionHeader
+{
+public:
+  static TypeId GetTypeId ();
+  virtual TypeId GetInstanceTypeId () const;
+
+  Ipv6MobilityOptionLinkLayerAddressHeader();
+  Ipv6MobilityOptionLinkLayerAddressHeader(uint8_t code, Mac48Address lla);
+  
+  virtual ~Ipv6MobilityOptionLinkLayerAddressHeader();
+
+  uint8_t GetOptionCode() const;
+  void SetOptionCode(uint8_t code);
+  
+  Mac48Address GetLinkLayerAddress() const;
+  void SetLinkLayerAddress(Mac48Address lla);
+  
+  virtual void Print (std::ostream& os) const;
+  virtual uint32_t GetSerializedSize () const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+ 
+protected:
+
+private:
+  uint8_t m_optionCode;
+  Mac48Address m_linkLayerAddress;
+};
+
 } /* namespace ns3 */
 
 #endif /* IPV6_MOBILITY_OPTION_HEADER_H */
@@ -27,6 +27,7 @@
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
 #include "ns3/identifier.h"
+#include "ipv6-mobility-header.h"
 #include "ipv6-mobility-option.h"
 #include "ipv6-mobility-option-header.h"
 
@@ -175,6 +176,20 @@ void Ipv6MobilityOptionBundle::SetTimestamp(Time tm)
   m_timestamp = tm;
 }
 
+Mac48Address Ipv6MobilityOptionBundle::GetNewAccessPoint() const
+{
+  NS_LOG_FUNCTION_NOARGS();
+  
+  return m_newAccessPoint;
+}
+
+void Ipv6MobilityOptionBundle::SetNewAccessPoint(Mac48Address ap)
+{
+  NS_LOG_FUNCTION ( this << ap );
+  
+  m_newAccessPoint = ap;
+}
+
 NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityOptionPad1);
 
 TypeId Ipv6MobilityOptionPad1::GetTypeId ()
@@ -197,19 +212,15 @@ uint8_t Ipv6MobilityOptionPad1::GetMobilityOptionNumber () const
   return OPT_NUMBER;
 }
 
-uint8_t Ipv6MobilityOptionPad1::Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle)
+uint8_t Ipv6MobilityOptionPad1::Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle)
 {
-  NS_LOG_FUNCTION ( this << packet );
-  
-  Ptr<Packet> p = packet->Copy();
-  
-  p->RemoveAtStart(offset);
-  
+  NS_LOG_FUNCTION (this);
+
   Ipv6MobilityOptionPad1Header pad1;
-  
-  p->RemoveHeader(pad1);
-  
-  return pad1.GetSerializedSize();
+
+  pad1.Deserialize (start);
+
+  return pad1.GetSerializedSize ();
 }
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityOptionPadn);
@@ -234,19 +245,15 @@ uint8_t Ipv6MobilityOptionPadn::GetMobilityOptionNumber () const
   return OPT_NUMBER;
 }
 
-uint8_t Ipv6MobilityOptionPadn::Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle)
+uint8_t Ipv6MobilityOptionPadn::Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle)
 {
-  NS_LOG_FUNCTION ( this << packet );
-  
-  Ptr<Packet> p = packet->Copy();
-  
-  p->RemoveAtStart(offset);
+  NS_LOG_FUNCTION (this);
 
   Ipv6MobilityOptionPadnHeader padn;
-  
-  p->RemoveHeader(padn);
-  
-  return padn.GetSerializedSize();
+
+  padn.Deserialize (start);
+
+  return padn.GetSerializedSize ();
 }
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityOptionMobileNodeIdentifier);
@@ -271,24 +278,20 @@ uint8_t Ipv6MobilityOptionMobileNodeIdentifier::GetMobilityOptionNumber () const
   return OPT_NUMBER;
 }
 
-uint8_t Ipv6MobilityOptionMobileNodeIdentifier::Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle)
+uint8_t Ipv6MobilityOptionMobileNodeIdentifier::Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle)
 {
-  NS_LOG_FUNCTION ( this << packet << (uint32_t)offset);
-  
-  Ptr<Packet> p = packet->Copy();
-  
-  p->RemoveAtStart(offset);
-  
+  NS_LOG_FUNCTION (this);
+
   Ipv6MobilityOptionMobileNodeIdentifierHeader nai;
-  
-  p->RemoveHeader(nai);
-  
+
+  nai.Deserialize (start);
+
   if ( nai.GetSubtype() == 1 ) //Network Address Identifier
     {
 	  bundle.SetMnIdentifier(nai.GetNodeIdentifier());
 	}
-  
-  return nai.GetSerializedSize();
+
+  return nai.GetSerializedSize ();
 }
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityOptionHomeNetworkPrefix);
@@ -313,21 +316,17 @@ uint8_t Ipv6MobilityOptionHomeNetworkPrefix::GetMobilityOptionNumber () const
   return OPT_NUMBER;
 }
 
-uint8_t Ipv6MobilityOptionHomeNetworkPrefix::Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle)
+uint8_t Ipv6MobilityOptionHomeNetworkPrefix::Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle)
 {
-  NS_LOG_FUNCTION ( this << packet );
-  
-  Ptr<Packet> p = packet->Copy();
-  
-  p->RemoveAtStart(offset);
-  
+  NS_LOG_FUNCTION (this);
+
   Ipv6MobilityOptionHomeNetworkPrefixHeader hnp;
-  
-  p->RemoveHeader(hnp);
-  
+
+  hnp.Deserialize (start);
+
   bundle.AddHomeNetworkPrefix(hnp.GetPrefix());
- 
-  return hnp.GetSerializedSize();
+
+  return hnp.GetSerializedSize ();
 }
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityOptionHandoffIndicator);
@@ -352,21 +351,17 @@ uint8_t Ipv6MobilityOptionHandoffIndicator::GetMobilityOptionNumber () const
   return OPT_NUMBER;
 }
 
-uint8_t Ipv6MobilityOptionHandoffIndicator::Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle)
+uint8_t Ipv6MobilityOptionHandoffIndicator::Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle)
 {
-  NS_LOG_FUNCTION ( this << packet );
-  
+  NS_LOG_FUNCTION (this);
+
   Ipv6MobilityOptionHandoffIndicatorHeader hi;
-  
-  Ptr<Packet> p = packet->Copy();
-  
-  p->RemoveAtStart(offset);
-  
-  p->RemoveHeader(hi);
-  
+
+  hi.Deserialize (start);
+
   bundle.SetHandoffIndicator(hi.GetHandoffIndicator());
- 
-  return hi.GetSerializedSize();
+
+  return hi.GetSerializedSize ();
 }
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityOptionAccessTechnologyType);
@@ -391,21 +386,17 @@ uint8_t Ipv6MobilityOptionAccessTechnologyType::GetMobilityOptionNumber () const
   return OPT_NUMBER;
 }
 
-uint8_t Ipv6MobilityOptionAccessTechnologyType::Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle)
+uint8_t Ipv6MobilityOptionAccessTechnologyType::Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle)
 {
-  NS_LOG_FUNCTION ( this << packet );
-  
+  NS_LOG_FUNCTION (this);
+
   Ipv6MobilityOptionAccessTechnologyTypeHeader att;
-  
-  Ptr<Packet> p = packet->Copy();
-  
-  p->RemoveAtStart(offset);
-  
-  p->RemoveHeader(att);
-  
+
+  att.Deserialize (start);
+
   bundle.SetAccessTechnologyType(att.GetAccessTechnologyType());
- 
-  return att.GetSerializedSize();
+
+  return att.GetSerializedSize ();
 }
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityOptionMobileNodeLinkLayerIdentifier);
@@ -430,21 +421,17 @@ uint8_t Ipv6MobilityOptionMobileNodeLinkLayerIdentifier::GetMobilityOptionNumber
   return OPT_NUMBER;
 }
 
-uint8_t Ipv6MobilityOptionMobileNodeLinkLayerIdentifier::Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle)
+uint8_t Ipv6MobilityOptionMobileNodeLinkLayerIdentifier::Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle)
 {
-  NS_LOG_FUNCTION ( this << packet );
-  
-  Ptr<Packet> p = packet->Copy();
-  
-  p->RemoveAtStart(offset);
-  
+  NS_LOG_FUNCTION (this);
+
   Ipv6MobilityOptionMobileNodeLinkLayerIdentifierHeader mnllid;
-  
-  p->RemoveHeader(mnllid);
-  
+
+  mnllid.Deserialize (start);
+
   bundle.SetMnLinkIdentifier(mnllid.GetLinkLayerIdentifier());
- 
-  return mnllid.GetSerializedSize();
+
+  return mnllid.GetSerializedSize ();
 }
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityOptionLinkLocalAddress);
@@ -469,21 +456,17 @@ uint8_t Ipv6MobilityOptionLinkLocalAddress::GetMobilityOptionNumber () const
   return OPT_NUMBER;
 }
 
-uint8_t Ipv6MobilityOptionLinkLocalAddress::Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle)
+uint8_t Ipv6MobilityOptionLinkLocalAddress::Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle)
 {
-  NS_LOG_FUNCTION ( this << packet );
-  
-  Ptr<Packet> p = packet->Copy();
-  
-  p->RemoveAtStart(offset);
-  
+  NS_LOG_FUNCTION (this);
+
   Ipv6MobilityOptionLinkLocalAddressHeader lla;
-  
-  p->RemoveHeader(lla);
-  
+
+  lla.Deserialize (start);
+
   bundle.SetMagLinkAddress(lla.GetLinkLocalAddress());
- 
-  return lla.GetSerializedSize();
+
+  return lla.GetSerializedSize ();
 }
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityOptionTimestamp);
@@ -508,21 +491,55 @@ uint8_t Ipv6MobilityOptionTimestamp::GetMobilityOptionNumber () const
   return OPT_NUMBER;
 }
 
-uint8_t Ipv6MobilityOptionTimestamp::Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle)
+uint8_t Ipv6MobilityOptionTimestamp::Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle)
 {
-  NS_LOG_FUNCTION ( this << packet );
-  
-  Ptr<Packet> p = packet->Copy();
-  
-  p->RemoveAtStart(offset);
-  
+  NS_LOG_FUNCTION (this);
+
   Ipv6MobilityOptionTimestampHeader timestamp;
-  
-  p->RemoveHeader(timestamp);
-  
+
+  timestamp.Deserialize (start);
+
   bundle.SetTimestamp(timestamp.GetTimestamp());
- 
-  return timestamp.GetSerializedSize();
+
+  return timestamp.GetSerializedSize ();
+}
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityOptionLinkLayerAddress);
+
+TypeId Ipv6MobilityOptionLinkLayerAddress::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::Ipv6MobilityOptionLinkLayerAddress")
+    .SetParent<Ipv6MobilityOption>()
+	;
+  return tid;
+}
+
+Ipv6MobilityOptionLinkLayerAddress::~Ipv6MobilityOptionLinkLayerAddress()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+uint8_t Ipv6MobilityOptionLinkLayerAddress::GetMobilityOptionNumber () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  return OPT_NUMBER;
+}
+
+uint8_t Ipv6MobilityOptionLinkLayerAddress::Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ipv6MobilityOptionLinkLayerAddressHeader lla;
+
+  lla.Deserialize (start);
+
+  if (lla.GetOptionCode () == Ipv6MobilityHeader::OPT_LLA_NEW_ACCESS_POINT)
+    {
+      bundle.SetNewAccessPoint(lla.GetLinkLayerAddress());
+    }
+
+  return lla.GetSerializedSize ();
 }
 
 } /* namespace ns3 */
@@ -31,7 +31,9 @@
 #include "ns3/node.h"
 #include "ns3/ptr.h"
 #include "ns3/header.h"
+#include "ns3/buffer.h"
 #include "ns3/ipv6-address.h"
+#include "ns3/mac48-address.h"
 #include "ns3/nstime.h"
 #include "ns3/identifier.h"
 
@@ -76,12 +78,12 @@ public:
   /**
    * \brief Process method
    *
-   * Called from Ipv6MobilityL4Protocol::Receive.
-   * \param packet the packet
+   * Called from Ipv6Mobility::ProcessOptions.
+   * \param start iterator on the option, inside the packet buffer
    * \param bundle bundle of all option data
    * \return the processed size
    */
-  virtual uint8_t Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle) = 0;
+  virtual uint8_t Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle) = 0;
   
 private:
   /**
@@ -117,6 +119,9 @@ public:
   Time GetTimestamp() const;
   void SetTimestamp(Time tm);
   
+  Mac48Address GetNewAccessPoint() const;
+  void SetNewAccessPoint(Mac48Address ap);
+  
 protected:
 private:
   //for PMIPv6
@@ -127,6 +132,9 @@ private:
   uint8_t m_accessTechnologyType;
   uint8_t m_handoffIndicator;
   Time m_timestamp;
+  
+  //for PFMIPv6
+  Mac48Address m_newAccessPoint;
 };
 
 /**
@@ -158,12 +166,12 @@ public:
   /**
    * \brief Process method
    *
-   * Called from Ipv6MobilityL4Protocol::Receive.
-   * \param packet the packet
+   * Called from Ipv6Mobility::ProcessOptions.
+   * \param start iterator on the option, inside the packet buffer
    * \param bundle bundle of all option data
    * \return the processed size
    */
-  virtual uint8_t Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle);
+  virtual uint8_t Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle);
   
 private:
 };
@@ -197,12 +205,12 @@ public:
   /**
    * \brief Process method
    *
-   * Called from Ipv6MobilityL4Protocol::Receive.
-   * \param packet the packet
+   * Called from Ipv6Mobility::ProcessOptions.
+   * \param start iterator on the option, inside the packet buffer
    * \param bundle bundle of all option data
    * \return the processed size
    */
-  virtual uint8_t Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle);
+  virtual uint8_t Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle);
   
 private:
 };
@@ -236,12 +244,12 @@ public:
   /**
    * \brief Process method
    *
-   * Called from Ipv6MobilityL4Protocol::Receive.
-   * \param packet the packet
+   * Called from Ipv6Mobility::ProcessOptions.
+   * \param start iterator on the option, inside the packet buffer
    * \param bundle bundle of all option data
    * \return the processed size
    */
-  virtual uint8_t Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle);
+  virtual uint8_t Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle);
   
 private:
 };
@@ -275,12 +283,12 @@ public:
   /**
    * \brief Process method
    *
-   * Called from Ipv6MobilityL4Protocol::Receive.
-   * \param packet the packet
+   * Called from Ipv6Mobility::ProcessOptions.
+   * \param start iterator on the option, inside the packet buffer
    * \param bundle bundle of all option data
    * \return the processed size
    */
-  virtual uint8_t Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle);
+  virtual uint8_t Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle);
   
 private:
 };
@@ -314,12 +322,12 @@ public:
   /**
    * \brief Process method
    *
-   * Called from Ipv6MobilityL4Protocol::Receive.
-   * \param packet the packet
+   * Called from Ipv6Mobility::ProcessOptions.
+   * \param start iterator on the option, inside the packet buffer
    * \param bundle bundle of all option data
    * \return the processed size
    */
-  virtual uint8_t Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle);
+  virtual uint8_t Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle);
   
 private:
 };
@@ -353,12 +361,12 @@ public:
   /**
    * \brief Process method
    *
-   * Called from Ipv6MobilityL4Protocol::Receive.
-   * \param packet the packet
+   * Called from Ipv6Mobility::ProcessOptions.
+   * \param start iterator on the option, inside the packet buffer
    * \param bundle bundle of all option data
    * \return the processed size
    */
-  virtual uint8_t Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle);
+  virtual uint8_t Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle);
   
 private:
 };
@@ -392,12 +400,12 @@ public:
   /**
    * \brief Process method
    *
-   * Called from Ipv6MobilityL4Protocol::Receive.
-   * \param packet the packet
+   * Called from Ipv6Mobility::ProcessOptions.
+   * \param start iterator on the option, inside the packet buffer
    * \param bundle bundle of all option data
    * \return the processed size
    */
-  virtual uint8_t Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle);
+  virtual uint8_t Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle);
   
 private:
 };
@@ -431,12 +439,12 @@ public:
   /**
    * \brief Process method
    *
-   * Called from Ipv6MobilityL4Protocol::Receive.
-   * \param packet the packet
+   * Called from Ipv6Mobility::ProcessOptions.
+   * \param start iterator on the option, inside the packet buffer
    * \param bundle bundle of all option data
    * \return the processed size
    */
-  virtual uint8_t Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle);
+  virtual uint8_t Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle);
   
 private:
 };
@@ -470,12 +478,51 @@ public:
   /**
    * \brief Process method
    *
-   * Called from Ipv6MobilityL4Protocol::Receive.
-   * \param packet the packet
+   * Called from Ipv6Mobility::ProcessOptions.
+   * \param start iterator on the option, inside the packet buffer
+   * \param bundle bundle of all option data
+   * \return the processed size
+   */
+  virtual uint8_t Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle);
+  
+private:
+};
+
+/**
+ * \class Ipv6MobilityOptionLinkLayerAddress
+ * \brief Ipv6 Mobility Option 
+ */
+class Ipv6MobilityOptionLinkLayerAddress : public Ipv6MobilityOption
+{
+public:
+  static const uint8_t OPT_NUMBER = 7;
+  
+  /**
+   * \brief Get the type identificator.
+   * \return type identificator
+   */
+  static TypeId GetTypeId (void);
+  
+  /**
+   * \brief Destructor.
+   */
+  virtual ~Ipv6MobilityOptionLinkLayerAddress ();
+  
+  /**
+   * \brief Get the option number.
+   * \return option number
+   */
+  virtual uint8_t GetMobilityOptionNumber () const;
+  
+  /**
+   * \brief Process method
+   *
+   * Called from Ipv6Mobility::ProcessOptions.
+   * \param start iterator on the option, inside the packet buffer
    * \param bundle bundle of all option data
    * \return the processed size
    */
-  virtual uint8_t Process (Ptr<Packet> packet, uint8_t offset, Ipv6MobilityOptionBundle& bundle);
+  virtual uint8_t Process (Buffer::Iterator start, Ipv6MobilityOptionBundle& bundle);
   
 private:
 };
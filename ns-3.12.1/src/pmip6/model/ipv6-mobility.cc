@@ -74,56 +74,62 @@ Ptr<Node> Ipv6Mobility::GetNode () const
   return m_node;
 }
 
-uint8_t Ipv6Mobility::ProcessOptions(Ptr<Packet> packet, uint8_t offset, uint8_t length, Ipv6MobilityOptionBundle &bundle)
+uint32_t Ipv6Mobility::ProcessOptions (Buffer::Iterator start, uint32_t length, Ipv6MobilityOptionBundle &bundle)
 {
-  NS_LOG_FUNCTION (this << packet << length);
-  Ptr<Packet> p = packet->Copy ();
-  p->RemoveAtStart(offset);
-  
-  Ptr<Ipv6MobilityOptionDemux> ipv6MobilityOptionDemux = GetNode()->GetObject<Ipv6MobilityOptionDemux>();
-  NS_ASSERT(ipv6MobilityOptionDemux != 0);
-  
+  NS_LOG_FUNCTION (this << length);
+
+  Ptr<Ipv6MobilityOptionDemux> ipv6MobilityOptionDemux = GetNode ()->GetObject<Ipv6MobilityOptionDemux> ();
+  NS_ASSERT (ipv6MobilityOptionDemux != 0);
+
+  Buffer::Iterator i = start;
   Ptr<Ipv6MobilityOption> ipv6MobilityOption = 0;
-  
-  uint8_t processedSize = 0;
-  uint32_t size = p->GetSize ();
-  uint8_t *data = new uint8_t[size];
-  p->CopyData (data, size);
-  
+  uint32_t processed = 0;
   uint8_t optType;
-  uint8_t optLen;
+  uint16_t optLen;
 
-  while ( processedSize < length )
+  while (processed < length)
     {
-      optType = *(data + processedSize);
-	  
-	  ipv6MobilityOption = ipv6MobilityOptionDemux -> GetOption ( optType );
-	  
-	  if ( ipv6MobilityOption == 0 )
-	    {
-		  if ( optType == 0 )
-		    {
-			  optLen = 1;
-			}
-		  else
-		    {
-			  optLen = *(data + processedSize + 1) + 2;
-			}
-			
-		  NS_LOG_LOGIC("No matched Ipv6MobilityOption for type=" << (uint32_t)optType );
-		}
-	  else
-	    {
-		  optLen = ipv6MobilityOption -> Process (packet, offset + processedSize, bundle);
-		}
-	  
-	  processedSize += optLen;
-	  p->RemoveAtStart(optLen);
+      optType = i.ReadU8 ();
+
+      if (optType == Ipv6MobilityHeader::IPV6_MOBILITY_OPT_PAD1)
+        {
+          optLen = 1;
+        }
+      else if (length - processed < 2)
+        {
+          NS_LOG_LOGIC ("Option type=" << (uint32_t)optType << " without length");
+          break;
+        }
+      else
+        {
+          optLen = i.ReadU8 () + 2;
+          i.Prev ();
+        }
+      i.Prev ();
+
+      /* a truncated option ends the walk before it is dispatched */
+      if (optLen > length - processed)
+        {
+          NS_LOG_LOGIC ("Option type=" << (uint32_t)optType << " overruns the options");
+          break;
+        }
+
+      ipv6MobilityOption = ipv6MobilityOptionDemux->GetOption (optType);
+
+      if (ipv6MobilityOption == 0)
+        {
+          NS_LOG_LOGIC ("No matched Ipv6MobilityOption for type=" << (uint32_t)optType);
+        }
+      else
+        {
+          ipv6MobilityOption->Process (i, bundle);
+        }
+
+      i.Next (optLen);
+      processed += optLen;
     }
 
-  delete [] data;
-  
-  return processedSize;
+  return processed;
 }
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityBindingUpdate);
@@ -151,13 +157,11 @@ uint8_t Ipv6MobilityBindingUpdate::Process (Ptr<Packet> p, Ipv6Address src, Ipv6
 {
   NS_LOG_FUNCTION_NOARGS();
 
-  Ptr<Packet> packet = p->Copy();
-  
   Ipv6MobilityBindingUpdateHeader buh;
   Ipv6MobilityOptionBundle bundle;
   
   /* Proxy Mobile Ipv6 process routine */
-  packet->RemoveHeader(buh);
+  p->PeekHeader(buh);
 
   if(buh.GetFlagP())
     {
@@ -177,9 +181,9 @@ uint8_t Ipv6MobilityBindingUpdate::Process (Ptr<Packet> p, Ipv6Address src, Ipv6
   Ptr<Ipv6Mobility> ipv6Mobility = ipv6MobilityDemux->GetMobility(buh.GetMhType());
   NS_ASSERT( ipv6Mobility );
 
-  uint8_t length = ((buh.GetHeaderLen() + 1 ) << 3) - buh.GetOptionsOffset();
+  Buffer options = buh.GetOptionBuffer();
   
-  ipv6Mobility->ProcessOptions ( packet, buh.GetOptionsOffset(), length, bundle);
+  ipv6Mobility->ProcessOptions ( options.Begin(), options.GetSize(), bundle);
 
   NS_LOG_LOGIC(" No Handler for Binding Update");
   
@@ -211,13 +215,11 @@ uint8_t Ipv6MobilityBindingAck::Process (Ptr<Packet> p, Ipv6Address src, Ipv6Add
 {
   NS_LOG_FUNCTION_NOARGS();
   
-  Ptr<Packet> packet = p->Copy();
-  
   Ipv6MobilityBindingAckHeader bah;
   Ipv6MobilityOptionBundle bundle;
   
   /* Proxy Mobile Ipv6 process routine */
-  packet->PeekHeader(bah);
+  p->PeekHeader(bah);
   
   if(bah.GetFlagP())
     {
@@ -237,13 +239,107 @@ uint8_t Ipv6MobilityBindingAck::Process (Ptr<Packet> p, Ipv6Address src, Ipv6Add
   Ptr<Ipv6Mobility> ipv6Mobility = ipv6MobilityDemux->GetMobility(bah.GetMhType());
   NS_ASSERT( ipv6Mobility );
 
-  uint8_t length = ((bah.GetHeaderLen() + 1 ) << 3) - bah.GetOptionsOffset();
+  Buffer options = bah.GetOptionBuffer();
   
-  ipv6Mobility->ProcessOptions ( packet, bah.GetOptionsOffset(), length, bundle);
+  ipv6Mobility->ProcessOptions ( options.Begin(), options.GetSize(), bundle);
 
   NS_LOG_LOGIC(" No Handler for Binding Ack");
   
   return 0;
 }
 
+NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityHandoverInitiate);
+
+TypeId Ipv6MobilityHandoverInitiate::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::Ipv6MobilityHandoverInitiate")
+    .SetParent<Ipv6Mobility>()
+	.AddConstructor<Ipv6MobilityHandoverInitiate>()
+	;
+  return tid;
+}
+
+Ipv6MobilityHandoverInitiate::~Ipv6MobilityHandoverInitiate()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+uint8_t Ipv6MobilityHandoverInitiate::GetMobilityNumber () const
+{
+  return MOB_NUMBER;
+}
+
+uint8_t Ipv6MobilityHandoverInitiate::Process (Ptr<Packet> p, Ipv6Address src, Ipv6Address dst, Ptr<Ipv6Interface> interface)
+{
+  NS_LOG_FUNCTION_NOARGS();
+  
+  Ipv6MobilityHandoverInitiateHeader hih;
+  
+  /* Proxy Mobile Ipv6 process routine */
+  p->PeekHeader(hih);
+  
+  if(hih.GetFlagP())
+    {
+      Ptr<Pmipv6Agent> pmip6 = GetNode()->GetObject<Pmipv6Agent>();
+      
+      if( pmip6 )
+        {
+          Simulator::ScheduleNow( &Pmipv6Agent::Receive, pmip6, p, src, dst, interface);
+          
+          return 0;
+        }
+    }
+
+  NS_LOG_LOGIC(" No Handler for Handover Initiate");
+  
+  return 0;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv6MobilityHandoverAck);
+
+TypeId Ipv6MobilityHandoverAck::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::Ipv6MobilityHandoverAck")
+    .SetParent<Ipv6Mobility>()
+	.AddConstructor<Ipv6MobilityHandoverAck>()
+	;
+  return tid;
+}
+
+Ipv6MobilityHandoverAck::~Ipv6MobilityHandoverAck()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+uint8_t Ipv6MobilityHandoverAck::GetMobilityNumber () const
+{
+  return MOB_NUMBER;
+}
+
+uint8_t Ipv6MobilityHandoverAck::Process (Ptr<Packet> p, Ipv6Address src, Ipv6Address dst, Ptr<Ipv6Interface> interface)
+{
+  NS_LOG_FUNCTION_NOARGS();
+  
+  Ipv6MobilityHandoverAckHeader hah;
+  
+  /* Proxy Mobile Ipv6 process routine */
+  p->PeekHeader(hah);
+  
+  if(hah.GetFlagP())
+    {
+      Ptr<Pmipv6Agent> pmip6 = GetNode()->GetObject<Pmipv6Agent>();
+      
+      if( pmip6 )
+        {
+          Simulator::ScheduleNow( &Pmipv6Agent::Receive, pmip6, p, src, dst, interface);
+          
+          return 0;
+        }
+    }
+
+  NS_LOG_LOGIC(" No Handler for Handover Acknowledge");
+  
+  return 0;
+}
+
 } /* namespace ns3 */
@@ -31,6 +31,7 @@
 #include "ns3/node.h"
 #include "ns3/ptr.h"
 #include "ns3/header.h"
+#include "ns3/buffer.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6-interface.h"
 
@@ -84,7 +85,18 @@ public:
    */
   virtual uint8_t Process (Ptr<Packet> p, Ipv6Address src, Ipv6Address dst, Ptr<Ipv6Interface> interface) = 0;
   
-  virtual uint8_t ProcessOptions (Ptr<Packet> packet, uint8_t offset, uint8_t length, Ipv6MobilityOptionBundle &bundle);
+  /**
+   * \brief Walk the mobility options of a message.
+   *
+   * Each option is checked to fit in the options before it is handed to
+   * its handler, which reads it where it lies.
+   * \param start iterator on the first option, from the option buffer of
+   * the deserialized mobility header
+   * \param length length of the options
+   * \param bundle the bundle to fill
+   * \return the length of the options walked
+   */
+  virtual uint32_t ProcessOptions (Buffer::Iterator start, uint32_t length, Ipv6MobilityOptionBundle &bundle);
   
 private:
   /**
@@ -179,6 +191,90 @@ private:
 
 };
 
+/**
+ * \class Ipv6MobilityHandoverInitiate
+ * \brief Ipv6 Mobility Handover Initiate (RFC5949)
+ *
+ * Messages with the P flag are handed to the PMIPv6 agent of the node.
+ */
+class Ipv6MobilityHandoverInitiate : public Ipv6Mobility
+{
+public:
+  static const uint8_t MOB_NUMBER = 14;
+
+  /**
+   * \brief Get the type identificator.
+   * \return type identificator
+   */
+  static TypeId GetTypeId (void);
+  
+  /**
+   * \brief Destructor.
+   */
+  virtual ~Ipv6MobilityHandoverInitiate ();
+  
+  /**
+   * \brief Get the option number.
+   * \return option number
+   */
+  virtual uint8_t GetMobilityNumber () const;
+  
+  /**
+   * \brief Process method
+   *
+   * Called from Ipv6MobilityL4Protocol::Receive.
+   * \param packet the packet
+   * \param offset the offset of the extension to process
+   * \return the processed size
+   */
+  virtual uint8_t Process (Ptr<Packet> p, Ipv6Address src, Ipv6Address dst, Ptr<Ipv6Interface> interface);
+  
+private:
+
+};
+
+/**
+ * \class Ipv6MobilityHandoverAck
+ * \brief Ipv6 Mobility Handover Acknowledge (RFC5949)
+ *
+ * Messages with the P flag are handed to the PMIPv6 agent of the node.
+ */
+class Ipv6MobilityHandoverAck : public Ipv6Mobility
+{
+public:
+  static const uint8_t MOB_NUMBER = 15;
+
+  /**
+   * \brief Get the type identificator.
+   * \return type identificator
+   */
+  static TypeId GetTypeId (void);
+  
+  /**
+   * \brief Destructor.
+   */
+  virtual ~Ipv6MobilityHandoverAck ();
+  
+  /**
+   * \brief Get the option number.
+   * \return option number
+   */
+  virtual uint8_t GetMobilityNumber () const;
+  
+  /**
+   * \brief Process method
+   *
+   * Called from Ipv6MobilityL4Protocol::Receive.
+   * \param packet the packet
+   * \param offset the offset of the extension to process
+   * \return the processed size
+   */
+  virtual uint8_t Process (Ptr<Packet> p, Ipv6Address src, Ipv6Address dst, Ptr<Ipv6Interface> interface);
+  
+private:
+
+};
+
 } /* namespace ns3 */
 
 #endif /* IPV6_MOBILITY_H */
@@ -45,8 +45,16 @@ TypeId Ipv6StaticSourceRouting::GetTypeId ()
   return tid;
 }
 
+Ipv6StaticSourceRouting::SourceRoute::SourceRoute (const Ipv6RoutingTableEntry &entry, uint32_t metric)
+  : m_entry (entry),
+    m_metric (metric),
+    m_index (0)
+{
+}
+
 Ipv6StaticSourceRouting::Ipv6StaticSourceRouting ()
-  : m_ipv6 (0)
+  : m_routeGeneration (0),
+    m_ipv6 (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -91,33 +99,50 @@ void Ipv6StaticSourceRouting::AddHostRouteFrom (Ipv6Address src, uint32_t interf
 void Ipv6StaticSourceRouting::AddNetworkRouteFrom (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface, uint32_t metric)
 {
   NS_LOG_FUNCTION (this << network << networkPrefix << nextHop << interface << metric);
-  Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
-  *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface);
-  m_networkRoutes.push_back (std::make_pair (route, metric));
+  AddRoute (Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface), metric);
 }
 
 void Ipv6StaticSourceRouting::AddNetworkRouteFrom (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
 {
   NS_LOG_FUNCTION (this << network << networkPrefix << nextHop << interface << prefixToUse << metric);
-  Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
-  *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface, prefixToUse);
-  m_networkRoutes.push_back (std::make_pair (route, metric));
+  AddRoute (Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface, prefixToUse), metric);
 }
 
 void Ipv6StaticSourceRouting::AddNetworkRouteFrom (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface, uint32_t metric)
 {
   NS_LOG_FUNCTION (this << network << networkPrefix << interface);
-  Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
-  *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface);
-  m_networkRoutes.push_back (std::make_pair (route, metric));
+  AddRoute (Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface), metric);
+}
+
+void Ipv6StaticSourceRouting::AddRoute (const Ipv6RoutingTableEntry &entry, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << metric);
+  SourceRoute *route = new SourceRoute (entry, metric);
+
+  route->m_index = m_networkRoutes.size ();
+  m_networkRoutes.push_back (route);
+  m_prefixTable.Add (route->m_entry.GetDestNetwork (), route->m_entry.GetDestNetworkPrefix (), route);
+  m_routeGeneration++;
+}
+
+void Ipv6StaticSourceRouting::DeleteRoute (SourceRoute *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  m_prefixTable.Remove (route->m_entry.GetDestNetwork (), route->m_entry.GetDestNetworkPrefix (), route);
+
+  /* keep indexes dense: the last route takes the freed slot */
+  SourceRoute *last = m_networkRoutes.back ();
+  m_networkRoutes[route->m_index] = last;
+  last->m_index = route->m_index;
+  m_networkRoutes.pop_back ();
+  m_routeGeneration++;
+
+  delete route;
 }
 
 Ptr<Ipv6Route> Ipv6StaticSourceRouting::LookupStatic (Ipv6Address src, Ipv6Address dst)
 {
   NS_LOG_FUNCTION (this << src << dst);
-  Ptr<Ipv6Route> rtentry = 0;
-  uint16_t longestMask = 0;
-  uint32_t shortestMetric = 0xffffffff;
 
   /* when sending on link-local multicast, there have to be interface specified */
   if (src == Ipv6Address::GetAllNodesMulticast () || src.IsSolicitedMulticast () || 
@@ -126,67 +151,56 @@ Ptr<Ipv6Route> Ipv6StaticSourceRouting::LookupStatic (Ipv6Address src, Ipv6Addre
       return 0;
     }
 
-  for (NetworkRoutesI it = m_networkRoutes.begin () ; it != m_networkRoutes.end () ; it++)
+  /* longest prefix first, so the first table holding src wins */
+  const std::vector<uint8_t> &prefixLengths = m_prefixTable.GetPrefixLengths ();
+  for (std::vector<uint8_t>::const_iterator it = prefixLengths.begin () ; it != prefixLengths.end () ; it++)
     {
-      Ipv6RoutingTableEntry* j = it->first;
-      uint32_t metric = it->second;
-      Ipv6Prefix mask = j->GetDestNetworkPrefix ();
-      uint16_t maskLen = mask.GetPrefixLength ();
-      Ipv6Address entry = j->GetDestNetwork ();
+      NS_LOG_LOGIC ("Searching for route from " << src << ", mask length " << (uint16_t)*it);
 
-      NS_LOG_LOGIC ("Searching for route from " << src << ", mask length " << maskLen << ", metric " << metric);
+      RouteBucket *routes = m_prefixTable.Find (src, *it);
+      if (routes == 0)
+        {
+          continue;
+        }
 
-      if (mask.IsMatch (src, entry))
+      /* equal mask length: lowest metric, the latest route on a tie */
+      SourceRoute *best = 0;
+      for (RouteBucketI j = routes->begin () ; j != routes->end () ; j++)
         {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << maskLen << ", metric " << metric);
-
-		  if (maskLen < longestMask)
-			{
-			  NS_LOG_LOGIC ("Previous match longer, skipping");
-			  continue;
-			}
-
-		  if (maskLen > longestMask)
-			{
-			  shortestMetric = 0xffffffff;
-			}
-
-		  longestMask = maskLen;
-		  if (metric > shortestMetric)
-			{
-			  NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
-			  continue;
-			}
-
-		  shortestMetric = metric;
-		  Ipv6RoutingTableEntry* route = j;
-		  uint32_t interfaceIdx = route->GetInterface ();
-		  rtentry = Create<Ipv6Route> ();
-
-		  rtentry->SetSource (route->GetDest());
-		  rtentry->SetDestination (dst);
-		  rtentry->SetGateway (route->GetGateway ());
-		  rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
+          if (best == 0 || (*j)->m_metric <= best->m_metric)
+            {
+              best = *j;
+            }
         }
-    }
+      NS_LOG_LOGIC ("Found global network route " << best << ", mask length " << (uint16_t)*it << ", metric " << best->m_metric);
+
+      /* the route goes along with the packet: never hand out one shared with other lookups */
+      Ipv6RoutingTableEntry* route = &best->m_entry;
+      Ptr<Ipv6Route> rtentry = Create<Ipv6Route> ();
+      rtentry->SetSource (route->GetDest ());
+      rtentry->SetDestination (dst);
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv6->GetNetDevice (route->GetInterface ()));
 
-  if(rtentry)
-    {
       NS_LOG_LOGIC ("Matching route via " << rtentry->GetDestination () << " (throught " << rtentry->GetGateway () << ") at the end");
+      return rtentry;
     }
-  return rtentry;
+
+  return 0;
 }
 
 void Ipv6StaticSourceRouting::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  for (NetworkRoutesI j = m_networkRoutes.begin () ;  j != m_networkRoutes.end () ; j = m_networkRoutes.erase (j))
+  for (NetworkRoutesI j = m_networkRoutes.begin () ;  j != m_networkRoutes.end () ; j++)
     {
-      delete j->first;
+      delete *j;
     }
   m_networkRoutes.clear ();
 
+  m_prefixTable.Clear ();
+
   m_ipv6 = 0;
   Ipv6RoutingProtocol::DoDispose ();
 }
@@ -196,72 +210,49 @@ uint32_t Ipv6StaticSourceRouting::GetNRoutes ()
   return m_networkRoutes.size ();
 }
 
+uint32_t Ipv6StaticSourceRouting::GetRouteGeneration () const
+{
+  return m_routeGeneration;
+}
+
 Ipv6RoutingTableEntry Ipv6StaticSourceRouting::GetRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
-  uint32_t tmp = 0;
-
-  for (NetworkRoutesI it = m_networkRoutes.begin () ; it != m_networkRoutes.end () ; it++)
-    {
-      if (tmp == index)
-        {
-          return it->first;
-        }
-      tmp++;
-    }
-  NS_ASSERT (false);
-  // quiet compiler.
-  return 0;
+  NS_ASSERT (index < m_networkRoutes.size ());
+  return m_networkRoutes[index]->m_entry;
 }
 
 uint32_t Ipv6StaticSourceRouting::GetMetric (uint32_t index)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  uint32_t tmp = 0;
-
-  for (NetworkRoutesI it = m_networkRoutes.begin () ; it != m_networkRoutes.end () ; it++)
-    {
-      if (tmp == index)
-        {
-          return it->second;
-        }
-      tmp++;
-    }
-  NS_ASSERT (false);
-  // quiet compiler.
-  return 0;
+  NS_ASSERT (index < m_networkRoutes.size ());
+  return m_networkRoutes[index]->m_metric;
 }
 
 void Ipv6StaticSourceRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
-  uint32_t tmp = 0;
-
-  for (NetworkRoutesI it = m_networkRoutes.begin () ; it != m_networkRoutes.end () ; it++)
-    {
-      if (tmp == index)
-        {
-          delete it->first;
-          m_networkRoutes.erase (it);
-          return;
-        }
-      tmp++;
-    }
-  NS_ASSERT (false);
+  NS_ASSERT (index < m_networkRoutes.size ());
+  DeleteRoute (m_networkRoutes[index]);
 }
 
 void Ipv6StaticSourceRouting::RemoveRoute (Ipv6Address network, Ipv6Prefix prefix, uint32_t ifIndex, Ipv6Address prefixToUse)
 {
   NS_LOG_FUNCTION (this << network << prefix << ifIndex);
+  RouteBucket *routes = m_prefixTable.Find (network, prefix.GetPrefixLength ());
 
-  for (NetworkRoutesI it = m_networkRoutes.begin () ; it != m_networkRoutes.end () ; it++)
+  if (routes == 0)
     {
-      Ipv6RoutingTableEntry* rtentry = it->first;
+      return;
+    }
+
+  for (RouteBucketI it = routes->begin () ; it != routes->end () ; it++)
+    {
+      Ipv6RoutingTableEntry* rtentry = &(*it)->m_entry;
       if (network == rtentry->GetDest () && rtentry->GetInterface () == ifIndex && 
           rtentry->GetPrefixToUse () == prefixToUse)
         {
-          delete it->first;
-          m_networkRoutes.erase (it);
+          DeleteRoute (*it);
           return;
         }
     }
@@ -310,28 +301,20 @@ bool Ipv6StaticSourceRouting::RouteInput (Ptr<const Packet> p, const Ipv6Header
   // a packet to one of our other interface addresses; that is, the
   // destination unicast address does not match one of the iif addresses,
   // but we check our other interfaces.  This could be an option
-  // (to remove the outer loop immediately below and just check iif).
-  for (uint32_t j = 0; j < m_ipv6->GetNInterfaces (); j++)
+  // (to check only the iif addresses instead of the whole stack).
+  int32_t j = m_ipv6->GetInterfaceForAddress (dst);
+  if (j >= 0)
     {
-      for (uint32_t i = 0; i < m_ipv6->GetNAddresses (j); i++)
+      if (static_cast<uint32_t> (j) == iif)
         {
-          Ipv6InterfaceAddress iaddr = m_ipv6->GetAddress (j, i);
-          Ipv6Address addr = iaddr.GetAddress ();
-          if (addr.IsEqual (dst))
-            {
-              if (j == iif)
-                {
-                  NS_LOG_LOGIC ("For me (destination " << addr << " match)");
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("For me (destination " << addr << " match) on another interface " << dst );
-                }
-              lcb (p, header, iif);
-              return true;
-            }
-          NS_LOG_LOGIC ("Address "<< addr << " not a match");
+          NS_LOG_LOGIC ("For me (destination " << dst << " match)");
+        }
+      else
+        {
+          NS_LOG_LOGIC ("For me (destination " << dst << " match) on another interface " << j);
         }
+      lcb (p, header, iif);
+      return true;
     }
   // Check if input device supports IP forwarding
   if (m_ipv6->IsForwarding (iif) == false)
@@ -365,16 +348,13 @@ void Ipv6StaticSourceRouting::NotifyInterfaceDown (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
   uint32_t j = 0;
-  uint32_t max = GetNRoutes ();
 
   /* remove all static routes that are going through this interface */
-  while (j < max)
+  while (j < m_networkRoutes.size ())
     {
-      Ipv6RoutingTableEntry route = GetRoute (j);
-
-      if (route.GetInterface () == i)
+      if (m_networkRoutes[j]->m_entry.GetInterface () == i)
         {
-          RemoveRoute (j);
+          DeleteRoute (m_networkRoutes[j]);
         }
       else
         {
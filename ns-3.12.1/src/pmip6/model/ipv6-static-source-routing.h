@@ -28,12 +28,15 @@
 #include <stdint.h>
 
 #include <list>
+#include <vector>
 
 #include "ns3/ptr.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/ipv6-routing-table-entry.h"
+#include "ns3/ipv6-prefix-table.h"
 
 namespace ns3
 {
@@ -43,7 +46,6 @@ class NetDevice;
 class Ipv6Interface;
 class Ipv6Route;
 class Node;
-class Ipv6RoutingTableEntry;
 class Ipv6MulticastRoutingTableEntry;
 
 /**
@@ -54,6 +56,12 @@ class Ipv6MulticastRoutingTableEntry;
  * \ingroup Ipv6StaticSourceRouting
  * \class Ipv6StaticSourceRouting
  * \brief Static routing protocol for IP version 6 stack.
+ *
+ * Routes are selected by the source address of the packet. They are
+ * kept in one hash table per prefix length, so a lookup costs at most
+ * one hash probe per distinct prefix length in use, whatever the number
+ * of routes. Each route caches the Ipv6Route handed to the forwarding
+ * path. Removing a route by index moves the last route into its slot.
  * \see Ipv6RoutingProtocol
  * \see Ipv6ListRouting
  */
@@ -172,6 +180,7 @@ public:
   virtual void NotifyAddRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse = Ipv6Address::GetZero ());
   virtual void NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse = Ipv6Address::GetZero ());
   virtual void SetIpv6 (Ptr<Ipv6> ipv6);
+  virtual uint32_t GetRouteGeneration () const;
 
 protected:
   /**
@@ -180,9 +189,49 @@ protected:
   void DoDispose ();
 
 private:
-  typedef std::list<std::pair <Ipv6RoutingTableEntry *, uint32_t> > NetworkRoutes;
-  typedef std::list<std::pair <Ipv6RoutingTableEntry *, uint32_t> >::const_iterator NetworkRoutesCI;
-  typedef std::list<std::pair <Ipv6RoutingTableEntry *, uint32_t> >::iterator NetworkRoutesI;
+  /**
+   * \class SourceRoute
+   * \brief A source route, its metric and its position in the table.
+   */
+  class SourceRoute
+  {
+public:
+    SourceRoute (const Ipv6RoutingTableEntry &entry, uint32_t metric);
+
+    /**
+     * \brief The routing table entry.
+     */
+    Ipv6RoutingTableEntry m_entry;
+
+    /**
+     * \brief Metric of the route.
+     */
+    uint32_t m_metric;
+
+    /**
+     * \brief Position in m_networkRoutes.
+     */
+    uint32_t m_index;
+  };
+
+  typedef std::vector<SourceRoute *> NetworkRoutes;
+  typedef std::vector<SourceRoute *>::iterator NetworkRoutesI;
+
+  typedef Ipv6PrefixTable<SourceRoute>::Bucket RouteBucket;
+  typedef Ipv6PrefixTable<SourceRoute>::BucketI RouteBucketI;
+
+  /**
+   * \brief Insert a route in the forwarding table.
+   * \param entry routing table entry
+   * \param metric metric of the route
+   */
+  void AddRoute (const Ipv6RoutingTableEntry &entry, uint32_t metric);
+
+  /**
+   * \brief Unlink a route from the forwarding table and free it.
+   * \param route the route
+   */
+  void DeleteRoute (SourceRoute *route);
 
   /**
    * \brief Lookup in the forwarding table for destination.
@@ -194,10 +243,20 @@ private:
 
 
   /**
-   * \brief the forwarding table for network.
+   * \brief the forwarding table for network, in index order.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief Routes indexed by source network.
+   */
+  Ipv6PrefixTable<SourceRoute> m_prefixTable;
+
+  /**
+   * \brief Routing table generation, changes with every route added or removed.
+   */
+  uint32_t m_routeGeneration;
+
   /**
    * \brief Ipv6 reference.
    */
@@ -30,6 +30,7 @@
 #include "ns3/packet.h"
 #include "ns3/node.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/ipv6-routing-protocol.h"
 #include "ns3/ipv6-route.h"
 #include "ns3/wifi-net-device.h"
@@ -60,12 +61,19 @@ TypeId Ipv6TunnelL4Protocol::GetTypeId ()
   static TypeId tid = TypeId ("ns3::Ipv6TunnelL4Protocol")
     .SetParent<Ipv6L4Protocol> ()
     .AddConstructor<Ipv6TunnelL4Protocol> ()
+    .AddAttribute ("RouteCacheSize", "Maximum number of routes cached for decapsulated packets, 0 disables the cache.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&Ipv6TunnelL4Protocol::m_routeCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
     ;
   return tid;
 }
 
 Ipv6TunnelL4Protocol::Ipv6TunnelL4Protocol ()
-  : m_node (0)
+  : m_node (0),
+    m_ipv6 (0),
+    m_routing (0),
+    m_routeGeneration (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -80,6 +88,12 @@ void Ipv6TunnelL4Protocol::DoDispose ()
   NS_LOG_FUNCTION_NOARGS ();
 
   m_node = 0;
+  m_ipv6 = 0;
+  m_routing = 0;
+  m_routeCache.clear ();
+  m_routeLru.clear ();
+  m_holdCallback = MakeNullCallback<bool, Ptr<Packet>, const Ipv6Address &, const Ipv6Header &> ();
+  m_sendHoldCallback = MakeNullCallback<bool, Ptr<Packet>, const Ipv6Header &> ();
   
   for ( TunnelMapI i = m_tunnelMap.begin(); i != m_tunnelMap.end(); i++ )
     {
@@ -104,6 +118,7 @@ void Ipv6TunnelL4Protocol::NotifyNewAggregate ()
           if (ipv6 != 0)
             {
               this->SetNode (node);
+              m_ipv6 = ipv6;
               ipv6->Insert (this);
             }
         }
@@ -145,23 +160,20 @@ enum Ipv6L4Protocol::RxStatus_e Ipv6TunnelL4Protocol::Receive (Ptr<Packet> packe
 {
   NS_LOG_FUNCTION (this << packet << src << dst << interface);
   
-  Ptr<Ipv6L3Protocol> ipv6 = GetNode()->GetObject<Ipv6L3Protocol>();
-  NS_ASSERT (ipv6 != 0);
+  NS_ASSERT (m_ipv6 != 0);
   
   /**
    * Check whether the packet belongs to one of tunnels
    */
   Ptr<TunnelNetDevice> tdev = GetTunnelDevice (src);   
-  if (tdev == 0)
+  if (tdev == 0 && m_holdCallback.IsNull ())
     {
       NS_LOG_DEBUG ("The packet does not associate any tunnel device");
       return Ipv6L4Protocol::RX_OK;
     }
   
-  Ptr<Packet> p = packet->Copy();
-  
   Ipv6Header innerHeader;
-  p->RemoveHeader(innerHeader);
+  packet->PeekHeader(innerHeader);
   
   Ipv6Address source = innerHeader.GetSourceAddress();
   Ipv6Address destination = innerHeader.GetDestinationAddress();
@@ -176,27 +188,104 @@ enum Ipv6L4Protocol::RxStatus_e Ipv6TunnelL4Protocol::Receive (Ptr<Packet> packe
 	  return Ipv6L4Protocol::RX_OK;
 	}
   
-  SocketIpTtlTag tag;
+  if (!m_holdCallback.IsNull () && m_holdCallback (packet, src, innerHeader))
+    {
+      NS_LOG_LOGIC ("Packet to " << destination << " held back");
+      return Ipv6L4Protocol::RX_OK;
+    }
+  
+  if (tdev == 0)
+    {
+      NS_LOG_DEBUG ("The packet does not associate any tunnel device");
+      return Ipv6L4Protocol::RX_OK;
+    }
+  
+  Forward (packet);
 
-  tag.SetTtl (innerHeader.GetHopLimit() - 1);
-  p->AddPacketTag (tag);
+  return Ipv6L4Protocol::RX_OK;
+}
+
+void Ipv6TunnelL4Protocol::SetHoldCallback (HoldCallback cb)
+{
+  NS_LOG_FUNCTION_NOARGS ();
   
-  //Prevent infinite loop
-  Ptr<Ipv6Route> route;
-  Socket::SocketErrno err;
-  Ptr<NetDevice> oif (0); //specify non-zero if bound to a source address
+  m_holdCallback = cb;
+}
+
+void Ipv6TunnelL4Protocol::SetSendHoldCallback (TunnelNetDevice::HoldCallback cb)
+{
+  NS_LOG_FUNCTION_NOARGS ();
   
-  Ipv6StaticRoutingHelper routingHelper;
+  m_sendHoldCallback = cb;
   
-  Ptr<Ipv6StaticRouting> routing = routingHelper.GetStaticRouting (ipv6);
+  for (TunnelMapI i = m_tunnelMap.begin (); i != m_tunnelMap.end (); i++)
+    {
+      i->second->SetHoldCallback (cb);
+    }
+}
+
+void Ipv6TunnelL4Protocol::Forward (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
   
-  NS_ASSERT (routing);
+  /* the packet is ours, strip the outer layer in place */
+  Ipv6Header innerHeader;
+  packet->RemoveHeader(innerHeader);
   
-  route = routing->RouteOutput (p, innerHeader, oif, err);
+  SocketIpTtlTag tag;
+
+  tag.SetTtl (innerHeader.GetHopLimit() - 1);
+  packet->AddPacketTag (tag);
   
-  ipv6->Send(p, source, destination, innerHeader.GetNextHeader(), route);
+  m_ipv6->Send(packet, innerHeader.GetSourceAddress(), innerHeader.GetDestinationAddress(), innerHeader.GetNextHeader(), LookupRoute (packet, innerHeader));
+}
 
-  return Ipv6L4Protocol::RX_OK;
+Ptr<Ipv6Route> Ipv6TunnelL4Protocol::LookupRoute (Ptr<Packet> packet, const Ipv6Header &header)
+{
+  NS_LOG_FUNCTION (this << packet);
+
+  if (m_routing == 0)
+    {
+      Ipv6StaticRoutingHelper routingHelper;
+      m_routing = routingHelper.GetStaticRouting (m_ipv6);
+      NS_ASSERT (m_routing);
+      m_routeGeneration = m_ipv6->GetRouteGeneration ();
+    }
+
+  if (m_routeGeneration != m_ipv6->GetRouteGeneration ())
+    {
+      NS_LOG_LOGIC ("Routing changed, flushing " << m_routeCache.size () << " cached routes");
+      m_routeCache.clear ();
+      m_routeLru.clear ();
+      m_routeGeneration = m_ipv6->GetRouteGeneration ();
+    }
+
+  RouteCacheI it = m_routeCache.find (header.GetDestinationAddress ());
+  if (it != m_routeCache.end ())
+    {
+      m_routeLru.splice (m_routeLru.begin (), m_routeLru, it->second.m_lru);
+      return it->second.m_route;
+    }
+
+  Socket::SocketErrno err;
+  Ptr<NetDevice> oif (0); //specify non-zero if bound to a source address
+  Ptr<Ipv6Route> route = m_routing->RouteOutput (packet, header, oif, err);
+
+  if (route && m_routeCacheSize > 0)
+    {
+      while (m_routeCache.size () >= m_routeCacheSize)
+        {
+          NS_LOG_LOGIC ("Route cache full, evicting " << m_routeLru.back ());
+          m_routeCache.erase (m_routeLru.back ());
+          m_routeLru.pop_back ();
+        }
+      m_routeLru.push_front (header.GetDestinationAddress ());
+
+      CachedRoute &cached = m_routeCache[header.GetDestinationAddress ()];
+      cached.m_route = route;
+      cached.m_lru = m_routeLru.begin ();
+    }
+  return route;
 }
 
 uint16_t Ipv6TunnelL4Protocol::AddTunnel(Ipv6Address remote, Ipv6Address local)
@@ -216,6 +305,7 @@ uint16_t Ipv6TunnelL4Protocol::AddTunnel(Ipv6Address remote, Ipv6Address local)
       
 	  dev->SetRemoteAddress(remote);
 	  dev->SetLocalAddress(local);
+      dev->SetHoldCallback (m_sendHoldCallback);
     }
   else
     {
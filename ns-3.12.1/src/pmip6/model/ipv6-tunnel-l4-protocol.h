@@ -25,8 +25,12 @@
 #ifndef IPV6_TUNNEL_L4_PROTOCOL_H
 #define IPV6_TUNNEL_L4_PROTOCOL_H
 
+#include <list>
+
 #include "ns3/ipv6-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ns3/ipv6-l4-protocol.h"
+#include "ns3/ipv6-route.h"
 #include "ns3/tunnel-net-device.h"
 
 namespace ns3
@@ -34,14 +38,29 @@ namespace ns3
 
 class Node;
 class Packet;
+class Ipv6Header;
+class Ipv6L3Protocol;
+class Ipv6StaticRouting;
 
 /**
  * \class Ipv6TunnelL4Protocol
  * \brief An implementation of the Ipv6 Tunnel protocol.
+ *
+ * Decapsulated packets are sent on with a route looked up in the
+ * static routing table of the node. Routes are cached per inner
+ * destination, the least recently used route making room for a new
+ * one, and the cache is flushed when the routing of the node changes.
  */
 class Ipv6TunnelL4Protocol : public Ipv6L4Protocol
 {
 public:
+  /**
+   * \brief Callback offered the decapsulated packets, with the outer source
+   * and the inner header, inner header included in the packet; returns
+   * true when it keeps the packet.
+   */
+  typedef Callback<bool, Ptr<Packet>, const Ipv6Address &, const Ipv6Header &> HoldCallback;
+
   /**
    * \brief Interface ID
    */
@@ -110,6 +129,32 @@ public:
    */
   virtual enum Ipv6L4Protocol::RxStatus_e Receive (Ptr<Packet> p, Ipv6Address const &src, Ipv6Address const &dst, Ptr<Ipv6Interface> interface);
 
+  /**
+   * \brief Set the callback which may keep decapsulated packets back,
+   * e.g. those of an MN not attached yet.
+   *
+   * The callback is also offered the packets of a remote endpoint with no
+   * tunnel yet, which are dropped if it does not keep them.
+   * \param cb the callback, a null callback to send them all on
+   */
+  void SetHoldCallback (HoldCallback cb);
+  
+  /**
+   * \brief Set the callback which may keep packets back from the tunnels,
+   * before their encapsulation.
+   * \param cb the callback, given to every tunnel device, a null callback
+   * to send them all
+   */
+  void SetSendHoldCallback (TunnelNetDevice::HoldCallback cb);
+  
+  /**
+   * \brief Send on a decapsulated packet.
+   *
+   * Used for the packets kept by the hold callback, once released.
+   * \param packet the packet, inner header included
+   */
+  void Forward (Ptr<Packet> packet);
+
   uint16_t AddTunnel(Ipv6Address remote, Ipv6Address local=Ipv6Address::GetZero());
   void RemoveTunnel(Ipv6Address remote);
   uint16_t ModifyTunnel(Ipv6Address remote, Ipv6Address newRemote, Ipv6Address local=Ipv6Address::GetZero());
@@ -125,11 +170,71 @@ protected:
 private:
   typedef std::map<Ipv6Address, Ptr<TunnelNetDevice> > TunnelMap;
   typedef std::map<Ipv6Address, Ptr<TunnelNetDevice> >::iterator TunnelMapI;
+
+  typedef std::list<Ipv6Address> RouteLru;
+  typedef std::list<Ipv6Address>::iterator RouteLruI;
+
+  struct CachedRoute
+  {
+    Ptr<Ipv6Route> m_route;
+    RouteLruI m_lru;
+  };
+
+  typedef sgi::hash_map<Ipv6Address, CachedRoute, Ipv6AddressHash> RouteCache;
+  typedef sgi::hash_map<Ipv6Address, CachedRoute, Ipv6AddressHash>::iterator RouteCacheI;
+
+  /**
+   * \brief Get the route for a decapsulated packet.
+   * \param packet the inner packet
+   * \param header the inner IPv6 header
+   * \return the route, 0 if the static routing has none
+   */
+  Ptr<Ipv6Route> LookupRoute (Ptr<Packet> packet, const Ipv6Header &header);
   
   /**
    * \brief The node.
    */
   Ptr<Node> m_node;
+
+  /**
+   * \brief The IPv6 stack of the node.
+   */
+  Ptr<Ipv6L3Protocol> m_ipv6;
+
+  /**
+   * \brief The static routing used for decapsulated packets.
+   */
+  Ptr<Ipv6StaticRouting> m_routing;
+
+  /**
+   * \brief Routes of decapsulated packets, by inner destination.
+   */
+  RouteCache m_routeCache;
+
+  /**
+   * \brief Cached destinations, most recently used first.
+   */
+  RouteLru m_routeLru;
+
+  /**
+   * \brief Routing generation of the stack the cache was filled at.
+   */
+  uint32_t m_routeGeneration;
+
+  /**
+   * \brief Maximum number of cached routes, 0 disables the cache.
+   */
+  uint32_t m_routeCacheSize;
+  
+  /**
+   * \brief Callback which may keep decapsulated packets back.
+   */
+  HoldCallback m_holdCallback;
+  
+  /**
+   * \brief Callback of the tunnel devices, which may keep packets back.
+   */
+  TunnelNetDevice::HoldCallback m_sendHoldCallback;
   
   TunnelMap m_tunnelMap;
   
@@ -34,9 +34,15 @@
 #include "ns3/ipv6-routing-protocol.h"
 #include "ns3/ipv6-route.h"
 #include "ns3/ipv6-interface.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+
+#include "binding-timer-wheel.h"
 
 #include "pmipv6-profile.h"
 #include "ipv6-mobility-header.h"
+#include "ipv6-mobility-l4-protocol.h"
 #include "pmipv6-agent.h"
 
 using namespace std;
@@ -53,12 +59,42 @@ TypeId Pmipv6Agent::GetTypeId ()
   static TypeId tid = TypeId ("ns3::Pmipv6Agent")
     .SetParent<Object> ()
     .AddConstructor<Pmipv6Agent> ()
+    .AddAttribute ("UseTimerWheel",
+                   "Drive all the binding timers of the agent from one shared timer wheel "
+                   "instead of one simulator event per timer.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Pmipv6Agent::m_useTimerWheel),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TimerWheelGranularity",
+                   "The tick of the binding timer wheel.",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&Pmipv6Agent::m_timerWheelGranularity),
+                   MakeTimeChecker ())
+    .AddAttribute ("BulkWindow",
+                   "Hold the mobility messages sent to a peer for this time and send them "
+                   "in one bulk packet. Zero sends each message at once. Bounded by the "
+                   "initial binding ack timeout of a first registration.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&Pmipv6Agent::SetBulkWindow,
+                                     &Pmipv6Agent::GetBulkWindow),
+                   MakeTimeChecker ())
+    .AddAttribute ("BulkMaxSize",
+                   "The maximum size of a bulk packet, in bytes.",
+                   UintegerValue (1232),
+                   MakeUintegerAccessor (&Pmipv6Agent::m_bulkMaxSize),
+                   MakeUintegerChecker<uint32_t> ())
     ;
   return tid;
 }
 
 Pmipv6Agent::Pmipv6Agent ()
-  : m_node (0)
+  : m_node (0),
+    m_useTimerWheel (false),
+    m_bulkReceiving (false),
+    m_txMessages (0),
+    m_txPackets (0),
+    m_rxMessages (0),
+    m_rxPackets (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -74,6 +110,16 @@ void Pmipv6Agent::DoDispose ()
 
   m_node = 0;
   m_profile = 0;
+  
+  m_bulkEvent.Cancel ();
+  m_bulkPackets.clear ();
+  
+  if (m_timerWheel)
+    {
+      m_timerWheel->Dispose ();
+      m_timerWheel = 0;
+    }
+  
   Object::DoDispose ();
 }
 
@@ -103,35 +149,191 @@ void Pmipv6Agent::SetProfile(Ptr<Pmipv6Profile> pf)
   m_profile = pf;
 }
 
+Ptr<BindingTimerWheel> Pmipv6Agent::GetTimerWheel ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  if (m_useTimerWheel && m_timerWheel == 0)
+    {
+      m_timerWheel = CreateObject<BindingTimerWheel> ();
+      m_timerWheel->SetGranularity (m_timerWheelGranularity);
+    }
+  
+  return m_timerWheel;
+}
+
+void Pmipv6Agent::SetBulkWindow (Time window)
+{
+  NS_LOG_FUNCTION (this << window);
+
+  if (window.IsNegative ())
+    {
+      NS_LOG_WARN ("Negative bulk window, messages are sent at once");
+      window = Seconds (0);
+    }
+  else if (window > Seconds (Ipv6MobilityL4Protocol::INITIAL_BINDING_ACK_TIMEOUT_FIRSTREG))
+    {
+      window = Seconds (Ipv6MobilityL4Protocol::INITIAL_BINDING_ACK_TIMEOUT_FIRSTREG);
+      NS_LOG_WARN ("Bulk window bounded to " << window.GetSeconds () << "s");
+    }
+
+  m_bulkWindow = window;
+}
+
+Time Pmipv6Agent::GetBulkWindow () const
+{
+  return m_bulkWindow;
+}
+
 uint8_t Pmipv6Agent::Receive (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface)
 {
   NS_LOG_FUNCTION ( this << packet << src << dst << interface );
   
-  Ptr<Packet> p = packet->Copy ();
+  uint32_t size = packet->GetSize ();
+  uint32_t offset = 0;
+  bool bulk = false;
+  
+  m_rxPackets++;
   
-  Ipv6MobilityHeader mh;
+  while (offset < size)
+    {
+      Ptr<Packet> p = packet;
+      Ipv6MobilityHeader mh;
+      
+      if (offset > 0)
+        {
+          p = packet->CreateFragment (offset, size - offset);
+        }
+      
+      p->PeekHeader (mh);
+      
+      uint32_t length = (mh.GetHeaderLen () + 1) << 3;
+      
+      if (length > size - offset)
+        {
+          NS_LOG_LOGIC ("Truncated mobility message.. drop remaining " << size - offset << " bytes");
+          break;
+        }
+      
+      if (length < size - offset)
+        {
+          p = p->CreateFragment (0, length);
+          bulk = true;
+          m_bulkReceiving = true;
+        }
+      
+      offset += length;
+      m_rxMessages++;
+      
+      uint8_t mhType = mh.GetMhType ();
+      
+      if (mhType == Ipv6MobilityHeader::IPV6_MOBILITY_BINDING_UPDATE)
+        {
+          HandlePbu (p, src, dst, interface);
+        }
+      else if (mhType == Ipv6MobilityHeader::IPV6_MOBILITY_BINDING_ACKNOWLEDGEMENT)
+        {
+          HandlePba (p, src, dst, interface);
+        }
+      else if (mhType == Ipv6MobilityHeader::IPV6_MOBILITY_HANDOVER_INITIATE)
+        {
+          HandleHi (p, src, dst, interface);
+        }
+      else if (mhType == Ipv6MobilityHeader::IPV6_MOBILITY_HANDOVER_ACKNOWLEDGE)
+        {
+          HandleHack (p, src, dst, interface);
+        }
+      else
+        {
+          NS_LOG_ERROR ("Unknown MHType (" << (uint32_t)mhType << ")");
+        }
+    }
   
-  p->PeekHeader (mh);
+  if (bulk)
+    {
+      m_bulkReceiving = false;
+      
+      //answer the whole bulk at once unless replies wait for the window
+      if (m_bulkWindow.IsZero ())
+        {
+          FlushBulk ();
+        }
+    }
   
-  uint8_t mhType = mh.GetMhType ();
+  return 0;
+}
+
+Time Pmipv6Agent::SendMessage (Ptr<Packet> packet, Ipv6Address dst, uint32_t ttl)
+{
+  NS_LOG_FUNCTION (this << packet << dst << (uint32_t)ttl);
   
-  if (mhType == Ipv6MobilityHeader::IPV6_MOBILITY_BINDING_UPDATE)
+  m_txMessages++;
+  
+  if (m_bulkWindow.IsZero () && !m_bulkReceiving)
     {
-	  HandlePbu (packet, src, dst, interface);
-	}
-  else if (mhType == Ipv6MobilityHeader::IPV6_MOBILITY_BINDING_ACKNOWLEDGEMENT)
+      SendPacket (packet, dst, ttl);
+      return Seconds (0);
+    }
+  
+  BulkPacketMapI it = m_bulkPackets.find (dst);
+  
+  if (it != m_bulkPackets.end () &&
+      it->second.m_packet->GetSize () + packet->GetSize () > m_bulkMaxSize)
     {
-	  HandlePba (packet, src, dst, interface);
-	}
+      SendPacket (it->second.m_packet, dst, it->second.m_ttl);
+      m_bulkPackets.erase (it);
+      it = m_bulkPackets.end ();
+    }
+  
+  if (it == m_bulkPackets.end ())
+    {
+      BulkPacket bulk;
+      
+      bulk.m_packet = packet;
+      bulk.m_ttl = ttl;
+      m_bulkPackets.insert (std::make_pair (dst, bulk));
+    }
   else
     {
-	  NS_LOG_ERROR ("Unknown MHType (" << (uint32_t)mhType << ")");
-	}
-	
-  return 0;
+      it->second.m_packet->AddAtEnd (packet);
+    }
+  
+  if (m_bulkWindow.IsZero ())
+    {
+      //sent at the end of the bulk being received
+      return Seconds (0);
+    }
+  
+  if (!m_bulkEvent.IsRunning ())
+    {
+      m_bulkEvent = Simulator::Schedule (m_bulkWindow, &Pmipv6Agent::BulkWindowExpired, this);
+    }
+  
+  return Simulator::GetDelayLeft (m_bulkEvent);
 }
 
-void Pmipv6Agent::SendMessage (Ptr<Packet> packet, Ipv6Address dst, uint32_t ttl)
+void Pmipv6Agent::BulkWindowExpired ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  FlushBulk ();
+}
+
+void Pmipv6Agent::FlushBulk ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  BulkPacketMap bulkPackets;
+  
+  bulkPackets.swap (m_bulkPackets);
+  
+  for (BulkPacketMapI it = bulkPackets.begin (); it != bulkPackets.end (); ++it)
+    {
+      SendPacket (it->second.m_packet, it->first, it->second.m_ttl);
+    }
+}
+
+void Pmipv6Agent::SendPacket (Ptr<Packet> packet, Ipv6Address dst, uint32_t ttl)
 {
   NS_LOG_FUNCTION (this << packet << dst << (uint32_t)ttl);
   
@@ -154,6 +356,7 @@ void Pmipv6Agent::SendMessage (Ptr<Packet> packet, Ipv6Address dst, uint32_t ttl
       packet->AddPacketTag (tag);
       Ipv6Address src = route->GetSource ();
 
+      m_txPackets++;
       ipv6->Send (packet, src, dst, 135, route);
     }
   else
@@ -162,6 +365,26 @@ void Pmipv6Agent::SendMessage (Ptr<Packet> packet, Ipv6Address dst, uint32_t ttl
     }
 }
 
+uint32_t Pmipv6Agent::GetTxMessages () const
+{
+  return m_txMessages;
+}
+
+uint32_t Pmipv6Agent::GetTxPackets () const
+{
+  return m_txPackets;
+}
+
+uint32_t Pmipv6Agent::GetRxMessages () const
+{
+  return m_rxMessages;
+}
+
+uint32_t Pmipv6Agent::GetRxPackets () const
+{
+  return m_rxPackets;
+}
+
 uint8_t Pmipv6Agent::HandlePbu (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface)
 {
   NS_LOG_FUNCTION ( this << src << dst );
@@ -180,5 +403,23 @@ uint8_t Pmipv6Agent::HandlePba (Ptr<Packet> packet, const Ipv6Address &src, cons
   return 0;
 }
 
+uint8_t Pmipv6Agent::HandleHi (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface)
+{
+  NS_LOG_FUNCTION ( this << src << dst );
+  
+  NS_LOG_WARN ("No handler for HI message");
+  
+  return 0;
+}
+
+uint8_t Pmipv6Agent::HandleHack (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface)
+{
+  NS_LOG_FUNCTION ( this << src << dst );
+  
+  NS_LOG_WARN ("No handler for HAck message");
+  
+  return 0;
+}
+
 } /* namespace ns3 */
 
@@ -25,8 +25,12 @@
 #ifndef PMIPV6_AGENT_H
 #define PMIPV6_AGENT_H
 
+#include <map>
+
 #include "ns3/object.h"
 #include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
 
 namespace ns3
 {
@@ -35,10 +39,21 @@ class Node;
 class Packet;
 class Ipv6Interface;
 class Pmipv6Profile;
+class BindingTimerWheel;
 
 /**
  * \class Pmip6Agent
  * \brief An implementation of the PMIPv6 protocol.
+ *
+ * Bulk signaling uses a private framing, not RFC 6602: a bulk packet is
+ * plain PMIPv6 messages (PBU, PBA, HI, HAck) placed back to back in the
+ * payload of one IPv6 packet, each one delimited by its header length.
+ * The mobility demux routes the packet on its first message, which is
+ * always a PMIPv6 message, to this agent. The agent then dispatches
+ * every message on its own type. A stock RFC 5213 node would only see
+ * the first message, so only enable BulkWindow between agents of this
+ * implementation. An agent answers a bulk packet with a bulk packet
+ * whatever its own window.
  */
 class Pmipv6Agent : public Object
 {
@@ -73,13 +88,84 @@ public:
   Ptr<Pmipv6Profile> GetProfile() const;
   void SetProfile (Ptr<Pmipv6Profile> pf);
   
+  /**
+   * \brief Handle a mobility packet.
+   *
+   * A bulk packet carries several mobility messages back to back, each
+   * delimited by its header length. They are handled in one pass and the
+   * replies sent to the same peer meanwhile go out as one bulk packet.
+   * \param packet the packet
+   * \param src source address
+   * \param dst destination address
+   * \param interface incoming interface
+   * \return 0
+   */
   virtual uint8_t Receive (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface);
   
-  void SendMessage(Ptr<Packet> packet, Ipv6Address dst, uint32_t ttl);
+  /**
+   * \brief Send a mobility message.
+   *
+   * With a non-zero BulkWindow the message is held and sent along with
+   * the other messages for the same peer at the end of the window.
+   * \param packet the message
+   * \param dst destination address
+   * \param ttl hop limit
+   * \return time until the message leaves, zero if sent at once
+   */
+  Time SendMessage(Ptr<Packet> packet, Ipv6Address dst, uint32_t ttl);
+
+  /**
+   * \brief Set the bulk window.
+   *
+   * The window is bounded by INITIAL_BINDING_ACK_TIMEOUT_FIRSTREG, so a
+   * held PBU is not delayed longer than a first registration waits for
+   * its PBA.
+   * \param window the window, zero to send each message at once
+   */
+  void SetBulkWindow (Time window);
+
+  /**
+   * \brief Get the bulk window.
+   * \return the window
+   */
+  Time GetBulkWindow () const;
+  
+  /**
+   * \brief Get the number of mobility messages sent.
+   * \return message count
+   */
+  uint32_t GetTxMessages () const;
+  
+  /**
+   * \brief Get the number of packets sent; lower than the message count
+   * when messages are bulked.
+   * \return packet count
+   */
+  uint32_t GetTxPackets () const;
+  
+  /**
+   * \brief Get the number of mobility messages received.
+   * \return message count
+   */
+  uint32_t GetRxMessages () const;
+  
+  /**
+   * \brief Get the number of packets received, one receive event each.
+   * \return packet count
+   */
+  uint32_t GetRxPackets () const;
+  
+  /**
+   * \brief Get the timer wheel shared by the bindings of this agent.
+   * \return the wheel, or 0 if each binding timer uses its own event
+   */
+  Ptr<BindingTimerWheel> GetTimerWheel ();
   
 protected:
   virtual uint8_t HandlePbu (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface);
   virtual uint8_t HandlePba (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface);
+  virtual uint8_t HandleHi (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface);
+  virtual uint8_t HandleHack (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface);
   
   /**
    * \brief Dispose this object.
@@ -87,6 +173,37 @@ protected:
   virtual void DoDispose ();
   
 private:
+  /**
+   * \brief Send a packet of one or more mobility messages.
+   * \param packet the packet
+   * \param dst destination address
+   * \param ttl hop limit
+   */
+  void SendPacket (Ptr<Packet> packet, Ipv6Address dst, uint32_t ttl);
+  
+  /**
+   * \brief Send all the pending bulk packets.
+   */
+  void FlushBulk ();
+
+  /**
+   * \brief End of the bulk window.
+   */
+  void BulkWindowExpired ();
+
+  /**
+   * \class BulkPacket
+   * \brief Messages pending for one peer.
+   */
+  class BulkPacket
+  {
+public:
+    Ptr<Packet> m_packet;
+    uint32_t m_ttl;
+  };
+
+  typedef std::map<Ipv6Address, BulkPacket> BulkPacketMap;
+  typedef std::map<Ipv6Address, BulkPacket>::iterator BulkPacketMapI;
 
   /**
    * \brief The node.
@@ -94,6 +211,42 @@ private:
   Ptr<Node> m_node;
   
   Ptr<Pmipv6Profile> m_profile;
+  
+  bool m_useTimerWheel;
+  
+  Time m_timerWheelGranularity;
+  
+  Ptr<BindingTimerWheel> m_timerWheel;
+  
+  /**
+   * \brief Time messages are held to be bulked, zero to send them at once.
+   */
+  Time m_bulkWindow;
+  
+  /**
+   * \brief Maximum size of a bulk packet.
+   */
+  uint32_t m_bulkMaxSize;
+  
+  /**
+   * \brief Pending bulk packet of each peer.
+   */
+  BulkPacketMap m_bulkPackets;
+  
+  /**
+   * \brief End of the current bulk window.
+   */
+  EventId m_bulkEvent;
+  
+  /**
+   * \brief Whether a bulk packet is being handled, so replies are bulked.
+   */
+  bool m_bulkReceiving;
+  
+  uint32_t m_txMessages;
+  uint32_t m_txPackets;
+  uint32_t m_rxMessages;
+  uint32_t m_rxPackets;
 };
 
 } /* namespace ns3 */
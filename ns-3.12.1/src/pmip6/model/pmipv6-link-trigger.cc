@@ -0,0 +1,154 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-mac-header.h"
+
+#include "pmipv6-mag.h"
+#include "pmipv6-link-trigger.h"
+
+NS_LOG_COMPONENT_DEFINE ("Pmipv6LinkTrigger");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED (Pmipv6LinkTrigger);
+
+TypeId Pmipv6LinkTrigger::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::Pmipv6LinkTrigger")
+    .SetParent<Object> ()
+    .AddConstructor<Pmipv6LinkTrigger> ()
+    .AddAttribute ("Threshold", "Signal of the serving access point, in dBm, below which the MN looks for another one.",
+                   DoubleValue (-80.0),
+                   MakeDoubleAccessor (&Pmipv6LinkTrigger::m_threshold),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("Hysteresis", "How much stronger, in dB, another access point must be to trigger a handover.",
+                   DoubleValue (3.0),
+                   MakeDoubleAccessor (&Pmipv6LinkTrigger::m_hysteresis),
+                   MakeDoubleChecker<double> (0.0))
+    ;
+  return tid;
+}
+
+Pmipv6LinkTrigger::Pmipv6LinkTrigger ()
+  : m_threshold (-80.0),
+    m_hysteresis (3.0),
+    m_device (0),
+    m_nTriggers (0)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+Pmipv6LinkTrigger::~Pmipv6LinkTrigger ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+void Pmipv6LinkTrigger::DoDispose ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  m_device = 0;
+  m_aps.clear ();
+
+  Object::DoDispose ();
+}
+
+void Pmipv6LinkTrigger::AddAccessPoint (Mac48Address bssid, Ptr<Pmipv6Mag> mag)
+{
+  NS_LOG_FUNCTION (this << bssid << mag);
+
+  m_aps[bssid] = mag;
+}
+
+void Pmipv6LinkTrigger::Install (Ptr<WifiNetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  NS_ASSERT (m_device == 0);
+
+  m_device = device;
+  m_device->GetPhy ()->TraceConnectWithoutContext ("MonitorSnifferRx",
+                                                   MakeCallback (&Pmipv6LinkTrigger::MonitorSnifferRx, this));
+}
+
+uint32_t Pmipv6LinkTrigger::GetNTriggers () const
+{
+  return m_nTriggers;
+}
+
+void Pmipv6LinkTrigger::MonitorSnifferRx (Ptr<const Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber,
+                                          uint32_t rate, bool isShortPreamble, double signalDbm, double noiseDbm)
+{
+  WifiMacHeader hdr;
+
+  packet->PeekHeader (hdr);
+
+  if (!hdr.IsBeacon ())
+    {
+      return;
+    }
+
+  Mac48Address bssid = hdr.GetAddr3 ();
+
+  m_signals[bssid] = signalDbm;
+
+  Mac48Address serving = m_device->GetMac ()->GetBssid ();
+
+  if (serving != m_serving)
+    {
+      //the MN moved, the last trigger is over
+      m_serving = serving;
+      m_target = Mac48Address ();
+    }
+
+  if (bssid == serving || bssid == m_target)
+    {
+      return;
+    }
+
+  AccessPointMap::iterator it = m_aps.find (serving);
+  SignalMap::iterator sit = m_signals.find (serving);
+
+  if (it == m_aps.end () || sit == m_signals.end () || m_aps.find (bssid) == m_aps.end ())
+    {
+      return;
+    }
+
+  if (sit->second >= m_threshold || signalDbm < sit->second + m_hysteresis)
+    {
+      return;
+    }
+
+  NS_LOG_LOGIC ("Serving " << serving << " at " << sit->second << "dBm, " << bssid << " at " << signalDbm << "dBm");
+
+  Mac48Address mn = Mac48Address::ConvertFrom (m_device->GetAddress ());
+
+  if (it->second->InitiateHandover (mn, bssid))
+    {
+      m_target = bssid;
+      m_nTriggers++;
+    }
+}
+
+} /* namespace ns3 */
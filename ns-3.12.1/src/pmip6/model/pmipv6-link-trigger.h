@@ -0,0 +1,103 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef PMIPV6_LINK_TRIGGER_H
+#define PMIPV6_LINK_TRIGGER_H
+
+#include <stdint.h>
+
+#include <map>
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/mac48-address.h"
+
+namespace ns3
+{
+
+class WifiNetDevice;
+class Pmipv6Mag;
+
+/**
+ * \class Pmipv6LinkTrigger
+ * \brief Predict the next access point of a wifi MN from the beacons it hears.
+ *
+ * The trigger sniffs the beacons received by the MN and keeps the signal
+ * strength of each access point. Once the serving access point falls below
+ * Threshold and another one is Hysteresis dB stronger, the MAG of the serving
+ * access point is asked to hand the MN over to the MAG of the other one,
+ * ahead of the link-layer handover.
+ */
+class Pmipv6LinkTrigger : public Object
+{
+public:
+  static TypeId GetTypeId ();
+  
+  Pmipv6LinkTrigger ();
+  virtual ~Pmipv6LinkTrigger ();
+  
+  /**
+   * \brief Declare an access point of the domain.
+   * \param bssid BSSID of the access point
+   * \param mag the MAG serving it
+   */
+  void AddAccessPoint (Mac48Address bssid, Ptr<Pmipv6Mag> mag);
+  
+  /**
+   * \brief Watch the beacons received by the device of an MN.
+   * \param device wifi station device of the MN
+   */
+  void Install (Ptr<WifiNetDevice> device);
+  
+  /**
+   * \return number of handovers initiated by the trigger
+   */
+  uint32_t GetNTriggers () const;
+  
+protected:
+  virtual void DoDispose ();
+  
+private:
+  void MonitorSnifferRx (Ptr<const Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber,
+                         uint32_t rate, bool isShortPreamble, double signalDbm, double noiseDbm);
+  
+  typedef std::map<Mac48Address, Ptr<Pmipv6Mag> > AccessPointMap;
+  typedef std::map<Mac48Address, double> SignalMap;
+  
+  double m_threshold;
+  double m_hysteresis;
+  
+  Ptr<WifiNetDevice> m_device;
+  
+  AccessPointMap m_aps;
+  SignalMap m_signals;
+  
+  /**
+   * \brief Serving access point and target of the last trigger.
+   */
+  Mac48Address m_serving;
+  Mac48Address m_target;
+  
+  uint32_t m_nTriggers;
+};
+
+} /* namespace ns3 */
+
+#endif /* PMIPV6_LINK_TRIGGER_H */
@@ -0,0 +1,238 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include "pmipv6-lma-cluster.h"
+
+NS_LOG_COMPONENT_DEFINE ("Pmipv6LmaCluster");
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED (Pmipv6LmaCluster);
+
+TypeId Pmipv6LmaCluster::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::Pmipv6LmaCluster")
+    .SetParent<Object> ()
+    .AddConstructor<Pmipv6LmaCluster> ()
+    .AddAttribute ("VirtualNodes", "Number of ring points of each LMA added from now on.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&Pmipv6LmaCluster::m_virtualNodes),
+                   MakeUintegerChecker<uint32_t> (1))
+    ;
+  return tid;
+}
+
+Pmipv6LmaCluster::Pmipv6LmaCluster ()
+  : m_virtualNodes (64)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+Pmipv6LmaCluster::~Pmipv6LmaCluster ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+void Pmipv6LmaCluster::DoDispose ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  m_rebalanceCallbacks.clear ();
+  Object::DoDispose ();
+}
+
+uint32_t Pmipv6LmaCluster::GetPoint (Ipv6Address lma, uint32_t replica) const
+{
+  uint8_t buf[20];
+  
+  lma.Serialize (buf);
+  buf[16] = replica >> 24;
+  buf[17] = (replica >> 16) & 0xff;
+  buf[18] = (replica >> 8) & 0xff;
+  buf[19] = replica & 0xff;
+  
+  //same hash as the MN identifiers, so that both spread over the ring alike
+  return Identifier (buf, sizeof (buf)).GetHash ();
+}
+
+void Pmipv6LmaCluster::AddLma (Ipv6Address lma)
+{
+  NS_LOG_FUNCTION (this << lma);
+  
+  if (std::find (m_lmas.begin (), m_lmas.end (), lma) != m_lmas.end ())
+    {
+      return;
+    }
+  
+  m_lmas.push_back (lma);
+  m_nPoints.push_back (m_virtualNodes);
+  m_placements.insert (std::make_pair (lma, 0));
+  m_load.insert (std::make_pair (lma, 0));
+  
+  BuildRing ();
+  Rebalance ();
+}
+
+void Pmipv6LmaCluster::RemoveLma (Ipv6Address lma)
+{
+  NS_LOG_FUNCTION (this << lma);
+  
+  std::vector<Ipv6Address>::iterator it = std::find (m_lmas.begin (), m_lmas.end (), lma);
+  
+  if (it == m_lmas.end ())
+    {
+      return;
+    }
+  
+  m_nPoints.erase (m_nPoints.begin () + (it - m_lmas.begin ()));
+  m_lmas.erase (it);
+  
+  BuildRing ();
+  Rebalance ();
+}
+
+void Pmipv6LmaCluster::BuildRing ()
+{
+  NS_LOG_FUNCTION (this << m_lmas.size ());
+  
+  m_ring.clear ();
+  
+  for (uint32_t i = 0; i < m_lmas.size (); i++)
+    {
+      for (uint32_t j = 0; j < m_nPoints[i]; j++)
+        {
+          //on a collision the point stays with the LMA that joined first
+          m_ring.insert (std::make_pair (GetPoint (m_lmas[i], j), m_lmas[i]));
+        }
+    }
+}
+
+uint32_t Pmipv6LmaCluster::GetNLmas () const
+{
+  return m_lmas.size ();
+}
+
+Ipv6Address Pmipv6LmaCluster::GetLma (uint32_t i) const
+{
+  NS_ASSERT (i < m_lmas.size ());
+  
+  return m_lmas[i];
+}
+
+Ipv6Address Pmipv6LmaCluster::Lookup (Identifier mnId) const
+{
+  NS_LOG_FUNCTION (this << mnId);
+  
+  if (m_ring.empty ())
+    {
+      return Ipv6Address::GetAny ();
+    }
+  
+  RingCI i = m_ring.lower_bound (mnId.GetHash ());
+  
+  if (i == m_ring.end ())
+    {
+      i = m_ring.begin ();
+    }
+  
+  return (*i).second;
+}
+
+Ipv6Address Pmipv6LmaCluster::Place (Identifier mnId)
+{
+  NS_LOG_FUNCTION (this << mnId);
+  
+  Ipv6Address lma = Lookup (mnId);
+  
+  if (!lma.IsAny ())
+    {
+      m_placements[lma]++;
+      m_load[lma]++;
+    }
+  
+  return lma;
+}
+
+void Pmipv6LmaCluster::Release (Ipv6Address lma)
+{
+  NS_LOG_FUNCTION (this << lma);
+  
+  //the LMA may have left the ring since, its count is kept until released
+  std::map<Ipv6Address, uint64_t>::iterator i = m_load.find (lma);
+  
+  if (i != m_load.end () && (*i).second > 0)
+    {
+      (*i).second--;
+    }
+}
+
+uint64_t Pmipv6LmaCluster::GetNPlacements (Ipv6Address lma) const
+{
+  std::map<Ipv6Address, uint64_t>::const_iterator i = m_placements.find (lma);
+  
+  return i == m_placements.end () ? 0 : (*i).second;
+}
+
+uint64_t Pmipv6LmaCluster::GetLoad (Ipv6Address lma) const
+{
+  std::map<Ipv6Address, uint64_t>::const_iterator i = m_load.find (lma);
+  
+  return i == m_load.end () ? 0 : (*i).second;
+}
+
+void Pmipv6LmaCluster::AddRebalanceCallback (Callback<void> cb)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  m_rebalanceCallbacks.push_back (cb);
+}
+
+void Pmipv6LmaCluster::RemoveRebalanceCallback (Callback<void> cb)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  for (std::vector<Callback<void> >::iterator i = m_rebalanceCallbacks.begin (); i != m_rebalanceCallbacks.end (); i++)
+    {
+      if ((*i).IsEqual (cb))
+        {
+          m_rebalanceCallbacks.erase (i);
+          return;
+        }
+    }
+}
+
+void Pmipv6LmaCluster::Rebalance ()
+{
+  NS_LOG_FUNCTION (this << m_lmas.size ());
+  
+  //a MAG may unregister itself meanwhile
+  std::vector<Callback<void> > callbacks = m_rebalanceCallbacks;
+  
+  for (std::vector<Callback<void> >::iterator i = callbacks.begin (); i != callbacks.end (); i++)
+    {
+      (*i) ();
+    }
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,136 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PMIPV6_LMA_CLUSTER_H
+#define PMIPV6_LMA_CLUSTER_H
+
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/callback.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/identifier.h"
+
+namespace ns3
+{
+
+/**
+ * \class Pmipv6LmaCluster
+ * \brief Set of LMAs sharing the MNs of a domain by consistent hashing.
+ *
+ * Every LMA owns VirtualNodes points of a 32-bit hash ring, and an MN is
+ * served by the owner of the first point at or after the hash of its MN
+ * identifier. Adding or removing an LMA only moves the MNs of the ring
+ * arcs it takes or gives back, about 1/n of them. The MAGs sharing the
+ * cluster select the LMA of an MN at attach time instead of reading it
+ * from the profile, and re-home their bindings when the ring changes.
+ *
+ * The ring is rebuilt from the LMAs in the order they joined on every
+ * change, so a point two LMAs hash to belongs to the earlier one and goes
+ * back to the other when it leaves.
+ */
+class Pmipv6LmaCluster : public Object
+{
+public:
+  static TypeId GetTypeId ();
+  
+  Pmipv6LmaCluster ();
+  virtual ~Pmipv6LmaCluster ();
+  
+  /**
+   * \brief Add an LMA to the ring and let the MAGs rebalance.
+   * \param lma address of the LMA
+   */
+  void AddLma (Ipv6Address lma);
+  
+  /**
+   * \brief Remove an LMA from the ring and let the MAGs rebalance.
+   * \param lma address of the LMA
+   */
+  void RemoveLma (Ipv6Address lma);
+  
+  uint32_t GetNLmas () const;
+  Ipv6Address GetLma (uint32_t i) const;
+  
+  /**
+   * \param mnId MN identifier
+   * \return the LMA serving the MN, or the any address if the ring is empty
+   */
+  Ipv6Address Lookup (Identifier mnId) const;
+  
+  /**
+   * \brief Select the LMA for a registration of an MN and account it.
+   * \param mnId MN identifier
+   * \return the LMA serving the MN, or the any address if the ring is empty
+   */
+  Ipv6Address Place (Identifier mnId);
+  
+  /**
+   * \brief Account the end of a registration placed on an LMA.
+   * \param lma address of the LMA, as returned by Place
+   *
+   * Called when the MN moves to another LMA or its binding is removed.
+   */
+  void Release (Ipv6Address lma);
+  
+  /**
+   * \param lma address of the LMA
+   * \return number of registrations placed on the LMA so far
+   */
+  uint64_t GetNPlacements (Ipv6Address lma) const;
+  
+  /**
+   * \param lma address of the LMA
+   * \return number of registrations placed on the LMA and not released
+   */
+  uint64_t GetLoad (Ipv6Address lma) const;
+  
+  /**
+   * \brief Register a function called after each change of the ring.
+   * \param cb the function, typically Pmipv6Mag::Rebalance
+   */
+  void AddRebalanceCallback (Callback<void> cb);
+  void RemoveRebalanceCallback (Callback<void> cb);
+  
+protected:
+  virtual void DoDispose ();
+  
+private:
+  typedef std::map<uint32_t, Ipv6Address> Ring;
+  typedef std::map<uint32_t, Ipv6Address>::const_iterator RingCI;
+  
+  uint32_t GetPoint (Ipv6Address lma, uint32_t replica) const;
+  void BuildRing ();
+  void Rebalance ();
+  
+  uint32_t m_virtualNodes;
+  
+  Ring m_ring;
+  std::vector<Ipv6Address> m_lmas;
+  std::vector<uint32_t> m_nPoints;
+  std::map<Ipv6Address, uint64_t> m_placements;
+  std::map<Ipv6Address, uint64_t> m_load;
+  std::vector<Callback<void> > m_rebalanceCallbacks;
+};
+
+} /* namespace ns3 */
+
+#endif /* PMIPV6_LMA_CLUSTER_H */
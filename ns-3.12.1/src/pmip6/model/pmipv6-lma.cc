@@ -27,18 +27,23 @@
 
 #include "ns3/log.h"
 #include "ns3/assert.h"
+#include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
 #include "ns3/node.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/ipv6-routing-protocol.h"
 #include "ns3/ipv6-route.h"
 #include "ns3/ipv6-l3-protocol.h"
 #include "ns3/ipv6-interface.h"
+#include "ns3/ipv6-header.h"
 
 #include "ns3/wifi-net-device.h"
 #include "ns3/wifi-mac.h"
 #include "ns3/regular-wifi-mac.h"
+#ifdef NS3_PMIP6_WIMAX
 #include "ns3/wimax-net-device.h"
+#endif
 
 #include "ns3/ipv6-static-routing-helper.h"
 #include "ns3/ipv6-static-routing.h"
@@ -55,6 +60,7 @@
 #include "ipv6-tunnel-l4-protocol.h"
 #include "pmipv6-profile.h"
 #include "pmipv6-prefix-pool.h"
+#include "handover-buffer.h"
 
 #include "pmipv6-lma.h"
 
@@ -67,9 +73,54 @@ namespace ns3
 
 NS_OBJECT_ENSURE_REGISTERED (Pmipv6Lma);
 
+TypeId Pmipv6Lma::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::Pmipv6Lma")
+    .SetParent<Pmipv6Agent> ()
+    .AddConstructor<Pmipv6Lma> ()
+    .AddTraceSource ("RxPbu", "A PBU was received for an MN from a Proxy-CoA, with its lifetime.",
+                     MakeTraceSourceAccessor (&Pmipv6Lma::m_rxPbuTrace))
+    .AddTraceSource ("TxPba", "A PBA was sent for an MN, with its status.",
+                     MakeTraceSourceAccessor (&Pmipv6Lma::m_txPbaTrace))
+    .AddTraceSource ("BceCreated", "A binding cache entry was created for an MN.",
+                     MakeTraceSourceAccessor (&Pmipv6Lma::m_bceCreatedTrace))
+    .AddTraceSource ("BceUpdated", "The binding cache entry of an MN was updated by a PBU with a non-zero lifetime.",
+                     MakeTraceSourceAccessor (&Pmipv6Lma::m_bceUpdatedTrace))
+    .AddTraceSource ("BceDeleted", "The binding cache entry of an MN was deleted.",
+                     MakeTraceSourceAccessor (&Pmipv6Lma::m_bceDeletedTrace))
+    .AddTraceSource ("TunnelSetup", "The tunnel of an MN was set up or moved towards a Proxy-CoA.",
+                     MakeTraceSourceAccessor (&Pmipv6Lma::m_tunnelSetupTrace))
+    .AddTraceSource ("DelayedRegistration", "A PBU of an MN from a new MAG was held until the former MAG deregisters.",
+                     MakeTraceSourceAccessor (&Pmipv6Lma::m_delayedRegistrationTrace))
+    .AddTraceSource ("FlushHeld", "The downlink held for an MN during its handover was sent into its new tunnel, with the number of packets.",
+                     MakeTraceSourceAccessor (&Pmipv6Lma::m_flushHeldTrace))
+    .AddAttribute ("HoldLimit",
+                   "Maximum number of downlink packets held for an MN being handed over.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&Pmipv6Lma::m_holdLimit),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("HoldBytes",
+                   "Maximum number of bytes of downlink packets held for an MN being handed over.",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&Pmipv6Lma::m_holdBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    ;
+  return tid;
+}
+
 Pmipv6Lma::Pmipv6Lma ()
  : m_bCache (0),
-   m_prefixPool (0)
+   m_prefixPool (0),
+   m_nBceCreated (0),
+   m_nBceUpdated (0),
+   m_nBceDeleted (0),
+   m_nDelayedRegistrations (0),
+   m_nPbaRejected (0),
+   m_nTunnelSetups (0),
+   m_holdLimit (64),
+   m_holdBytes (65536),
+   m_nHeldPackets (0),
+   m_nHeldDrops (0)
 {
 }
 
@@ -79,6 +130,27 @@ Pmipv6Lma::~Pmipv6Lma ()
   m_prefixPool = 0;
 }
 
+void Pmipv6Lma::DoDispose ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  for (BufferMapI i = m_buffers.begin (); i != m_buffers.end (); i++)
+    {
+      m_bufferPool.Destroy (i->second);
+    }
+  
+  m_buffers.clear ();
+  
+  Ptr<Ipv6TunnelL4Protocol> th = GetNode () ? GetNode ()->GetObject<Ipv6TunnelL4Protocol> () : 0;
+  
+  if (th)
+    {
+      th->SetSendHoldCallback (MakeNullCallback<bool, Ptr<Packet>, const Ipv6Header &> ());
+    }
+  
+  Pmipv6Agent::DoDispose ();
+}
+
 Ptr<Pmipv6PrefixPool> Pmipv6Lma::GetPrefixPool () const
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -103,6 +175,7 @@ void Pmipv6Lma::NotifyNewAggregate ()
       
       SetNode (node);
       m_bCache->SetNode (node);
+      m_bCache->SetTimerWheel (GetTimerWheel ());
     }
     
   Pmipv6Agent::NotifyNewAggregate ();
@@ -225,12 +298,10 @@ uint8_t Pmipv6Lma::HandlePbu(Ptr<Packet> packet, const Ipv6Address &src, const I
 {
   NS_LOG_FUNCTION (this << packet << src << dst << interface);
   
-  Ptr<Packet> p = packet->Copy ();
-  
   Ipv6MobilityBindingUpdateHeader pbu;
   Ipv6MobilityOptionBundle bundle;
   
-  p->RemoveHeader (pbu);
+  packet->PeekHeader (pbu);
   
   Ptr<Ipv6MobilityDemux> ipv6MobilityDemux = GetNode ()->GetObject<Ipv6MobilityDemux> ();
   NS_ASSERT (ipv6MobilityDemux);
@@ -238,15 +309,18 @@ uint8_t Pmipv6Lma::HandlePbu(Ptr<Packet> packet, const Ipv6Address &src, const I
   Ptr<Ipv6Mobility> ipv6Mobility = ipv6MobilityDemux->GetMobility (pbu.GetMhType ());
   NS_ASSERT (ipv6Mobility);
   
-  uint8_t length = ((pbu.GetHeaderLen () + 1) << 3) - pbu.GetOptionsOffset ();
+  Buffer options = pbu.GetOptionBuffer ();
+  
+  ipv6Mobility->ProcessOptions (options.Begin (), options.GetSize (), bundle);
   
-  ipv6Mobility->ProcessOptions (packet, pbu.GetOptionsOffset (), length, bundle);
+  m_rxPbuTrace (bundle.GetMnIdentifier (), src, pbu.GetLifetime ());
   
   uint8_t errStatus = 0;
   BindingCache::Entry *bce = 0;
   Pmipv6Profile::Entry *pf = 0;
   
   bool delayedRegister = false;
+  bool moved = false;
   
   /* RFC5213 5.3.1 - 4 Check MN Identifier*/
   if (bundle.GetMnIdentifier ().IsEmpty ())
@@ -360,6 +434,11 @@ uint8_t Pmipv6Lma::HandlePbu(Ptr<Packet> packet, const Ipv6Address &src, const I
               if ((bce->GetProxyCoa () == src) || bce->IsDeregistering ())
                 {
                   //update BCE
+                  m_nBceUpdated++;
+                  m_bceUpdatedTrace (mnId);
+                  
+                  moved = (bce->GetProxyCoa () != src);
+                  
                   bce->SetProxyCoa (src);
                   
                   bce->SetMnLinkIdentifier (mnLinkId);
@@ -371,9 +450,16 @@ uint8_t Pmipv6Lma::HandlePbu(Ptr<Packet> packet, const Ipv6Address &src, const I
                   bce->SetReachableTime (Seconds (pbu.GetLifetime ()));
                   bce->SetLastBindingUpdateSequence (pbu.GetSequence ());
                   
+                  //another MAG took the binding over while it was being deregistered
+                  if (moved)
+                    {
+                      ModifyTunnelAndRouting (bce);
+                    }
+                  
                   bce->MarkReachable ();
                   
                   //start lifetime timer
+                  bce->StopDeregisterTimer ();
                   bce->StopReachableTimer ();
                   bce->StartReachableTimer ();
                 }
@@ -404,6 +490,11 @@ uint8_t Pmipv6Lma::HandlePbu(Ptr<Packet> packet, const Ipv6Address &src, const I
                           bce->SetTentativeEntry (bce_temp);
                           
                           bce->MarkRegistering ();
+                          
+                          StartHolding (bce);
+                          
+                          m_nDelayedRegistrations++;
+                          m_delayedRegistrationTrace (mnId);
                       
                           bce->StopRegisterTimer ();
                           bce->StartRegisterTimer ();
@@ -420,6 +511,9 @@ uint8_t Pmipv6Lma::HandlePbu(Ptr<Packet> packet, const Ipv6Address &src, const I
                       NS_LOG_LOGIC ("Handoff in two different mags for the same interface");
                       
                       //update BCE
+                      m_nBceUpdated++;
+                      m_bceUpdatedTrace (mnId);
+                      
                       bce->SetProxyCoa (src);
                       
                       bce->SetMnLinkIdentifier (mnLinkId);
@@ -431,11 +525,13 @@ uint8_t Pmipv6Lma::HandlePbu(Ptr<Packet> packet, const Ipv6Address &src, const I
                       bce->SetReachableTime (Seconds (pbu.GetLifetime ()));
                       bce->SetLastBindingUpdateSequence (pbu.GetSequence ());
                       
-                        ModifyTunnelAndRouting (bce);
+                      moved = true;
+                      ModifyTunnelAndRouting (bce);
 
                       bce->MarkReachable ();
                       
                       //start lifetime timer
+                      bce->StopDeregisterTimer ();
                       bce->StopReachableTimer ();
                       bce->StartReachableTimer ();                      
                     }
@@ -444,12 +540,40 @@ uint8_t Pmipv6Lma::HandlePbu(Ptr<Packet> packet, const Ipv6Address &src, const I
           else
             {
               NS_LOG_LOGIC ("Lifetime is zero.. Deregistering..");
-              if (bce->GetProxyCoa () == src)
+              if (bce->GetProxyCoa () == src && bce->IsRegistering ())
+                {
+                  //the previous MAG let the MN go, the waiting registration goes ahead
+                  SendPba (BuildPba (pbu, bundle, Ipv6MobilityHeader::BA_STATUS_BINDING_UPDATE_ACCEPTED),
+                           mnId, Ipv6MobilityHeader::BA_STATUS_BINDING_UPDATE_ACCEPTED, src);
+                  
+                  bce->StopRegisterTimer ();
+                  DoDelayedRegistration (bce);
+                  
+                  return 0;
+                }
+              else if (bce->GetProxyCoa () == src)
                 {
                   //Deregistering
+                  bce->SetLastBindingUpdateTime (bundle.GetTimestamp ());
+                  bce->SetReachableTime (Seconds (0));
+                  bce->SetLastBindingUpdateSequence (pbu.GetSequence ());
+                  
                   bce->MarkDeregistering ();
                   
                   bce->StartDeregisterTimer ();
+                  
+                  //the MN may show up at another MAG before the entry is deleted
+                  StartHolding (bce);
+                  
+                  //the pool prefixes stay with the entry until it is deleted, a registration
+                  //of the MN with another LMA meanwhile must not take them from the profile
+                  std::list<Ipv6Address> hnps = bce->GetHomeNetworkPrefixes ();
+                  
+                  if (m_prefixPool != 0 && hnps.size () > 0 && m_prefixPool->IsAssigned (hnps.front ())
+                      && pf->GetHomeNetworkPrefixes () == hnps)
+                    {
+                      pf->SetHomeNetworkPrefixes (std::list<Ipv6Address> ());
+                    }
                 }
             }
         }
@@ -458,43 +582,56 @@ uint8_t Pmipv6Lma::HandlePbu(Ptr<Packet> packet, const Ipv6Address &src, const I
           if (pbu.GetLifetime () > 0)
             {
               //No Binding Cache Exists
-              NS_LOG_LOGIC ("Createing new Binding Cache Entry");
-              
-              bce = m_bCache->Add (mnId);
-
-              bce->SetProxyCoa (src);
-              
-              bce->SetMnLinkIdentifier (mnLinkId);
-              bce->SetAccessTechnologyType (bundle.GetAccessTechnologyType ());
-              bce->SetHandoffIndicator (bundle.GetHandoffIndicator ());
-              bce->SetMagLinkAddress (bundle.GetMagLinkAddress ());
-              
-              bce->SetLastBindingUpdateTime (bundle.GetTimestamp ());
-              bce->SetReachableTime (Seconds (pbu.GetLifetime ()));
-              bce->SetLastBindingUpdateSequence (pbu.GetSequence ());
-              
-              //allocate new prefix
-              std::list<Ipv6Address> hnpList;
+              std::list<Ipv6Address> hnps;
               
               if (pf && pf->GetHomeNetworkPrefixes ().size () > 0)
                 {
-                  bce->SetHomeNetworkPrefixes (pf->GetHomeNetworkPrefixes ());
+                  hnps = pf->GetHomeNetworkPrefixes ();
                 }
               else
                 {
+                  //allocate new prefix
                   Ipv6Address prefix = m_prefixPool->Assign ();
                   
-                  NS_LOG_LOGIC ("Assign new Prefix from Pool: " << prefix);
+                  if (prefix.IsAny ())
+                    {
+                      NS_LOG_LOGIC ("Prefix pool exhausted.. Rejecting");
+                      
+                      SendPba (BuildPba (pbu, bundle, Ipv6MobilityHeader::BA_STATUS_INSUFFICIENT_RESOURCES),
+                               mnId, Ipv6MobilityHeader::BA_STATUS_INSUFFICIENT_RESOURCES, src);
+                      
+                      return 0;
+                    }
                   
-                  hnpList.push_back (prefix);
+                  NS_LOG_LOGIC ("Assign new Prefix from Pool: " << prefix);
                   
-                  bce->SetHomeNetworkPrefixes (hnpList);
+                  hnps.push_back (prefix);
                   
                   if (pf)
                     {
-                      pf->SetHomeNetworkPrefixes (hnpList);
+                      pf->SetHomeNetworkPrefixes (hnps);
                     }
                 }
+              
+              NS_LOG_LOGIC ("Createing new Binding Cache Entry");
+              
+              bce = m_bCache->Add (mnId);
+              
+              m_nBceCreated++;
+              m_bceCreatedTrace (mnId);
+
+              bce->SetProxyCoa (src);
+              
+              bce->SetMnLinkIdentifier (mnLinkId);
+              bce->SetAccessTechnologyType (bundle.GetAccessTechnologyType ());
+              bce->SetHandoffIndicator (bundle.GetHandoffIndicator ());
+              bce->SetMagLinkAddress (bundle.GetMagLinkAddress ());
+              
+              bce->SetLastBindingUpdateTime (bundle.GetTimestamp ());
+              bce->SetReachableTime (Seconds (pbu.GetLifetime ()));
+              bce->SetLastBindingUpdateSequence (pbu.GetSequence ());
+              
+              bce->SetHomeNetworkPrefixes (hnps);
                 
               //create tunnel
               SetupTunnelAndRouting (bce);
@@ -523,7 +660,19 @@ uint8_t Pmipv6Lma::HandlePbu(Ptr<Packet> packet, const Ipv6Address &src, const I
         pktPba = BuildPba (pbu, bundle, errStatus);
       }
       
-    SendMessage (pktPba, src, 64);
+    Time delay = SendPba (pktPba, bundle.GetMnIdentifier (), errStatus, src);
+    
+    //the packets held during the handover follow the PBA into the new tunnel
+    if (bce != 0 && bce->IsReachable ())
+      {
+        //the new MAG cannot route the downlink before a bulked PBA
+        if (moved && delay.IsStrictlyPositive ())
+          {
+            StartHolding (bce);
+          }
+        
+        Simulator::Schedule (delay, &Pmipv6Lma::FlushHeldBehindPba, this, bce->GetMnIdentifier (), bce->GetProxyCoa ());
+      }
 
   return 0;
 }
@@ -540,6 +689,9 @@ bool Pmipv6Lma::SetupTunnelAndRouting (BindingCache::Entry *bce)
   
   bce->SetTunnelIfIndex (tunnelIf);
   
+  m_nTunnelSetups++;
+  m_tunnelSetupTrace (bce->GetMnIdentifier (), bce->GetProxyCoa ());
+  
   //routing setup by static routing protocol
   Ipv6StaticRoutingHelper staticRoutingHelper;
   Ptr<Ipv6> ipv6 = GetNode ()->GetObject<Ipv6> ();
@@ -603,6 +755,10 @@ bool Pmipv6Lma::ModifyTunnelAndRouting (BindingCache::Entry *bce)
       std::list<Ipv6Address> hnpList = bce->GetHomeNetworkPrefixes ();
       
       bce->SetTunnelIfIndex (tunnelIf);
+      
+      m_nTunnelSetups++;
+      m_tunnelSetupTrace (bce->GetMnIdentifier (), bce->GetProxyCoa ());
+      
       for (std::list<Ipv6Address>::iterator i = hnpList.begin (); i != hnpList.end (); i++)
         {
           NS_LOG_LOGIC ("Modify Route " << (*i) << "/64 via " << (uint32_t)oldTunnelIf << " to " << tunnelIf);
@@ -614,6 +770,124 @@ bool Pmipv6Lma::ModifyTunnelAndRouting (BindingCache::Entry *bce)
   return true;
 }
 
+uint32_t Pmipv6Lma::ClearBindings (Ipv6Address pcoa)
+{
+  NS_LOG_FUNCTION (this << pcoa);
+  
+  std::list<BindingCache::Entry *> entries = m_bCache->LookupByProxyCoa (pcoa);
+  
+  for (std::list<BindingCache::Entry *>::iterator i = entries.begin (); i != entries.end (); i++)
+    {
+      NS_LOG_LOGIC ("Clear binding " << (*i)->GetMnIdentifier () << " via " << pcoa);
+      
+      RemoveBinding ((*i));
+    }
+  
+  return entries.size ();
+}
+
+void Pmipv6Lma::RemoveBinding (BindingCache::Entry *bce)
+{
+  NS_LOG_FUNCTION (this << bce);
+  
+  if (bce->GetTunnelIfIndex () >= 0)
+    {
+      ClearTunnelAndRouting (bce);
+    }
+  
+  ReleasePrefixes (bce);
+  
+  DropHeld (bce->GetMnIdentifier ());
+  
+  BindingCache::Entry *bce_temp = bce->GetTentativeEntry ();
+  
+  if (bce_temp)
+    {
+      bce->SetTentativeEntry (0);
+      m_bCache->DeleteEntry (bce_temp);
+    }
+  
+  m_nBceDeleted++;
+  m_bceDeletedTrace (bce->GetMnIdentifier ());
+  
+  m_bCache->Remove (bce);
+}
+
+uint32_t Pmipv6Lma::GetNBindings () const
+{
+  return m_bCache == 0 ? 0 : m_bCache->GetNEntries ();
+}
+
+uint32_t Pmipv6Lma::GetNBceCreated () const
+{
+  return m_nBceCreated;
+}
+
+uint32_t Pmipv6Lma::GetNBceUpdated () const
+{
+  return m_nBceUpdated;
+}
+
+uint32_t Pmipv6Lma::GetNBceDeleted () const
+{
+  return m_nBceDeleted;
+}
+
+uint32_t Pmipv6Lma::GetNDelayedRegistrations () const
+{
+  return m_nDelayedRegistrations;
+}
+
+uint32_t Pmipv6Lma::GetNPbaRejected () const
+{
+  return m_nPbaRejected;
+}
+
+uint32_t Pmipv6Lma::GetNTunnelSetups () const
+{
+  return m_nTunnelSetups;
+}
+
+uint32_t Pmipv6Lma::GetNHeldPackets () const
+{
+  return m_nHeldPackets;
+}
+
+uint32_t Pmipv6Lma::GetNHeldDrops () const
+{
+  return m_nHeldDrops;
+}
+
+void Pmipv6Lma::ReleasePrefixes (BindingCache::Entry *bce)
+{
+  NS_LOG_FUNCTION (this << bce);
+  
+  if (m_prefixPool == 0)
+    {
+      return;
+    }
+  
+  std::list<Ipv6Address> hnpList = bce->GetHomeNetworkPrefixes ();
+  bool released = false;
+  
+  for (std::list<Ipv6Address>::iterator i = hnpList.begin (); i != hnpList.end (); i++)
+    {
+      if (m_prefixPool->Release ((*i)))
+        {
+          NS_LOG_LOGIC ("Release Prefix to Pool: " << (*i));
+          released = true;
+        }
+    }
+  
+  //the profile kept the prefixes for the next attachment, they may now go to another MN
+  Pmipv6Profile::Entry *pf = GetProfile ()->Lookup (bce->GetMnIdentifier ());
+  
+  if (released && pf && pf->GetHomeNetworkPrefixes () == hnpList)
+    {
+      pf->SetHomeNetworkPrefixes (std::list<Ipv6Address> ());
+    }
+}
+
 void Pmipv6Lma::DoDelayedRegistration (BindingCache::Entry *bce)
 {
   NS_LOG_FUNCTION (this << bce);
@@ -634,7 +908,10 @@ void Pmipv6Lma::DoDelayedRegistration (BindingCache::Entry *bce)
   bce->SetReachableTime (bce_temp->GetReachableTime ());
   bce->SetLastBindingUpdateSequence (bce_temp->GetLastBindingUpdateSequence ());  
 
-  delete bce_temp;
+  m_bCache->DeleteEntry (bce_temp);
+  
+  m_nBceUpdated++;
+  m_bceUpdatedTrace (bce->GetMnIdentifier ());
   
   ModifyTunnelAndRouting (bce);
 
@@ -648,8 +925,157 @@ void Pmipv6Lma::DoDelayedRegistration (BindingCache::Entry *bce)
   Ptr<Packet> pktPba;
   pktPba = BuildPba (bce, Ipv6MobilityHeader::BA_STATUS_BINDING_UPDATE_ACCEPTED);
   
-  SendMessage (pktPba, bce->GetProxyCoa (), 64);
+  Time delay = SendPba (pktPba, bce->GetMnIdentifier (), Ipv6MobilityHeader::BA_STATUS_BINDING_UPDATE_ACCEPTED, bce->GetProxyCoa ());
+  
+  Simulator::Schedule (delay, &Pmipv6Lma::FlushHeldBehindPba, this, bce->GetMnIdentifier (), bce->GetProxyCoa ());
 }
 
-} /* namespace ns3 */
+Time Pmipv6Lma::SendPba (Ptr<Packet> pba, const Identifier &mnId, uint8_t status, Ipv6Address dst)
+{
+  NS_LOG_FUNCTION (this << pba << mnId << (uint32_t)status << dst);
+  
+  //error codes start at 128, RFC 3775 6.1.8
+  if (status >= 128)
+    {
+      m_nPbaRejected++;
+    }
+  
+  m_txPbaTrace (mnId, status);
+  
+  return SendMessage (pba, dst, 64);
+}
+
+void Pmipv6Lma::StartHolding (BindingCache::Entry *bce)
+{
+  NS_LOG_FUNCTION (this << bce);
+  
+  Identifier mnId = bce->GetMnIdentifier ();
+  
+  if (m_buffers.find (mnId) != m_buffers.end ())
+    {
+      return;
+    }
+  
+  if (m_buffers.empty ())
+    {
+      Ptr<Ipv6TunnelL4Protocol> th = GetNode ()->GetObject<Ipv6TunnelL4Protocol> ();
+      NS_ASSERT (th);
+      
+      th->SetSendHoldCallback (MakeCallback (&Pmipv6Lma::HoldPacket, this));
+    }
+  
+  m_buffers[mnId] = m_bufferPool.Create (m_holdLimit, m_holdBytes);
+}
 
+bool Pmipv6Lma::HoldPacket (Ptr<Packet> packet, const Ipv6Header &header)
+{
+  NS_LOG_FUNCTION (this << packet);
+  
+  Ipv6Address prefix = header.GetDestinationAddress ();
+  
+  BindingCache::Entry *bce = m_bCache->LookupByHomeNetworkPrefix (prefix.CombinePrefix (Ipv6Prefix (64)));
+  
+  if (bce == 0)
+    {
+      return false;
+    }
+  
+  BufferMapI it = m_buffers.find (bce->GetMnIdentifier ());
+  
+  if (it == m_buffers.end ())
+    {
+      return false;
+    }
+  
+  if (!it->second->Enqueue (packet))
+    {
+      NS_LOG_LOGIC ("No room left to hold packets for " << it->first);
+      
+      m_nHeldDrops++;
+      
+      return true;
+    }
+  
+  m_nHeldPackets++;
+  
+  return true;
+}
+
+uint32_t Pmipv6Lma::FlushHeld (Identifier mnId, Ipv6Address proxyCoa)
+{
+  NS_LOG_FUNCTION (this << mnId << proxyCoa);
+  
+  BufferMapI it = m_buffers.find (mnId);
+  
+  if (it == m_buffers.end ())
+    {
+      return 0;
+    }
+  
+  HandoverBuffer *buffer = it->second;
+  
+  m_buffers.erase (it);
+  
+  Ptr<Ipv6TunnelL4Protocol> th = GetNode ()->GetObject<Ipv6TunnelL4Protocol> ();
+  NS_ASSERT (th);
+  
+  if (m_buffers.empty ())
+    {
+      th->SetSendHoldCallback (MakeNullCallback<bool, Ptr<Packet>, const Ipv6Header &> ());
+    }
+  
+  Ptr<TunnelNetDevice> dev = th->GetTunnelDevice (proxyCoa);
+  uint32_t n = 0;
+  
+  if (dev != 0)
+    {
+      for (Ptr<Packet> p = buffer->Dequeue (); p != 0; p = buffer->Dequeue ())
+        {
+          dev->Send (p, dev->GetBroadcast (), Ipv6L3Protocol::PROT_NUMBER);
+          n++;
+        }
+    }
+  
+  m_nHeldDrops += buffer->Clear ();
+  
+  m_bufferPool.Destroy (buffer);
+  
+  m_flushHeldTrace (mnId, n);
+  
+  return n;
+}
+
+void Pmipv6Lma::FlushHeldBehindPba (Identifier mnId, Ipv6Address proxyCoa)
+{
+  NS_LOG_FUNCTION (this << mnId << proxyCoa);
+  
+  Simulator::ScheduleNow (&Pmipv6Lma::FlushHeld, this, mnId, proxyCoa);
+}
+
+void Pmipv6Lma::DropHeld (const Identifier &mnId)
+{
+  NS_LOG_FUNCTION (this << mnId);
+  
+  BufferMapI it = m_buffers.find (mnId);
+  
+  if (it == m_buffers.end ())
+    {
+      return;
+    }
+  
+  m_nHeldDrops += it->second->Clear ();
+  
+  m_bufferPool.Destroy (it->second);
+  
+  m_buffers.erase (it);
+  
+  if (m_buffers.empty ())
+    {
+      Ptr<Ipv6TunnelL4Protocol> th = GetNode ()->GetObject<Ipv6TunnelL4Protocol> ();
+      NS_ASSERT (th);
+      
+      th->SetSendHoldCallback (MakeNullCallback<bool, Ptr<Packet>, const Ipv6Header &> ());
+    }
+}
+
+} /* namespace ns3 */
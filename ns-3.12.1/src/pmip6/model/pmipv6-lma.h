@@ -25,17 +25,23 @@
 #ifndef PMIPV6_LMA_H
 #define PMIPV6_LMA_H
 
+#include "ns3/traced-callback.h"
+
 #include "pmipv6-agent.h"
 #include "binding-cache.h"
+#include "handover-buffer.h"
 
 namespace ns3
 {
 class Packet;
+class Ipv6Header;
 class Ipv6MobilityOptionBundle;
 class Pmipv6PrefixPool;
 
 class Pmipv6Lma : public Pmipv6Agent {
 public:
+  static TypeId GetTypeId ();
+  
   Pmipv6Lma ();
   
   virtual ~Pmipv6Lma ();
@@ -45,8 +51,70 @@ public:
   
   void DoDelayedRegistration (BindingCache::Entry *bce);
   
+  /**
+   * \brief Tear down every binding registered through a MAG, e.g. on MAG failure.
+   * \param pcoa Proxy-CoA of the MAG
+   * \return number of removed bindings
+   */
+  uint32_t ClearBindings (Ipv6Address pcoa);
+  
+  /**
+   * \brief Delete a binding whose lifetime expired or which was deregistered.
+   * \param bce the entry, deleted on return
+   *
+   * The tunnel and routes of the binding are torn down and the prefixes
+   * it got from the prefix pool are released.
+   */
+  void RemoveBinding (BindingCache::Entry *bce);
+  
+  /**
+   * \return number of bindings in the binding cache
+   */
+  uint32_t GetNBindings () const;
+  
+  /**
+   * \return number of binding cache entries created
+   */
+  uint32_t GetNBceCreated () const;
+  
+  /**
+   * \return number of binding cache entries updated by a PBU with a non-zero lifetime
+   */
+  uint32_t GetNBceUpdated () const;
+  
+  /**
+   * \return number of binding cache entries deleted
+   */
+  uint32_t GetNBceDeleted () const;
+  
+  /**
+   * \return number of PBUs held for a delayed registration
+   */
+  uint32_t GetNDelayedRegistrations () const;
+  
+  /**
+   * \return number of PBAs sent with an error status
+   */
+  uint32_t GetNPbaRejected () const;
+  
+  /**
+   * \return number of tunnels set up or moved towards a MAG
+   */
+  uint32_t GetNTunnelSetups () const;
+  
+  /**
+   * \return number of downlink packets held for bindings being handed over
+   */
+  uint32_t GetNHeldPackets () const;
+  
+  /**
+   * \return number of held packets dropped, for lack of room or of a new registration
+   */
+  uint32_t GetNHeldDrops () const;
+  
 protected:
   virtual void NotifyNewAggregate ();
+  virtual void DoDispose ();
   
   Ptr<Packet> BuildPba (BindingCache::Entry *bce, uint8_t status);
   Ptr<Packet> BuildPba (Ipv6MobilityBindingUpdateHeader pbu, Ipv6MobilityOptionBundle bundle, uint8_t status);
@@ -56,11 +124,91 @@ protected:
   bool SetupTunnelAndRouting (BindingCache::Entry *bce);
   bool ModifyTunnelAndRouting (BindingCache::Entry *bce);
   void ClearTunnelAndRouting (BindingCache::Entry *bce); 
+  
+  /**
+   * \brief Give the pool prefixes of a binding back, and forget them in the MN profile.
+   */
+  void ReleasePrefixes (BindingCache::Entry *bce);
+  
+  /**
+   * \brief Send a PBA and account it.
+   * \return time until the PBA leaves, in a bulk or alone
+   */
+  Time SendPba (Ptr<Packet> pba, const Identifier &mnId, uint8_t status, Ipv6Address dst);
+  
+  /**
+   * \brief Hold the downlink of a binding until a MAG registers it again.
+   *
+   * Called when the MAG of the binding deregisters it, or when a new MAG
+   * waits for a delayed registration: the tunnel still leads to a MAG the
+   * MN has left. Also called when the tunnel moves to a new MAG whose PBA
+   * waits in a bulk: the new MAG holds no downlink itself.
+   */
+  void StartHolding (BindingCache::Entry *bce);
+  
+  /**
+   * \brief Keep back the packets to the prefixes of the bindings being held.
+   * \return true if the packet was kept or dropped
+   */
+  bool HoldPacket (Ptr<Packet> packet, const Ipv6Header &header);
+  
+  /**
+   * \brief Send the packets held for an MN into its tunnel to a MAG, and stop holding.
+   * \return number of packets sent
+   *
+   * Scheduled after the PBA leaves: the new MAG learns the prefixes of the
+   * MN from the PBA, and only holds the packets to these prefixes.
+   */
+  uint32_t FlushHeld (Identifier mnId, Ipv6Address proxyCoa);
+  
+  /**
+   * \brief Send the packets held for an MN once the PBA is on its way.
+   *
+   * Called when the PBA leaves. A MAG handles a PBA in an event of its
+   * own: the packets follow in the next event, not to overtake it on
+   * links without delay.
+   */
+  void FlushHeldBehindPba (Identifier mnId, Ipv6Address proxyCoa);
+  
+  /**
+   * \brief Drop the packets held for an MN, and stop holding.
+   */
+  void DropHeld (const Identifier &mnId);
 
 private:
+  typedef sgi::hash_map<Identifier, HandoverBuffer *, IdentifierHash> BufferMap;
+  typedef sgi::hash_map<Identifier, HandoverBuffer *, IdentifierHash>::iterator BufferMapI;
+  
   Ptr<BindingCache> m_bCache;
   
   Ptr<Pmipv6PrefixPool> m_prefixPool;
+  
+  uint32_t m_nBceCreated;
+  uint32_t m_nBceUpdated;
+  uint32_t m_nBceDeleted;
+  uint32_t m_nDelayedRegistrations;
+  uint32_t m_nPbaRejected;
+  uint32_t m_nTunnelSetups;
+  
+  /**
+   * \brief Downlink held for the bindings being handed over, by MN.
+   */
+  BufferMap m_buffers;
+  HandoverBufferPool m_bufferPool;
+  
+  uint32_t m_holdLimit;
+  uint32_t m_holdBytes;
+  uint32_t m_nHeldPackets;
+  uint32_t m_nHeldDrops;
+  
+  TracedCallback<const Identifier &, Ipv6Address, uint16_t> m_rxPbuTrace;
+  TracedCallback<const Identifier &, uint8_t> m_txPbaTrace;
+  TracedCallback<const Identifier &> m_bceCreatedTrace;
+  TracedCallback<const Identifier &> m_bceUpdatedTrace;
+  TracedCallback<const Identifier &> m_bceDeletedTrace;
+  TracedCallback<const Identifier &, Ipv6Address> m_tunnelSetupTrace;
+  TracedCallback<const Identifier &> m_delayedRegistrationTrace;
+  TracedCallback<const Identifier &, uint32_t> m_flushHeldTrace;
 };
 
 } /* namespace ns3 */
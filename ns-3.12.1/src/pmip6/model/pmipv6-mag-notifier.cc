@@ -35,7 +35,9 @@
 #include "ns3/wifi-net-device.h"
 #include "ns3/wifi-mac.h"
 #include "ns3/regular-wifi-mac.h"
+#ifdef NS3_PMIP6_WIMAX
 #include "ns3/wimax-net-device.h"
+#endif
 #include "ns3/point-to-point-net-device.h"
 
 #include "ns3/ipv6-l3-protocol.h"
@@ -27,6 +27,9 @@
 
 #include "ns3/log.h"
 #include "ns3/assert.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
 #include "ns3/packet.h"
 #include "ns3/node.h"
 #include "ns3/ipv6-routing-protocol.h"
@@ -37,7 +40,13 @@
 #include "ns3/wifi-net-device.h"
 #include "ns3/wifi-mac.h"
 #include "ns3/regular-wifi-mac.h"
+#ifdef NS3_PMIP6_WIMAX
 #include "ns3/wimax-net-device.h"
+#include "ns3/bs-net-device.h"
+#endif
+#ifdef NS3_PMIP6_LTE
+#include "ns3/enb-net-device.h"
+#endif
 
 #include "ns3/point-to-point-net-device.h"
 
@@ -56,7 +65,9 @@
 #include "ipv6-tunnel-l4-protocol.h"
 #include "unicast-radvd.h"
 #include "pmipv6-profile.h"
+#include "pmipv6-lma-cluster.h"
 #include "pmipv6-mag-notifier.h"
+#include "handover-buffer.h"
 #include "pmipv6-mag.h"
 
 using namespace std;
@@ -68,11 +79,67 @@ namespace ns3
 
 NS_OBJECT_ENSURE_REGISTERED (Pmipv6Mag);
 
+TypeId Pmipv6Mag::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::Pmipv6Mag")
+    .SetParent<Pmipv6Agent> ()
+    .AddConstructor<Pmipv6Mag> ()
+    .AddTraceSource ("Attach", "An MN with a profile attached, given by MN identifier and MN link identifier.",
+                     MakeTraceSourceAccessor (&Pmipv6Mag::m_attachTrace))
+    .AddTraceSource ("Detach", "An MN with a binding left its access link, given by MN identifier and MN link identifier.",
+                     MakeTraceSourceAccessor (&Pmipv6Mag::m_detachTrace))
+    .AddTraceSource ("TxPbu", "A new PBU was sent for an MN to an LMA, with its lifetime.",
+                     MakeTraceSourceAccessor (&Pmipv6Mag::m_txPbuTrace))
+    .AddTraceSource ("RetransmitPbu", "The PBU of an MN was sent again, with the retry count.",
+                     MakeTraceSourceAccessor (&Pmipv6Mag::m_retransmitPbuTrace))
+    .AddTraceSource ("RxPba", "A PBA matching the last PBU of an MN was received, with its status and lifetime.",
+                     MakeTraceSourceAccessor (&Pmipv6Mag::m_rxPbaTrace))
+    .AddTraceSource ("TunnelSetup", "A tunnel to the LMA of an MN was set up.",
+                     MakeTraceSourceAccessor (&Pmipv6Mag::m_tunnelSetupTrace))
+    .AddTraceSource ("TxHi", "A Handover Initiate was sent for an MN to the MAG it is moving to.",
+                     MakeTraceSourceAccessor (&Pmipv6Mag::m_txHiTrace))
+    .AddTraceSource ("RxHack", "A Handover Acknowledge was received for an MN, with its code.",
+                     MakeTraceSourceAccessor (&Pmipv6Mag::m_rxHackTrace))
+    .AddTraceSource ("PredictiveAttach", "A pre-registered MN attached, with the number of held packets sent on.",
+                     MakeTraceSourceAccessor (&Pmipv6Mag::m_predictiveAttachTrace))
+    .AddAttribute ("PredictionTimeout",
+                   "How long an MN registered on a Handover Initiate has to attach before it is deregistered.",
+                   TimeValue (Seconds (3.0)),
+                   MakeTimeAccessor (&Pmipv6Mag::m_predictionTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("HoldLimit",
+                   "Maximum number of downlink packets held for an MN not registered or not attached yet.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&Pmipv6Mag::m_holdLimit),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("HoldBytes",
+                   "Maximum number of bytes of downlink packets held for an MN not registered or not attached yet.",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&Pmipv6Mag::m_holdBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    ;
+  return tid;
+}
+
 Pmipv6Mag::Pmipv6Mag ()
 : m_useRemoteAp (false),
   m_sequence (0),
   m_buList (0),
-  m_radvd (0)
+  m_radvd (0),
+  m_lmaCluster (0),
+  m_nRehomed (0),
+  m_holdLimit (64),
+  m_holdBytes (65536),
+  m_nHandoversInitiated (0),
+  m_nPreRegistrations (0),
+  m_nPredictiveAttaches (0),
+  m_nHeldPackets (0),
+  m_nHeldDrops (0),
+  m_nAttaches (0),
+  m_nDetaches (0),
+  m_nRetransmissions (0),
+  m_nPbaRejected (0),
+  m_nTunnelSetups (0)
 {
 }
 
@@ -80,6 +147,38 @@ Pmipv6Mag::~Pmipv6Mag ()
 {
 }
 
+void Pmipv6Mag::DoDispose ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  SetLmaCluster (0);
+
+  for (PredictionMapI i = m_predictions.begin (); i != m_predictions.end (); i++)
+    {
+      i->second.m_expireEvent.Cancel ();
+    }
+
+  m_predictions.clear ();
+  m_handovers.clear ();
+
+  for (BufferMapI i = m_buffers.begin (); i != m_buffers.end (); i++)
+    {
+      m_bufferPool.Destroy (i->second.m_buffer);
+    }
+
+  m_buffers.clear ();
+  m_heldPrefixes.clear ();
+
+  Ptr<Ipv6TunnelL4Protocol> th = GetNode () ? GetNode ()->GetObject<Ipv6TunnelL4Protocol> () : 0;
+
+  if (th)
+    {
+      th->SetHoldCallback (MakeNullCallback<bool, Ptr<Packet>, const Ipv6Address &, const Ipv6Header &> ());
+    }
+
+  Pmipv6Agent::DoDispose ();
+}
+
 void Pmipv6Mag::NotifyNewAggregate ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -92,10 +191,11 @@ void Pmipv6Mag::NotifyNewAggregate ()
 
 	  m_buList = CreateObject<BindingUpdateList> ();
       m_buList->SetNode (node);
+      m_buList->SetTimerWheel (GetTimerWheel ());
 
       if (!m_useRemoteAp)
         {
-          //register linkup callback.
+          //register attach and detach callbacks of the access devices.
           uint32_t nDev = node->GetNDevices ();
 
           for (uint32_t i = 0; i < nDev; ++i)
@@ -114,7 +214,32 @@ void Pmipv6Mag::NotifyNewAggregate ()
                     }
 
                   rmac->SetNewHostCallback (MakeCallback (&Pmipv6Mag::HandleNewNode, this));
+                  rmac->SetDelHostCallback (MakeCallback (&Pmipv6Mag::HandleDelNode, this));
+
+                  continue;
+                }
+
+#ifdef NS3_PMIP6_WIMAX
+              Ptr<BaseStationNetDevice> bsDev = dev->GetObject<BaseStationNetDevice> ();
+
+              if (bsDev)
+                {
+                  bsDev->SetNewHostCallback (MakeCallback (&Pmipv6Mag::HandleNewNode, this));
+                  bsDev->SetDelHostCallback (MakeCallback (&Pmipv6Mag::HandleDelNode, this));
+
+                  continue;
+                }
+#endif
+
+#ifdef NS3_PMIP6_LTE
+              Ptr<EnbNetDevice> enbDev = dev->GetObject<EnbNetDevice> ();
+
+              if (enbDev)
+                {
+                  enbDev->SetNewHostCallback (MakeCallback (&Pmipv6Mag::HandleNewNode, this));
+                  enbDev->SetDelHostCallback (MakeCallback (&Pmipv6Mag::HandleDelNode, this));
                 }
+#endif
             }
         }
 	  else
@@ -197,7 +322,12 @@ Ptr<UnicastRadvd> Pmipv6Mag::GetRadvd () const
 
 Ptr<Packet> Pmipv6Mag::BuildPbu (BindingUpdateList::Entry *bule)
 {
-  NS_LOG_FUNCTION(this << bule);
+  return BuildPbu (bule, (uint16_t)Ipv6MobilityL4Protocol::MAX_BINDING_LIFETIME);
+}
+
+Ptr<Packet> Pmipv6Mag::BuildPbu (BindingUpdateList::Entry *bule, uint16_t lifetime)
+{
+  NS_LOG_FUNCTION(this << bule << lifetime);
 
   Ptr<Packet> p = Create<Packet> ();
 
@@ -216,7 +346,7 @@ Ptr<Packet> Pmipv6Mag::BuildPbu (BindingUpdateList::Entry *bule)
   pbu.SetFlagL (true);
   pbu.SetFlagP (true);
 
-  pbu.SetLifetime ((uint16_t)Ipv6MobilityL4Protocol::MAX_BINDING_LIFETIME);
+  pbu.SetLifetime (lifetime);
 
   //Add Mobile Node Identifier Option
   mnidh.SetSubtype (1);
@@ -292,17 +422,102 @@ void Pmipv6Mag::HandleNewNode (Mac48Address from, Mac48Address to, uint8_t att)
       return;
     }
 
+  m_nAttaches++;
+  m_attachTrace (pf->GetMnIdentifier (), pf->GetMnLinkIdentifier ());
+
+  //the MN did not go where it was handed over to
+  m_handovers.erase (pf->GetMnIdentifier ());
+
   //check BUL
   BindingUpdateList::Entry *bule = m_buList->Lookup (pf->GetMnIdentifier ());
 
+  if (bule != 0 && bule->IsPredictive ())
+    {
+      bule->SetPredictive (false);
+
+      if (GetInterfaceForAddress (to) == bule->GetIfIndex ())
+        {
+          //registered on a Handover Initiate, only the RAs are missing
+          bule->SetAccessTechnologyType (att);
+          m_nPredictiveAttaches++;
+
+          uint32_t released = 0;
+
+          if (bule->IsReachable ())
+            {
+              SetupRadvdInterface (bule);
+              released = ReleaseHeld (pf->GetMnIdentifier ());
+            }
+
+          //otherwise both wait for the PBA
+          m_predictiveAttachTrace (pf->GetMnIdentifier (), released);
+
+          return;
+        }
+
+      //attached to another access link than announced, register it anew
+      if (bule->GetTunnelIfIndex () >= 0)
+        {
+          ClearTunnelAndRouting (bule);
+        }
+
+      bule->MarkUnreachable ();
+    }
+
   if (bule == 0)
     {
       bule = m_buList->Add (pf->GetMnIdentifier ());
     }
 
+  PrepareEntry (bule, pf, att);
+
+  //Get IfIndex from "to"
+  int32_t ifIndex = GetInterfaceForAddress (to);
+
+  if (ifIndex == -1)
+    {
+      return;
+    }
+
+  bule->SetIfIndex (ifIndex);
+
+  SendPbu (bule, (uint16_t)Ipv6MobilityL4Protocol::MAX_BINDING_LIFETIME);
+
+  //the LMA holds the downlink until the PBA, only a handover announced
+  //by the previous MAG is held here
+  if (bule->IsReachable ())
+    {
+      bule->MarkRefreshing ();
+    }
+  else
+    {
+      bule->MarkUpdating ();
+    }
+}
+
+void Pmipv6Mag::PrepareEntry (BindingUpdateList::Entry *bule, Pmipv6Profile::Entry *pf, uint8_t att)
+{
+  NS_LOG_FUNCTION (this << bule << pf << (uint32_t)att);
+
   bule->SetAccessTechnologyType (att);
   bule->SetMnLinkIdentifier (pf->GetMnLinkIdentifier ());
-  bule->SetLmaAddress (pf->GetLmaAddress ());
+
+  if (m_lmaCluster != 0)
+    {
+      //an existing binding gives up its placement, an unset LMA is ignored
+      m_lmaCluster->Release (bule->GetLmaAddress ());
+
+      Ipv6Address lma = m_lmaCluster->Place (pf->GetMnIdentifier ());
+
+      //a pending move is superseded by this attachment
+      m_rehoming.erase (pf->GetMnIdentifier ());
+
+      bule->SetLmaAddress (lma.IsAny () ? pf->GetLmaAddress () : lma);
+    }
+  else
+    {
+      bule->SetLmaAddress (pf->GetLmaAddress ());
+    }
 
   if (pf->GetHomeNetworkPrefixes ().size () > 0)
     {
@@ -317,8 +532,90 @@ void Pmipv6Mag::HandleNewNode (Mac48Address from, Mac48Address to, uint8_t att)
     {
       bule->SetMagLinkAddress (lla);
     }
+}
+
+void Pmipv6Mag::HandleDelNode (Mac48Address from, Mac48Address to, uint8_t att)
+{
+  NS_LOG_FUNCTION (this << from << to << (uint32_t)att);
+  NS_ASSERT (GetProfile () != 0);
+
+  Pmipv6Profile::Entry *pf = GetProfile ()->Lookup (Identifier (from));
+
+  if (pf == 0)
+    {
+      NS_LOG_LOGIC ("No profile exists for MAC(" << from << ") ATT(" << (uint32_t)att << ")");
+      return;
+    }
+
+  BindingUpdateList::Entry *bule = m_buList->Lookup (pf->GetMnIdentifier ());
+
+  if (bule == 0)
+    {
+      NS_LOG_LOGIC ("No binding for " << pf->GetMnIdentifier ());
+      return;
+    }
+
+  //the MN may have attached to another access link of this MAG meanwhile
+  if (GetInterfaceForAddress (to) != bule->GetIfIndex ())
+    {
+      NS_LOG_LOGIC ("MN " << pf->GetMnIdentifier () << " is attached to another interface. Ignored.");
+      return;
+    }
+
+  m_nDetaches++;
+  m_detachTrace (pf->GetMnIdentifier (), pf->GetMnLinkIdentifier ());
+
+  //a pending move is superseded by this detachment
+  m_rehoming.erase (pf->GetMnIdentifier ());
+
+  HandoverMapI it = m_handovers.find (pf->GetMnIdentifier ());
+  bool handedOver = (it != m_handovers.end () && it->second.m_accepted);
+
+  if (it != m_handovers.end ())
+    {
+      m_handovers.erase (it);
+    }
+
+  DropHeld (pf->GetMnIdentifier ());
+
+  //an outstanding PBU is superseded by the de-registration
+  bule->StopRetransTimer ();
+  bule->StopRefreshTimer ();
+  bule->StopReachableTimer ();
+
+  if (bule->GetRadvdIfIndex () >= 0)
+    {
+      ClearRadvdInterface (bule);
+    }
+
+  if (bule->GetTunnelIfIndex () >= 0)
+    {
+      ClearTunnelAndRouting (bule);
+    }
+
+  if (handedOver)
+    {
+      //the binding belongs to the new MAG already
+      if (m_lmaCluster != 0)
+        {
+          m_lmaCluster->Release (bule->GetLmaAddress ());
+        }
+
+      m_buList->Remove (bule);
+
+      return;
+    }
+
+  bule->MarkUnreachable ();
+
+  //the entry is removed on the PBA
+  SendPbu (bule, 0);
+}
+
+int32_t Pmipv6Mag::GetInterfaceForAddress (Mac48Address addr)
+{
+  NS_LOG_FUNCTION (this << addr);
 
-  //Get IfIndex from "to"
   uint32_t nDev = GetNode ()->GetNDevices ();
   Ptr<NetDevice> dev = 0;
   bool found = false;
@@ -327,10 +624,10 @@ void Pmipv6Mag::HandleNewNode (Mac48Address from, Mac48Address to, uint8_t att)
     {
       dev = GetNode ()->GetDevice (i);
 
-      if (Mac48Address::ConvertFrom (dev->GetAddress ()) == to)
+      if (Mac48Address::ConvertFrom (dev->GetAddress ()) == addr)
         {
           found = true;
-          NS_LOG_LOGIC ("Found Device (" << dev->GetIfIndex () << ") for MAC address (" << to << ")");
+          NS_LOG_LOGIC ("Found Device (" << dev->GetIfIndex () << ") for MAC address (" << addr << ")");
 
           break;
         }
@@ -338,9 +635,9 @@ void Pmipv6Mag::HandleNewNode (Mac48Address from, Mac48Address to, uint8_t att)
 
   if (found == false)
     {
-      NS_LOG_WARN ("Device Not Found for MAC address (" << to << ")");
+      NS_LOG_WARN ("Device Not Found for MAC address (" << addr << ")");
 
-      return;
+      return -1;
     }
 
   Ptr<Ipv6> ipv6 = GetNode ()->GetObject<Ipv6> ();
@@ -351,49 +648,19 @@ void Pmipv6Mag::HandleNewNode (Mac48Address from, Mac48Address to, uint8_t att)
   if (ifIndex == -1)
     {
       NS_LOG_LOGIC ("No Ipv6Interface for Device " << dev->GetIfIndex ());
-
-      return;
     }
 
-  bule->SetIfIndex (ifIndex);
-
-  //preset header information
-  bule->SetLastBindingUpdateSequence (GetSequence ());
-  //Cut to micro-seconds
-  bule->SetLastBindingUpdateTime (MicroSeconds (Simulator::Now ().GetMicroSeconds ()));
-
-  Ptr<Packet> p = BuildPbu (bule);
-
-  //save packet
-  bule->SetPbuPacket (p);
-
-  //reset (for the first registration)
-  bule->ResetRetryCount ();
-
-  //send PBU
-  SendMessage (p->Copy (), bule->GetLmaAddress (), 64);
-
-  bule->StartRetransTimer ();
-
-  if (bule->IsReachable ())
-    {
-      bule->MarkRefreshing ();
-    }
-  else
-    {
-      bule->MarkUpdating ();
-    }
+  return ifIndex;
 }
 
 uint8_t Pmipv6Mag::HandlePba (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface)
 {
   NS_LOG_FUNCTION (this << packet << src << dst << interface);
-  Ptr<Packet> p = packet->Copy ();
 
   Ipv6MobilityBindingAckHeader pba;
   Ipv6MobilityOptionBundle bundle;
 
-  p->RemoveHeader (pba);
+  packet->PeekHeader (pba);
 
   Ptr<Ipv6MobilityDemux> ipv6MobilityDemux = GetNode ()->GetObject<Ipv6MobilityDemux> ();
   NS_ASSERT (ipv6MobilityDemux);
@@ -401,9 +668,9 @@ uint8_t Pmipv6Mag::HandlePba (Ptr<Packet> packet, const Ipv6Address &src, const
   Ptr<Ipv6Mobility> ipv6Mobility = ipv6MobilityDemux->GetMobility (pba.GetMhType ());
   NS_ASSERT (ipv6Mobility);
 
-  uint8_t length = ((pba.GetHeaderLen () + 1) << 3) - pba.GetOptionsOffset ();
+  Buffer options = pba.GetOptionBuffer ();
 
-  ipv6Mobility->ProcessOptions (packet, pba.GetOptionsOffset (), length, bundle);
+  ipv6Mobility->ProcessOptions (options.Begin (), options.GetSize (), bundle);
 
   //option check
   //Error Process for Mandatory Options
@@ -446,6 +713,8 @@ uint8_t Pmipv6Mag::HandlePba (Ptr<Packet> packet, const Ipv6Address &src, const
       return 0;
     }
 
+  m_rxPbaTrace (bule->GetMnIdentifier (), pba.GetStatus (), pba.GetLifetime ());
+
   //check status code
   switch (pba.GetStatus ())
     {
@@ -456,14 +725,18 @@ uint8_t Pmipv6Mag::HandlePba (Ptr<Packet> packet, const Ipv6Address &src, const
 
       //update information
       bule->SetHomeNetworkPrefixes (bundle.GetHomeNetworkPrefixes ());
+      IndexHeld (bule->GetMnIdentifier (), bule->GetHomeNetworkPrefixes ());
       bule->SetReachableTime (Seconds (pba.GetLifetime ()));
 
       if (pba.GetLifetime () > 0)
         {
           if (bule->IsUpdating ())
             {
-              //register radvd interface
-              SetupRadvdInterface (bule);
+              //register radvd interface, once the MN is on the link
+              if (!bule->IsPredictive ())
+                {
+                  SetupRadvdInterface (bule);
+                }
 
               //create tunnel & setup routing
               SetupTunnelAndRouting (bule);
@@ -476,36 +749,765 @@ uint8_t Pmipv6Mag::HandlePba (Ptr<Packet> packet, const Ipv6Address &src, const
           bule->StartRefreshTimer ();
           bule->StopReachableTimer ();
           bule->StartReachableTimer ();
+
+          //the MN is on the link, possibly a pre-registered one which attached before the PBA
+          if (!bule->IsPredictive ())
+            {
+              ReleaseHeld (bule->GetMnIdentifier ());
+            }
+
+          //the ring changed while the registration was in progress
+          RehomeMapI it = m_rehoming.find (bule->GetMnIdentifier ());
+
+          if (it != m_rehoming.end ())
+            {
+              if (m_lmaCluster != 0 && m_lmaCluster->Lookup (bule->GetMnIdentifier ()) != bule->GetLmaAddress ())
+                {
+                  NS_LOG_LOGIC ("Deregister " << bule->GetMnIdentifier () << " from " << bule->GetLmaAddress ()
+                                << " to move it to " << it->second);
+
+                  bule->StopRefreshTimer ();
+                  bule->MarkRefreshing ();
+                  SendPbu (bule, 0);
+                }
+              else
+                {
+                  m_rehoming.erase (it);
+                }
+            }
         }
       else
         {
-          //de-registering
-          ClearRadvdInterface (bule);
-          ClearTunnelAndRouting (bule);
+          //de-registering, the MN may have been cleared on detachment
+          if (bule->GetRadvdIfIndex () >= 0)
+            {
+              ClearRadvdInterface (bule);
+            }
+
+          if (bule->GetTunnelIfIndex () >= 0)
+            {
+              ClearTunnelAndRouting (bule);
+            }
+
+          bool rehome = m_rehoming.erase (bule->GetMnIdentifier ()) > 0;
+          Ipv6Address lma;
+
+          if (m_lmaCluster != 0)
+            {
+              m_lmaCluster->Release (bule->GetLmaAddress ());
+
+              if (rehome)
+                {
+                  lma = m_lmaCluster->Place (bule->GetMnIdentifier ());
+                }
+            }
+
+          if (lma.IsAny ())
+            {
+              DropHeld (bule->GetMnIdentifier ());
+              m_buList->Remove (bule);
+              break;
+            }
+
+          //register with the LMA the cluster moved the MN to
+          NS_LOG_LOGIC ("Re-home " << bule->GetMnIdentifier () << " to " << lma);
+
+          bule->StopReachableTimer ();
+          bule->SetHomeNetworkPrefixes (std::list<Ipv6Address> ());
+          IndexHeld (bule->GetMnIdentifier (), bule->GetHomeNetworkPrefixes ());
+          bule->SetLmaAddress (lma);
 
-          m_buList->Remove (bule);
+          Ipv6Address lla = GetLinkLocalAddress (bule->GetLmaAddress ());
+          if (!lla.IsAny ())
+            {
+              bule->SetMagLinkAddress (lla);
+            }
+
+          bule->MarkUpdating ();
+          SendPbu (bule, (uint16_t)Ipv6MobilityL4Protocol::MAX_BINDING_LIFETIME);
+
+          m_nRehomed++;
         }
       break;
     }
 
     default:
       NS_LOG_LOGIC ("Error occurred code=" << pba.GetStatus ());
+      m_nPbaRejected++;
+
+      //nothing comes through this MAG for the MN
+      DropHeld (bule->GetMnIdentifier ());
     }
 
   return 0;
 }
 
-bool Pmipv6Mag::SetupTunnelAndRouting (BindingUpdateList::Entry *bule)
+void Pmipv6Mag::SendPbu (BindingUpdateList::Entry *bule, uint16_t lifetime)
+{
+  NS_LOG_FUNCTION (this << bule << lifetime);
+
+  //preset header information
+  bule->SetLastBindingUpdateSequence (GetSequence ());
+  //Cut to micro-seconds
+  bule->SetLastBindingUpdateTime (MicroSeconds (Simulator::Now ().GetMicroSeconds ()));
+
+  Ptr<Packet> p = BuildPbu (bule, lifetime);
+
+  //save packet
+  bule->SetPbuPacket (p);
+
+  //reset (for the first registration)
+  bule->ResetRetryCount ();
+
+  //send PBU
+  Time hold = SendMessage (p->Copy (), bule->GetLmaAddress (), 64);
+  m_txPbuTrace (bule->GetMnIdentifier (), bule->GetLmaAddress (), lifetime);
+
+  //the PBA is awaited from the time the PBU leaves
+  bule->StartRetransTimer (hold);
+}
+
+Time Pmipv6Mag::RetransmitPbu (BindingUpdateList::Entry *bule)
 {
   NS_LOG_FUNCTION (this << bule);
 
-  //create tunnel
-  Ptr<Ipv6TunnelL4Protocol> th = GetNode ()->GetObject<Ipv6TunnelL4Protocol> ();
-  NS_ASSERT (th);
+  m_nRetransmissions++;
+  m_retransmitPbuTrace (bule->GetMnIdentifier (), bule->GetRetryCount ());
 
-  uint16_t tunnelIf = th->AddTunnel (bule->GetLmaAddress ());
+  return SendMessage (bule->GetPbuPacket ()->Copy (), bule->GetLmaAddress (), 64);
+}
 
-  bule->SetTunnelIfIndex (tunnelIf);
+void Pmipv6Mag::AddNeighbor (Mac48Address ap, Ipv6Address mag)
+{
+  NS_LOG_FUNCTION (this << ap << mag);
+
+  m_neighbors[ap] = mag;
+}
+
+bool Pmipv6Mag::InitiateHandover (Mac48Address mn, Mac48Address ap)
+{
+  NS_LOG_FUNCTION (this << mn << ap);
+  NS_ASSERT (GetProfile () != 0);
+
+  Pmipv6Profile::Entry *pf = GetProfile ()->Lookup (Identifier (mn));
+
+  if (pf == 0)
+    {
+      NS_LOG_LOGIC ("No profile exists for MAC(" << mn << ")");
+      return false;
+    }
+
+  BindingUpdateList::Entry *bule = m_buList->Lookup (pf->GetMnIdentifier ());
+
+  if (bule == 0 || bule->IsPredictive () || !(bule->IsReachable () || bule->IsRefreshing ()))
+    {
+      NS_LOG_LOGIC ("No binding to hand over for " << pf->GetMnIdentifier ());
+      return false;
+    }
+
+  NeighborMapI nit = m_neighbors.find (ap);
+
+  if (nit == m_neighbors.end ())
+    {
+      NS_LOG_LOGIC ("No neighbor MAG for access point " << ap);
+      return false;
+    }
+
+  if (m_handovers.find (pf->GetMnIdentifier ()) != m_handovers.end ())
+    {
+      NS_LOG_LOGIC ("Handover of " << pf->GetMnIdentifier () << " already initiated");
+      return false;
+    }
+
+  Ptr<Packet> p = Create<Packet> ();
+
+  Ipv6MobilityHandoverInitiateHeader hi;
+
+  Ipv6MobilityOptionMobileNodeIdentifierHeader mnidh;
+  Ipv6MobilityOptionHomeNetworkPrefixHeader hnph;
+  Ipv6MobilityOptionHandoffIndicatorHeader hih;
+  Ipv6MobilityOptionAccessTechnologyTypeHeader atth;
+  Ipv6MobilityOptionMobileNodeLinkLayerIdentifierHeader mnllidh;
+  Ipv6MobilityOptionLinkLayerAddressHeader llah (Ipv6MobilityHeader::OPT_LLA_NEW_ACCESS_POINT, ap);
+
+  hi.SetSequence (GetSequence ());
+  hi.SetFlagP (true);
+  hi.SetFlagU (true);
+  hi.SetCode (0);
+
+  //context of the MN
+  mnidh.SetSubtype (1);
+  mnidh.SetNodeIdentifier (bule->GetMnIdentifier ());
+
+  hi.AddOption (mnidh);
+
+  std::list<Ipv6Address> hnp = bule->GetHomeNetworkPrefixes ();
+
+  for (std::list<Ipv6Address>::iterator i = hnp.begin (); i != hnp.end (); i++)
+    {
+      hnph.SetPrefix ((*i));
+      hnph.SetPrefixLength (64);
+
+      hi.AddOption (hnph);
+    }
+
+  hih.SetHandoffIndicator (Ipv6MobilityHeader::OPT_HI_HANDOFF_BETWEEN_MAGS_FOR_SAME_INTERFACE);
+
+  hi.AddOption (hih);
+
+  atth.SetAccessTechnologyType (bule->GetAccessTechnologyType ());
+
+  hi.AddOption (atth);
+
+  mnllidh.SetLinkLayerIdentifier (bule->GetMnLinkIdentifier ());
+
+  hi.AddOption (mnllidh);
+
+  hi.AddOption (llah);
+
+  p->AddHeader (hi);
+
+  Handover handover;
+
+  handover.m_mag = nit->second;
+  handover.m_accepted = false;
+
+  m_handovers[bule->GetMnIdentifier ()] = handover;
+
+  SendMessage (p, nit->second, 64);
+
+  m_nHandoversInitiated++;
+  m_txHiTrace (bule->GetMnIdentifier (), nit->second);
+
+  return true;
+}
+
+Ptr<Packet> Pmipv6Mag::BuildHack (const Identifier &mnId, uint16_t sequence, uint8_t code)
+{
+  NS_LOG_FUNCTION (this << mnId << sequence << (uint32_t)code);
+
+  Ptr<Packet> p = Create<Packet> ();
+
+  Ipv6MobilityHandoverAckHeader hack;
+  Ipv6MobilityOptionMobileNodeIdentifierHeader mnidh;
+
+  hack.SetSequence (sequence);
+  hack.SetFlagP (true);
+  hack.SetCode (code);
+
+  mnidh.SetSubtype (1);
+  mnidh.SetNodeIdentifier (mnId);
+
+  hack.AddOption (mnidh);
+
+  p->AddHeader (hack);
+
+  return p;
+}
+
+uint8_t Pmipv6Mag::HandleHi (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface)
+{
+  NS_LOG_FUNCTION (this << packet << src << dst << interface);
+  NS_ASSERT (GetProfile () != 0);
+
+  Ipv6MobilityHandoverInitiateHeader hi;
+  Ipv6MobilityOptionBundle bundle;
+
+  packet->PeekHeader (hi);
+
+  Ptr<Ipv6MobilityDemux> ipv6MobilityDemux = GetNode ()->GetObject<Ipv6MobilityDemux> ();
+  NS_ASSERT (ipv6MobilityDemux);
+
+  Ptr<Ipv6Mobility> ipv6Mobility = ipv6MobilityDemux->GetMobility (hi.GetMhType ());
+  NS_ASSERT (ipv6Mobility);
+
+  Buffer options = hi.GetOptionBuffer ();
+
+  ipv6Mobility->ProcessOptions (options.Begin (), options.GetSize (), bundle);
+
+  if (bundle.GetMnIdentifier ().IsEmpty ())
+    {
+      NS_LOG_LOGIC ("HI Option missing.. Ignored.");
+
+      return 0;
+    }
+
+  Identifier mnId = bundle.GetMnIdentifier ();
+  Pmipv6Profile::Entry *pf = GetProfile ()->Lookup (mnId);
+  int32_t ifIndex = GetInterfaceForAddress (bundle.GetNewAccessPoint ());
+  uint8_t code = Ipv6MobilityHeader::HACK_CODE_HANDOVER_ACCEPTED;
+
+  BindingUpdateList::Entry *bule = m_buList->Lookup (mnId);
+
+  if (pf == 0)
+    {
+      NS_LOG_LOGIC ("No profile exists for " << mnId);
+
+      code = Ipv6MobilityHeader::HACK_CODE_ADMINISTRATIVELY_PROHIBITED;
+    }
+  else if (ifIndex == -1 || (bule != 0 && !bule->IsPredictive () && !bule->IsUnreachable ()))
+    {
+      NS_LOG_LOGIC ("Access point " << bundle.GetNewAccessPoint () << " unknown or MN " << mnId << " already here");
+
+      code = Ipv6MobilityHeader::HACK_CODE_HANDOVER_NOT_ACCEPTED;
+    }
+  else
+    {
+      if (bule == 0)
+        {
+          bule = m_buList->Add (mnId);
+        }
+
+      PrepareEntry (bule, pf, bundle.GetAccessTechnologyType ());
+
+      std::list<Ipv6Address> hnps;
+      std::list<Ipv6Address> ctx = bundle.GetHomeNetworkPrefixes ();
+
+      for (std::list<Ipv6Address>::iterator i = ctx.begin (); i != ctx.end (); i++)
+        {
+          if (!(*i).IsAny ())
+            {
+              hnps.push_back (*i);
+            }
+        }
+
+      //the prefixes the LMA assigned take over from the profile
+      if (hnps.size () > 0)
+        {
+          bule->SetHomeNetworkPrefixes (hnps);
+        }
+
+      bule->SetHandoffIndicator (Ipv6MobilityHeader::OPT_HI_HANDOFF_BETWEEN_MAGS_FOR_SAME_INTERFACE);
+      bule->SetIfIndex (ifIndex);
+      bule->SetPredictive (true);
+
+      Prediction &prediction = m_predictions[mnId];
+
+      prediction.m_previousMag = src;
+      prediction.m_expireEvent.Cancel ();
+      prediction.m_expireEvent = Simulator::Schedule (m_predictionTimeout, &Pmipv6Mag::ExpirePrediction, this, mnId);
+
+      StartHolding (bule);
+
+      SendPbu (bule, (uint16_t)Ipv6MobilityL4Protocol::MAX_BINDING_LIFETIME);
+
+      if (!bule->IsReachable ())
+        {
+          bule->MarkUpdating ();
+        }
+
+      m_nPreRegistrations++;
+    }
+
+  SendMessage (BuildHack (mnId, hi.GetSequence (), code), src, 64);
+
+  return 0;
+}
+
+uint8_t Pmipv6Mag::HandleHack (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface)
+{
+  NS_LOG_FUNCTION (this << packet << src << dst << interface);
+
+  Ipv6MobilityHandoverAckHeader hack;
+  Ipv6MobilityOptionBundle bundle;
+
+  packet->PeekHeader (hack);
+
+  Ptr<Ipv6MobilityDemux> ipv6MobilityDemux = GetNode ()->GetObject<Ipv6MobilityDemux> ();
+  NS_ASSERT (ipv6MobilityDemux);
+
+  Ptr<Ipv6Mobility> ipv6Mobility = ipv6MobilityDemux->GetMobility (hack.GetMhType ());
+  NS_ASSERT (ipv6Mobility);
+
+  Buffer options = hack.GetOptionBuffer ();
+
+  ipv6Mobility->ProcessOptions (options.Begin (), options.GetSize (), bundle);
+
+  HandoverMapI it = m_handovers.find (bundle.GetMnIdentifier ());
+
+  if (it == m_handovers.end () || it->second.m_mag != src)
+    {
+      NS_LOG_LOGIC ("No handover to " << src << " matches the HAck. Ignored.");
+
+      return 0;
+    }
+
+  m_rxHackTrace (bundle.GetMnIdentifier (), hack.GetCode ());
+
+  BindingUpdateList::Entry *bule = m_buList->Lookup (bundle.GetMnIdentifier ());
+
+  if (hack.GetCode () == Ipv6MobilityHeader::HACK_CODE_HANDOVER_ACCEPTED)
+    {
+      it->second.m_accepted = true;
+
+      //the new MAG refreshes the binding from now on
+      if (bule != 0)
+        {
+          bule->StopRefreshTimer ();
+        }
+
+      return 0;
+    }
+
+  //refused, or withdrawn as the MN did not show up there
+  bool accepted = it->second.m_accepted;
+
+  m_handovers.erase (it);
+
+  if (accepted && bule != 0 && bule->IsReachable ())
+    {
+      //take the binding back for the MN still attached here
+      bule->StopRefreshTimer ();
+      SendPbu (bule, (uint16_t)Ipv6MobilityL4Protocol::MAX_BINDING_LIFETIME);
+      bule->MarkRefreshing ();
+    }
+
+  return 0;
+}
+
+void Pmipv6Mag::StartHolding (BindingUpdateList::Entry *bule)
+{
+  NS_LOG_FUNCTION (this << bule);
+
+  Identifier mnId = bule->GetMnIdentifier ();
+
+  if (m_buffers.find (mnId) != m_buffers.end ())
+    {
+      return;
+    }
+
+  m_buffers[mnId].m_buffer = m_bufferPool.Create (m_holdLimit, m_holdBytes);
+
+  IndexHeld (mnId, bule->GetHomeNetworkPrefixes ());
+}
+
+void Pmipv6Mag::IndexHeld (const Identifier &mnId, const std::list<Ipv6Address> &hnpList)
+{
+  NS_LOG_FUNCTION (this << mnId);
+
+  BufferMapI it = m_buffers.find (mnId);
+
+  if (it == m_buffers.end ())
+    {
+      return;
+    }
+
+  std::list<Ipv6Address> &prefixes = it->second.m_prefixes;
+
+  for (std::list<Ipv6Address>::iterator i = prefixes.begin (); i != prefixes.end (); i++)
+    {
+      HeldPrefixMapI held = m_heldPrefixes.find (*i);
+
+      if (held != m_heldPrefixes.end () && held->second == mnId)
+        {
+          m_heldPrefixes.erase (held);
+        }
+    }
+
+  prefixes.clear ();
+
+  //an MN whose prefixes are not known yet has no downlink to hold
+  for (std::list<Ipv6Address>::const_iterator i = hnpList.begin (); i != hnpList.end (); i++)
+    {
+      Ipv6Address prefix = *i;
+
+      prefix = prefix.CombinePrefix (Ipv6Prefix (64));
+
+      if (!prefix.IsAny ())
+        {
+          m_heldPrefixes[prefix] = mnId;
+          prefixes.push_back (prefix);
+        }
+    }
+
+  //decapsulated packets only go through the hook while some are awaited
+  Ptr<Ipv6TunnelL4Protocol> th = GetNode ()->GetObject<Ipv6TunnelL4Protocol> ();
+  NS_ASSERT (th);
+
+  if (m_heldPrefixes.empty ())
+    {
+      th->SetHoldCallback (MakeNullCallback<bool, Ptr<Packet>, const Ipv6Address &, const Ipv6Header &> ());
+    }
+  else
+    {
+      th->SetHoldCallback (MakeCallback (&Pmipv6Mag::HoldPacket, this));
+    }
+}
+
+bool Pmipv6Mag::HoldPacket (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Header &header)
+{
+  NS_LOG_FUNCTION (this << packet << src);
+
+  HeldPrefixMapI held = m_heldPrefixes.find (header.GetDestinationAddress ().CombinePrefix (Ipv6Prefix (64)));
+
+  if (held == m_heldPrefixes.end ())
+    {
+      return false;
+    }
+
+  BindingUpdateList::Entry *bule = m_buList->Lookup (held->second);
+
+  //an established binding of an attached MN is not held
+  if (bule == 0 || bule->GetLmaAddress () != src || (bule->IsReachable () && !bule->IsPredictive ()))
+    {
+      return false;
+    }
+
+  BufferMapI found = m_buffers.find (held->second);
+
+  NS_ASSERT (found != m_buffers.end ());
+
+  if (!found->second.m_buffer->Enqueue (packet))
+    {
+      NS_LOG_LOGIC ("No room left to hold packets for " << found->first);
+
+      m_nHeldDrops++;
+
+      return true;
+    }
+
+  m_nHeldPackets++;
+
+  return true;
+}
+
+uint32_t Pmipv6Mag::ReleaseHeld (const Identifier &mnId)
+{
+  NS_LOG_FUNCTION (this << mnId);
+
+  PredictionMapI pit = m_predictions.find (mnId);
+
+  if (pit != m_predictions.end ())
+    {
+      pit->second.m_expireEvent.Cancel ();
+      m_predictions.erase (pit);
+    }
+
+  BufferMapI it = m_buffers.find (mnId);
+
+  if (it == m_buffers.end ())
+    {
+      return 0;
+    }
+
+  HandoverBuffer *buffer = it->second.m_buffer;
+
+  IndexHeld (mnId, std::list<Ipv6Address> ());
+  m_buffers.erase (it);
+
+  Ptr<Ipv6TunnelL4Protocol> th = GetNode ()->GetObject<Ipv6TunnelL4Protocol> ();
+  NS_ASSERT (th);
+
+  uint32_t n = 0;
+
+  for (Ptr<Packet> p = buffer->Dequeue (); p != 0; p = buffer->Dequeue ())
+    {
+      th->Forward (p);
+      n++;
+    }
+
+  m_bufferPool.Destroy (buffer);
+
+  return n;
+}
+
+void Pmipv6Mag::DropHeld (const Identifier &mnId)
+{
+  NS_LOG_FUNCTION (this << mnId);
+
+  BufferMapI it = m_buffers.find (mnId);
+
+  if (it == m_buffers.end ())
+    {
+      return;
+    }
+
+  m_nHeldDrops += it->second.m_buffer->Clear ();
+
+  m_bufferPool.Destroy (it->second.m_buffer);
+
+  IndexHeld (mnId, std::list<Ipv6Address> ());
+  m_buffers.erase (it);
+}
+
+void Pmipv6Mag::ExpirePrediction (Identifier mnId)
+{
+  NS_LOG_FUNCTION (this << mnId);
+
+  PredictionMapI it = m_predictions.find (mnId);
+
+  if (it == m_predictions.end ())
+    {
+      return;
+    }
+
+  Ipv6Address previousMag = it->second.m_previousMag;
+
+  m_predictions.erase (it);
+
+  //the binding is withdrawn, not moved
+  m_rehoming.erase (mnId);
+
+  BindingUpdateList::Entry *bule = m_buList->Lookup (mnId);
+
+  if (bule == 0 || !bule->IsPredictive ())
+    {
+      return;
+    }
+
+  DropHeld (mnId);
+
+  NS_LOG_LOGIC ("MN " << mnId << " did not attach, withdraw its pre-registration");
+
+  bule->SetPredictive (false);
+  bule->StopRetransTimer ();
+  bule->StopRefreshTimer ();
+  bule->StopReachableTimer ();
+
+  if (bule->GetTunnelIfIndex () >= 0)
+    {
+      ClearTunnelAndRouting (bule);
+    }
+
+  bule->MarkUnreachable ();
+
+  //the previous MAG registers the MN again if it is still there
+  SendMessage (BuildHack (mnId, GetSequence (), Ipv6MobilityHeader::HACK_CODE_HANDOVER_NOT_ACCEPTED), previousMag, 64);
+
+  //the entry is removed on the PBA
+  SendPbu (bule, 0);
+}
+
+void Pmipv6Mag::SetLmaCluster (Ptr<Pmipv6LmaCluster> cluster)
+{
+  NS_LOG_FUNCTION (this << cluster);
+
+  if (m_lmaCluster != 0)
+    {
+      m_lmaCluster->RemoveRebalanceCallback (MakeCallback (&Pmipv6Mag::Rebalance, this));
+    }
+
+  m_lmaCluster = cluster;
+
+  if (m_lmaCluster != 0)
+    {
+      m_lmaCluster->AddRebalanceCallback (MakeCallback (&Pmipv6Mag::Rebalance, this));
+    }
+}
+
+Ptr<Pmipv6LmaCluster> Pmipv6Mag::GetLmaCluster () const
+{
+  return m_lmaCluster;
+}
+
+uint32_t Pmipv6Mag::GetNRehomed () const
+{
+  return m_nRehomed;
+}
+
+uint32_t Pmipv6Mag::GetNHandoversInitiated () const
+{
+  return m_nHandoversInitiated;
+}
+
+uint32_t Pmipv6Mag::GetNPreRegistrations () const
+{
+  return m_nPreRegistrations;
+}
+
+uint32_t Pmipv6Mag::GetNPredictiveAttaches () const
+{
+  return m_nPredictiveAttaches;
+}
+
+uint32_t Pmipv6Mag::GetNHeldPackets () const
+{
+  return m_nHeldPackets;
+}
+
+uint32_t Pmipv6Mag::GetNHeldDrops () const
+{
+  return m_nHeldDrops;
+}
+
+uint32_t Pmipv6Mag::GetNAttaches () const
+{
+  return m_nAttaches;
+}
+
+uint32_t Pmipv6Mag::GetNDetaches () const
+{
+  return m_nDetaches;
+}
+
+uint32_t Pmipv6Mag::GetNPbuRetransmissions () const
+{
+  return m_nRetransmissions;
+}
+
+uint32_t Pmipv6Mag::GetNPbaRejected () const
+{
+  return m_nPbaRejected;
+}
+
+uint32_t Pmipv6Mag::GetNTunnelSetups () const
+{
+  return m_nTunnelSetups;
+}
+
+void Pmipv6Mag::Rebalance ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  if (m_lmaCluster == 0 || m_buList == 0)
+    {
+      return;
+    }
+
+  std::list<BindingUpdateList::Entry *> entries = m_buList->GetEntries ();
+
+  for (std::list<BindingUpdateList::Entry *>::iterator i = entries.begin (); i != entries.end (); i++)
+    {
+      BindingUpdateList::Entry *bule = (*i);
+      Ipv6Address lma = m_lmaCluster->Lookup (bule->GetMnIdentifier ());
+
+      //de-registrations in flight remove the binding anyway
+      if (lma.IsAny () || lma == bule->GetLmaAddress () || bule->IsUnreachable ())
+        {
+          continue;
+        }
+
+      m_rehoming[bule->GetMnIdentifier ()] = lma;
+
+      //registrations in progress move on their PBA
+      if (!bule->IsReachable ())
+        {
+          continue;
+        }
+
+      NS_LOG_LOGIC ("Deregister " << bule->GetMnIdentifier () << " from " << bule->GetLmaAddress ()
+                    << " to move it to " << lma);
+
+      bule->StopRefreshTimer ();
+      bule->MarkRefreshing ();
+      SendPbu (bule, 0);
+    }
+}
+
+bool Pmipv6Mag::SetupTunnelAndRouting (BindingUpdateList::Entry *bule)
+{
+  NS_LOG_FUNCTION (this << bule);
+
+  //create tunnel
+  Ptr<Ipv6TunnelL4Protocol> th = GetNode ()->GetObject<Ipv6TunnelL4Protocol> ();
+  NS_ASSERT (th);
+
+  uint16_t tunnelIf = th->AddTunnel (bule->GetLmaAddress ());
+
+  bule->SetTunnelIfIndex (tunnelIf);
+
+  m_nTunnelSetups++;
+  m_tunnelSetupTrace (bule->GetMnIdentifier (), bule->GetLmaAddress ());
 
   //routing setup by static routing protocol
   Ipv6StaticRoutingHelper staticRoutingHelper;
@@ -593,7 +1595,7 @@ bool Pmipv6Mag::SetupRadvdInterface (BindingUpdateList::Entry *bule)
 
   GetRadvd ()->AddConfiguration (uri);
 
-  bule->SetRadvdIfIndex (uri->GetInterface ());
+  bule->SetRadvdIfIndex (uri->GetId ());
 
   return true;
 }
@@ -25,16 +25,30 @@
 #ifndef PMIPV6_MAG_H
 #define PMIPV6_MAG_H
 
+#include <list>
+#include <map>
+
+#include "ns3/sgi-hashmap.h"
+#include "ns3/traced-callback.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/mac48-address.h"
+
 #include "pmipv6-agent.h"
 #include "binding-update-list.h"
+#include "pmipv6-profile.h"
+#include "handover-buffer.h"
 
 namespace ns3
 {
 class UnicastRadvd;
-class Mac48Address;
+class Ipv6Header;
+class Pmipv6LmaCluster;
 
 class Pmipv6Mag : public Pmipv6Agent {
 public:
+  static TypeId GetTypeId ();
+  
   Pmipv6Mag();
   
   virtual ~Pmipv6Mag();
@@ -51,18 +65,229 @@ public:
   void ClearRadvdInterface(BindingUpdateList::Entry *bule);
   
   Ptr<Packet> BuildPbu(BindingUpdateList::Entry *bule);
+  Ptr<Packet> BuildPbu(BindingUpdateList::Entry *bule, uint16_t lifetime);
+  
+  /**
+   * \brief Select the LMA of the MNs from a cluster instead of their profile.
+   * \param cluster the cluster, or 0 to go back to the profile
+   */
+  void SetLmaCluster(Ptr<Pmipv6LmaCluster> cluster);
+  Ptr<Pmipv6LmaCluster> GetLmaCluster() const;
+  
+  /**
+   * \brief Move the bindings whose MN the cluster now places on another LMA.
+   *
+   * Each moved binding is deregistered from its LMA, then registered with
+   * the new one, which assigns new prefixes. Called by the cluster when
+   * its ring changes.
+   */
+  void Rebalance();
+  
+  /**
+   * \return number of bindings moved to another LMA by Rebalance
+   */
+  uint32_t GetNRehomed() const;
+  
+  /**
+   * \brief Send the PBU of an entry again, on expiry of its retransmission timer.
+   * \return time until the PBU leaves, when bulked
+   */
+  Time RetransmitPbu(BindingUpdateList::Entry *bule);
+  
+  /**
+   * \brief Declare the MAG of an access point next to ours.
+   * \param ap link-layer address of the access point
+   * \param mag address of its MAG
+   */
+  void AddNeighbor(Mac48Address ap, Ipv6Address mag);
+  
+  /**
+   * \brief Pre-register an MN with the MAG of the access point it is about to move to.
+   *
+   * This is the predictive mode of RFC5949: the context of the MN is sent to
+   * the new MAG in a Handover Initiate. The new MAG registers the MN with the
+   * LMA right away and holds its downlink packets until it attaches, so only
+   * the link-layer handover is left when the MN moves.
+   * \param mn link-layer address of the MN
+   * \param ap the access point it is moving to
+   * \return false if the MN has no binding here or the access point no neighbor MAG
+   */
+  bool InitiateHandover(Mac48Address mn, Mac48Address ap);
+  
+  /**
+   * \return number of Handover Initiates sent
+   */
+  uint32_t GetNHandoversInitiated() const;
+  
+  /**
+   * \return number of MNs registered on a Handover Initiate
+   */
+  uint32_t GetNPreRegistrations() const;
+  
+  /**
+   * \return number of pre-registered MNs which attached
+   */
+  uint32_t GetNPredictiveAttaches() const;
+  
+  /**
+   * \return number of downlink packets held for MNs not registered or not attached yet
+   */
+  uint32_t GetNHeldPackets() const;
+  
+  /**
+   * \return number of held packets dropped, for lack of room, of a registration or of an attachment
+   */
+  uint32_t GetNHeldDrops() const;
+  
+  /**
+   * \return number of attachments of MNs with a profile
+   */
+  uint32_t GetNAttaches() const;
+  
+  /**
+   * \return number of detachments of MNs with a binding
+   */
+  uint32_t GetNDetaches() const;
+  
+  /**
+   * \return number of PBUs sent again for lack of a PBA
+   */
+  uint32_t GetNPbuRetransmissions() const;
+  
+  /**
+   * \return number of PBAs matching a PBU but carrying an error status
+   */
+  uint32_t GetNPbaRejected() const;
+  
+  /**
+   * \return number of tunnels set up towards an LMA
+   */
+  uint32_t GetNTunnelSetups() const;
   
 protected:
   virtual void NotifyNewAggregate();
+  virtual void DoDispose();
   
   Ipv6Address GetLinkLocalAddress(Ipv6Address addr);
   
   Ptr<UnicastRadvd> GetRadvd() const;
   
+  /**
+   * \return index of the IPv6 interface of the device with this MAC address, -1 if none
+   */
+  int32_t GetInterfaceForAddress(Mac48Address addr);
+  
   virtual void HandleNewNode(Mac48Address from, Mac48Address to, uint8_t att);
+  
+  /**
+   * \brief Deregister an MN which left the access link it was attached to.
+   *
+   * The tunnel, routes and RAs of the MN are cleared right away, without
+   * waiting for the binding lifetime to expire.
+   */
+  virtual void HandleDelNode(Mac48Address from, Mac48Address to, uint8_t att);
   virtual uint8_t HandlePba(Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface);
+  virtual uint8_t HandleHi(Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface);
+  virtual uint8_t HandleHack(Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface);
+  
+  /**
+   * \brief Set up an entry for the MN of a profile, as for a new attachment.
+   */
+  void PrepareEntry(BindingUpdateList::Entry *bule, Pmipv6Profile::Entry *pf, uint8_t att);
+  
+  Ptr<Packet> BuildHack(const Identifier &mnId, uint16_t sequence, uint8_t code);
+  
+  /**
+   * \brief Hold the downlink of an MN until it is both registered and attached.
+   *
+   * Called when a PBU registers the MN with this MAG: the LMA may send
+   * its packets here before the PBA, or before the MN arrives.
+   */
+  void StartHolding(BindingUpdateList::Entry *bule);
+  
+  /**
+   * \brief Index the downlink held for an MN under new home network prefixes.
+   * \param mnId the MN
+   * \param hnpList its prefixes, none to unindex it
+   */
+  void IndexHeld(const Identifier &mnId, const std::list<Ipv6Address> &hnpList);
+  
+  /**
+   * \brief Keep back a packet decapsulated from the LMA of an MN being held.
+   * \return true if the packet was kept or dropped
+   *
+   * Only a packet to a home network prefix of such an MN is kept, until
+   * the MN is both registered and attached.
+   */
+  bool HoldPacket(Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Header &header);
+  
+  /**
+   * \brief Send on the packets held for an MN and forget its pre-registration.
+   * \return number of packets sent
+   */
+  uint32_t ReleaseHeld(const Identifier &mnId);
+  
+  /**
+   * \brief Drop the packets held for an MN, and stop holding.
+   */
+  void DropHeld(const Identifier &mnId);
+  
+  /**
+   * \brief Withdraw the pre-registration of an MN which did not attach in time.
+   */
+  void ExpirePrediction(Identifier mnId);
+  
+  /**
+   * \brief Send a new PBU for an entry, with a fresh sequence and timestamp.
+   */
+  void SendPbu(BindingUpdateList::Entry *bule, uint16_t lifetime);
   
 private:
+  typedef sgi::hash_map<Identifier, Ipv6Address, IdentifierHash> RehomeMap;
+  typedef sgi::hash_map<Identifier, Ipv6Address, IdentifierHash>::iterator RehomeMapI;
+  
+  /**
+   * \brief Handover of an MN to a neighbor MAG, on the previous MAG.
+   */
+  struct Handover
+  {
+    Ipv6Address m_mag;
+    bool m_accepted;
+  };
+  
+  typedef sgi::hash_map<Identifier, Handover, IdentifierHash> HandoverMap;
+  typedef sgi::hash_map<Identifier, Handover, IdentifierHash>::iterator HandoverMapI;
+  
+  /**
+   * \brief Pre-registration of an MN, on the new MAG.
+   */
+  struct Prediction
+  {
+    Ipv6Address m_previousMag;
+    EventId m_expireEvent;
+  };
+  
+  typedef sgi::hash_map<Identifier, Prediction, IdentifierHash> PredictionMap;
+  typedef sgi::hash_map<Identifier, Prediction, IdentifierHash>::iterator PredictionMapI;
+  
+  /**
+   * \brief Downlink held for an MN, with the prefixes it is indexed under.
+   */
+  struct Held
+  {
+    HandoverBuffer *m_buffer;
+    std::list<Ipv6Address> m_prefixes;
+  };
+  
+  typedef sgi::hash_map<Identifier, Held, IdentifierHash> BufferMap;
+  typedef sgi::hash_map<Identifier, Held, IdentifierHash>::iterator BufferMapI;
+  
+  typedef sgi::hash_map<Ipv6Address, Identifier, Ipv6AddressHash> HeldPrefixMap;
+  typedef sgi::hash_map<Ipv6Address, Identifier, Ipv6AddressHash>::iterator HeldPrefixMapI;
+  
+  typedef std::map<Mac48Address, Ipv6Address> NeighborMap;
+  typedef std::map<Mac48Address, Ipv6Address>::iterator NeighborMapI;
+  
   
   bool m_useRemoteAp;
   
@@ -71,6 +296,67 @@ private:
   Ptr<BindingUpdateList> m_buList;
   
   Ptr<UnicastRadvd> m_radvd;
+  
+  Ptr<Pmipv6LmaCluster> m_lmaCluster;
+  
+  /**
+   * \brief New LMA of the MNs being deregistered from their former one.
+   */
+  RehomeMap m_rehoming;
+  
+  uint32_t m_nRehomed;
+  
+  /**
+   * \brief MAGs of the neighbor access points.
+   */
+  NeighborMap m_neighbors;
+  
+  /**
+   * \brief MNs handed over to a neighbor MAG ahead of their move.
+   */
+  HandoverMap m_handovers;
+  
+  /**
+   * \brief MNs registered on a Handover Initiate, not attached yet.
+   */
+  PredictionMap m_predictions;
+  
+  /**
+   * \brief Downlink held for the MNs not registered or not attached yet.
+   */
+  BufferMap m_buffers;
+  
+  /**
+   * \brief MN held for, by home network prefix.
+   */
+  HeldPrefixMap m_heldPrefixes;
+  HandoverBufferPool m_bufferPool;
+  
+  Time m_predictionTimeout;
+  uint32_t m_holdLimit;
+  uint32_t m_holdBytes;
+  
+  uint32_t m_nHandoversInitiated;
+  uint32_t m_nPreRegistrations;
+  uint32_t m_nPredictiveAttaches;
+  uint32_t m_nHeldPackets;
+  uint32_t m_nHeldDrops;
+  
+  uint32_t m_nAttaches;
+  uint32_t m_nDetaches;
+  uint32_t m_nRetransmissions;
+  uint32_t m_nPbaRejected;
+  uint32_t m_nTunnelSetups;
+  
+  TracedCallback<const Identifier &, const Identifier &> m_attachTrace;
+  TracedCallback<const Identifier &, const Identifier &> m_detachTrace;
+  TracedCallback<const Identifier &, Ipv6Address, uint16_t> m_txPbuTrace;
+  TracedCallback<const Identifier &, uint8_t> m_retransmitPbuTrace;
+  TracedCallback<const Identifier &, uint8_t, uint16_t> m_rxPbaTrace;
+  TracedCallback<const Identifier &, Ipv6Address> m_tunnelSetupTrace;
+  TracedCallback<const Identifier &, Ipv6Address> m_txHiTrace;
+  TracedCallback<const Identifier &, uint8_t> m_rxHackTrace;
+  TracedCallback<const Identifier &, uint32_t> m_predictiveAttachTrace;
 };
 
 } /* namespace ns3 */
@@ -22,46 +22,210 @@
  * Author: Hyon-Young Choi <commani@gmail.com>
  */
  
- #include "ns3/log.h"
- #include "pmipv6-prefix-pool.h"
- 
- NS_LOG_COMPONENT_DEFINE( "Pmipv6PrefixPool" );
- 
- namespace ns3 
- {
- 
- Pmipv6PrefixPool::Pmipv6PrefixPool(Ipv6Address prefixBegin, uint8_t prefixLen)
-  : m_prefixBegin(prefixBegin),
-    m_prefixBeginLen(prefixLen),
-	m_lastPrefixIndex(0)
- {
-   NS_LOG_FUNCTION ( this << prefixBegin << (uint32_t) prefixLen);
-   
-   NS_ASSERT ( prefixLen < 64 );
- }
- 
- Ipv6Address Pmipv6PrefixPool::Assign()
- {
-   NS_LOG_FUNCTION_NOARGS();
-   
-   uint8_t buf[16];
-   Ipv6Address addr;
-   int len;
-   
-   m_prefixBegin.Serialize(buf);
-   
-   len = 8 - m_prefixBeginLen/8;
-   
-   m_lastPrefixIndex++;
-   
-   for ( int i = 0; i < len; i++ )
-     {
-	   buf[7-i] = (uint8_t)((m_lastPrefixIndex >> (i * 8)) & 0xff);
-	 }
-   
-   addr.Set(buf);
-   
-   return addr;
- }
- 
- }
\ No newline at end of file
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "pmipv6-prefix-pool.h"
+
+NS_LOG_COMPONENT_DEFINE ("Pmipv6PrefixPool");
+
+namespace ns3
+{
+
+static uint64_t
+ReadPrefixNumber (const uint8_t *buf)
+{
+  uint64_t hi = 0;
+  
+  for (int i = 0; i < 8; i++)
+    {
+      hi = (hi << 8) | buf[i];
+    }
+  return hi;
+}
+
+static void
+WritePrefixNumber (uint8_t *buf, uint64_t hi)
+{
+  for (int i = 7; i >= 0; i--)
+    {
+      buf[i] = (uint8_t)(hi & 0xff);
+      hi >>= 8;
+    }
+}
+
+/**
+ * \return the mask of the prefix number bits following a base of length len
+ */
+static uint64_t
+GetNumberMask (uint8_t len)
+{
+  return (len == 0) ? ~(uint64_t)0 : (((uint64_t)1 << (64 - len)) - 1);
+}
+
+Pmipv6PrefixPool::Pmipv6PrefixPool (Ipv6Address prefixBegin, uint8_t prefixLen)
+  : m_prefixBegin (prefixBegin),
+    m_prefixBeginLen (prefixLen),
+    m_first (1),
+    m_size (GetNumberMask (prefixLen)),
+    m_watermark (0),
+    m_nAssigned (0),
+    m_maxAssigned (0),
+    m_nExhausted (0)
+{
+  NS_LOG_FUNCTION (this << prefixBegin << (uint32_t) prefixLen);
+  
+  NS_ASSERT (prefixLen < 64);
+}
+
+Pmipv6PrefixPool::Pmipv6PrefixPool (Ipv6Address prefixBegin, uint8_t prefixLen, uint64_t first, uint64_t size)
+  : m_prefixBegin (prefixBegin),
+    m_prefixBeginLen (prefixLen),
+    m_first (first),
+    m_size (size),
+    m_watermark (0),
+    m_nAssigned (0),
+    m_maxAssigned (0),
+    m_nExhausted (0)
+{
+  NS_LOG_FUNCTION (this << prefixBegin << (uint32_t) prefixLen << first << size);
+  
+  NS_ASSERT (prefixLen < 64);
+  NS_ASSERT (size > 0);
+  NS_ASSERT_MSG (first <= GetNumberMask (prefixLen) && size - 1 <= GetNumberMask (prefixLen) - first,
+                 "Prefix range does not fit after a /" << (uint32_t) prefixLen);
+}
+
+Ipv6Address Pmipv6PrefixPool::Assign ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  uint64_t offset;
+  
+  if (!m_released.empty ())
+    {
+      offset = m_released.front ();
+      m_released.pop_front ();
+    }
+  else if (m_watermark < m_size)
+    {
+      offset = m_watermark++;
+      
+      if ((offset >> 5) >= m_assigned.size ())
+        {
+          m_assigned.push_back (0);
+        }
+    }
+  else
+    {
+      NS_LOG_LOGIC ("Prefix pool exhausted after " << m_nAssigned << " prefixes");
+      m_nExhausted++;
+      return Ipv6Address::GetAny ();
+    }
+  
+  SetBit (offset, true);
+  
+  if (++m_nAssigned > m_maxAssigned)
+    {
+      m_maxAssigned = m_nAssigned;
+    }
+  
+  uint8_t buf[16];
+  uint64_t mask = GetNumberMask (m_prefixBeginLen);
+  
+  m_prefixBegin.Serialize (buf);
+  WritePrefixNumber (buf, (ReadPrefixNumber (buf) & ~mask) | (m_first + offset));
+  
+  return Ipv6Address (buf);
+}
+
+bool Pmipv6PrefixPool::Release (Ipv6Address prefix)
+{
+  NS_LOG_FUNCTION (this << prefix);
+  
+  uint64_t offset;
+  
+  if (!GetOffset (prefix, offset) || !IsSet (offset))
+    {
+      NS_LOG_LOGIC ("Prefix " << prefix << " was not assigned by this pool");
+      return false;
+    }
+  
+  SetBit (offset, false);
+  m_released.push_back (offset);
+  m_nAssigned--;
+  
+  return true;
+}
+
+bool Pmipv6PrefixPool::IsAssigned (Ipv6Address prefix) const
+{
+  uint64_t offset;
+  
+  return GetOffset (prefix, offset) && IsSet (offset);
+}
+
+uint64_t Pmipv6PrefixPool::GetCapacity () const
+{
+  return m_size;
+}
+
+uint64_t Pmipv6PrefixPool::GetNAssigned () const
+{
+  return m_nAssigned;
+}
+
+uint64_t Pmipv6PrefixPool::GetMaxAssigned () const
+{
+  return m_maxAssigned;
+}
+
+uint64_t Pmipv6PrefixPool::GetNExhausted () const
+{
+  return m_nExhausted;
+}
+
+bool Pmipv6PrefixPool::GetOffset (Ipv6Address prefix, uint64_t &offset) const
+{
+  uint8_t buf[16];
+  uint8_t base[16];
+  uint64_t mask = GetNumberMask (m_prefixBeginLen);
+  
+  prefix.Serialize (buf);
+  m_prefixBegin.Serialize (base);
+  
+  uint64_t hi = ReadPrefixNumber (buf);
+  
+  if ((hi & ~mask) != (ReadPrefixNumber (base) & ~mask))
+    {
+      return false;
+    }
+  
+  uint64_t number = hi & mask;
+  
+  if (number < m_first || number - m_first >= m_watermark)
+    {
+      return false;
+    }
+  
+  offset = number - m_first;
+  return true;
+}
+
+bool Pmipv6PrefixPool::IsSet (uint64_t offset) const
+{
+  return (m_assigned[offset >> 5] >> (offset & 31)) & 1;
+}
+
+void Pmipv6PrefixPool::SetBit (uint64_t offset, bool value)
+{
+  if (value)
+    {
+      m_assigned[offset >> 5] |= (1u << (offset & 31));
+    }
+  else
+    {
+      m_assigned[offset >> 5] &= ~(1u << (offset & 31));
+    }
+}
+
+} /* namespace ns3 */
@@ -25,25 +25,106 @@
 #ifndef PMIPV6_PREFIX_POOL_H
 #define PMIPV6_PREFIX_POOL_H
 
+#include <deque>
+#include <vector>
+#include <stdint.h>
+
 #include "ns3/simple-ref-count.h"
 #include "ns3/ipv6-address.h"
 
 namespace ns3
 {
 
+/**
+ * \class Pmipv6PrefixPool
+ * \brief Allocator of the /64 home network prefixes handed out by an LMA.
+ *
+ * Prefix number i of the pool is the base prefix with i written in the
+ * bits that follow the base prefix length. A pool owns the numbers
+ * [first, first + size), so pools built over disjoint ranges of the same
+ * base never hand out the same prefix and need not share any state.
+ *
+ * Released prefixes are queued and reused, oldest first, before the pool
+ * hands out a number it never used, so Assign and Release are O(1). A
+ * bitmap of the numbers in use, which only grows up to the peak
+ * occupation, catches double and foreign releases.
+ */
 class Pmipv6PrefixPool : public SimpleRefCount<Pmipv6PrefixPool>
 {
 public:
+  /**
+   * \brief Pool of all the prefixes of a base, except number 0.
+   */
   Pmipv6PrefixPool(Ipv6Address prefixBegin, uint8_t prefixLen);
   
+  /**
+   * \brief Pool of the prefix numbers [first, first + size) of a base.
+   */
+  Pmipv6PrefixPool(Ipv6Address prefixBegin, uint8_t prefixLen, uint64_t first, uint64_t size);
+  
+  /**
+   * \return a free prefix, or the unspecified address if the pool is exhausted
+   */
   Ipv6Address Assign();
+  
+  /**
+   * \brief Give a prefix back to the pool.
+   * \param prefix the prefix
+   * \return false if the prefix was not assigned by this pool
+   */
+  bool Release(Ipv6Address prefix);
+  
+  bool IsAssigned(Ipv6Address prefix) const;
+  
+  /**
+   * \return the number of prefixes of the pool
+   */
+  uint64_t GetCapacity() const;
+  
+  /**
+   * \return the number of prefixes currently assigned
+   */
+  uint64_t GetNAssigned() const;
+  
+  /**
+   * \return the highest number of prefixes assigned at once
+   */
+  uint64_t GetMaxAssigned() const;
+  
+  /**
+   * \return the number of Assign calls which found the pool exhausted
+   */
+  uint64_t GetNExhausted() const;
+  
 protected:
 
 private:
+  /**
+   * \brief Get the offset of a prefix within the pool.
+   * \return false if the prefix is outside of the pool
+   */
+  bool GetOffset(Ipv6Address prefix, uint64_t &offset) const;
+  
+  bool IsSet(uint64_t offset) const;
+  void SetBit(uint64_t offset, bool value);
+  
   Ipv6Address m_prefixBegin;
   uint8_t m_prefixBeginLen;
   
-  uint64_t m_lastPrefixIndex;
+  uint64_t m_first;
+  uint64_t m_size;
+  
+  /**
+   * \brief Offsets below the watermark have been assigned at least once.
+   */
+  uint64_t m_watermark;
+  
+  std::deque<uint64_t> m_released;
+  std::vector<uint32_t> m_assigned;
+  
+  uint64_t m_nAssigned;
+  uint64_t m_maxAssigned;
+  uint64_t m_nExhausted;
 };
 
 } /* namespace ns3 */
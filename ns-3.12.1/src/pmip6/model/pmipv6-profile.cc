@@ -22,6 +22,16 @@
  * Author: Hyon-Young Choi <commani@gmail.com>
  */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
 #include "ns3/node.h"
@@ -35,6 +45,20 @@ namespace ns3
 
 NS_OBJECT_ENSURE_REGISTERED (Pmipv6Profile);
 
+/* binary profile format, see the Pmipv6Profile documentation */
+static const uint8_t PROFILE_MAGIC[4] = { 'P', 'M', '6', 'P' };
+static const uint16_t PROFILE_VERSION = 1;
+static const uint32_t PROFILE_HEADER_SIZE = 12;
+static const uint32_t PROFILE_RECORD_SIZE = 20; /* fixed part of a record */
+
+static uint32_t
+ProfileRecordSize (uint8_t mnIdLen, uint8_t mnLinkIdLen, uint8_t nHnps)
+{
+  uint32_t size = PROFILE_RECORD_SIZE + nHnps * 16 + mnIdLen + mnLinkIdLen;
+  
+  return (size + 3) & ~3;
+}
+
 TypeId Pmipv6Profile::GetTypeId ()
 {
   static TypeId tid = TypeId ("ns3::Pmipv6Profile")
@@ -45,6 +69,7 @@ TypeId Pmipv6Profile::GetTypeId ()
 } 
 
 Pmipv6Profile::Pmipv6Profile ()
+  : m_nEntries (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -66,11 +91,11 @@ Pmipv6Profile::Entry* Pmipv6Profile::Lookup (Identifier id)
 {
   NS_LOG_FUNCTION (this << id);
   
-  if ( m_profileList.find (id) != m_profileList.end ())
+  ProfileListI i = m_profileList.find (id);
+  
+  if (i != m_profileList.end ())
     {
-      Pmipv6Profile::Entry* entry = m_profileList[id];
-	  
-	  return entry;
+      return (*i).second;
     }
   return 0;
 }
@@ -80,38 +105,278 @@ Pmipv6Profile::Entry* Pmipv6Profile::Add (Identifier id)
   NS_LOG_FUNCTION (this << id);
   NS_ASSERT( m_profileList.find (id) == m_profileList.end() );
   
-  Pmipv6Profile::Entry* entry = new Pmipv6Profile::Entry (this);
+  Pmipv6Profile::Entry* entry = new (m_entryPool.Allocate ()) Pmipv6Profile::Entry (this);
+  
+  entry->m_key = id;
 
   m_profileList[id] = entry;
+  m_nEntries++;
+  
+  return entry;
+}
+
+Pmipv6Profile::Entry* Pmipv6Profile::Add (Identifier mnId, Identifier mnLinkId)
+{
+  NS_LOG_FUNCTION (this << mnId << mnLinkId);
+  
+  Pmipv6Profile::Entry* entry = Add (mnId);
+  
+  entry->m_mnIdentifier = mnId;
+  entry->m_mnLinkIdentifier = mnLinkId;
+  
+  if (!mnLinkId.IsEmpty () && mnLinkId != mnId)
+    {
+      NS_ASSERT( m_profileList.find (mnLinkId) == m_profileList.end() );
+      
+      entry->m_linkKey = mnLinkId;
+      m_profileList[mnLinkId] = entry;
+    }
   
   return entry;
 }
 
 void Pmipv6Profile::Remove (Pmipv6Profile::Entry* entry)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  ProfileListI i = m_profileList.find (entry->m_key);
+  
+  if (i == m_profileList.end () || (*i).second != entry)
+    {
+      return;
+    }
+  
+  m_profileList.erase (i);
+  
+  if (!entry->m_linkKey.IsEmpty ())
+    {
+      m_profileList.erase (entry->m_linkKey);
+    }
+  
+  m_nEntries--;
+  m_entryPool.Delete (entry);
+}
+
+void Pmipv6Profile::Flush ()
 {
   NS_LOG_FUNCTION_NOARGS ();
 
   for (ProfileListI i = m_profileList.begin () ; i != m_profileList.end () ; i++)
     {
-      if ((*i).second == entry)
+      /* an entry indexed by its link identifier too is deleted once, from its own key */
+      if ((*i).first == (*i).second->m_key)
         {
-          m_profileList.erase (i);
-          delete entry;
-          return;
+          m_entryPool.Delete ((*i).second); /* delete the pointer Pmipv6Profile::Entry */
         }
     }
+
+  m_profileList.erase (m_profileList.begin (), m_profileList.end ());
+  m_nEntries = 0;
 }
 
-void Pmipv6Profile::Flush ()
+uint32_t Pmipv6Profile::GetN () const
 {
   NS_LOG_FUNCTION_NOARGS ();
+  
+  return m_nEntries;
+}
 
-  for (ProfileListI i = m_profileList.begin () ; i != m_profileList.end () ; i++)
+void Pmipv6Profile::Reserve (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  
+  /* two keys per subscriber */
+  m_profileList.resize (m_profileList.size () + 2 * n);
+  m_entryPool.Reserve (n);
+}
+
+bool Pmipv6Profile::Load (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  
+  int fd = open (filename.c_str (), O_RDONLY);
+  
+  if (fd < 0)
+    {
+      NS_LOG_WARN ("Cannot open profile file " << filename);
+      return false;
+    }
+  
+  struct stat st;
+  
+  if (fstat (fd, &st) < 0 || st.st_size < (off_t)PROFILE_HEADER_SIZE || st.st_size > (off_t)0xffffffff)
+    {
+      NS_LOG_WARN ("Bad profile file size " << filename);
+      close (fd);
+      return false;
+    }
+  
+  void *image = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  
+  if (image == MAP_FAILED)
     {
-      delete (*i).second; /* delete the pointer Pmipv6Profile::Entry */
+      NS_LOG_WARN ("Cannot map profile file " << filename);
+      return false;
     }
+  
+  bool loaded = Load (static_cast<const uint8_t *> (image), st.st_size);
+  
+  munmap (image, st.st_size);
+  
+  return loaded;
+}
 
-  m_profileList.erase (m_profileList.begin (), m_profileList.end ());
+bool Pmipv6Profile::Load (const uint8_t *buffer, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  
+  if (size < PROFILE_HEADER_SIZE
+      || memcmp (buffer, PROFILE_MAGIC, sizeof (PROFILE_MAGIC)) != 0
+      || ((buffer[4] << 8) | buffer[5]) != PROFILE_VERSION)
+    {
+      NS_LOG_WARN ("Not a profile image");
+      return false;
+    }
+  
+  uint32_t count = (buffer[8] << 24) | (buffer[9] << 16) | (buffer[10] << 8) | buffer[11];
+  
+  /* every record takes at least its fixed part, do not trust the count further */
+  if (count > (size - PROFILE_HEADER_SIZE) / PROFILE_RECORD_SIZE)
+    {
+      NS_LOG_WARN ("Truncated profile image");
+      return false;
+    }
+  
+  Reserve (count);
+  
+  std::vector<Pmipv6Profile::Entry *> added;
+  added.reserve (count);
+  
+  const uint8_t *p = buffer + PROFILE_HEADER_SIZE;
+  const uint8_t *end = buffer + size;
+  
+  for (uint32_t n = 0; n < count; n++)
+    {
+      if (end - p < (ptrdiff_t)PROFILE_RECORD_SIZE)
+        {
+          break;
+        }
+      
+      uint8_t mnIdLen = p[0];
+      uint8_t mnLinkIdLen = p[1];
+      uint8_t nHnps = p[2];
+      uint32_t recordSize = ProfileRecordSize (mnIdLen, mnLinkIdLen, nHnps);
+      
+      if (mnIdLen == 0 || end - p < (ptrdiff_t)recordSize)
+        {
+          break;
+        }
+      
+      const uint8_t *ids = p + PROFILE_RECORD_SIZE + nHnps * 16;
+      Identifier mnId (ids, mnIdLen);
+      Identifier mnLinkId (ids + mnIdLen, mnLinkIdLen);
+      
+      /* same rule as Add: a link identifier equal to the MN identifier is not indexed again */
+      if (Lookup (mnId) || (mnLinkIdLen > 0 && mnLinkId != mnId && Lookup (mnLinkId)))
+        {
+          NS_LOG_WARN ("Duplicate subscriber " << mnId);
+          break;
+        }
+      
+      Pmipv6Profile::Entry *entry = Add (mnId, mnLinkId);
+      
+      entry->m_lmaAddress = Ipv6Address::Deserialize (p + 4);
+      
+      for (uint8_t i = 0; i < nHnps; i++)
+        {
+          entry->m_homeNetworkPrefixes.push_back (Ipv6Address::Deserialize (p + PROFILE_RECORD_SIZE + i * 16));
+        }
+      
+      added.push_back (entry);
+      p += recordSize;
+    }
+  
+  if (added.size () != count || p != end)
+    {
+      NS_LOG_WARN ("Malformed profile record " << added.size ());
+      
+      for (std::vector<Pmipv6Profile::Entry *>::iterator i = added.begin (); i != added.end (); i++)
+        {
+          Remove (*i);
+        }
+      return false;
+    }
+  
+  return true;
+}
+
+bool Pmipv6Profile::Save (std::string filename) const
+{
+  NS_LOG_FUNCTION (this << filename);
+  
+  std::vector<uint8_t> image (PROFILE_HEADER_SIZE, 0);
+  
+  memcpy (&image[0], PROFILE_MAGIC, sizeof (PROFILE_MAGIC));
+  image[4] = PROFILE_VERSION >> 8;
+  image[5] = PROFILE_VERSION & 0xff;
+  image[8] = m_nEntries >> 24;
+  image[9] = (m_nEntries >> 16) & 0xff;
+  image[10] = (m_nEntries >> 8) & 0xff;
+  image[11] = m_nEntries & 0xff;
+  
+  for (ProfileListCI i = m_profileList.begin () ; i != m_profileList.end () ; i++)
+    {
+      const Pmipv6Profile::Entry *entry = (*i).second;
+      
+      if ((*i).first != entry->m_key)
+        {
+          continue;
+        }
+      
+      /* Load indexes the entry by its key and, through Add, by its link identifier */
+      Identifier mnLinkId = entry->m_mnLinkIdentifier;
+      
+      if (entry->m_homeNetworkPrefixes.size () > 0xff)
+        {
+          NS_LOG_WARN ("Too many prefixes for " << entry->m_key);
+          return false;
+        }
+      
+      uint8_t nHnps = entry->m_homeNetworkPrefixes.size ();
+      uint32_t offset = image.size ();
+      
+      image.resize (offset + ProfileRecordSize (entry->m_key.GetLength (), mnLinkId.GetLength (), nHnps), 0);
+      
+      uint8_t *p = &image[offset];
+      
+      p[0] = entry->m_key.GetLength ();
+      p[1] = mnLinkId.GetLength ();
+      p[2] = nHnps;
+      entry->m_lmaAddress.Serialize (p + 4);
+      p += PROFILE_RECORD_SIZE;
+      
+      for (std::list<Ipv6Address>::const_iterator j = entry->m_homeNetworkPrefixes.begin (); j != entry->m_homeNetworkPrefixes.end (); j++)
+        {
+          (*j).Serialize (p);
+          p += 16;
+        }
+      
+      p += entry->m_key.CopyTo (p, entry->m_key.GetLength ());
+      mnLinkId.CopyTo (p, mnLinkId.GetLength ());
+    }
+  
+  std::ofstream os (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  
+  if (!os)
+    {
+      NS_LOG_WARN ("Cannot create profile file " << filename);
+      return false;
+    }
+  
+  os.write (reinterpret_cast<const char *> (&image[0]), image.size ());
+  
+  return os.good ();
 }
 
 Pmipv6Profile::Entry::Entry (Pmipv6Profile* pf)
@@ -28,6 +28,7 @@
 #include <stdint.h>
 
 #include <list>
+#include <string>
 
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
@@ -38,9 +39,29 @@
 #include "ns3/sgi-hashmap.h"
 #include "ns3/identifier.h"
 
+#include "entry-pool.h"
+
 namespace ns3
 {
 
+/**
+ * \class Pmipv6Profile
+ * \brief Policy store of the subscribers served by the PMIPv6 domain.
+ *
+ * A subscriber is held in a single entry, indexed both by its MN identifier
+ * and by its MN link identifier, and one store is meant to be shared by all
+ * the agents of a domain.  Large stores are bulk-loaded from a binary file:
+ *
+ * \verbatim
+   header  : magic "PM6P" (4), version (2), reserved (2), record count (4)
+   record  : MN-ID length (1), link-ID length (1), HNP count (1), reserved (1),
+             LMA address (16), HNPs (16 each), MN-ID, link-ID,
+             zero padding up to a multiple of 4 bytes
+   \endverbatim
+ *
+ * Integers are in network byte order.  The file holds no pointer and no
+ * absolute offset, so it can be mapped and walked in place.
+ */
 class Pmipv6Profile : public Object
 {
 public:
@@ -57,10 +78,51 @@ public:
   
   Entry *Lookup(Identifier id);
   Entry *Add(Identifier id);
+  
+  /**
+   * \brief Add a subscriber indexed by both of its identifiers.
+   * \param mnId MN identifier
+   * \param mnLinkId MN link identifier, not indexed if empty
+   * \return the new entry
+   */
+  Entry *Add(Identifier mnId, Identifier mnLinkId);
   void Remove(Entry *entry);
   
   void Flush();
   
+  /**
+   * \return the number of subscribers in the store
+   */
+  uint32_t GetN() const;
+  
+  /**
+   * \brief Prepare the store for n more subscribers.
+   * \param n number of subscribers
+   */
+  void Reserve(uint32_t n);
+  
+  /**
+   * \brief Load the subscribers of a binary profile file.
+   * \param filename name of the file
+   * \return false if the file cannot be read or is malformed
+   */
+  bool Load(std::string filename);
+  
+  /**
+   * \brief Load the subscribers of a binary profile image in memory.
+   * \param buffer start of the image
+   * \param size size of the image
+   * \return false if the image is malformed, in which case the store is unchanged
+   */
+  bool Load(const uint8_t *buffer, uint32_t size);
+  
+  /**
+   * \brief Write the subscribers of the store into a binary profile file.
+   * \param filename name of the file
+   * \return false if the file cannot be written
+   */
+  bool Save(std::string filename) const;
+  
   class Entry
   {
   public:
@@ -82,7 +144,12 @@ public:
   protected:
   
   private:
+    friend class Pmipv6Profile;
+    
     Pmipv6Profile *m_profile;
+    
+    Identifier m_key;
+    Identifier m_linkKey;
 	
 	Identifier m_mnIdentifier;
 	Identifier m_mnLinkIdentifier;
@@ -94,10 +161,14 @@ protected:
 private:
   typedef sgi::hash_map<Identifier, Pmipv6Profile::Entry *, IdentifierHash> ProfileList;
   typedef sgi::hash_map<Identifier, Pmipv6Profile::Entry *, IdentifierHash>::iterator ProfileListI;
+  typedef sgi::hash_map<Identifier, Pmipv6Profile::Entry *, IdentifierHash>::const_iterator ProfileListCI;
   
   void DoDispose();
   
   ProfileList m_profileList;
+  uint32_t m_nEntries;
+  
+  EntryPool<Pmipv6Profile::Entry> m_entryPool;
 
 };
 
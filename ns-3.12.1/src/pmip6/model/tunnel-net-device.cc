@@ -84,7 +84,10 @@ TunnelNetDevice::GetTypeId (void)
 TunnelNetDevice::TunnelNetDevice ()
  : m_localAddress("::"),
    m_remoteAddress("::"),
-   m_refCount(1)
+   m_refCount(1),
+   m_ipv6 (0),
+   m_route (0),
+   m_routeGeneration (0)
 {
   NS_LOG_FUNCTION_NOARGS();
   
@@ -133,6 +136,9 @@ void TunnelNetDevice::DoDispose()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_node = 0;
+  m_ipv6 = 0;
+  m_route = 0;
+  m_holdCallback = MakeNullCallback<bool, Ptr<Packet>, const Ipv6Header &> ();
   NetDevice::DoDispose ();
 }
 
@@ -148,6 +154,7 @@ void TunnelNetDevice::SetLocalAddress(Ipv6Address laddr)
   NS_LOG_FUNCTION ( this << laddr );
   
   m_localAddress = laddr;
+  m_route = 0;
 }
   
 Ipv6Address TunnelNetDevice::GetRemoteAddress() const
@@ -162,6 +169,14 @@ void TunnelNetDevice::SetRemoteAddress(Ipv6Address raddr)
   NS_LOG_FUNCTION ( this << raddr );
   
   m_remoteAddress = raddr;
+  m_route = 0;
+}
+
+void TunnelNetDevice::SetHoldCallback (HoldCallback cb)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  
+  m_holdCallback = cb;
 }
    
 void TunnelNetDevice::IncreaseRefCount()
@@ -316,10 +331,26 @@ TunnelNetDevice::Send (Ptr<Packet> packet, const Address& dest, uint16_t protoco
 {
   NS_LOG_FUNCTION ( this << packet << dest << protocolNumber );
   
-  Ptr<Ipv6L3Protocol> ipv6 = GetNode()->GetObject<Ipv6L3Protocol>();
+  if (m_ipv6 == 0)
+    {
+      m_ipv6 = GetNode()->GetObject<Ipv6L3Protocol>();
+    }
+  Ptr<Ipv6L3Protocol> ipv6 = m_ipv6;
   NS_ASSERT (ipv6 != 0 && ipv6->GetRoutingProtocol () != 0);
   NS_ASSERT ( !m_remoteAddress.IsAny() );
   
+  if (!m_holdCallback.IsNull ())
+    {
+      Ipv6Header header;
+      packet->PeekHeader (header);
+      
+      if (m_holdCallback (packet, header))
+        {
+          NS_LOG_LOGIC ("Packet to " << header.GetDestinationAddress () << " held back");
+          return true;
+        }
+    }
+  
   Ipv6Address src = m_localAddress;
   Ipv6Address dst = m_remoteAddress;
   SocketIpTtlTag tag;
@@ -330,13 +361,7 @@ TunnelNetDevice::Send (Ptr<Packet> packet, const Address& dest, uint16_t protoco
   if ( m_localAddress.IsAny() )
     {
   
-	  Ipv6Header header;
-	  Socket::SocketErrno err;
-      Ptr<Ipv6Route> route;
-	  Ptr<NetDevice> oif (0); //specify non-zero if bound to a source address
-
-	  header.SetDestinationAddress (dst);
-	  route = ipv6->GetRoutingProtocol ()->RouteOutput (packet, header, oif, err);
+	  Ptr<Ipv6Route> route = LookupRoute (packet);
 
 	  if (route == 0)
 		{
@@ -363,6 +388,26 @@ TunnelNetDevice::Send (Ptr<Packet> packet, const Address& dest, uint16_t protoco
 	return true;
 }
 
+Ptr<Ipv6Route>
+TunnelNetDevice::LookupRoute (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+
+  if (m_route != 0 && m_routeGeneration == m_ipv6->GetRouteGeneration ())
+    {
+      return m_route;
+    }
+
+  Ipv6Header header;
+  Socket::SocketErrno err;
+  Ptr<NetDevice> oif (0); //specify non-zero if bound to a source address
+
+  header.SetDestinationAddress (m_remoteAddress);
+  m_route = m_ipv6->GetRoutingProtocol ()->RouteOutput (packet, header, oif, err);
+  m_routeGeneration = m_ipv6->GetRouteGeneration ();
+  return m_route;
+}
+
 bool
 TunnelNetDevice::SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber)
 {
@@ -371,10 +416,26 @@ TunnelNetDevice::SendFrom (Ptr<Packet> packet, const Address& source, const Addr
   
   NS_ASSERT (m_supportsSendFrom);
   
-  Ptr<Ipv6L3Protocol> ipv6 = GetNode()->GetObject<Ipv6L3Protocol>();
+  if (m_ipv6 == 0)
+    {
+      m_ipv6 = GetNode()->GetObject<Ipv6L3Protocol>();
+    }
+  Ptr<Ipv6L3Protocol> ipv6 = m_ipv6;
   NS_ASSERT (ipv6 != 0 && ipv6->GetRoutingProtocol () != 0);
   NS_ASSERT ( !m_remoteAddress.IsAny() );
   
+  if (!m_holdCallback.IsNull ())
+    {
+      Ipv6Header header;
+      packet->PeekHeader (header);
+      
+      if (m_holdCallback (packet, header))
+        {
+          NS_LOG_LOGIC ("Packet to " << header.GetDestinationAddress () << " held back");
+          return true;
+        }
+    }
+  
   Ipv6Address src = m_localAddress;
   Ipv6Address dst = m_remoteAddress;
   SocketIpTtlTag tag;
@@ -392,13 +453,7 @@ TunnelNetDevice::SendFrom (Ptr<Packet> packet, const Address& source, const Addr
   if ( m_localAddress.IsAny() )
     {
   
-	  Ipv6Header header;
-	  Socket::SocketErrno err;
-      Ptr<Ipv6Route> route;
-	  Ptr<NetDevice> oif (0); //specify non-zero if bound to a source address
-
-	  header.SetDestinationAddress (dst);
-	  route = ipv6->GetRoutingProtocol ()->RouteOutput (packet, header, oif, err);
+	  Ptr<Ipv6Route> route = LookupRoute (packet);
 
 	  if (route == 0)
 		{
@@ -35,15 +35,27 @@
 
 namespace ns3 {
 
+class Ipv6Route;
+class Ipv6Header;
+class Ipv6L3Protocol;
 
 /**
  * \class TunnelNetDevice
  * \brief A tunnel device, similar to Linux TUN/TAP interfaces.
  *
+ * When no local address is set, the outer route and source address are
+ * looked up once and reused until the routing of the node changes (a route
+ * in any of its routing protocols, an address, an interface going up or
+ * down) or an endpoint is set.
  */
 class TunnelNetDevice : public NetDevice
 {
 public:
+  /**
+   * \brief Callback offered the packets to encapsulate, inner header
+   * included; returns true when it keeps the packet.
+   */
+  typedef Callback<bool, Ptr<Packet>, const Ipv6Header &> HoldCallback;
 
   static TypeId GetTypeId (void);
   TunnelNetDevice ();
@@ -85,6 +97,13 @@ public:
   Ipv6Address GetRemoteAddress() const;
   void SetRemoteAddress(Ipv6Address raddr);
   
+  /**
+   * \brief Set the callback which may keep packets back from the tunnel,
+   * e.g. those of an MN being handed over.
+   * \param cb the callback, a null callback to send them all
+   */
+  void SetHoldCallback (HoldCallback cb);
+  
   void IncreaseRefCount();
   void DecreaseRefCount();
   uint32_t GetRefCount() const;
@@ -136,6 +155,13 @@ protected:
 
 private:
 
+  /**
+   * \brief Get the route towards the remote endpoint.
+   * \param packet the packet to encapsulate
+   * \return the route, 0 if there is none
+   */
+  Ptr<Ipv6Route> LookupRoute (Ptr<Packet> packet);
+
   Address m_myAddress;
   TracedCallback<Ptr<const Packet> > m_macRxTrace;
   TracedCallback<Ptr<const Packet> > m_macTxTrace;
@@ -155,6 +181,12 @@ private:
   Ipv6Address m_localAddress;
   Ipv6Address m_remoteAddress;
   uint32_t m_refCount;
+
+  Ptr<Ipv6L3Protocol> m_ipv6;
+  Ptr<Ipv6Route> m_route;
+  uint32_t m_routeGeneration;
+  
+  HoldCallback m_holdCallback;
 };
 
 }; // namespace ns3
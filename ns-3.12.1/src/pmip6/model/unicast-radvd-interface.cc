@@ -29,15 +29,28 @@ namespace ns3
 
 uint32_t UnicastRadvdInterface::m_idGen = 1;
 
+static uint32_t
+NextId (uint32_t *idGen)
+{
+#ifdef __GNUC__
+  // MAGs simulated by different threads add interfaces concurrently
+  return __sync_fetch_and_add (idGen, 1);
+#else
+  return (*idGen)++;
+#endif
+}
+
 UnicastRadvdInterface::UnicastRadvdInterface(uint32_t interface)
  : RadvdInterface(interface),
-   m_id (m_idGen++)
+   m_raGeneration (0),
+   m_id (NextId (&m_idGen))
 {
 }
 
 UnicastRadvdInterface::UnicastRadvdInterface(uint32_t interface, uint32_t maxRtrAdvInterval, uint32_t minRtrAdvInterval)
  : RadvdInterface(interface, maxRtrAdvInterval, minRtrAdvInterval),
-   m_id (m_idGen++)
+   m_raGeneration (0),
+   m_id (NextId (&m_idGen))
 {
   
 }
@@ -57,4 +70,27 @@ uint32_t UnicastRadvdInterface::GetId () const
   return m_id;
 }
 
+Ptr<const Packet> UnicastRadvdInterface::GetRa (Ipv6Address src, Ipv6Address dst) const
+{
+  if (m_ra == 0 || src != m_raSource || dst != m_raDestination || m_raGeneration != GetGeneration ())
+    {
+      return 0;
+    }
+  
+  return m_ra;
+}
+
+void UnicastRadvdInterface::SetRa (Ptr<const Packet> ra, Ipv6Address src, Ipv6Address dst)
+{
+  m_ra = ra;
+  m_raSource = src;
+  m_raDestination = dst;
+  m_raGeneration = GetGeneration ();
+}
+
+void UnicastRadvdInterface::InvalidateRa ()
+{
+  m_ra = 0;
+}
+
 }
@@ -26,6 +26,8 @@
 #define UNICAST_RADVD_INTERFACE_H
 
 #include "ns3/radvd-interface.h"
+#include "ns3/packet.h"
+#include "ns3/ipv6-address.h"
 
 namespace ns3
 {
@@ -34,6 +36,10 @@ namespace ns3
  * \ingroup radvd
  * \class RadvdInterface
  * \brief Radvd interface configuration.
+ *
+ * The RA built from the configuration is cached, with the addresses its
+ * checksum was computed for and the generation of the configuration, and
+ * sent again as is until the configuration or one of its prefixes changes.
  */
 class UnicastRadvdInterface : public RadvdInterface
 {
@@ -47,10 +53,27 @@ public:
   void SetPhysicalAddress(Address addr);
   
   uint32_t GetId () const;
+  
+  /**
+   * \param src source address of the RA
+   * \param dst destination address of the RA
+   * \return the cached RA with its IPv6 header, 0 if none was built for these
+   * addresses from the current configuration
+   */
+  Ptr<const Packet> GetRa (Ipv6Address src, Ipv6Address dst) const;
+  
+  void SetRa (Ptr<const Packet> ra, Ipv6Address src, Ipv6Address dst);
+  
+  void InvalidateRa ();
 
 private:
   Address m_physicalAddress;
   
+  Ptr<const Packet> m_ra;
+  Ipv6Address m_raSource;
+  Ipv6Address m_raDestination;
+  uint32_t m_raGeneration;
+  
   uint32_t m_id;
   
   static uint32_t m_idGen;
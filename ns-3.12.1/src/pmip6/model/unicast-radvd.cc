@@ -36,6 +36,7 @@
 #include "ns3/ipv6-header.h"
 #include "ns3/icmpv6-header.h"
 #include "ns3/packet-socket-address.h"
+#include "ns3/trace-source-accessor.h"
 
 #include "unicast-radvd.h"
 
@@ -51,11 +52,21 @@ TypeId UnicastRadvd::GetTypeId ()
   static TypeId tid = TypeId ("ns3::UnicastRadvd")
     .SetParent<Application> ()
     .AddConstructor<UnicastRadvd> ()
+    .AddAttribute ("CoalescingWindow", "An RA due at most this long before a pending batch is delayed to join it.",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&UnicastRadvd::m_coalescingWindow),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Tx", "A router advertisement was sent to the given physical address.",
+                     MakeTraceSourceAccessor (&UnicastRadvd::m_txTrace))
     ;
   return tid;
 }
 
 UnicastRadvd::UnicastRadvd ()
+  : m_coalescingWindow (MilliSeconds (10)),
+    m_nRas (0),
+    m_nRasBuilt (0),
+    m_nBatches (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -95,8 +106,7 @@ void UnicastRadvd::StartApplication ()
 
   for (RadvdInterfaceListCI it = m_configurations.begin () ; it != m_configurations.end () ; it++)
     {
-      m_eventIds[(*it)->GetId ()] = EventId ();
-      ScheduleTransmit (Seconds (0.), (*it), m_eventIds[(*it)->GetId ()], Ipv6Address::GetAllNodesMulticast (), true); 
+      ScheduleTransmit (Seconds (0.), (*it));
     }
 }
 
@@ -109,11 +119,12 @@ void UnicastRadvd::StopApplication ()
 	  m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
 	}
 
-  for (EventIdMapI it = m_eventIds.begin () ; it != m_eventIds.end () ; ++it)
+  for (BatchMapI it = m_batches.begin () ; it != m_batches.end () ; ++it)
     {
-      Simulator::Cancel ((*it).second);
+      Simulator::Cancel ((*it).second.m_event);
     }
-  m_eventIds.clear ();
+  m_batches.clear ();
+  m_dueTimes.clear ();
 }
 
 void UnicastRadvd::AddConfiguration (Ptr<UnicastRadvdInterface> routerInterface)
@@ -126,13 +137,7 @@ void UnicastRadvd::AddConfiguration (Ptr<UnicastRadvdInterface> routerInterface)
     {
 	  NS_LOG_LOGIC ("Application is already started. Adding and Scheduling..");
 	  
-	  if (m_eventIds.find(routerInterface->GetId()) != m_eventIds.end() )
-	    {
-		  m_eventIds[routerInterface->GetId()].Cancel();
-		}
-		
-	  m_eventIds[routerInterface->GetId()] = EventId();
-      ScheduleTransmit (Seconds (0.), routerInterface, m_eventIds[routerInterface->GetId ()], Ipv6Address::GetAllNodesMulticast (), true); 
+      ScheduleTransmit (Seconds (0.), routerInterface);
 	}
 }
 
@@ -140,10 +145,7 @@ void UnicastRadvd::RemoveConfiguration (Ptr<UnicastRadvdInterface> routerInterfa
 {
   NS_LOG_FUNCTION ( this << routerInterface );
   
-  if ( m_eventIds.find(routerInterface->GetId()) != m_eventIds.end() )
-    {
-	  m_eventIds[routerInterface->GetId()].Cancel();
-	}
+  CancelTransmit (routerInterface);
   
   m_configurations.remove (routerInterface);
 }
@@ -163,16 +165,133 @@ void UnicastRadvd::RemoveConfiguration (int32_t ifIndex)
 	}
 }
   
-void UnicastRadvd::ScheduleTransmit (Time dt, Ptr<UnicastRadvdInterface> config, EventId& eventId, Ipv6Address dst, bool reschedule)
+uint32_t UnicastRadvd::GetNRas () const
+{
+  return m_nRas;
+}
+
+uint32_t UnicastRadvd::GetNRasBuilt () const
+{
+  return m_nRasBuilt;
+}
+
+uint32_t UnicastRadvd::GetNBatches () const
+{
+  return m_nBatches;
+}
+
+void UnicastRadvd::ScheduleTransmit (Time dt, Ptr<UnicastRadvdInterface> config)
 {
   NS_LOG_FUNCTION (this << dt);
-  eventId = Simulator::Schedule (dt, &UnicastRadvd::Send, this, config, dst, reschedule);
+  
+  CancelTransmit (config);
+  
+  Time due = Simulator::Now () + dt;
+  
+  //never earlier, the minimum interval between RAs holds
+  BatchMapI it = m_batches.lower_bound (due);
+  
+  if (it == m_batches.end () || it->first > due + m_coalescingWindow)
+    {
+      it = m_batches.insert (it, std::make_pair (due, Batch ()));
+      it->second.m_event = Simulator::Schedule (dt, &UnicastRadvd::SendBatch, this, due);
+    }
+  
+  it->second.m_configurations.push_back (config);
+  m_dueTimes[config->GetId ()] = it->first;
+}
+
+void UnicastRadvd::CancelTransmit (Ptr<UnicastRadvdInterface> config)
+{
+  NS_LOG_FUNCTION (this << config);
+  
+  DueTimeMapI it = m_dueTimes.find (config->GetId ());
+  
+  if (it == m_dueTimes.end ())
+    {
+      return;
+    }
+  
+  BatchMapI batch = m_batches.find (it->second);
+  
+  NS_ASSERT (batch != m_batches.end ());
+  
+  batch->second.m_configurations.remove (config);
+  
+  if (batch->second.m_configurations.empty ())
+    {
+      Simulator::Cancel (batch->second.m_event);
+      m_batches.erase (batch);
+    }
+  
+  m_dueTimes.erase (it);
+}
+
+void UnicastRadvd::SendBatch (Time due)
+{
+  NS_LOG_FUNCTION (this << due);
+  
+  BatchMapI batch = m_batches.find (due);
+  
+  NS_ASSERT (batch != m_batches.end ());
+  
+  //the handlers reschedule into other batches, detach this one first
+  RadvdInterfaceList configurations;
+  configurations.swap (batch->second.m_configurations);
+  m_batches.erase (batch);
+  
+  m_nBatches++;
+  
+  for (RadvdInterfaceListI it = configurations.begin (); it != configurations.end (); ++it)
+    {
+      m_dueTimes.erase ((*it)->GetId ());
+      Send ((*it), Ipv6Address::GetAllNodesMulticast (), true);
+    }
 }
 
 void UnicastRadvd::Send (Ptr<UnicastRadvdInterface> config, Ipv6Address dst, bool reschedule)
 {
   NS_LOG_FUNCTION (this << dst);
-  NS_ASSERT (m_eventIds[config->GetId ()].IsExpired ());
+  
+  Ptr<Ipv6> ipv6 = GetNode ()->GetObject<Ipv6> ();
+  Ipv6Address src = ipv6->GetAddress (config->GetInterface (), 0).GetAddress ();
+  Ptr<const Packet> ra = config->GetRa (src, dst);
+
+  if (ra == 0)
+    {
+      ra = BuildRa (config, src, dst);
+      config->SetRa (ra, src, dst);
+      m_nRasBuilt++;
+    }
+  
+  Ptr<Packet> p = ra->Copy ();
+  
+  PacketSocketAddress target;
+
+  target.SetSingleDevice(ipv6->GetNetDevice(config->GetInterface())->GetIfIndex());
+  target.SetPhysicalAddress (config->GetPhysicalAddress());
+  target.SetProtocol (0x86dd /* Ipv6 */);
+  
+  /* send RA */
+  NS_LOG_LOGIC ("Send RA");
+  m_socket->SendTo (p, 0, target);
+  m_txTrace (p, config->GetPhysicalAddress ());
+  m_nRas++;
+
+  if (reschedule)
+    {
+      UniformVariable rnd;
+      uint64_t delay = static_cast<uint64_t> (rnd.GetValue (config->GetMinRtrAdvInterval (), config->GetMaxRtrAdvInterval ()) + 0.5);
+      NS_LOG_INFO ("Reschedule in " << delay);
+      Time t = MilliSeconds (delay);
+      ScheduleTransmit (t, config);
+    }
+
+}
+
+Ptr<Packet> UnicastRadvd::BuildRa (Ptr<UnicastRadvdInterface> config, Ipv6Address src, Ipv6Address dst)
+{
+  NS_LOG_FUNCTION (this << src << dst);
   
   Ipv6Header ipv6Hdr;
   
@@ -181,11 +300,6 @@ void UnicastRadvd::Send (Ptr<UnicastRadvdInterface> config, Ipv6Address dst, boo
   Icmpv6OptionMtu mtuHdr;
   Icmpv6OptionPrefixInformation prefixHdr;
 
-  if (m_eventIds.size () == 0)
-    {
-      return;
-    }
-
   std::list<Ptr<RadvdPrefix> > prefixes = config->GetPrefixes ();
   Ptr<Packet> p = Create<Packet> ();
   Ptr<Ipv6> ipv6 = GetNode ()->GetObject<Ipv6> ();
@@ -244,8 +358,6 @@ void UnicastRadvd::Send (Ptr<UnicastRadvdInterface> config, Ipv6Address dst, boo
       p->AddHeader (prefixHdr);
     }
 
-  Ipv6Address src = ipv6->GetAddress (config->GetInterface (), 0).GetAddress ();
-
   /* as we know interface index that will be used to send RA and 
    * we always send RA with router's link-local address, we can 
    * calculate checksum here.
@@ -261,29 +373,7 @@ void UnicastRadvd::Send (Ptr<UnicastRadvdInterface> config, Ipv6Address dst, boo
   
   p->AddHeader (ipv6Hdr);
   
-  PacketSocketAddress target;
-
-  target.SetSingleDevice(ipv6->GetNetDevice(config->GetInterface())->GetIfIndex());
-  target.SetPhysicalAddress (config->GetPhysicalAddress());
-  target.SetProtocol (0x86dd /* Ipv6 */);
-  
-  Ptr<NetDevice> dev = ipv6->GetNetDevice(config->GetInterface());
-  
-  NS_LOG_LOGIC ("Netdev: " << dev << ", address: " << dev->GetAddress() );
-  
-  /* send RA */
-  NS_LOG_LOGIC ("Send RA");
-  m_socket->SendTo (p, 0, target);
-
-  if (reschedule)
-    {
-      UniformVariable rnd;
-      uint64_t delay = static_cast<uint64_t> (rnd.GetValue (config->GetMinRtrAdvInterval (), config->GetMaxRtrAdvInterval ()) + 0.5);
-      NS_LOG_INFO ("Reschedule in " << delay);
-      Time t = MilliSeconds (delay);
-      ScheduleTransmit (t, config, m_eventIds[config->GetId ()], Ipv6Address::GetAllNodesMulticast (), reschedule);
-    }
-
+  return p;
 }
 
 void UnicastRadvd::HandleRead (Ptr<Socket> socket)
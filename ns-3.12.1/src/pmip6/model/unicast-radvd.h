@@ -26,9 +26,13 @@
 #define UNICAST_RADVD_H
 
 #include <map>
+#include <list>
 
 #include "ns3/application.h"
 #include "ns3/socket.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-callback.h"
 
 #include "unicast-radvd-interface.h"
 
@@ -44,6 +48,11 @@ namespace ns3
  * \ingroup unicast-radvd
  * \class UnicastRadvd
  * \brief Router advertisement daemon with MAC unicast.
+ *
+ * An RA joins the pending batch due within CoalescingWindow after it,
+ * whatever the configuration it belongs to, and each batch is sent by a
+ * single simulator event. Each RA is built once and cached in its
+ * configuration, see UnicastRadvdInterface.
  */
 class UnicastRadvd : public Application
 {
@@ -77,6 +86,21 @@ public:
   
   void RemoveConfiguration (Ptr<UnicastRadvdInterface> routerInterface);
   void RemoveConfiguration (int32_t ifIndex);
+  
+  /**
+   * \return the number of RAs sent so far
+   */
+  uint32_t GetNRas () const;
+  
+  /**
+   * \return the number of RAs built so far, the other ones came from the cache
+   */
+  uint32_t GetNRasBuilt () const;
+  
+  /**
+   * \return the number of send events processed so far
+   */
+  uint32_t GetNBatches () const;
 
 protected:
   /**
@@ -89,9 +113,20 @@ private:
   typedef std::list<Ptr<UnicastRadvdInterface> >::iterator RadvdInterfaceListI;
   typedef std::list<Ptr<UnicastRadvdInterface> >::const_iterator RadvdInterfaceListCI;
 
-  typedef std::map<uint32_t, EventId> EventIdMap;
-  typedef std::map<uint32_t, EventId>::iterator EventIdMapI;
-  typedef std::map<uint32_t, EventId>::const_iterator EventIdMapCI;
+  /**
+   * \brief Configurations whose RA is due within the coalescing window.
+   */
+  struct Batch
+  {
+    EventId m_event;
+    RadvdInterfaceList m_configurations;
+  };
+
+  typedef std::map<Time, Batch> BatchMap;
+  typedef std::map<Time, Batch>::iterator BatchMapI;
+
+  typedef std::map<uint32_t, Time> DueTimeMap;
+  typedef std::map<uint32_t, Time>::iterator DueTimeMapI;
 
   /**
    * \brief Start the application.
@@ -104,14 +139,26 @@ private:
   virtual void StopApplication ();
 
   /**
-   * \brief Schedule sending a packet.
-   * \param dt interval between packet
+   * \brief Schedule the next periodic RA of a configuration.
+   * \param dt delay before the RA
+   * \param config interface configuration
+   *
+   * The RA joins the first batch due within the coalescing window after
+   * it, if any.
+   */
+  void ScheduleTransmit (Time dt, Ptr<UnicastRadvdInterface> config);
+
+  /**
+   * \brief Withdraw the pending RA of a configuration from its batch.
    * \param config interface configuration
-   * \param eventId event ID associated
-   * \param dst IPv6 destination address
-   * \param reschedule if true another send will be reschedule (periodic)
    */
-  void ScheduleTransmit (Time dt, Ptr<UnicastRadvdInterface> config, EventId& eventId, Ipv6Address dst = Ipv6Address::GetAllNodesMulticast (), bool reschedule = false);
+  void CancelTransmit (Ptr<UnicastRadvdInterface> config);
+
+  /**
+   * \brief Send the RAs of a batch.
+   * \param due time the batch was scheduled for
+   */
+  void SendBatch (Time due);
 
   /**
    * \brief Send a packet.
@@ -121,6 +168,15 @@ private:
    */
   void Send (Ptr<UnicastRadvdInterface> config, Ipv6Address dst = Ipv6Address::GetAllNodesMulticast (), bool reschedule = false);
 
+  /**
+   * \brief Build the RA of a configuration, with its IPv6 header.
+   * \param config interface configuration
+   * \param src source address
+   * \param dst destination address
+   * \return the RA
+   */
+  Ptr<Packet> BuildRa (Ptr<UnicastRadvdInterface> config, Ipv6Address src, Ipv6Address dst);
+
   
   void HandleRead (Ptr<Socket> socket);
   
@@ -135,9 +191,28 @@ private:
   RadvdInterfaceList m_configurations;
 
   /**
-   * \brief Event ID map.
+   * \brief Pending batches by due time.
+   */
+  BatchMap m_batches;
+
+  /**
+   * \brief Due time of the batch holding the pending RA of each configuration.
+   */
+  DueTimeMap m_dueTimes;
+
+  /**
+   * \brief Delay an RA may take to join a pending batch.
+   */
+  Time m_coalescingWindow;
+
+  uint32_t m_nRas;
+  uint32_t m_nRasBuilt;
+  uint32_t m_nBatches;
+
+  /**
+   * \brief Callback to trace sent RAs and their physical destination.
    */
-  EventIdMap m_eventIds;
+  TracedCallback<Ptr<const Packet>, Address> m_txTrace;
 };
 
 } /* namespace ns3 */
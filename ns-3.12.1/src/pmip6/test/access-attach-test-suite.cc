@@ -0,0 +1,325 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/ipv6.h"
+#include "ns3/regular-wifi-mac.h"
+#include "ns3/wimax-helper.h"
+#include "ns3/bs-net-device.h"
+#include "ns3/ss-net-device.h"
+#include "ns3/lte-helper.h"
+#include "ns3/enb-net-device.h"
+#include "ns3/ue-net-device.h"
+#include "ns3/ue-manager.h"
+#include "ns3/lte-phy.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/identifier.h"
+#include "ns3/ipv6-mobility-header.h"
+#include "ns3/pmipv6-lma.h"
+#include "ns3/pmipv6-mag.h"
+#include "ns3/pmip6-helper.h"
+
+namespace ns3 {
+
+/*
+ * LMA -- MAG (BS or eNB) -- MN
+ *
+ * The MAG learns of the MN straight from its WiMAX or LTE access device,
+ * without any notifier in between.
+ */
+class AccessAttachTestCase : public TestCase
+{
+public:
+  AccessAttachTestCase (std::string name);
+
+protected:
+  /**
+   * \brief Build the LMA and MAG, the MAG having the access device given.
+   */
+  void Setup (Ptr<Node> mag, Ptr<NetDevice> access, Mac48Address mn);
+  void Attach (const Identifier &mnId, const Identifier &mnLinkId);
+  void Detach (const Identifier &mnId, const Identifier &mnLinkId);
+  void TxPbu (const Identifier &mnId, Ipv6Address lma, uint16_t lifetime);
+
+  Ptr<Pmipv6Mag> m_magAgent;
+  Ptr<Pmipv6Lma> m_lmaAgent;
+  std::vector<uint8_t> m_atts;
+  uint32_t m_nAttaches;
+  uint32_t m_nDetaches;
+  uint32_t m_nDeregistrations;
+};
+
+AccessAttachTestCase::AccessAttachTestCase (std::string name)
+  : TestCase (name),
+    m_nAttaches (0),
+    m_nDetaches (0),
+    m_nDeregistrations (0)
+{
+}
+
+void
+AccessAttachTestCase::Setup (Ptr<Node> mag, Ptr<NetDevice> access, Mac48Address mn)
+{
+  Ptr<Node> lma = CreateObject<Node> ();
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (lma);
+  internet.Install (mag);
+
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (mag);
+
+  Ptr<SimpleChannel> backhaul = CreateObject<SimpleChannel> ();
+  Ptr<Node> nodes[2] = { lma, mag };
+  const char *addresses[2] = { "2001:2::1", "2001:2::2" };
+
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (backhaul);
+      nodes[i]->AddDevice (device);
+
+      Ptr<Ipv6> ipv6 = nodes[i]->GetObject<Ipv6> ();
+      uint32_t ifIndex = ipv6->AddInterface (device);
+      ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (Ipv6Address (addresses[i]), Ipv6Prefix (64)));
+      ipv6->SetForwarding (ifIndex, true);
+      ipv6->SetUp (ifIndex);
+    }
+
+  Ptr<Ipv6> ipv6 = mag->GetObject<Ipv6> ();
+  uint32_t accessIf = ipv6->AddInterface (access);
+  ipv6->SetForwarding (accessIf, true);
+  ipv6->SetUp (accessIf);
+
+  Pmip6ProfileHelper profile;
+  profile.AddProfile (Identifier ("mn@example.com"), Identifier (mn), Ipv6Address ("2001:2::1"), std::list<Ipv6Address> ());
+
+  Pmip6LmaHelper lmaHelper;
+  lmaHelper.SetProfileHelper (&profile);
+  lmaHelper.Install (lma);
+
+  /* the access devices must be on the MAG before its agent */
+  Pmip6MagHelper magHelper;
+  magHelper.SetProfileHelper (&profile);
+  magHelper.Install (mag);
+
+  m_magAgent = mag->GetObject<Pmipv6Mag> ();
+  m_lmaAgent = lma->GetObject<Pmipv6Lma> ();
+
+  m_magAgent->TraceConnectWithoutContext ("Attach", MakeCallback (&AccessAttachTestCase::Attach, this));
+  m_magAgent->TraceConnectWithoutContext ("Detach", MakeCallback (&AccessAttachTestCase::Detach, this));
+  m_magAgent->TraceConnectWithoutContext ("TxPbu", MakeCallback (&AccessAttachTestCase::TxPbu, this));
+}
+
+void
+AccessAttachTestCase::Attach (const Identifier &mnId, const Identifier &mnLinkId)
+{
+  m_nAttaches++;
+}
+
+void
+AccessAttachTestCase::Detach (const Identifier &mnId, const Identifier &mnLinkId)
+{
+  m_nDetaches++;
+}
+
+void
+AccessAttachTestCase::TxPbu (const Identifier &mnId, Ipv6Address lma, uint16_t lifetime)
+{
+  if (lifetime == 0)
+    {
+      m_nDeregistrations++;
+    }
+}
+
+/*
+ * An SS completing its initial ranging with the BS of the MAG.
+ */
+class WimaxAttachTestCase : public AccessAttachTestCase
+{
+public:
+  WimaxAttachTestCase ();
+  virtual void DoRun (void);
+};
+
+WimaxAttachTestCase::WimaxAttachTestCase ()
+  : AccessAttachTestCase ("Check MN attachment through a WiMAX BS")
+{
+}
+
+void
+WimaxAttachTestCase::DoRun (void)
+{
+  NodeContainer ssNodes;
+  NodeContainer bsNodes;
+
+  ssNodes.Create (1);
+  bsNodes.Create (1);
+
+  WimaxHelper wimax;
+  NetDeviceContainer ssDevs = wimax.Install (ssNodes,
+                                             WimaxHelper::DEVICE_TYPE_SUBSCRIBER_STATION,
+                                             WimaxHelper::SIMPLE_PHY_TYPE_OFDM,
+                                             WimaxHelper::SCHED_TYPE_SIMPLE);
+  NetDeviceContainer bsDevs = wimax.Install (bsNodes,
+                                             WimaxHelper::DEVICE_TYPE_BASE_STATION,
+                                             WimaxHelper::SIMPLE_PHY_TYPE_OFDM,
+                                             WimaxHelper::SCHED_TYPE_SIMPLE);
+
+  Mac48Address mn = Mac48Address::ConvertFrom (ssDevs.Get (0)->GetAddress ());
+
+  Setup (bsNodes.Get (0), bsDevs.Get (0), mn);
+
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (ssDevs.Get (0)->GetObject<SubscriberStationNetDevice> ()->IsRegistered (), true, "SS not registered");
+  NS_TEST_ASSERT_MSG_EQ (m_nAttaches, 1, "ranging of the SS not seen by the MAG");
+  NS_TEST_ASSERT_MSG_EQ (m_magAgent->GetNTunnelSetups (), 1, "MN not registered with the LMA");
+  NS_TEST_ASSERT_MSG_EQ (m_lmaAgent->GetNBceCreated (), 1, "no binding at the LMA");
+  NS_TEST_ASSERT_MSG_EQ (m_nDetaches, 0, "MN detached");
+
+  Simulator::Destroy ();
+}
+
+/*
+ * A UE registered to the eNB of the MAG, then removed from it.
+ */
+class LteAttachTestCase : public AccessAttachTestCase
+{
+public:
+  LteAttachTestCase ();
+  virtual void DoRun (void);
+};
+
+LteAttachTestCase::LteAttachTestCase ()
+  : AccessAttachTestCase ("Check MN attachment and detachment through an LTE eNB")
+{
+}
+
+void
+LteAttachTestCase::DoRun (void)
+{
+  NodeContainer ueNodes;
+  NodeContainer enbNodes;
+
+  ueNodes.Create (1);
+  enbNodes.Create (1);
+
+  LteHelper lte;
+  NetDeviceContainer ueDevs = lte.Install (ueNodes, LteHelper::DEVICE_TYPE_USER_EQUIPMENT);
+  NetDeviceContainer enbDevs = lte.Install (enbNodes, LteHelper::DEVICE_TYPE_ENODEB);
+
+  Ptr<EnbNetDevice> enb = enbDevs.Get (0)->GetObject<EnbNetDevice> ();
+  Ptr<UeNetDevice> ue = ueDevs.Get (0)->GetObject<UeNetDevice> ();
+
+  std::vector<int> dlSubChannels;
+  std::vector<int> ulSubChannels;
+
+  for (int i = 0; i < 25; i++)
+    {
+      dlSubChannels.push_back (i);
+      ulSubChannels.push_back (50 + i);
+    }
+
+  enb->GetPhy ()->SetDownlinkSubChannels (dlSubChannels);
+  enb->GetPhy ()->SetUplinkSubChannels (ulSubChannels);
+  ue->GetPhy ()->SetDownlinkSubChannels (dlSubChannels);
+  ue->GetPhy ()->SetUplinkSubChannels (ulSubChannels);
+
+  Ptr<ConstantPositionMobilityModel> enbMobility = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> ueMobility = CreateObject<ConstantPositionMobilityModel> ();
+  enbMobility->SetPosition (Vector (0.0, 0.0, 0.0));
+  ueMobility->SetPosition (Vector (30.0, 0.0, 0.0));
+  lte.AddMobility (enb->GetPhy (), enbMobility);
+  lte.AddMobility (ue->GetPhy (), ueMobility);
+  lte.AddDownlinkChannelRealization (enbMobility, ueMobility, ue->GetPhy ());
+
+  Setup (enbNodes.Get (0), enb, Mac48Address::ConvertFrom (ue->GetAddress ()));
+
+  /* the UE reports to its eNB from the first frame on, but is only
+   * registered later: a PBU sent at time zero has a zero timestamp,
+   * which the MAG takes for a missing option */
+  ue->SetTargetEnb (enb);
+  Simulator::Schedule (MilliSeconds (10), &UeManager::CreateUeRecord, enb->GetUeManager (), ue, enb);
+  Simulator::Schedule (Seconds (2.0), static_cast<void (UeManager::*) (Ptr<UeNetDevice>)> (&UeManager::DeleteUeRecord),
+                       enb->GetUeManager (), ue);
+
+  Simulator::Stop (Seconds (3.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_nAttaches, 1, "registration of the UE not seen by the MAG");
+  NS_TEST_ASSERT_MSG_EQ (m_magAgent->GetNTunnelSetups (), 1, "MN not registered with the LMA");
+  NS_TEST_ASSERT_MSG_EQ (m_lmaAgent->GetNBceCreated (), 1, "no binding at the LMA");
+  NS_TEST_ASSERT_MSG_EQ (m_nDetaches, 1, "removal of the UE not seen by the MAG");
+  NS_TEST_ASSERT_MSG_EQ (m_magAgent->GetNDetaches (), 1, "MAG detaches miscounted");
+  NS_TEST_ASSERT_MSG_EQ (m_nDeregistrations, 1, "MN not deregistered on detachment");
+  NS_TEST_ASSERT_MSG_EQ (m_magAgent->GetNPbaRejected (), 0, "deregistration rejected");
+
+  Simulator::Destroy ();
+}
+
+/*
+ * The access devices cannot depend on PMIPv6, they keep their own copy of
+ * their access technology type.
+ */
+class AccessTechnologyTypeTestCase : public TestCase
+{
+public:
+  AccessTechnologyTypeTestCase ();
+  virtual void DoRun (void);
+};
+
+AccessTechnologyTypeTestCase::AccessTechnologyTypeTestCase ()
+  : TestCase ("Check the access technology types of the access devices")
+{
+}
+
+void
+AccessTechnologyTypeTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)RegularWifiMac::ACCESS_TECHNOLOGY_TYPE, (uint32_t)Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG, "wifi AP");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)BaseStationNetDevice::ACCESS_TECHNOLOGY_TYPE, (uint32_t)Ipv6MobilityHeader::OPT_ATT_IEEE_802_16E, "WiMAX BS");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)EnbNetDevice::ACCESS_TECHNOLOGY_TYPE, (uint32_t)Ipv6MobilityHeader::OPT_ATT_3GPP_EUTRAN, "LTE eNB");
+}
+
+static class AccessAttachTestSuite : public TestSuite
+{
+public:
+  AccessAttachTestSuite ()
+    : TestSuite ("pmip6-access-attach", UNIT)
+  {
+    AddTestCase (new AccessTechnologyTypeTestCase ());
+    AddTestCase (new WimaxAttachTestCase ());
+    AddTestCase (new LteAttachTestCase ());
+  }
+} g_accessAttachTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,140 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/binding-cache.h"
+
+namespace ns3 {
+
+class BindingCacheIndexTestCase : public TestCase
+{
+public:
+  BindingCacheIndexTestCase ();
+  virtual void DoRun (void);
+};
+
+BindingCacheIndexTestCase::BindingCacheIndexTestCase ()
+  : TestCase ("Check binding cache secondary indexes")
+{
+}
+
+void
+BindingCacheIndexTestCase::DoRun (void)
+{
+  Ptr<BindingCache> bc = CreateObject<BindingCache> ();
+  Identifier mnId ("mn1@pmip6");
+  Ipv6Address mag1 ("2001:db8::1");
+  Ipv6Address mag2 ("2001:db8::2");
+  std::list<Ipv6Address> hnps1;
+  std::list<Ipv6Address> hnps2;
+
+  hnps1.push_back (Ipv6Address ("3ffe:1:4:1::"));
+  hnps2.push_back (Ipv6Address ("3ffe:1:4:2::"));
+  hnps2.push_back (Ipv6Address ("3ffe:1:4:3::"));
+
+  BindingCache::Entry *e1 = bc->Add (mnId);
+  e1->SetProxyCoa (mag1);
+  e1->SetHomeNetworkPrefixes (hnps1);
+
+  BindingCache::Entry *e2 = bc->Add (mnId);
+  e2->SetProxyCoa (mag1);
+  e2->SetHomeNetworkPrefixes (hnps2);
+
+  NS_TEST_ASSERT_MSG_EQ (bc->GetNEntries (), 2, "Two entries expected");
+  NS_TEST_ASSERT_MSG_EQ (bc->LookupByHomeNetworkPrefix (Ipv6Address ("3ffe:1:4:3::")), e2, "HNP index mismatch");
+  NS_TEST_ASSERT_MSG_EQ (bc->LookupByProxyCoa (mag1).size (), 2, "Proxy-CoA index mismatch");
+
+  bool allMatched = false;
+  NS_TEST_ASSERT_MSG_EQ (bc->Lookup (mnId, hnps2, allMatched), e2, "Lookup by HNP list failed");
+  NS_TEST_ASSERT_MSG_EQ (allMatched, true, "All prefixes should match");
+
+  std::list<Ipv6Address> partial;
+  partial.push_back (Ipv6Address ("3ffe:1:4:2::"));
+  partial.push_back (Ipv6Address ("3ffe:1:4:9::"));
+  NS_TEST_ASSERT_MSG_EQ (bc->Lookup (mnId, partial, allMatched), e2, "Partial lookup failed");
+  NS_TEST_ASSERT_MSG_EQ (allMatched, false, "Prefix set should only partially match");
+
+  NS_TEST_ASSERT_MSG_EQ (bc->Lookup (Identifier ("mn2@pmip6"), hnps1, allMatched), 0, "Foreign MN matched");
+
+  //moving to another MAG updates the Proxy-CoA index
+  e1->SetProxyCoa (mag2);
+  NS_TEST_ASSERT_MSG_EQ (bc->LookupByProxyCoa (mag1).size (), 1, "Stale Proxy-CoA index");
+  NS_TEST_ASSERT_MSG_EQ (bc->LookupByProxyCoa (mag2).front (), e1, "Proxy-CoA index not updated");
+
+  bc->Flush ();
+  NS_TEST_ASSERT_MSG_EQ (bc->GetNEntries (), 0, "Flush left entries");
+  NS_TEST_ASSERT_MSG_EQ (bc->LookupByHomeNetworkPrefix (Ipv6Address ("3ffe:1:4:1::")), 0, "Flush left HNP index");
+}
+
+class BindingCacheRemoveTestCase : public TestCase
+{
+public:
+  BindingCacheRemoveTestCase ();
+  virtual void DoRun (void);
+};
+
+BindingCacheRemoveTestCase::BindingCacheRemoveTestCase ()
+  : TestCase ("Check binding cache removal inside a per-MN chain")
+{
+}
+
+void
+BindingCacheRemoveTestCase::DoRun (void)
+{
+  Ptr<BindingCache> bc = CreateObject<BindingCache> ();
+  Identifier mnId ("mn1@pmip6");
+  BindingCache::Entry *entries[3];
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      uint8_t buf[16] = { 0x3f, 0xfe, 0x00, 0x01, 0x00, 0x04, 0x00, (uint8_t)(i + 1) };
+      std::list<Ipv6Address> hnps;
+
+      hnps.push_back (Ipv6Address (buf));
+      entries[i] = bc->Add (mnId);
+      entries[i]->SetProxyCoa (Ipv6Address ("2001:db8::1"));
+      entries[i]->SetHomeNetworkPrefixes (hnps);
+    }
+
+  //chain is entries[2] -> entries[1] -> entries[0]
+  bc->Remove (entries[1]);
+  NS_TEST_ASSERT_MSG_EQ (bc->GetNEntries (), 2, "Middle entry not removed");
+  NS_TEST_ASSERT_MSG_EQ (bc->Lookup (mnId), entries[2], "Chain head changed");
+  NS_TEST_ASSERT_MSG_EQ (entries[2]->GetNext (), entries[0], "Chain not relinked");
+  NS_TEST_ASSERT_MSG_EQ (entries[0]->GetPrev (), entries[2], "Chain not relinked");
+
+  bc->Remove (entries[2]);
+  NS_TEST_ASSERT_MSG_EQ (bc->Lookup (mnId), entries[0], "Head removal dropped the chain");
+
+  bc->Remove (entries[0]);
+  NS_TEST_ASSERT_MSG_EQ (bc->Lookup (mnId), 0, "Empty chain still indexed");
+  NS_TEST_ASSERT_MSG_EQ (bc->LookupByProxyCoa (Ipv6Address ("2001:db8::1")).size (), 0, "Proxy-CoA index not cleared");
+}
+
+static class BindingCacheTestSuite : public TestSuite
+{
+public:
+  BindingCacheTestSuite ()
+    : TestSuite ("pmip6-binding-cache", UNIT)
+  {
+    AddTestCase (new BindingCacheIndexTestCase ());
+    AddTestCase (new BindingCacheRemoveTestCase ());
+  }
+} g_bindingCacheTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,174 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/binding-timer-wheel.h"
+
+#include <vector>
+
+namespace ns3 {
+
+class BindingTimerWheelTestCase : public TestCase
+{
+public:
+  BindingTimerWheelTestCase ();
+  virtual void DoRun (void);
+
+private:
+  struct Probe
+  {
+    void Fire ()
+    {
+      m_fired = Simulator::Now ();
+    }
+
+    BindingTimer m_timer;
+    Time m_expected;
+    Time m_fired;
+  };
+
+  void Rearm (Probe *probe, Time delay);
+};
+
+BindingTimerWheelTestCase::BindingTimerWheelTestCase ()
+  : TestCase ("Check binding timer wheel expirations")
+{
+}
+
+void
+BindingTimerWheelTestCase::Rearm (Probe *probe, Time delay)
+{
+  //refresh-like Stop/Start of a pending timer
+  probe->m_timer.Cancel ();
+  probe->m_timer.SetDelay (delay);
+  probe->m_timer.Schedule ();
+  probe->m_expected = Simulator::Now () + delay;
+}
+
+void
+BindingTimerWheelTestCase::DoRun (void)
+{
+  const uint32_t nProbes = 6;
+  Ptr<BindingTimerWheel> wheel = CreateObject<BindingTimerWheel> ();
+  Time granularity = MilliSeconds (10);
+
+  //root slots, each upper level and a cancelled timer
+  double delays[nProbes] = { 1.0, 0.001, 2.555, 180.0, 7200.0, 5.0 };
+  Probe probes[nProbes];
+
+  wheel->SetGranularity (granularity);
+
+  for (uint32_t i = 0; i < nProbes; i++)
+    {
+      probes[i].m_timer.SetWheel (wheel);
+      probes[i].m_timer.SetFunction (&Probe::Fire, &probes[i]);
+      probes[i].m_timer.SetDelay (Seconds (delays[i]));
+      probes[i].m_timer.Schedule ();
+      probes[i].m_expected = Seconds (delays[i]);
+      probes[i].m_fired = Seconds (-1.0);
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (wheel->GetNTimers (), nProbes, "Timers not linked in the wheel");
+
+  Simulator::Schedule (Seconds (0.5), &BindingTimerWheelTestCase::Rearm, this, &probes[0], Seconds (3.0));
+  Simulator::Schedule (Seconds (4.0), &BindingTimer::Cancel, &probes[5].m_timer);
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < nProbes - 1; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((probes[i].m_fired >= probes[i].m_expected), true, "Timer " << i << " fired early");
+      NS_TEST_EXPECT_MSG_EQ ((probes[i].m_fired <= probes[i].m_expected + granularity), true, "Timer " << i << " fired late");
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (probes[nProbes - 1].m_fired, Seconds (-1.0), "Cancelled timer fired");
+  NS_TEST_ASSERT_MSG_EQ (wheel->GetNTimers (), 0, "Timers left in the wheel");
+
+  Simulator::Destroy ();
+}
+
+class BindingTimerWheelRearmTestCase : public TestCase
+{
+public:
+  BindingTimerWheelRearmTestCase ();
+  virtual void DoRun (void);
+
+private:
+  void Fire (void);
+
+  BindingTimer m_timer;
+  Time m_delay;
+  std::vector<Time> m_fired;
+};
+
+BindingTimerWheelRearmTestCase::BindingTimerWheelRearmTestCase ()
+  : TestCase ("Check timers re-armed by their handler")
+{
+}
+
+void
+BindingTimerWheelRearmTestCase::Fire (void)
+{
+  m_fired.push_back (Simulator::Now ());
+  if (m_fired.size () < 4)
+    {
+      m_timer.SetDelay (m_delay);
+      m_timer.Schedule ();
+    }
+}
+
+void
+BindingTimerWheelRearmTestCase::DoRun (void)
+{
+  Ptr<BindingTimerWheel> wheel = CreateObject<BindingTimerWheel> ();
+  Time granularity = MilliSeconds (10);
+
+  //rounded up to 256 ticks: one full turn of the root level
+  m_delay = MilliSeconds (2555);
+  wheel->SetGranularity (granularity);
+  m_timer.SetWheel (wheel);
+  m_timer.SetFunction (&BindingTimerWheelRearmTestCase::Fire, this);
+  m_timer.SetDelay (m_delay);
+  m_timer.Schedule ();
+
+  Simulator::Stop (Seconds (20.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_fired.size (), 4, "Re-armed timer did not fire once per period");
+  for (uint32_t i = 1; i < m_fired.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((m_fired[i] - m_fired[i - 1] >= m_delay), true, "Re-armed timer " << i << " fired early");
+      NS_TEST_EXPECT_MSG_EQ ((m_fired[i] - m_fired[i - 1] <= m_delay + granularity), true, "Re-armed timer " << i << " fired late");
+    }
+  NS_TEST_ASSERT_MSG_EQ (wheel->GetNTimers (), 0, "Timers left in the wheel");
+
+  Simulator::Destroy ();
+}
+
+static class BindingTimerWheelTestSuite : public TestSuite
+{
+public:
+  BindingTimerWheelTestSuite ()
+    : TestSuite ("pmip6-binding-timer-wheel", UNIT)
+  {
+    AddTestCase (new BindingTimerWheelTestCase ());
+    AddTestCase (new BindingTimerWheelRearmTestCase ());
+  }
+} g_bindingTimerWheelTestSuite;
+
+} // namespace ns3
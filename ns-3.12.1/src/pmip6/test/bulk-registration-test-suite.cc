@@ -0,0 +1,440 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/identifier.h"
+#include "ns3/ipv6-mobility-header.h"
+#include "ns3/ipv6-mobility-option-header.h"
+#include "ns3/ipv6-mobility-l4-protocol.h"
+#include "ns3/pmipv6-agent.h"
+#include "ns3/pmipv6-lma.h"
+#include "ns3/pmipv6-mag.h"
+#include "ns3/pmipv6-mag-notifier.h"
+#include "ns3/pmip6-helper.h"
+
+#include "pmip6-test-helper.h"
+
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * LMA -- MAG -- (MNs)
+ *
+ * A crowd of MNs attaches to the MAG at once. Each attach is notified
+ * as from a remote AP and triggers a PBU, which the MAG may bulk.
+ */
+class BulkRegistrationTestCase : public TestCase
+{
+public:
+  BulkRegistrationTestCase ();
+  virtual void DoRun (void);
+
+protected:
+  BulkRegistrationTestCase (std::string name, uint32_t nMns);
+  void Run (Time bulkWindow);
+
+  uint32_t m_nMns;
+  uint32_t m_magTxMessages;
+  uint32_t m_magTxPackets;
+  uint32_t m_magRxMessages;
+  uint32_t m_magRxPackets;
+  uint32_t m_lmaRxMessages;
+  uint32_t m_lmaRxPackets;
+  uint32_t m_lmaTxPackets;
+  uint64_t m_events;
+  int64_t m_ms;
+};
+
+BulkRegistrationTestCase::BulkRegistrationTestCase ()
+  : TestCase ("Check bulked PBU and PBA signaling during a mass attach"),
+    m_nMns (100)
+{
+}
+
+BulkRegistrationTestCase::BulkRegistrationTestCase (std::string name, uint32_t nMns)
+  : TestCase (name),
+    m_nMns (nMns)
+{
+}
+
+void
+BulkRegistrationTestCase::Run (Time bulkWindow)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<Node> lma = nodes.Get (0);
+  Ptr<Node> mag = nodes.Get (1);
+
+  InstallIpv6Stack (nodes, mag);
+
+  Ptr<SimpleChannel> backhaul = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> access = CreateObject<SimpleChannel> ();
+
+  AddSimpleLink (lma, backhaul, "2001:2::1");
+  AddSimpleLink (mag, backhaul, "2001:2::2");
+  uint32_t accessIf = AddSimpleLink (mag, access, "2001:3::1");
+
+  Pmip6ProfileHelper profile;
+  std::list<Ipv6Address> hnps;
+  std::list<Mac48Address> mns;
+
+  for (uint32_t i = 0; i < m_nMns; i++)
+    {
+      char nai[32];
+      Mac48Address mn = Mac48Address::Allocate ();
+
+      sprintf (nai, "mn%u@example.com", i);
+      profile.AddProfile (Identifier (nai), Identifier (mn), Ipv6Address ("2001:2::1"), hnps);
+      mns.push_back (mn);
+    }
+
+  Pmip6LmaHelper lmaHelper;
+  lmaHelper.SetProfileHelper (&profile);
+  lmaHelper.Install (lma);
+
+  Pmip6MagHelper magHelper;
+  magHelper.SetProfileHelper (&profile);
+  magHelper.Install (mag, Ipv6Address ("2001:2::2"), NodeContainer ());
+
+  Ptr<Pmipv6Mag> magAgent = mag->GetObject<Pmipv6Mag> ();
+  Ptr<Pmipv6Lma> lmaAgent = lma->GetObject<Pmipv6Lma> ();
+  magAgent->SetAttribute ("BulkWindow", TimeValue (bulkWindow));
+
+  Ptr<Pmipv6MagNotifier> notifier = mag->GetObject<Pmipv6MagNotifier> ();
+  Ptr<Ipv6Interface> interface = mag->GetObject<Ipv6L3Protocol> ()->GetInterface (accessIf);
+  Time at = Seconds (2.0);
+
+  for (std::list<Mac48Address>::iterator i = mns.begin (); i != mns.end (); i++)
+    {
+      Simulator::Schedule (at, &NotifyMagAttach, notifier, interface, (*i),
+                           (uint8_t) Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+      at += MicroSeconds (100);
+    }
+
+  SystemWallClockMs clock;
+  uint64_t firstUid = GetEventUid ();
+
+  clock.Start ();
+  Simulator::Stop (Seconds (5.0));
+  Simulator::Run ();
+  m_ms = clock.End ();
+  m_events = GetEventUid () - firstUid;
+
+  m_magTxMessages = magAgent->GetTxMessages ();
+  m_magTxPackets = magAgent->GetTxPackets ();
+  m_magRxMessages = magAgent->GetRxMessages ();
+  m_magRxPackets = magAgent->GetRxPackets ();
+  m_lmaRxMessages = lmaAgent->GetRxMessages ();
+  m_lmaRxPackets = lmaAgent->GetRxPackets ();
+  m_lmaTxPackets = lmaAgent->GetTxPackets ();
+
+  Simulator::Destroy ();
+}
+
+void
+BulkRegistrationTestCase::DoRun (void)
+{
+  Run (Seconds (0));
+
+  NS_TEST_ASSERT_MSG_EQ (m_magTxMessages, m_nMns, "one PBU per MN");
+  NS_TEST_ASSERT_MSG_EQ (m_magTxPackets, m_nMns, "unbulked PBUs go out one per packet");
+  NS_TEST_ASSERT_MSG_EQ (m_lmaRxPackets, m_nMns, "LMA receives one packet per PBU");
+  NS_TEST_ASSERT_MSG_EQ (m_lmaTxPackets, m_nMns, "LMA answers each PBU on its own");
+  NS_TEST_ASSERT_MSG_EQ (m_magRxMessages, m_nMns, "one PBA per MN");
+
+  uint64_t events = m_events;
+
+  Run (MilliSeconds (20));
+
+  NS_TEST_ASSERT_MSG_EQ (m_magTxMessages, m_nMns, "one PBU per MN, no retransmission");
+  NS_TEST_ASSERT_MSG_EQ ((m_magTxPackets < m_nMns / 4), true, "PBUs are not bulked");
+  NS_TEST_ASSERT_MSG_EQ (m_lmaRxMessages, m_nMns, "LMA misses bulked PBUs");
+  NS_TEST_ASSERT_MSG_EQ (m_lmaRxPackets, m_magTxPackets, "LMA receives one packet per bulk");
+  NS_TEST_ASSERT_MSG_EQ (m_lmaTxPackets, m_lmaRxPackets, "LMA does not answer a bulk with one bulk");
+  NS_TEST_ASSERT_MSG_EQ (m_magRxMessages, m_nMns, "MAG misses bulked PBAs");
+  NS_TEST_ASSERT_MSG_EQ (m_magRxPackets, m_lmaTxPackets, "MAG receives one packet per bulk");
+  NS_TEST_ASSERT_MSG_EQ ((m_events < events), true, "bulking does not save events");
+}
+
+class BulkRegistrationCostTestCase : public BulkRegistrationTestCase
+{
+public:
+  BulkRegistrationCostTestCase ();
+  virtual void DoRun (void);
+};
+
+BulkRegistrationCostTestCase::BulkRegistrationCostTestCase ()
+  : BulkRegistrationTestCase ("Measure the signaling cost of a mass attach with and without bulking", 1000)
+{
+}
+
+void
+BulkRegistrationCostTestCase::DoRun (void)
+{
+  Run (Seconds (0));
+
+  uint32_t packets = m_magTxPackets + m_lmaTxPackets;
+  uint64_t events = m_events;
+  int64_t ms = m_ms;
+
+  Run (MilliSeconds (20));
+
+  std::cout << "registration of " << m_nMns << " MNs: unbulked " << packets << " packets, "
+            << events << " events, " << ms << " ms; bulked " << m_magTxPackets + m_lmaTxPackets
+            << " packets, " << m_events << " events, " << m_ms << " ms" << std::endl;
+
+  NS_TEST_ASSERT_MSG_EQ (m_lmaRxMessages, m_nMns, "LMA misses bulked PBUs");
+  NS_TEST_ASSERT_MSG_EQ (m_magRxMessages, m_nMns, "MAG misses bulked PBAs");
+}
+
+/*
+ * A bulk packet is PMIPv6 messages back to back. Each one is handled on
+ * its own type, whatever the type of the first one.
+ */
+class BulkFramingTestCase : public TestCase
+{
+public:
+  BulkFramingTestCase ();
+  virtual void DoRun (void);
+
+private:
+  class Agent : public Pmipv6Agent
+  {
+public:
+    std::vector<uint8_t> m_types;
+    std::vector<uint32_t> m_sizes;
+
+protected:
+    virtual uint8_t HandlePbu (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface)
+    {
+      return Handle (Ipv6MobilityHeader::IPV6_MOBILITY_BINDING_UPDATE, packet);
+    }
+    virtual uint8_t HandlePba (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface)
+    {
+      return Handle (Ipv6MobilityHeader::IPV6_MOBILITY_BINDING_ACKNOWLEDGEMENT, packet);
+    }
+    virtual uint8_t HandleHi (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface)
+    {
+      return Handle (Ipv6MobilityHeader::IPV6_MOBILITY_HANDOVER_INITIATE, packet);
+    }
+    virtual uint8_t HandleHack (Ptr<Packet> packet, const Ipv6Address &src, const Ipv6Address &dst, Ptr<Ipv6Interface> interface)
+    {
+      return Handle (Ipv6MobilityHeader::IPV6_MOBILITY_HANDOVER_ACKNOWLEDGE, packet);
+    }
+
+private:
+    uint8_t Handle (uint8_t type, Ptr<Packet> packet)
+    {
+      m_types.push_back (type);
+      m_sizes.push_back (packet->GetSize ());
+      return 0;
+    }
+  };
+};
+
+BulkFramingTestCase::BulkFramingTestCase ()
+  : TestCase ("Check every message of a bulk packet is dispatched on its own type")
+{
+}
+
+void
+BulkFramingTestCase::DoRun (void)
+{
+  Ipv6MobilityBindingAckHeader pba;
+  Ipv6MobilityHandoverInitiateHeader hi;
+  Ipv6MobilityHandoverAckHeader hack;
+  Ipv6MobilityBindingUpdateHeader pbu;
+  Ipv6MobilityOptionMobileNodeIdentifierHeader mnid;
+
+  pba.SetFlagP (true);
+  pbu.SetFlagP (true);
+  mnid.SetSubtype (1);
+  mnid.SetNodeIdentifier (Identifier ("mn@example.com"));
+  pbu.AddOption (mnid);
+
+  Ptr<Packet> bulk = Create<Packet> ();
+  bulk->AddHeader (pbu);
+  bulk->AddHeader (hack);
+  bulk->AddHeader (hi);
+  bulk->AddHeader (pba);
+
+  /* a truncated message at the end is dropped */
+  Ptr<Packet> trailer = Create<Packet> ();
+  trailer->AddHeader (hack);
+  bulk->AddAtEnd (trailer->CreateFragment (0, trailer->GetSize () - 8));
+
+  Ptr<Agent> agent = CreateObject<Agent> ();
+  agent->Receive (bulk, Ipv6Address ("2001:2::2"), Ipv6Address ("2001:2::1"), 0);
+
+  NS_TEST_ASSERT_MSG_EQ (agent->m_types.size (), 4, "messages of a bulk packet missed");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)agent->m_types[0], (uint32_t)Ipv6MobilityHeader::IPV6_MOBILITY_BINDING_ACKNOWLEDGEMENT, "first message");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)agent->m_types[1], (uint32_t)Ipv6MobilityHeader::IPV6_MOBILITY_HANDOVER_INITIATE, "second message");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)agent->m_types[2], (uint32_t)Ipv6MobilityHeader::IPV6_MOBILITY_HANDOVER_ACKNOWLEDGE, "third message");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)agent->m_types[3], (uint32_t)Ipv6MobilityHeader::IPV6_MOBILITY_BINDING_UPDATE, "fourth message");
+  NS_TEST_ASSERT_MSG_EQ (agent->m_sizes[0], pba.GetSerializedSize (), "PBA not delimited by its length");
+  NS_TEST_ASSERT_MSG_EQ (agent->m_sizes[3], pbu.GetSerializedSize (), "PBU not delimited by its length");
+  NS_TEST_ASSERT_MSG_EQ (agent->GetRxMessages (), 4, "truncated message counted");
+  NS_TEST_ASSERT_MSG_EQ (agent->GetRxPackets (), 1, "one bulk packet");
+
+  agent->Dispose ();
+}
+
+/*
+ * LMA -- MAG, the LMA node without LMA agent so no PBA comes back. The
+ * retransmission timer of a PBU held in the bulk window starts when the
+ * PBU leaves. The window is bounded.
+ */
+class BulkRetransmissionTestCase : public TestCase
+{
+public:
+  BulkRetransmissionTestCase ();
+  virtual void DoRun (void);
+
+private:
+  void TxPbu (const Identifier &mnId, Ipv6Address lma, uint16_t lifetime);
+  void RetransmitPbu (const Identifier &mnId, uint8_t retry);
+
+  Time m_txTime;
+  std::vector<Time> m_retransmitTimes;
+};
+
+BulkRetransmissionTestCase::BulkRetransmissionTestCase ()
+  : TestCase ("Check the PBU retransmission timer starts when a bulked PBU is sent")
+{
+}
+
+void
+BulkRetransmissionTestCase::TxPbu (const Identifier &mnId, Ipv6Address lma, uint16_t lifetime)
+{
+  m_txTime = Simulator::Now ();
+}
+
+void
+BulkRetransmissionTestCase::RetransmitPbu (const Identifier &mnId, uint8_t retry)
+{
+  m_retransmitTimes.push_back (Simulator::Now ());
+}
+
+void
+BulkRetransmissionTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<Node> lma = nodes.Get (0);
+  Ptr<Node> mag = nodes.Get (1);
+
+  InstallIpv6Stack (nodes, mag);
+
+  Ptr<SimpleChannel> backhaul = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> access = CreateObject<SimpleChannel> ();
+
+  Ptr<SimpleNetDevice> devices[3];
+  Ptr<Node> owners[3] = { lma, mag, mag };
+  Ptr<SimpleChannel> channels[3] = { backhaul, backhaul, access };
+  const char *addresses[3] = { "2001:2::1", "2001:2::2", "2001:3::1" };
+  uint32_t ifIndex = 0;
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      devices[i] = CreateObject<SimpleNetDevice> ();
+      devices[i]->SetAddress (Mac48Address::Allocate ());
+      devices[i]->SetChannel (channels[i]);
+      owners[i]->AddDevice (devices[i]);
+
+      Ptr<Ipv6> ipv6 = owners[i]->GetObject<Ipv6> ();
+      ifIndex = ipv6->AddInterface (devices[i]);
+      ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (Ipv6Address (addresses[i]), Ipv6Prefix (64)));
+      ipv6->SetForwarding (ifIndex, true);
+      ipv6->SetUp (ifIndex);
+    }
+
+  Pmip6ProfileHelper profile;
+  Mac48Address mn = Mac48Address::Allocate ();
+  profile.AddProfile (Identifier ("mn@example.com"), Identifier (mn), Ipv6Address ("2001:2::1"), std::list<Ipv6Address> ());
+
+  Pmip6MagHelper magHelper;
+  magHelper.SetProfileHelper (&profile);
+  magHelper.Install (mag, Ipv6Address ("2001:2::2"), NodeContainer ());
+
+  Ptr<Pmipv6Mag> magAgent = mag->GetObject<Pmipv6Mag> ();
+
+  magAgent->SetAttribute ("BulkWindow", TimeValue (Seconds (10)));
+  NS_TEST_ASSERT_MSG_EQ (magAgent->GetBulkWindow (), Seconds (Ipv6MobilityL4Protocol::INITIAL_BINDING_ACK_TIMEOUT_FIRSTREG), "bulk window not bounded");
+
+  magAgent->SetAttribute ("BulkWindow", TimeValue (Seconds (1)));
+  magAgent->TraceConnectWithoutContext ("TxPbu", MakeCallback (&BulkRetransmissionTestCase::TxPbu, this));
+  magAgent->TraceConnectWithoutContext ("RetransmitPbu", MakeCallback (&BulkRetransmissionTestCase::RetransmitPbu, this));
+
+  Ptr<Packet> packet = Create<Packet> ();
+  Pmipv6MagNotifyHeader header;
+  header.SetMacAddress (mn);
+  header.SetAccessTechnologyType (Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+  packet->AddHeader (header);
+
+  Ptr<Ipv6Interface> interface = mag->GetObject<Ipv6L3Protocol> ()->GetInterface (ifIndex);
+  Simulator::Schedule (Seconds (2.0), &Pmipv6MagNotifier::Receive, mag->GetObject<Pmipv6MagNotifier> (),
+                       packet, Ipv6Address::GetAny (), Ipv6Address::GetAny (), interface);
+
+  Simulator::Stop (Seconds (6.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  /* queued at 2s, sent at 3s, first retransmission queued at 4.5s */
+  NS_TEST_ASSERT_MSG_EQ (m_txTime, Seconds (2.0), "PBU not queued at attach");
+  NS_TEST_ASSERT_MSG_EQ (m_retransmitTimes.empty (), false, "PBU not retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (m_retransmitTimes[0], Seconds (3.0 + Ipv6MobilityL4Protocol::INITIAL_BINDING_ACK_TIMEOUT_FIRSTREG),
+                         "retransmission timer not started at send time");
+}
+
+static class BulkRegistrationTestSuite : public TestSuite
+{
+public:
+  BulkRegistrationTestSuite ()
+    : TestSuite ("pmip6-bulk-registration", UNIT)
+  {
+    AddTestCase (new BulkRegistrationTestCase ());
+    AddTestCase (new BulkFramingTestCase ());
+    AddTestCase (new BulkRetransmissionTestCase ());
+  }
+} g_bulkRegistrationTestSuite;
+
+static class BulkRegistrationPerfTestSuite : public TestSuite
+{
+public:
+  BulkRegistrationPerfTestSuite ()
+    : TestSuite ("pmip6-bulk-registration-perf", PERFORMANCE)
+  {
+    AddTestCase (new BulkRegistrationCostTestCase ());
+  }
+} g_bulkRegistrationPerfTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,297 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/ipv6-static-routing.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/udp-header.h"
+#include "ns3/identifier.h"
+#include "ns3/ipv6-mobility-header.h"
+#include "ns3/pmipv6-lma.h"
+#include "ns3/pmipv6-mag.h"
+#include "ns3/pmipv6-mag-notifier.h"
+#include "ns3/pmip6-helper.h"
+
+#include "pmip6-test-helper.h"
+
+namespace ns3 {
+
+/*
+ * CN -- LMA -- R -- MAG1 -- (MN)
+ *                \-- MAG2
+ *
+ * MAG1 hands the MN over to MAG2 ahead of its move. MAG2 registers the MN
+ * with the LMA and holds the downlink packets until the MN attaches, or
+ * gives the binding back to MAG1 if it never does.
+ */
+class FastHandoverTestCase : public TestCase
+{
+public:
+  FastHandoverTestCase (bool attach);
+  virtual void DoRun (void);
+
+private:
+  void SendPacket (Ptr<Ipv6L3Protocol> ipv6, Ipv6Address src, Ipv6Address dst, uint32_t count);
+  void InitiateHandover (Ptr<Pmipv6Mag> mag, Mac48Address mn, Mac48Address ap);
+  void Tx (std::string context, Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface);
+  void TxPbu (const Identifier &mnId, Ipv6Address lma, uint16_t lifetime);
+  void RxHack (const Identifier &mnId, uint8_t code);
+
+  bool m_attach;
+  bool m_initiated;
+  uint32_t m_nPackets;
+  uint32_t m_mag1Delivered;
+  uint32_t m_mag2Delivered;
+  Time m_firstMag2Delivery;
+  uint32_t m_mag1AccessIf;
+  uint32_t m_mag2AccessIf;
+  uint32_t m_txPbu;
+  uint32_t m_hackAccepted;
+  uint32_t m_hackRefused;
+};
+
+FastHandoverTestCase::FastHandoverTestCase (bool attach)
+  : TestCase (attach ? "Check the pre-registration and held packets of a predicted handover"
+                     : "Check the withdrawal of a pre-registration the MN does not follow"),
+    m_attach (attach),
+    m_initiated (false),
+    m_nPackets (10),
+    m_mag1Delivered (0),
+    m_mag2Delivered (0),
+    m_mag1AccessIf (0),
+    m_mag2AccessIf (0),
+    m_txPbu (0),
+    m_hackAccepted (0),
+    m_hackRefused (0)
+{
+}
+
+void
+FastHandoverTestCase::SendPacket (Ptr<Ipv6L3Protocol> ipv6, Ipv6Address src, Ipv6Address dst, uint32_t count)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  UdpHeader udp;
+  udp.SetSourcePort (9);
+  udp.SetDestinationPort (9);
+  packet->AddHeader (udp);
+  ipv6->Send (packet, src, dst, 17, 0);
+
+  if (count > 1)
+    {
+      Simulator::Schedule (MilliSeconds (10), &FastHandoverTestCase::SendPacket, this, ipv6, src, dst, count - 1);
+    }
+}
+
+void
+FastHandoverTestCase::InitiateHandover (Ptr<Pmipv6Mag> mag, Mac48Address mn, Mac48Address ap)
+{
+  m_initiated = mag->InitiateHandover (mn, ap);
+}
+
+void
+FastHandoverTestCase::Tx (std::string context, Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  Ipv6Header header;
+  packet->PeekHeader (header);
+
+  if (header.GetNextHeader () != 17)
+    {
+      return;
+    }
+
+  if (context == "mag1" && interface == m_mag1AccessIf)
+    {
+      m_mag1Delivered++;
+    }
+  else if (context == "mag2" && interface == m_mag2AccessIf)
+    {
+      if (m_mag2Delivered++ == 0)
+        {
+          m_firstMag2Delivery = Simulator::Now ();
+        }
+    }
+}
+
+void
+FastHandoverTestCase::TxPbu (const Identifier &mnId, Ipv6Address lma, uint16_t lifetime)
+{
+  m_txPbu++;
+}
+
+void
+FastHandoverTestCase::RxHack (const Identifier &mnId, uint8_t code)
+{
+  if (code == Ipv6MobilityHeader::HACK_CODE_HANDOVER_ACCEPTED)
+    {
+      m_hackAccepted++;
+    }
+  else
+    {
+      m_hackRefused++;
+    }
+}
+
+void
+FastHandoverTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+  Ptr<Node> cn = nodes.Get (0);
+  Ptr<Node> lma = nodes.Get (1);
+  Ptr<Node> router = nodes.Get (2);
+  Ptr<Node> mag1 = nodes.Get (3);
+  Ptr<Node> mag2 = nodes.Get (4);
+
+  InstallIpv6Stack (nodes, NodeContainer (mag1, mag2));
+
+  /* a simple channel hands every frame to all its devices, keep the links point to point */
+  Ptr<SimpleChannel> core = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> backhaul = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> backhaul1 = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> backhaul2 = CreateObject<SimpleChannel> ();
+
+  uint32_t cnIf = AddSimpleLink (cn, core, "2001:1::1");
+  AddSimpleLink (lma, core, "2001:1::2");
+  uint32_t lmaIf = AddSimpleLink (lma, backhaul, "2001:2::1");
+  AddSimpleLink (router, backhaul, "2001:2::2");
+  AddSimpleLink (router, backhaul1, "2001:6::1");
+  AddSimpleLink (router, backhaul2, "2001:7::1");
+  uint32_t mag1If = AddSimpleLink (mag1, backhaul1, "2001:6::2");
+  uint32_t mag2If = AddSimpleLink (mag2, backhaul2, "2001:7::2");
+  m_mag1AccessIf = AddSimpleLink (mag1, CreateObject<SimpleChannel> (), "2001:3::1");
+  m_mag2AccessIf = AddSimpleLink (mag2, CreateObject<SimpleChannel> (), "2001:4::1");
+
+  Ipv6StaticRoutingHelper routingHelper;
+  routingHelper.GetStaticRouting (cn->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("2001:1::2"), cnIf);
+  routingHelper.GetStaticRouting (lma->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("2001:2::2"), lmaIf);
+  routingHelper.GetStaticRouting (mag1->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("2001:6::1"), mag1If);
+  routingHelper.GetStaticRouting (mag2->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("2001:7::1"), mag2If);
+
+  Mac48Address mn = Mac48Address::Allocate ();
+  Pmip6ProfileHelper profile;
+  std::list<Ipv6Address> hnps;
+
+  hnps.push_back (Ipv6Address ("2001:5::"));
+  profile.AddProfile (Identifier ("mn@example.com"), Identifier (mn), Ipv6Address ("2001:2::1"), hnps);
+
+  Pmip6LmaHelper lmaHelper;
+  lmaHelper.SetProfileHelper (&profile);
+  lmaHelper.Install (lma);
+
+  Pmip6MagHelper magHelper;
+  magHelper.SetProfileHelper (&profile);
+  magHelper.Install (mag1, Ipv6Address ("2001:6::2"), NodeContainer ());
+  magHelper.Install (mag2, Ipv6Address ("2001:7::2"), NodeContainer ());
+
+  Ptr<Pmipv6Lma> lmaAgent = lma->GetObject<Pmipv6Lma> ();
+  Ptr<Pmipv6Mag> mag1Agent = mag1->GetObject<Pmipv6Mag> ();
+  Ptr<Pmipv6Mag> mag2Agent = mag2->GetObject<Pmipv6Mag> ();
+
+  mag2Agent->SetAttribute ("PredictionTimeout", TimeValue (Seconds (1.0)));
+
+  Ptr<Ipv6Interface> access1 = mag1->GetObject<Ipv6L3Protocol> ()->GetInterface (m_mag1AccessIf);
+  Ptr<Ipv6Interface> access2 = mag2->GetObject<Ipv6L3Protocol> ()->GetInterface (m_mag2AccessIf);
+  Mac48Address ap2 = Mac48Address::ConvertFrom (access2->GetDevice ()->GetAddress ());
+
+  mag1Agent->AddNeighbor (ap2, Ipv6Address ("2001:7::2"));
+
+  mag1Agent->TraceConnectWithoutContext ("RxHack", MakeCallback (&FastHandoverTestCase::RxHack, this));
+  mag1Agent->TraceConnectWithoutContext ("TxPbu", MakeCallback (&FastHandoverTestCase::TxPbu, this));
+  mag1->GetObject<Ipv6L3Protocol> ()->TraceConnect ("Tx", "mag1", MakeCallback (&FastHandoverTestCase::Tx, this));
+  mag2->GetObject<Ipv6L3Protocol> ()->TraceConnect ("Tx", "mag2", MakeCallback (&FastHandoverTestCase::Tx, this));
+
+  Simulator::Schedule (Seconds (2.0), &NotifyMagAttach,
+                       mag1->GetObject<Pmipv6MagNotifier> (), access1, mn,
+                       (uint8_t) Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+  Simulator::Schedule (Seconds (3.0), &FastHandoverTestCase::InitiateHandover, this, mag1Agent, mn, ap2);
+
+  /* downlink while the MN is on its way */
+  Simulator::Schedule (Seconds (3.1), &FastHandoverTestCase::SendPacket, this,
+                       cn->GetObject<Ipv6L3Protocol> (), Ipv6Address ("2001:1::1"), Ipv6Address ("2001:5::100"), m_nPackets);
+
+  if (m_attach)
+    {
+      Simulator::Schedule (Seconds (3.5), &NotifyMagAttach,
+                           mag2->GetObject<Pmipv6MagNotifier> (), access2, mn,
+                           (uint8_t) Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+    }
+  else
+    {
+      /* downlink once the pre-registration is withdrawn */
+      Simulator::Schedule (Seconds (5.0), &FastHandoverTestCase::SendPacket, this,
+                           cn->GetObject<Ipv6L3Protocol> (), Ipv6Address ("2001:1::1"), Ipv6Address ("2001:5::100"), m_nPackets);
+    }
+
+  Simulator::Stop (Seconds (6.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_initiated, true, "handover not initiated");
+  NS_TEST_ASSERT_MSG_EQ (mag1Agent->InitiateHandover (mn, Mac48Address::Allocate ()), false,
+                         "handover to an access point without a neighbor MAG");
+  NS_TEST_ASSERT_MSG_EQ (mag1Agent->GetNHandoversInitiated (), 1, "HI miscounted");
+  NS_TEST_ASSERT_MSG_EQ (mag2Agent->GetNPreRegistrations (), 1, "MN not pre-registered");
+  NS_TEST_ASSERT_MSG_EQ (m_hackAccepted, 1, "no accepting HAck");
+  NS_TEST_ASSERT_MSG_EQ (mag2Agent->GetNHeldPackets (), m_nPackets, "downlink not held by the new MAG");
+
+  if (m_attach)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_hackRefused, 0, "pre-registration withdrawn");
+      NS_TEST_ASSERT_MSG_EQ (mag2Agent->GetNPredictiveAttaches (), 1, "attach not matched to the pre-registration");
+      NS_TEST_ASSERT_MSG_EQ (mag2Agent->GetNHeldDrops (), 0, "held packets dropped");
+      NS_TEST_ASSERT_MSG_EQ (m_mag1Delivered, 0, "downlink sent to the old link");
+      NS_TEST_ASSERT_MSG_EQ (m_mag2Delivered, m_nPackets, "held packets not sent on");
+      NS_TEST_ASSERT_MSG_EQ (m_firstMag2Delivery, Seconds (3.5), "held packets sent before the attach");
+      NS_TEST_ASSERT_MSG_EQ (lmaAgent->GetNBceUpdated (), 1, "LMA binding not moved");
+      NS_TEST_ASSERT_MSG_EQ (mag2Agent->GetNTunnelSetups (), 1, "new MAG tunnel setups miscounted");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_hackRefused, 1, "pre-registration not withdrawn");
+      NS_TEST_ASSERT_MSG_EQ (mag2Agent->GetNPredictiveAttaches (), 0, "attach without an MN");
+      NS_TEST_ASSERT_MSG_EQ (mag2Agent->GetNHeldDrops (), m_nPackets, "held packets kept");
+      NS_TEST_ASSERT_MSG_EQ (m_mag2Delivered, 0, "downlink sent to a link without the MN");
+      NS_TEST_ASSERT_MSG_EQ (m_txPbu, 2, "old MAG did not take the binding back");
+      NS_TEST_ASSERT_MSG_EQ (m_mag1Delivered, m_nPackets, "downlink lost after the withdrawal");
+    }
+
+  Simulator::Destroy ();
+}
+
+static class FastHandoverTestSuite : public TestSuite
+{
+public:
+  FastHandoverTestSuite ()
+    : TestSuite ("pmip6-fast-handover", UNIT)
+  {
+    AddTestCase (new FastHandoverTestCase (true));
+    AddTestCase (new FastHandoverTestCase (false));
+  }
+} g_fastHandoverTestSuite;
+
+} // namespace ns3
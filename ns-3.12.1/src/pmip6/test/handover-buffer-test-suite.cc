@@ -0,0 +1,528 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/uinteger.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/ipv6-static-routing.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/udp-header.h"
+#include "ns3/identifier.h"
+#include "ns3/ipv6-mobility-header.h"
+#include "ns3/handover-buffer.h"
+#include "ns3/pmipv6-lma.h"
+#include "ns3/pmipv6-mag.h"
+#include "ns3/pmipv6-mag-notifier.h"
+#include "ns3/pmip6-helper.h"
+
+#include "pmip6-test-helper.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ns3 {
+
+class HandoverBufferOrderTestCase : public TestCase
+{
+public:
+  HandoverBufferOrderTestCase ();
+  virtual void DoRun (void);
+};
+
+HandoverBufferOrderTestCase::HandoverBufferOrderTestCase ()
+  : TestCase ("Check handover buffer order and reuse of its segments")
+{
+}
+
+void
+HandoverBufferOrderTestCase::DoRun (void)
+{
+  HandoverBufferPool pool;
+  HandoverBuffer *buffer = pool.Create (100, 100000);
+  std::vector<uint32_t> uids;
+
+  NS_TEST_ASSERT_MSG_EQ (buffer->IsEmpty (), true, "New buffer not empty");
+  NS_TEST_ASSERT_MSG_EQ (buffer->Dequeue (), 0, "Packet out of an empty buffer");
+
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      Ptr<Packet> packet = Create<Packet> (10);
+      uids.push_back (packet->GetUid ());
+      NS_TEST_ASSERT_MSG_EQ (buffer->Enqueue (packet), true, "Packet refused below the limits");
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (buffer->GetNPackets (), 40, "Packets miscounted");
+  NS_TEST_ASSERT_MSG_EQ (buffer->GetNBytes (), 400, "Bytes miscounted");
+  NS_TEST_ASSERT_MSG_EQ (buffer->GetNSegments (), 3, "40 packets span three segments");
+
+  //read half, then write past the segments read: the ring grows in between
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (buffer->Dequeue ()->GetUid (), uids[i], "Packet out of order");
+    }
+
+  for (uint32_t i = 0; i < 30; i++)
+    {
+      Ptr<Packet> packet = Create<Packet> (10);
+      uids.push_back (packet->GetUid ());
+      buffer->Enqueue (packet);
+    }
+
+  for (uint32_t i = 20; i < 70; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (buffer->Dequeue ()->GetUid (), uids[i], "Packet out of order across segments");
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (buffer->IsEmpty (), true, "Drained buffer not empty");
+  NS_TEST_ASSERT_MSG_EQ (buffer->GetNBytes (), 0, "Drained buffer holds bytes");
+
+  //filled and drained again and again, the buffer keeps its segments
+  uint32_t segments = buffer->GetNSegments ();
+
+  for (uint32_t round = 0; round < 10; round++)
+    {
+      for (uint32_t i = 0; i < 50; i++)
+        {
+          buffer->Enqueue (Create<Packet> (10));
+        }
+      for (uint32_t i = 0; i < 25; i++)
+        {
+          buffer->Dequeue ();
+        }
+      for (uint32_t i = 0; i < 25; i++)
+        {
+          buffer->Enqueue (Create<Packet> (10));
+        }
+      NS_TEST_ASSERT_MSG_EQ (buffer->Clear (), 50, "Clear dropped a wrong number of packets");
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (buffer->GetNSegments (), segments, "Segments not reused");
+
+  pool.Destroy (buffer);
+}
+
+class HandoverBufferLimitTestCase : public TestCase
+{
+public:
+  HandoverBufferLimitTestCase ();
+  virtual void DoRun (void);
+};
+
+HandoverBufferLimitTestCase::HandoverBufferLimitTestCase ()
+  : TestCase ("Check handover buffer packet and byte limits")
+{
+}
+
+void
+HandoverBufferLimitTestCase::DoRun (void)
+{
+  HandoverBufferPool pool;
+  HandoverBuffer *buffer = pool.Create (3, 1000);
+
+  NS_TEST_ASSERT_MSG_EQ (buffer->Enqueue (Create<Packet> (100)), true, "Packet refused below the limits");
+  NS_TEST_ASSERT_MSG_EQ (buffer->Enqueue (Create<Packet> (100)), true, "Packet refused below the limits");
+  NS_TEST_ASSERT_MSG_EQ (buffer->Enqueue (Create<Packet> (100)), true, "Packet refused below the limits");
+  NS_TEST_ASSERT_MSG_EQ (buffer->Enqueue (Create<Packet> (100)), false, "Packet limit exceeded");
+  NS_TEST_ASSERT_MSG_EQ (buffer->GetNPackets (), 3, "Refused packet counted");
+
+  buffer->Clear ();
+
+  NS_TEST_ASSERT_MSG_EQ (buffer->Enqueue (Create<Packet> (600)), true, "Packet refused below the limits");
+  NS_TEST_ASSERT_MSG_EQ (buffer->Enqueue (Create<Packet> (500)), false, "Byte limit exceeded");
+  NS_TEST_ASSERT_MSG_EQ (buffer->Enqueue (Create<Packet> (400)), true, "Packet refused up to the byte limit");
+  NS_TEST_ASSERT_MSG_EQ (buffer->GetNBytes (), 1000, "Bytes miscounted");
+
+  pool.Destroy (buffer);
+}
+
+/*
+ * CN -- LMA -- R -- MAG1 -- (MN)
+ *                \-- MAG2
+ *
+ * The MN shows up at MAG2 while MAG1 still holds its binding. When the
+ * handoff state is unknown, the LMA delays the registration from MAG2 and
+ * holds the downlink meanwhile, then sends it into the new tunnel behind
+ * the PBA. Otherwise the tunnel moves at once, but the PBA waits in a
+ * bulk: the LMA holds the downlink until the PBA leaves, MAG2 holds none.
+ */
+class LmaHoldTestCase : public TestCase
+{
+public:
+  LmaHoldTestCase (uint32_t holdLimit, bool delayed);
+  virtual void DoRun (void);
+
+private:
+  void SendPacket (Ptr<Ipv6L3Protocol> ipv6, Ipv6Address src, Ipv6Address dst, uint32_t count);
+  void Tx (std::string context, Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface);
+  void FlushHeld (const Identifier &mnId, uint32_t count);
+
+  uint32_t m_holdLimit;
+  bool m_delayed;
+  uint32_t m_nPackets;
+  uint32_t m_mag1Delivered;
+  uint32_t m_mag2Delivered;
+  Time m_firstMag2Delivery;
+  uint32_t m_mag1AccessIf;
+  uint32_t m_mag2AccessIf;
+  uint32_t m_flushed;
+};
+
+LmaHoldTestCase::LmaHoldTestCase (uint32_t holdLimit, bool delayed)
+  : TestCase (!delayed ? "Check the downlink held by the LMA until a bulked PBA"
+              : holdLimit < 10 ? "Check the drops of a full LMA handover buffer"
+              : "Check the downlink held by the LMA during a delayed registration"),
+    m_holdLimit (holdLimit),
+    m_delayed (delayed),
+    m_nPackets (10),
+    m_mag1Delivered (0),
+    m_mag2Delivered (0),
+    m_mag1AccessIf (0),
+    m_mag2AccessIf (0),
+    m_flushed (0)
+{
+}
+
+void
+LmaHoldTestCase::SendPacket (Ptr<Ipv6L3Protocol> ipv6, Ipv6Address src, Ipv6Address dst, uint32_t count)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  UdpHeader udp;
+  udp.SetSourcePort (9);
+  udp.SetDestinationPort (9);
+  packet->AddHeader (udp);
+  ipv6->Send (packet, src, dst, 17, 0);
+
+  if (count > 1)
+    {
+      Simulator::Schedule (MilliSeconds (10), &LmaHoldTestCase::SendPacket, this, ipv6, src, dst, count - 1);
+    }
+}
+
+void
+LmaHoldTestCase::Tx (std::string context, Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  Ipv6Header header;
+  packet->PeekHeader (header);
+
+  if (header.GetNextHeader () != 17)
+    {
+      return;
+    }
+
+  if (context == "mag1" && interface == m_mag1AccessIf)
+    {
+      m_mag1Delivered++;
+    }
+  else if (context == "mag2" && interface == m_mag2AccessIf)
+    {
+      if (m_mag2Delivered++ == 0)
+        {
+          m_firstMag2Delivery = Simulator::Now ();
+        }
+    }
+}
+
+void
+LmaHoldTestCase::FlushHeld (const Identifier &mnId, uint32_t count)
+{
+  m_flushed += count;
+}
+
+void
+LmaHoldTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+  Ptr<Node> cn = nodes.Get (0);
+  Ptr<Node> lma = nodes.Get (1);
+  Ptr<Node> router = nodes.Get (2);
+  Ptr<Node> mag1 = nodes.Get (3);
+  Ptr<Node> mag2 = nodes.Get (4);
+
+  InstallIpv6Stack (nodes, NodeContainer (mag1, mag2));
+
+  /* a simple channel hands every frame to all its devices, keep the links point to point */
+  Ptr<SimpleChannel> core = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> backhaul = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> backhaul1 = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> backhaul2 = CreateObject<SimpleChannel> ();
+
+  uint32_t cnIf = AddSimpleLink (cn, core, "2001:1::1");
+  AddSimpleLink (lma, core, "2001:1::2");
+  uint32_t lmaIf = AddSimpleLink (lma, backhaul, "2001:2::1");
+  AddSimpleLink (router, backhaul, "2001:2::2");
+  AddSimpleLink (router, backhaul1, "2001:6::1");
+  AddSimpleLink (router, backhaul2, "2001:7::1");
+  uint32_t mag1If = AddSimpleLink (mag1, backhaul1, "2001:6::2");
+  uint32_t mag2If = AddSimpleLink (mag2, backhaul2, "2001:7::2");
+  m_mag1AccessIf = AddSimpleLink (mag1, CreateObject<SimpleChannel> (), "2001:3::1");
+  m_mag2AccessIf = AddSimpleLink (mag2, CreateObject<SimpleChannel> (), "2001:4::1");
+
+  Ipv6StaticRoutingHelper routingHelper;
+  routingHelper.GetStaticRouting (cn->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("2001:1::2"), cnIf);
+  routingHelper.GetStaticRouting (lma->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("2001:2::2"), lmaIf);
+  routingHelper.GetStaticRouting (mag1->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("2001:6::1"), mag1If);
+  routingHelper.GetStaticRouting (mag2->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("2001:7::1"), mag2If);
+
+  Mac48Address mn = Mac48Address::Allocate ();
+  Pmip6ProfileHelper profile;
+  Pmip6ProfileHelper lmaProfile;
+  std::list<Ipv6Address> hnps;
+  Ipv6Address dst ("2001:5::100");
+
+  /* the LMA assigns the prefix and keeps it to itself: the PBU from MAG2,
+   * on another access technology and without prefix, matches no binding
+   * and the LMA cannot tell a handover */
+  if (m_delayed)
+    {
+      dst = Ipv6Address ("2001:5:0:1::100");
+    }
+  else
+    {
+      hnps.push_back (Ipv6Address ("2001:5::"));
+    }
+
+  profile.AddProfile (Identifier ("mn@example.com"), Identifier (mn), Ipv6Address ("2001:2::1"), hnps);
+  lmaProfile.AddProfile (Identifier ("mn@example.com"), Identifier (mn), Ipv6Address ("2001:2::1"), hnps);
+
+  Pmip6LmaHelper lmaHelper;
+  lmaHelper.SetProfileHelper (&lmaProfile);
+  lmaHelper.SetPrefixPoolBase (Ipv6Address ("2001:5::"), 48);
+  lmaHelper.Install (lma);
+
+  Pmip6MagHelper magHelper;
+  magHelper.SetProfileHelper (&profile);
+  magHelper.Install (mag1, Ipv6Address ("2001:6::2"), NodeContainer ());
+  magHelper.Install (mag2, Ipv6Address ("2001:7::2"), NodeContainer ());
+
+  Ptr<Pmipv6Lma> lmaAgent = lma->GetObject<Pmipv6Lma> ();
+  Ptr<Pmipv6Mag> mag2Agent = mag2->GetObject<Pmipv6Mag> ();
+
+  lmaAgent->SetAttribute ("HoldLimit", UintegerValue (m_holdLimit));
+  if (!m_delayed)
+    {
+      lmaAgent->SetAttribute ("BulkWindow", TimeValue (MilliSeconds (50)));
+    }
+
+  Ptr<Ipv6Interface> access1 = mag1->GetObject<Ipv6L3Protocol> ()->GetInterface (m_mag1AccessIf);
+  Ptr<Ipv6Interface> access2 = mag2->GetObject<Ipv6L3Protocol> ()->GetInterface (m_mag2AccessIf);
+
+  lmaAgent->TraceConnectWithoutContext ("FlushHeld", MakeCallback (&LmaHoldTestCase::FlushHeld, this));
+  mag1->GetObject<Ipv6L3Protocol> ()->TraceConnect ("Tx", "mag1", MakeCallback (&LmaHoldTestCase::Tx, this));
+  mag2->GetObject<Ipv6L3Protocol> ()->TraceConnect ("Tx", "mag2", MakeCallback (&LmaHoldTestCase::Tx, this));
+
+  Simulator::Schedule (Seconds (2.0), &NotifyMagAttach,
+                       mag1->GetObject<Pmipv6MagNotifier> (), access1, mn,
+                       (uint8_t) Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+  Simulator::Schedule (Seconds (3.0), &NotifyMagAttach,
+                       mag2->GetObject<Pmipv6MagNotifier> (), access2, mn,
+                       (uint8_t) (m_delayed ? Ipv6MobilityHeader::OPT_ATT_IEEE_802_16E
+                                  : Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG));
+  Simulator::Schedule (Seconds (3.01), &LmaHoldTestCase::SendPacket, this,
+                       cn->GetObject<Ipv6L3Protocol> (), Ipv6Address ("2001:1::1"), dst, m_nPackets);
+
+  Simulator::Stop (Seconds (6.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_mag1Delivered, 0, "downlink sent to the old link");
+  NS_TEST_ASSERT_MSG_EQ (mag2Agent->GetNHeldDrops (), 0, "packets dropped by the new MAG");
+
+  if (m_delayed)
+    {
+      uint32_t kept = std::min (m_holdLimit, m_nPackets);
+
+      NS_TEST_ASSERT_MSG_EQ (lmaAgent->GetNDelayedRegistrations (), 1, "registration not delayed");
+      NS_TEST_ASSERT_MSG_EQ (lmaAgent->GetNHeldPackets (), kept, "downlink not held by the LMA");
+      NS_TEST_ASSERT_MSG_EQ (lmaAgent->GetNHeldDrops (), m_nPackets - kept, "LMA held drops miscounted");
+      NS_TEST_ASSERT_MSG_EQ (m_flushed, kept, "held packets not flushed into the new tunnel");
+      NS_TEST_ASSERT_MSG_EQ (m_mag2Delivered, kept, "held packets lost on the way");
+      NS_TEST_ASSERT_MSG_EQ ((m_firstMag2Delivery >= Seconds (4.5)), true, "held packets sent before the registration");
+      /* the held packets leave the LMA behind the PBA, which gives MAG2
+       * the prefix of the MN: none reaches MAG2 ahead of it */
+      NS_TEST_ASSERT_MSG_EQ (mag2Agent->GetNHeldPackets (), 0, "packets flushed ahead of the PBA");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (lmaAgent->GetNDelayedRegistrations (), 0, "registration delayed");
+      NS_TEST_ASSERT_MSG_EQ ((lmaAgent->GetNHeldPackets () > 0), true, "packets ahead of the PBA not held by the LMA");
+      NS_TEST_ASSERT_MSG_EQ (m_flushed, lmaAgent->GetNHeldPackets (), "held packets not flushed behind the PBA");
+      NS_TEST_ASSERT_MSG_EQ (mag2Agent->GetNHeldPackets (), 0, "downlink held by the new MAG without a handover initiate");
+      NS_TEST_ASSERT_MSG_EQ (m_mag2Delivered, m_nPackets, "downlink lost during the handover");
+    }
+
+  Simulator::Destroy ();
+}
+
+/*
+ * CN -- LMA -- MAG -- (MN1, MN2)
+ *
+ * MN1 is registered and attached, MN2 attaches while the bulked PBA for it
+ * is on its way. The downlink of MN1 goes on meanwhile, the MAG holds no
+ * packet of an MN but to the prefixes of that MN.
+ */
+class MagHoldOtherMnTestCase : public TestCase
+{
+public:
+  MagHoldOtherMnTestCase ();
+  virtual void DoRun (void);
+
+private:
+  void SendPacket (Ptr<Ipv6L3Protocol> ipv6, Ipv6Address src, Ipv6Address dst, uint32_t count);
+  void Tx (Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface);
+
+  uint32_t m_nPackets;
+  uint32_t m_delivered;
+  uint32_t m_accessIf;
+};
+
+MagHoldOtherMnTestCase::MagHoldOtherMnTestCase ()
+  : TestCase ("Check the MAG does not hold the downlink of another MN"),
+    m_nPackets (10),
+    m_delivered (0),
+    m_accessIf (0)
+{
+}
+
+void
+MagHoldOtherMnTestCase::SendPacket (Ptr<Ipv6L3Protocol> ipv6, Ipv6Address src, Ipv6Address dst, uint32_t count)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  UdpHeader udp;
+  udp.SetSourcePort (9);
+  udp.SetDestinationPort (9);
+  packet->AddHeader (udp);
+  ipv6->Send (packet, src, dst, 17, 0);
+
+  if (count > 1)
+    {
+      Simulator::Schedule (MilliSeconds (10), &MagHoldOtherMnTestCase::SendPacket, this, ipv6, src, dst, count - 1);
+    }
+}
+
+void
+MagHoldOtherMnTestCase::Tx (Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  Ipv6Header header;
+  packet->PeekHeader (header);
+
+  if (header.GetNextHeader () == 17 && interface == m_accessIf)
+    {
+      m_delivered++;
+    }
+}
+
+void
+MagHoldOtherMnTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  Ptr<Node> cn = nodes.Get (0);
+  Ptr<Node> lma = nodes.Get (1);
+  Ptr<Node> mag = nodes.Get (2);
+
+  InstallIpv6Stack (nodes, mag);
+
+  Ptr<SimpleChannel> core = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> backhaul = CreateObject<SimpleChannel> ();
+
+  uint32_t cnIf = AddSimpleLink (cn, core, "2001:1::1");
+  AddSimpleLink (lma, core, "2001:1::2");
+  uint32_t lmaIf = AddSimpleLink (lma, backhaul, "2001:2::1");
+  uint32_t magIf = AddSimpleLink (mag, backhaul, "2001:2::2");
+  m_accessIf = AddSimpleLink (mag, CreateObject<SimpleChannel> (), "2001:3::1");
+
+  Ipv6StaticRoutingHelper routingHelper;
+  routingHelper.GetStaticRouting (cn->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("2001:1::2"), cnIf);
+  routingHelper.GetStaticRouting (lma->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("2001:2::2"), lmaIf);
+  routingHelper.GetStaticRouting (mag->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("2001:2::1"), magIf);
+
+  /* the LMA assigns the prefixes: the MAG learns them from the PBAs */
+  Mac48Address mn1 = Mac48Address::Allocate ();
+  Mac48Address mn2 = Mac48Address::Allocate ();
+  Pmip6ProfileHelper profile;
+  Pmip6ProfileHelper lmaProfile;
+
+  profile.AddProfile (Identifier ("mn1@example.com"), Identifier (mn1), Ipv6Address ("2001:2::1"), std::list<Ipv6Address> ());
+  profile.AddProfile (Identifier ("mn2@example.com"), Identifier (mn2), Ipv6Address ("2001:2::1"), std::list<Ipv6Address> ());
+  lmaProfile.AddProfile (Identifier ("mn1@example.com"), Identifier (mn1), Ipv6Address ("2001:2::1"), std::list<Ipv6Address> ());
+  lmaProfile.AddProfile (Identifier ("mn2@example.com"), Identifier (mn2), Ipv6Address ("2001:2::1"), std::list<Ipv6Address> ());
+
+  Pmip6LmaHelper lmaHelper;
+  lmaHelper.SetProfileHelper (&lmaProfile);
+  lmaHelper.SetPrefixPoolBase (Ipv6Address ("2001:5::"), 48);
+  lmaHelper.Install (lma);
+
+  Pmip6MagHelper magHelper;
+  magHelper.SetProfileHelper (&profile);
+  magHelper.Install (mag, Ipv6Address ("2001:2::2"), NodeContainer ());
+
+  Ptr<Pmipv6Lma> lmaAgent = lma->GetObject<Pmipv6Lma> ();
+  Ptr<Pmipv6Mag> magAgent = mag->GetObject<Pmipv6Mag> ();
+
+  lmaAgent->SetAttribute ("BulkWindow", TimeValue (MilliSeconds (50)));
+
+  Ptr<Ipv6Interface> access = mag->GetObject<Ipv6L3Protocol> ()->GetInterface (m_accessIf);
+
+  mag->GetObject<Ipv6L3Protocol> ()->TraceConnectWithoutContext ("Tx", MakeCallback (&MagHoldOtherMnTestCase::Tx, this));
+
+  Simulator::Schedule (Seconds (2.0), &NotifyMagAttach,
+                       mag->GetObject<Pmipv6MagNotifier> (), access, mn1,
+                       (uint8_t) Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+  Simulator::Schedule (Seconds (3.0), &NotifyMagAttach,
+                       mag->GetObject<Pmipv6MagNotifier> (), access, mn2,
+                       (uint8_t) Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+  /* the first prefix of the pool goes to MN1 */
+  Simulator::Schedule (Seconds (3.0), &MagHoldOtherMnTestCase::SendPacket, this,
+                       cn->GetObject<Ipv6L3Protocol> (), Ipv6Address ("2001:1::1"), Ipv6Address ("2001:5:0:1::100"), m_nPackets);
+
+  Simulator::Stop (Seconds (4.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (magAgent->GetNHeldPackets (), 0, "downlink of MN1 held for MN2");
+  NS_TEST_ASSERT_MSG_EQ (magAgent->GetNHeldDrops (), 0, "downlink of MN1 dropped");
+  NS_TEST_ASSERT_MSG_EQ (m_delivered, m_nPackets, "downlink of MN1 lost");
+
+  Simulator::Destroy ();
+}
+
+static class HandoverBufferTestSuite : public TestSuite
+{
+public:
+  HandoverBufferTestSuite ()
+    : TestSuite ("pmip6-handover-buffer", UNIT)
+  {
+    AddTestCase (new HandoverBufferOrderTestCase ());
+    AddTestCase (new HandoverBufferLimitTestCase ());
+    AddTestCase (new LmaHoldTestCase (64, true));
+    AddTestCase (new LmaHoldTestCase (4, true));
+    AddTestCase (new LmaHoldTestCase (64, false));
+    AddTestCase (new MagHoldOtherMnTestCase ());
+  }
+} g_handoverBufferTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,194 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+
+#include "ns3/test.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/mac48-address.h"
+#include "ns3/identifier.h"
+
+namespace ns3 {
+
+class IdentifierStorageTestCase : public TestCase
+{
+public:
+  IdentifierStorageTestCase ();
+  virtual void DoRun (void);
+};
+
+IdentifierStorageTestCase::IdentifierStorageTestCase ()
+  : TestCase ("Check inline and shared identifier storage")
+{
+}
+
+void
+IdentifierStorageTestCase::DoRun (void)
+{
+  uint8_t buf[Identifier::MAX_SIZE];
+  uint8_t out[Identifier::MAX_SIZE];
+
+  for (uint32_t i = 0; i < Identifier::MAX_SIZE; i++)
+    {
+      buf[i] = i;
+    }
+
+  Identifier mac (Mac48Address ("00:00:00:00:00:01"));
+  Identifier shortId (buf, Identifier::INLINE_SIZE);
+  Identifier longId (buf, Identifier::MAX_SIZE);
+
+  NS_TEST_ASSERT_MSG_EQ (mac.GetLength (), 6, "MAC identifier length");
+  NS_TEST_ASSERT_MSG_EQ ((mac == Identifier (Mac48Address ("00:00:00:00:00:01"))), true, "MAC identifiers differ");
+
+  Identifier copy = longId;
+  NS_TEST_ASSERT_MSG_EQ ((copy == longId), true, "Shared copy differs");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetHash (), longId.GetHash (), "Shared copy hash differs");
+
+  //rewriting a copy must not affect the shared original
+  copy.CopyFrom (buf, 10);
+  NS_TEST_ASSERT_MSG_EQ (longId.GetLength (), Identifier::MAX_SIZE, "Shared buffer modified");
+  NS_TEST_ASSERT_MSG_EQ ((copy == Identifier (buf, 10)), true, "CopyFrom failed");
+
+  longId.CopyTo (out, Identifier::MAX_SIZE);
+  NS_TEST_ASSERT_MSG_EQ (memcmp (out, buf, Identifier::MAX_SIZE), 0, "Long identifier content");
+  shortId.CopyTo (out, Identifier::MAX_SIZE);
+  NS_TEST_ASSERT_MSG_EQ (memcmp (out, buf, Identifier::INLINE_SIZE), 0, "Short identifier content");
+
+  NS_TEST_ASSERT_MSG_EQ ((shortId != Identifier (buf, Identifier::INLINE_SIZE + 1)), true, "Prefix identifiers equal");
+  NS_TEST_ASSERT_MSG_EQ (IdentifierHash () (shortId), Identifier (buf, Identifier::INLINE_SIZE).GetHash (), "Hash not stable");
+
+  //empty identifiers are equal however they were built
+  NS_TEST_ASSERT_MSG_EQ ((Identifier () == Identifier (buf, 0)), true, "Empty identifiers differ");
+  NS_TEST_ASSERT_MSG_EQ ((Identifier () == Identifier ("")), true, "Empty identifiers differ");
+  copy.CopyFrom (buf, 0);
+  NS_TEST_ASSERT_MSG_EQ ((copy == Identifier ()), true, "Emptied identifier differs");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetHash (), Identifier ().GetHash (), "Empty identifier hashes differ");
+}
+
+/**
+ * \brief The former Identifier layout: a fixed buffer copied by value and
+ * rehashed on every lookup.
+ */
+struct LegacyIdentifier
+{
+  uint8_t m_len;
+  uint8_t m_identifier[Identifier::MAX_SIZE];
+};
+
+/**
+ * \brief The former IdentifierHash: copy the bytes out, then hash them.
+ */
+static uint32_t
+LegacyHash (const LegacyIdentifier &x)
+{
+  uint8_t buf[Identifier::MAX_SIZE];
+
+  memcpy (buf, x.m_identifier, x.m_len);
+  return Identifier::Hash (buf, x.m_len);
+}
+
+class IdentifierCostTestCase : public TestCase
+{
+public:
+  IdentifierCostTestCase ();
+  virtual void DoRun (void);
+};
+
+IdentifierCostTestCase::IdentifierCostTestCase ()
+  : TestCase ("Measure identifier copy and hash cost per PBU")
+{
+}
+
+void
+IdentifierCostTestCase::DoRun (void)
+{
+  //a PBU on the LMA copies the MN and MN-link identifiers about eight
+  //times (bundle, lookups, BCE setters, PBA) and hashes them three times
+  const uint32_t nPbu = 1000000;
+  const uint32_t nCopies = 8;
+  const uint32_t nHashes = 3;
+
+  const char *nai = "mn-000001@pmip6.example.net";
+  LegacyIdentifier legacy;
+  legacy.m_len = strlen (nai);
+  memcpy (legacy.m_identifier, nai, legacy.m_len);
+  Identifier current (nai);
+
+  SystemWallClockMs clock;
+  volatile uint32_t sink = 0;
+
+  clock.Start ();
+  for (uint32_t i = 0; i < nPbu; i++)
+    {
+      LegacyIdentifier tmp = legacy;
+      for (uint32_t j = 1; j < nCopies; j++)
+        {
+          LegacyIdentifier next = tmp;
+          tmp = next;
+        }
+      for (uint32_t j = 0; j < nHashes; j++)
+        {
+          sink += LegacyHash (tmp);
+        }
+    }
+  int64_t legacyMs = clock.End ();
+
+  clock.Start ();
+  for (uint32_t i = 0; i < nPbu; i++)
+    {
+      Identifier tmp = current;
+      for (uint32_t j = 1; j < nCopies; j++)
+        {
+          Identifier next = tmp;
+          tmp = next;
+        }
+      for (uint32_t j = 0; j < nHashes; j++)
+        {
+          sink += IdentifierHash () (tmp);
+        }
+    }
+  int64_t currentMs = clock.End ();
+
+  std::cout << "identifier cost for " << nPbu << " PBUs: legacy "
+            << legacyMs << " ms (" << (legacyMs * 1e6 / nPbu) << " ns/PBU), current "
+            << currentMs << " ms (" << (currentMs * 1e6 / nPbu) << " ns/PBU)" << std::endl;
+
+  NS_TEST_ASSERT_MSG_EQ ((sizeof (Identifier) < sizeof (LegacyIdentifier)), true, "Identifier did not shrink");
+}
+
+static class IdentifierTestSuite : public TestSuite
+{
+public:
+  IdentifierTestSuite ()
+    : TestSuite ("pmip6-identifier", UNIT)
+  {
+    AddTestCase (new IdentifierStorageTestCase ());
+  }
+} g_identifierTestSuite;
+
+static class IdentifierPerfTestSuite : public TestSuite
+{
+public:
+  IdentifierPerfTestSuite ()
+    : TestSuite ("pmip6-identifier-perf", PERFORMANCE)
+  {
+    AddTestCase (new IdentifierCostTestCase ());
+  }
+} g_identifierPerfTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,234 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/identifier.h"
+#include "ns3/ipv6-mobility-header.h"
+#include "ns3/pmipv6-lma.h"
+#include "ns3/pmipv6-mag.h"
+#include "ns3/pmipv6-mag-notifier.h"
+#include "ns3/pmip6-helper.h"
+#include "ns3/pmip6-latency-helper.h"
+
+#include "pmip6-test-helper.h"
+
+#include <stdio.h>
+
+namespace ns3 {
+
+class LatencyHistogramTestCase : public TestCase
+{
+public:
+  LatencyHistogramTestCase ();
+  virtual void DoRun (void);
+};
+
+LatencyHistogramTestCase::LatencyHistogramTestCase ()
+  : TestCase ("Check the binning of handover delays")
+{
+}
+
+void
+LatencyHistogramTestCase::DoRun (void)
+{
+  Pmip6LatencyHelper::Histogram h (MilliSeconds (10));
+
+  NS_TEST_ASSERT_MSG_EQ (h.GetNBins (), 0, "empty histogram has bins");
+  NS_TEST_ASSERT_MSG_EQ (h.GetMean (), Seconds (0), "empty histogram has a mean");
+
+  h.AddValue (MilliSeconds (3));
+  h.AddValue (MilliSeconds (9));
+  h.AddValue (MilliSeconds (10));
+  h.AddValue (MilliSeconds (42));
+
+  NS_TEST_ASSERT_MSG_EQ (h.GetCount (), 4, "value lost");
+  NS_TEST_ASSERT_MSG_EQ (h.GetNBins (), 5, "bins do not stop at the largest value");
+  NS_TEST_ASSERT_MSG_EQ (h.GetBinCount (0), 2, "[0, 10ms) miscounted");
+  NS_TEST_ASSERT_MSG_EQ (h.GetBinCount (1), 1, "[10ms, 20ms) miscounted");
+  NS_TEST_ASSERT_MSG_EQ (h.GetBinCount (2), 0, "[20ms, 30ms) miscounted");
+  NS_TEST_ASSERT_MSG_EQ (h.GetBinCount (4), 1, "[40ms, 50ms) miscounted");
+  NS_TEST_ASSERT_MSG_EQ (h.GetBinStart (4), MilliSeconds (40), "wrong bin start");
+  NS_TEST_ASSERT_MSG_EQ (h.GetMax (), MilliSeconds (42), "wrong max");
+  NS_TEST_ASSERT_MSG_EQ (h.GetMean (), MilliSeconds (16), "wrong mean");
+}
+
+/*
+ * LMA -- MAG -- (MNs)
+ *
+ * MNs attach to the MAG one after the other. The counters of both agents,
+ * their trace sources and the latency helper must all see each of them once.
+ */
+class AgentInstrumentationTestCase : public TestCase
+{
+public:
+  AgentInstrumentationTestCase ();
+  virtual void DoRun (void);
+
+private:
+  void TxPbu (const Identifier &mnId, Ipv6Address lma, uint16_t lifetime);
+  void TxPba (const Identifier &mnId, uint8_t status);
+  void BceCreated (const Identifier &mnId);
+
+  uint32_t m_nMns;
+  uint32_t m_txPbu;
+  uint32_t m_txPbaAccepted;
+  uint32_t m_bceCreated;
+};
+
+AgentInstrumentationTestCase::AgentInstrumentationTestCase ()
+  : TestCase ("Check MAG and LMA counters, trace sources and latency histograms"),
+    m_nMns (20),
+    m_txPbu (0),
+    m_txPbaAccepted (0),
+    m_bceCreated (0)
+{
+}
+
+void
+AgentInstrumentationTestCase::TxPbu (const Identifier &mnId, Ipv6Address lma, uint16_t lifetime)
+{
+  m_txPbu++;
+}
+
+void
+AgentInstrumentationTestCase::TxPba (const Identifier &mnId, uint8_t status)
+{
+  if (status == Ipv6MobilityHeader::BA_STATUS_BINDING_UPDATE_ACCEPTED)
+    {
+      m_txPbaAccepted++;
+    }
+}
+
+void
+AgentInstrumentationTestCase::BceCreated (const Identifier &mnId)
+{
+  m_bceCreated++;
+}
+
+void
+AgentInstrumentationTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<Node> lma = nodes.Get (0);
+  Ptr<Node> mag = nodes.Get (1);
+
+  InstallIpv6Stack (nodes, mag);
+
+  Ptr<SimpleChannel> backhaul = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> access = CreateObject<SimpleChannel> ();
+
+  AddSimpleLink (lma, backhaul, "2001:2::1");
+  AddSimpleLink (mag, backhaul, "2001:2::2");
+  uint32_t accessIf = AddSimpleLink (mag, access, "2001:3::1");
+
+  Pmip6ProfileHelper profile;
+  std::list<Ipv6Address> hnps;
+  std::list<Mac48Address> mns;
+
+  for (uint32_t i = 0; i < m_nMns; i++)
+    {
+      char nai[32];
+      Mac48Address mn = Mac48Address::Allocate ();
+
+      sprintf (nai, "mn%u@example.com", i);
+      profile.AddProfile (Identifier (nai), Identifier (mn), Ipv6Address ("2001:2::1"), hnps);
+      mns.push_back (mn);
+    }
+
+  Pmip6LmaHelper lmaHelper;
+  lmaHelper.SetProfileHelper (&profile);
+  lmaHelper.Install (lma);
+
+  Pmip6MagHelper magHelper;
+  magHelper.SetProfileHelper (&profile);
+  magHelper.Install (mag, Ipv6Address ("2001:2::2"), NodeContainer ());
+
+  Ptr<Pmipv6Mag> magAgent = mag->GetObject<Pmipv6Mag> ();
+  Ptr<Pmipv6Lma> lmaAgent = lma->GetObject<Pmipv6Lma> ();
+
+  magAgent->TraceConnectWithoutContext ("TxPbu", MakeCallback (&AgentInstrumentationTestCase::TxPbu, this));
+  lmaAgent->TraceConnectWithoutContext ("TxPba", MakeCallback (&AgentInstrumentationTestCase::TxPba, this));
+  lmaAgent->TraceConnectWithoutContext ("BceCreated", MakeCallback (&AgentInstrumentationTestCase::BceCreated, this));
+
+  Pmip6LatencyHelper latency;
+  latency.SetBinWidth (MicroSeconds (100));
+  latency.Install (mag);
+
+  Ptr<Pmipv6MagNotifier> notifier = mag->GetObject<Pmipv6MagNotifier> ();
+  Ptr<Ipv6Interface> interface = mag->GetObject<Ipv6L3Protocol> ()->GetInterface (accessIf);
+  Time at = Seconds (2.0);
+
+  for (std::list<Mac48Address>::iterator i = mns.begin (); i != mns.end (); i++)
+    {
+      Simulator::Schedule (at, &NotifyMagAttach, notifier, interface, (*i),
+                           (uint8_t) Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+      at += MilliSeconds (10);
+    }
+
+  Simulator::Stop (Seconds (5.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (magAgent->GetNAttaches (), m_nMns, "MAG missed attaches");
+  NS_TEST_ASSERT_MSG_EQ (magAgent->GetNPbuRetransmissions (), 0, "PBUs retransmitted on a lossless link");
+  NS_TEST_ASSERT_MSG_EQ (magAgent->GetNPbaRejected (), 0, "MAG got rejected PBAs");
+  NS_TEST_ASSERT_MSG_EQ (magAgent->GetNTunnelSetups (), m_nMns, "MAG tunnel setups miscounted");
+  NS_TEST_ASSERT_MSG_EQ (m_txPbu, m_nMns, "TxPbu trace miscounted");
+
+  NS_TEST_ASSERT_MSG_EQ (lmaAgent->GetNBceCreated (), m_nMns, "LMA BCE creations miscounted");
+  NS_TEST_ASSERT_MSG_EQ (lmaAgent->GetNBceUpdated (), 0, "LMA updated BCEs without handover");
+  NS_TEST_ASSERT_MSG_EQ (lmaAgent->GetNBceDeleted (), 0, "LMA deleted BCEs");
+  NS_TEST_ASSERT_MSG_EQ (lmaAgent->GetNDelayedRegistrations (), 0, "LMA delayed registrations");
+  NS_TEST_ASSERT_MSG_EQ (lmaAgent->GetNPbaRejected (), 0, "LMA rejected PBUs");
+  NS_TEST_ASSERT_MSG_EQ (lmaAgent->GetNTunnelSetups (), m_nMns, "LMA tunnel setups miscounted");
+  NS_TEST_ASSERT_MSG_EQ (m_bceCreated, m_nMns, "BceCreated trace miscounted");
+  NS_TEST_ASSERT_MSG_EQ (m_txPbaAccepted, m_nMns, "TxPba trace miscounted");
+
+  NS_TEST_ASSERT_MSG_EQ (latency.GetPbaLatency ().GetCount (), m_nMns, "attach to PBA delays lost");
+  NS_TEST_ASSERT_MSG_EQ (latency.GetRaLatency ().GetCount (), m_nMns, "attach to RA delays lost");
+  NS_TEST_ASSERT_MSG_EQ ((latency.GetPbaLatency ().GetNBins () > 0), true, "no PBA delay binned");
+  NS_TEST_ASSERT_MSG_EQ ((latency.GetRaLatency ().GetMean () >= latency.GetPbaLatency ().GetMean ()), true,
+                         "RA sent before the PBA");
+  NS_TEST_ASSERT_MSG_EQ (latency.GetPbaLatency (Identifier ("mn0@example.com")).GetCount (), 1, "per-MN delay lost");
+  NS_TEST_ASSERT_MSG_EQ (latency.GetRaLatency (Identifier ("mn0@example.com")).GetCount (), 1, "per-MN delay lost");
+  NS_TEST_ASSERT_MSG_EQ (latency.GetPbaLatency (Identifier ("unknown@example.com")).GetCount (), 0, "delay for unknown MN");
+
+  Simulator::Destroy ();
+}
+
+static class InstrumentationTestSuite : public TestSuite
+{
+public:
+  InstrumentationTestSuite ()
+    : TestSuite ("pmip6-instrumentation", UNIT)
+  {
+    AddTestCase (new LatencyHistogramTestCase ());
+    AddTestCase (new AgentInstrumentationTestCase ());
+  }
+} g_instrumentationTestSuite;
+
+} // namespace ns3
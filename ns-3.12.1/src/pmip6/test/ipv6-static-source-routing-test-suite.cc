@@ -0,0 +1,133 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/packet.h"
+#include "ns3/ipv6-static-source-routing.h"
+
+namespace ns3 {
+
+class Ipv6StaticSourceRoutingTestCase : public TestCase
+{
+public:
+  Ipv6StaticSourceRoutingTestCase ();
+  virtual void DoRun (void);
+
+private:
+  Ptr<Ipv6Route> Lookup (Ptr<Ipv6StaticSourceRouting> routing, Ipv6Address src, Ipv6Address dst);
+};
+
+Ipv6StaticSourceRoutingTestCase::Ipv6StaticSourceRoutingTestCase ()
+  : TestCase ("Check longest prefix match and route removal of the source routing table")
+{
+}
+
+Ptr<Ipv6Route>
+Ipv6StaticSourceRoutingTestCase::Lookup (Ptr<Ipv6StaticSourceRouting> routing, Ipv6Address src, Ipv6Address dst)
+{
+  Ipv6Header header;
+  Socket::SocketErrno sockerr;
+
+  header.SetSourceAddress (src);
+  header.SetDestinationAddress (dst);
+  return routing->RouteOutput (Create<Packet> (), header, 0, sockerr);
+}
+
+void
+Ipv6StaticSourceRoutingTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (node);
+
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+  Ptr<SimpleNetDevice> dev1 = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> dev2 = CreateObject<SimpleNetDevice> ();
+  node->AddDevice (dev1);
+  node->AddDevice (dev2);
+  uint32_t if1 = ipv6->AddInterface (dev1);
+  uint32_t if2 = ipv6->AddInterface (dev2);
+  ipv6->SetUp (if1);
+  ipv6->SetUp (if2);
+
+  Ptr<Ipv6StaticSourceRouting> routing = CreateObject<Ipv6StaticSourceRouting> ();
+  routing->SetIpv6 (ipv6);
+
+  Ipv6Address dst ("2001:db8::1");
+  Ipv6Address src1 ("3ffe:1:4:1::100");
+  Ipv6Address src2 ("3ffe:1:4:2::100");
+
+  routing->AddNetworkRouteFrom (Ipv6Address ("3ffe:1::"), Ipv6Prefix (32), if1, 0);
+  routing->AddNetworkRouteFrom (Ipv6Address ("3ffe:1:4:1::"), Ipv6Prefix (64), if2, 0);
+  NS_TEST_ASSERT_MSG_EQ (routing->GetNRoutes (), 2, "two routes");
+
+  Ptr<Ipv6Route> route = Lookup (routing, src1, dst);
+  NS_TEST_ASSERT_MSG_NE (route, 0, "route from the /64");
+  NS_TEST_ASSERT_MSG_EQ (route->GetOutputDevice (), dev2, "longest prefix wins");
+  NS_TEST_ASSERT_MSG_EQ (route->GetDestination (), dst, "destination is the packet one");
+
+  route = Lookup (routing, src2, dst);
+  NS_TEST_ASSERT_MSG_NE (route, 0, "route from the /32");
+  NS_TEST_ASSERT_MSG_EQ (route->GetOutputDevice (), dev1, "falls back on the shorter prefix");
+
+  Ptr<Ipv6Route> other = Lookup (routing, src2, Ipv6Address ("2001:db8::2"));
+  NS_TEST_ASSERT_MSG_EQ (other->GetDestination (), Ipv6Address ("2001:db8::2"), "destination is the packet one");
+  NS_TEST_ASSERT_MSG_EQ (route->GetDestination (), dst, "route handed out before left as it was");
+
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing, Ipv6Address ("3fff::1"), dst), 0, "no route for unknown source");
+
+  /* same prefix, lower metric wins */
+  routing->AddNetworkRouteFrom (Ipv6Address ("3ffe:1::"), Ipv6Prefix (32), if2, 5);
+  routing->AddNetworkRouteFrom (Ipv6Address ("3ffe:1::"), Ipv6Prefix (32), if2, 10);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing, src2, dst)->GetOutputDevice (), dev1, "lowest metric wins");
+
+  /* removing by index keeps the indexes dense */
+  routing->RemoveRoute (0);
+  NS_TEST_ASSERT_MSG_EQ (routing->GetNRoutes (), 3, "three routes left");
+  NS_TEST_ASSERT_MSG_EQ (routing->GetMetric (0), 10, "last route moved to the freed index");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing, src2, dst)->GetOutputDevice (), dev2, "next best metric");
+
+  routing->RemoveRoute (Ipv6Address ("3ffe:1:4:1::"), Ipv6Prefix (64), if2, Ipv6Address ("3ffe:1:4:1::"));
+  NS_TEST_ASSERT_MSG_EQ (routing->GetNRoutes (), 2, "/64 removed");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing, src1, dst)->GetSource (), Ipv6Address ("3ffe:1::"), "/32 now used");
+
+  routing->NotifyInterfaceDown (if2);
+  NS_TEST_ASSERT_MSG_EQ (routing->GetNRoutes (), 0, "routes on the interface removed");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing, src1, dst), 0, "no route left");
+
+  Simulator::Destroy ();
+}
+
+static class Ipv6StaticSourceRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv6StaticSourceRoutingTestSuite ()
+    : TestSuite ("pmip6-ipv6-static-source-routing", UNIT)
+  {
+    AddTestCase (new Ipv6StaticSourceRoutingTestCase ());
+  }
+} g_ipv6StaticSourceRoutingTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,290 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ipv6-static-routing.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/identifier.h"
+#include "ns3/ipv6-mobility-header.h"
+#include "ns3/pmipv6-lma.h"
+#include "ns3/pmipv6-mag.h"
+#include "ns3/pmipv6-mag-notifier.h"
+#include "ns3/pmipv6-lma-cluster.h"
+#include "ns3/pmip6-helper.h"
+
+#include "pmip6-test-helper.h"
+
+#include <stdio.h>
+#include <vector>
+
+namespace ns3 {
+
+static Identifier
+MakeNai (uint32_t i)
+{
+  char nai[32];
+
+  sprintf (nai, "mn%u@example.com", i);
+  return Identifier (nai);
+}
+
+class LmaClusterRingTestCase : public TestCase
+{
+public:
+  LmaClusterRingTestCase ();
+  virtual void DoRun (void);
+};
+
+LmaClusterRingTestCase::LmaClusterRingTestCase ()
+  : TestCase ("Check MN spread and movement on the consistent hash ring")
+{
+}
+
+void
+LmaClusterRingTestCase::DoRun (void)
+{
+  const uint32_t nMns = 10000;
+  const uint32_t nLmas = 4;
+  Ptr<Pmipv6LmaCluster> cluster = CreateObject<Pmipv6LmaCluster> ();
+  std::vector<Ipv6Address> before;
+
+  NS_TEST_ASSERT_MSG_EQ (cluster->Lookup (MakeNai (0)), Ipv6Address::GetAny (), "empty ring serves no MN");
+
+  cluster->AddLma (Ipv6Address ("2001:2::1"));
+  cluster->AddLma (Ipv6Address ("2001:2::2"));
+  cluster->AddLma (Ipv6Address ("2001:2::3"));
+  cluster->AddLma (Ipv6Address ("2001:2::4"));
+  NS_TEST_ASSERT_MSG_EQ (cluster->GetNLmas (), nLmas, "four LMAs");
+
+  for (uint32_t i = 0; i < nMns; i++)
+    {
+      Ipv6Address lma = cluster->Place (MakeNai (i));
+
+      NS_TEST_ASSERT_MSG_EQ (cluster->Lookup (MakeNai (i)), lma, "lookup is stable");
+      before.push_back (lma);
+    }
+
+  for (uint32_t i = 0; i < nLmas; i++)
+    {
+      uint64_t n = cluster->GetNPlacements (cluster->GetLma (i));
+
+      NS_TEST_ASSERT_MSG_GT (n, nMns / nLmas / 2, "LMA under-loaded");
+      NS_TEST_ASSERT_MSG_LT (n, nMns / nLmas * 3 / 2, "LMA over-loaded");
+      NS_TEST_ASSERT_MSG_EQ (cluster->GetLoad (cluster->GetLma (i)), n, "no placement released yet");
+    }
+
+  cluster->Release (before[0]);
+  NS_TEST_ASSERT_MSG_EQ (cluster->GetLoad (before[0]), cluster->GetNPlacements (before[0]) - 1, "release lowers the load");
+  cluster->Release (Ipv6Address::GetAny ());
+  cluster->Release (Ipv6Address ("2001:2::5"));
+
+  Ipv6Address added ("2001:2::5");
+  uint32_t moved = 0;
+
+  cluster->AddLma (added);
+  for (uint32_t i = 0; i < nMns; i++)
+    {
+      Ipv6Address lma = cluster->Lookup (MakeNai (i));
+
+      if (lma != before[i])
+        {
+          NS_TEST_ASSERT_MSG_EQ (lma, added, "MNs only move to the new LMA");
+          moved++;
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (moved, nMns / 10, "new LMA takes its share");
+  NS_TEST_ASSERT_MSG_LT (moved, nMns * 3 / 10, "about 1/n of the MNs move");
+
+  cluster->RemoveLma (added);
+  for (uint32_t i = 0; i < nMns; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (cluster->Lookup (MakeNai (i)), before[i], "removal restores the ring");
+    }
+
+  /* the ring left by a removal is the ring of the remaining LMAs */
+  Ptr<Pmipv6LmaCluster> remaining = CreateObject<Pmipv6LmaCluster> ();
+  remaining->AddLma (Ipv6Address ("2001:2::2"));
+  remaining->AddLma (Ipv6Address ("2001:2::3"));
+  remaining->AddLma (Ipv6Address ("2001:2::4"));
+
+  cluster->RemoveLma (Ipv6Address ("2001:2::1"));
+  for (uint32_t i = 0; i < nMns; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (cluster->Lookup (MakeNai (i)), remaining->Lookup (MakeNai (i)), "removal rebuilds the ring");
+    }
+}
+
+/*
+ * LMA1       LMA2
+ *    \        /
+ *     +-MAG-+
+ *        |
+ *      (MNs)
+ *
+ * The MNs register on LMA1 alone, then LMA2 joins the cluster and the
+ * MAG moves its share of the bindings over. LMA2 joins either once the
+ * bindings are established or while their PBUs are in flight.
+ */
+class LmaClusterRehomeTestCase : public TestCase
+{
+public:
+  LmaClusterRehomeTestCase (Time join);
+  virtual void DoRun (void);
+
+private:
+  void CheckRegistered (Ptr<Pmipv6Lma> lma1, Ptr<Pmipv6Lma> lma2);
+
+  uint32_t m_nMns;
+  Time m_join;
+};
+
+LmaClusterRehomeTestCase::LmaClusterRehomeTestCase (Time join)
+  : TestCase ("Check re-homing of bindings when an LMA joins the cluster"),
+    m_nMns (40),
+    m_join (join)
+{
+}
+
+void
+LmaClusterRehomeTestCase::CheckRegistered (Ptr<Pmipv6Lma> lma1, Ptr<Pmipv6Lma> lma2)
+{
+  NS_TEST_EXPECT_MSG_EQ (lma1->GetNBindings (), m_nMns, "all MNs on LMA1 before LMA2 joins");
+  NS_TEST_EXPECT_MSG_EQ (lma2->GetNBindings (), 0, "no MN on LMA2 before it joins");
+}
+
+void
+LmaClusterRehomeTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  Ptr<Node> lma1 = nodes.Get (0);
+  Ptr<Node> lma2 = nodes.Get (1);
+  Ptr<Node> mag = nodes.Get (2);
+
+  InstallIpv6Stack (nodes, mag);
+
+  /* one link per LMA, a shared one would have every node forward every frame */
+  Ptr<SimpleChannel> backhaul1 = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> backhaul2 = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> access = CreateObject<SimpleChannel> ();
+
+  AddSimpleLink (lma1, backhaul1, "2001:2::1");
+  AddSimpleLink (mag, backhaul1, "2001:2::2");
+  uint32_t lma2If = AddSimpleLink (lma2, backhaul2, "2001:4::1");
+  AddSimpleLink (mag, backhaul2, "2001:4::2");
+  uint32_t accessIf = AddSimpleLink (mag, access, "2001:3::1");
+
+  /* LMA2 reaches the proxy-CoA of the MAG through its own link */
+  Ipv6StaticRoutingHelper routingHelper;
+  routingHelper.GetStaticRouting (lma2->GetObject<Ipv6> ())->SetDefaultRoute (Ipv6Address ("2001:4::2"), lma2If);
+
+  Pmip6ProfileHelper profile;
+  std::list<Ipv6Address> hnps;
+  std::list<Mac48Address> mns;
+
+  for (uint32_t i = 0; i < m_nMns; i++)
+    {
+      Mac48Address mn = Mac48Address::Allocate ();
+
+      profile.AddProfile (MakeNai (i), Identifier (mn), Ipv6Address ("2001:2::1"), hnps);
+      mns.push_back (mn);
+    }
+
+  /* disjoint pools, so that a re-homed MN never meets its old prefix */
+  Pmip6LmaHelper lmaHelper;
+  lmaHelper.SetProfileHelper (&profile);
+  lmaHelper.SetPrefixPoolRange (0, 1000);
+  lmaHelper.Install (lma1);
+  lmaHelper.SetPrefixPoolRange (1000, 1000);
+  lmaHelper.Install (lma2);
+
+  Ptr<Pmipv6LmaCluster> cluster = CreateObject<Pmipv6LmaCluster> ();
+  cluster->AddLma (Ipv6Address ("2001:2::1"));
+
+  Pmip6MagHelper magHelper;
+  magHelper.SetProfileHelper (&profile);
+  magHelper.SetLmaCluster (cluster);
+  magHelper.Install (mag, Ipv6Address ("2001:2::2"), NodeContainer ());
+
+  Ptr<Pmipv6Mag> magAgent = mag->GetObject<Pmipv6Mag> ();
+  Ptr<Pmipv6Lma> lma1Agent = lma1->GetObject<Pmipv6Lma> ();
+  Ptr<Pmipv6Lma> lma2Agent = lma2->GetObject<Pmipv6Lma> ();
+
+  Ptr<Pmipv6MagNotifier> notifier = mag->GetObject<Pmipv6MagNotifier> ();
+  Ptr<Ipv6Interface> interface = mag->GetObject<Ipv6L3Protocol> ()->GetInterface (accessIf);
+  /* all attach at once, so that a join at the same time sees every PBU in flight */
+  for (std::list<Mac48Address>::iterator i = mns.begin (); i != mns.end (); i++)
+    {
+      Simulator::Schedule (Seconds (2.0), &NotifyMagAttach, notifier, interface, (*i),
+                           (uint8_t) Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+    }
+
+  if (m_join > Seconds (4.0))
+    {
+      Simulator::Schedule (Seconds (4.0), &LmaClusterRehomeTestCase::CheckRegistered, this, lma1Agent, lma2Agent);
+    }
+  Simulator::Schedule (m_join, &Pmipv6LmaCluster::AddLma, cluster, Ipv6Address ("2001:4::1"));
+
+  /* the old LMA keeps a deregistered entry for MIN_DELAY_BEFORE_BCE_DELETE */
+  Simulator::Stop (Seconds (17.0));
+  Simulator::Run ();
+
+  uint32_t moved = 0;
+  for (uint32_t i = 0; i < m_nMns; i++)
+    {
+      if (cluster->Lookup (MakeNai (i)) == Ipv6Address ("2001:4::1"))
+        {
+          moved++;
+        }
+    }
+
+  NS_TEST_EXPECT_MSG_GT (moved, 0, "LMA2 takes a share of the MNs");
+  NS_TEST_EXPECT_MSG_LT (moved, m_nMns, "LMA1 keeps a share of the MNs");
+  NS_TEST_EXPECT_MSG_EQ (magAgent->GetNRehomed (), moved, "MAG re-homes every moved MN");
+  NS_TEST_EXPECT_MSG_EQ (lma2Agent->GetNBindings (), moved, "moved MNs are bound on LMA2");
+  NS_TEST_EXPECT_MSG_EQ (lma1Agent->GetNBindings (), m_nMns - moved, "LMA1 drops the moved MNs");
+  NS_TEST_EXPECT_MSG_EQ (cluster->GetNPlacements (Ipv6Address ("2001:2::1")), m_nMns, "one placement per attach");
+  NS_TEST_EXPECT_MSG_EQ (cluster->GetNPlacements (Ipv6Address ("2001:4::1")), moved, "one placement per re-home");
+  NS_TEST_EXPECT_MSG_EQ (cluster->GetLoad (Ipv6Address ("2001:2::1")), m_nMns - moved, "moved MNs leave the load of LMA1");
+  NS_TEST_EXPECT_MSG_EQ (cluster->GetLoad (Ipv6Address ("2001:4::1")), moved, "moved MNs load LMA2");
+
+  Simulator::Destroy ();
+}
+
+static class LmaClusterTestSuite : public TestSuite
+{
+public:
+  LmaClusterTestSuite ()
+    : TestSuite ("pmip6-lma-cluster", UNIT)
+  {
+    AddTestCase (new LmaClusterRingTestCase ());
+    AddTestCase (new LmaClusterRehomeTestCase (Seconds (5.0)));
+    AddTestCase (new LmaClusterRehomeTestCase (Seconds (2.0)));
+  }
+} g_lmaClusterTestSuite;
+
+} /* namespace ns3 */
@@ -0,0 +1,480 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <list>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/mac48-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/identifier.h"
+#include "ns3/ipv6-mobility.h"
+#include "ns3/ipv6-mobility-demux.h"
+#include "ns3/ipv6-mobility-header.h"
+#include "ns3/ipv6-mobility-l4-protocol.h"
+#include "ns3/ipv6-mobility-option.h"
+#include "ns3/ipv6-mobility-option-header.h"
+
+namespace ns3 {
+
+/**
+ * \brief Build a PBU the way Pmipv6Mag::BuildPbu does, with two home
+ * network prefixes and a MAG link-local address.
+ */
+static Ptr<Packet>
+BuildPbu (void)
+{
+  Ptr<Packet> p = Create<Packet> ();
+
+  Ipv6MobilityBindingUpdateHeader pbu;
+
+  Ipv6MobilityOptionMobileNodeIdentifierHeader mnidh;
+  Ipv6MobilityOptionHomeNetworkPrefixHeader hnph;
+  Ipv6MobilityOptionHandoffIndicatorHeader hih;
+  Ipv6MobilityOptionAccessTechnologyTypeHeader atth;
+  Ipv6MobilityOptionMobileNodeLinkLayerIdentifierHeader mnllidh;
+  Ipv6MobilityOptionLinkLocalAddressHeader llah;
+  Ipv6MobilityOptionTimestampHeader timestamph;
+
+  pbu.SetSequence (7);
+  pbu.SetFlagA (true);
+  pbu.SetFlagH (true);
+  pbu.SetFlagL (true);
+  pbu.SetFlagP (true);
+  pbu.SetLifetime ((uint16_t)Ipv6MobilityL4Protocol::MAX_BINDING_LIFETIME);
+
+  mnidh.SetSubtype (1);
+  mnidh.SetNodeIdentifier (Identifier ("mn-000001@pmip6.example.net"));
+  pbu.AddOption (mnidh);
+
+  hnph.SetPrefix (Ipv6Address ("3ffe:1:4:1::"));
+  hnph.SetPrefixLength (64);
+  pbu.AddOption (hnph);
+  hnph.SetPrefix (Ipv6Address ("3ffe:1:4:2::"));
+  pbu.AddOption (hnph);
+
+  hih.SetHandoffIndicator (Ipv6MobilityHeader::OPT_HI_HANDOFF_BETWEEN_MAGS_FOR_SAME_INTERFACE);
+  pbu.AddOption (hih);
+
+  atth.SetAccessTechnologyType (Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+  pbu.AddOption (atth);
+
+  mnllidh.SetLinkLayerIdentifier (Identifier (Mac48Address ("00:00:00:00:00:01")));
+  pbu.AddOption (mnllidh);
+
+  llah.SetLinkLocalAddress (Ipv6Address ("fe80::1"));
+  pbu.AddOption (llah);
+
+  timestamph.SetTimestamp (MicroSeconds (123456789));
+  pbu.AddOption (timestamph);
+
+  p->AddHeader (pbu);
+
+  return p;
+}
+
+/**
+ * \brief The former option walk: copy the packet and its bytes, then let
+ * every option copy the packet again to deserialize itself.
+ */
+static uint8_t
+LegacyProcessOptions (Ptr<Packet> packet, uint8_t offset, uint8_t length, Ipv6MobilityOptionBundle &bundle)
+{
+  Ptr<Packet> p = packet->Copy ();
+  p->RemoveAtStart (offset);
+
+  uint8_t processedSize = 0;
+  uint32_t size = p->GetSize ();
+  uint8_t *data = new uint8_t[size];
+  p->CopyData (data, size);
+
+  while (processedSize < length)
+    {
+      uint8_t optType = data[processedSize];
+      uint8_t optLen;
+      Ptr<Packet> q = packet->Copy ();
+
+      q->RemoveAtStart (offset + processedSize);
+
+      switch (optType)
+        {
+        case Ipv6MobilityHeader::IPV6_MOBILITY_OPT_MOBILE_NODE_IDENTIFIER:
+          {
+            Ipv6MobilityOptionMobileNodeIdentifierHeader nai;
+            q->RemoveHeader (nai);
+            bundle.SetMnIdentifier (nai.GetNodeIdentifier ());
+            optLen = nai.GetSerializedSize ();
+            break;
+          }
+        case Ipv6MobilityHeader::IPV6_MOBILITY_OPT_HOME_NETWORK_PREFIX:
+          {
+            Ipv6MobilityOptionHomeNetworkPrefixHeader hnp;
+            q->RemoveHeader (hnp);
+            bundle.AddHomeNetworkPrefix (hnp.GetPrefix ());
+            optLen = hnp.GetSerializedSize ();
+            break;
+          }
+        case Ipv6MobilityHeader::IPV6_MOBILITY_OPT_HANDOFF_INDICATOR:
+          {
+            Ipv6MobilityOptionHandoffIndicatorHeader hi;
+            q->RemoveHeader (hi);
+            bundle.SetHandoffIndicator (hi.GetHandoffIndicator ());
+            optLen = hi.GetSerializedSize ();
+            break;
+          }
+        case Ipv6MobilityHeader::IPV6_MOBILITY_OPT_ACCESS_TECHNOLOGY_TYPE:
+          {
+            Ipv6MobilityOptionAccessTechnologyTypeHeader att;
+            q->RemoveHeader (att);
+            bundle.SetAccessTechnologyType (att.GetAccessTechnologyType ());
+            optLen = att.GetSerializedSize ();
+            break;
+          }
+        case Ipv6MobilityHeader::IPV6_MOBILITY_OPT_MOBILE_NODE_LINK_LAYER_IDENTIFIER:
+          {
+            Ipv6MobilityOptionMobileNodeLinkLayerIdentifierHeader mnllid;
+            q->RemoveHeader (mnllid);
+            bundle.SetMnLinkIdentifier (mnllid.GetLinkLayerIdentifier ());
+            optLen = mnllid.GetSerializedSize ();
+            break;
+          }
+        case Ipv6MobilityHeader::IPV6_MOBILITY_OPT_LINK_LOCAL_ADDRESS:
+          {
+            Ipv6MobilityOptionLinkLocalAddressHeader lla;
+            q->RemoveHeader (lla);
+            bundle.SetMagLinkAddress (lla.GetLinkLocalAddress ());
+            optLen = lla.GetSerializedSize ();
+            break;
+          }
+        case Ipv6MobilityHeader::IPV6_MOBILITY_OPT_TIMESTAMP:
+          {
+            Ipv6MobilityOptionTimestampHeader timestamp;
+            q->RemoveHeader (timestamp);
+            bundle.SetTimestamp (timestamp.GetTimestamp ());
+            optLen = timestamp.GetSerializedSize ();
+            break;
+          }
+        case Ipv6MobilityHeader::IPV6_MOBILITY_OPT_PAD1:
+          optLen = 1;
+          break;
+        default:
+          optLen = data[processedSize + 1] + 2;
+          break;
+        }
+
+      processedSize += optLen;
+      p->RemoveAtStart (optLen);
+    }
+
+  delete [] data;
+
+  return processedSize;
+}
+
+/**
+ * \brief Node with the mobility and mobility option demuxes of an LMA.
+ */
+static Ptr<Ipv6Mobility>
+CreateBindingUpdateHandler (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (node);
+
+  Ptr<Ipv6MobilityL4Protocol> mipv6 = CreateObject<Ipv6MobilityL4Protocol> ();
+  node->AggregateObject (mipv6);
+  mipv6->RegisterMobility ();
+  mipv6->RegisterMobilityOptions ();
+
+  return node->GetObject<Ipv6MobilityDemux> ()->GetMobility (Ipv6MobilityHeader::IPV6_MOBILITY_BINDING_UPDATE);
+}
+
+static uint8_t
+GetOptionsLength (Ipv6MobilityBindingUpdateHeader &pbu)
+{
+  return ((pbu.GetHeaderLen () + 1) << 3) - pbu.GetOptionsOffset ();
+}
+
+class PbuParsingTestCase : public TestCase
+{
+public:
+  PbuParsingTestCase ();
+  virtual void DoRun (void);
+};
+
+PbuParsingTestCase::PbuParsingTestCase ()
+  : TestCase ("Check single-pass mobility option parsing of a PBU")
+{
+}
+
+void
+PbuParsingTestCase::DoRun (void)
+{
+  Ptr<Ipv6Mobility> mobility = CreateBindingUpdateHandler ();
+  Ptr<Packet> packet = BuildPbu ();
+  uint32_t size = packet->GetSize ();
+
+  Ipv6MobilityBindingUpdateHeader pbu;
+  packet->PeekHeader (pbu);
+  uint8_t length = GetOptionsLength (pbu);
+
+  Ipv6MobilityOptionBundle bundle;
+  Buffer options = pbu.GetOptionBuffer ();
+  NS_TEST_ASSERT_MSG_EQ (options.GetSize (), (uint32_t)length, "Option buffer length");
+  uint32_t processed = mobility->ProcessOptions (options.Begin (), options.GetSize (), bundle);
+
+  NS_TEST_ASSERT_MSG_EQ (processed, (uint32_t)length, "Options not fully walked");
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), size, "Packet modified by parsing");
+
+  NS_TEST_ASSERT_MSG_EQ ((bundle.GetMnIdentifier () == Identifier ("mn-000001@pmip6.example.net")), true, "MN identifier");
+  NS_TEST_ASSERT_MSG_EQ ((bundle.GetMnLinkIdentifier () == Identifier (Mac48Address ("00:00:00:00:00:01"))), true, "MN link-layer identifier");
+
+  std::list<Ipv6Address> hnps = bundle.GetHomeNetworkPrefixes ();
+  NS_TEST_ASSERT_MSG_EQ (hnps.size (), 2, "Home network prefixes");
+  NS_TEST_ASSERT_MSG_EQ (hnps.front (), Ipv6Address ("3ffe:1:4:1::"), "First home network prefix");
+  NS_TEST_ASSERT_MSG_EQ (hnps.back (), Ipv6Address ("3ffe:1:4:2::"), "Second home network prefix");
+
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)bundle.GetHandoffIndicator (), (uint32_t)Ipv6MobilityHeader::OPT_HI_HANDOFF_BETWEEN_MAGS_FOR_SAME_INTERFACE, "Handoff indicator");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t)bundle.GetAccessTechnologyType (), (uint32_t)Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG, "Access technology type");
+  NS_TEST_ASSERT_MSG_EQ (bundle.GetMagLinkAddress (), Ipv6Address ("fe80::1"), "MAG link-local address");
+  NS_TEST_ASSERT_MSG_EQ (bundle.GetTimestamp (), MicroSeconds (123456789), "Timestamp");
+
+  //the former walk must agree
+  Ipv6MobilityOptionBundle legacy;
+  processed = LegacyProcessOptions (packet, pbu.GetOptionsOffset (), length, legacy);
+
+  NS_TEST_ASSERT_MSG_EQ (processed, (uint32_t)length, "Legacy walk length");
+  NS_TEST_ASSERT_MSG_EQ ((legacy.GetMnIdentifier () == bundle.GetMnIdentifier ()), true, "Legacy MN identifier");
+  NS_TEST_ASSERT_MSG_EQ ((legacy.GetHomeNetworkPrefixes () == hnps), true, "Legacy home network prefixes");
+  NS_TEST_ASSERT_MSG_EQ (legacy.GetTimestamp (), bundle.GetTimestamp (), "Legacy timestamp");
+
+  //a PBA keeps all its options across deserialization
+  Ipv6MobilityBindingAckHeader pba;
+  Ipv6MobilityOptionMobileNodeIdentifierHeader mnidh;
+  Ipv6MobilityOptionTimestampHeader timestamph;
+
+  pba.SetFlagP (true);
+  mnidh.SetSubtype (1);
+  mnidh.SetNodeIdentifier (Identifier ("mn-000001@pmip6.example.net"));
+  pba.AddOption (mnidh);
+  timestamph.SetTimestamp (MicroSeconds (123456789));
+  pba.AddOption (timestamph);
+
+  Ptr<Packet> pbaPacket = Create<Packet> ();
+  pbaPacket->AddHeader (pba);
+
+  Ipv6MobilityBindingAckHeader received;
+  Ipv6MobilityOptionBundle pbaBundle;
+  pbaPacket->PeekHeader (received);
+  options = received.GetOptionBuffer ();
+  mobility->ProcessOptions (options.Begin (), options.GetSize (), pbaBundle);
+
+  NS_TEST_ASSERT_MSG_EQ (options.GetSize (), pbaPacket->GetSize () - received.GetOptionsOffset (), "PBA option buffer length");
+  NS_TEST_ASSERT_MSG_EQ ((pbaBundle.GetMnIdentifier () == mnidh.GetNodeIdentifier ()), true, "PBA MN identifier");
+  NS_TEST_ASSERT_MSG_EQ (pbaBundle.GetTimestamp (), MicroSeconds (123456789), "PBA timestamp");
+
+  Simulator::Destroy ();
+}
+
+class TruncatedOptionTestCase : public TestCase
+{
+public:
+  TruncatedOptionTestCase ();
+  virtual void DoRun (void);
+};
+
+TruncatedOptionTestCase::TruncatedOptionTestCase ()
+  : TestCase ("Check a truncated mobility option is not dispatched")
+{
+}
+
+void
+TruncatedOptionTestCase::DoRun (void)
+{
+  Ptr<Ipv6Mobility> mobility = CreateBindingUpdateHandler ();
+
+  Ipv6MobilityOptionMobileNodeIdentifierHeader mnidh;
+  mnidh.SetSubtype (1);
+  mnidh.SetNodeIdentifier (Identifier ("mn-000001@pmip6.example.net"));
+
+  Buffer options;
+  options.AddAtEnd (mnidh.GetSerializedSize ());
+  mnidh.Serialize (options.Begin ());
+  uint32_t valid = options.GetSize ();
+
+  /* an MN identifier claiming 40 bytes with 4 left */
+  options.AddAtEnd (4);
+  Buffer::Iterator i = options.Begin ();
+  i.Next (valid);
+  i.WriteU8 (Ipv6MobilityHeader::IPV6_MOBILITY_OPT_MOBILE_NODE_IDENTIFIER);
+  i.WriteU8 (40);
+  i.WriteU8 (1);
+  i.WriteU8 ('x');
+
+  Ipv6MobilityOptionBundle bundle;
+  uint32_t processed = mobility->ProcessOptions (options.Begin (), options.GetSize (), bundle);
+
+  NS_TEST_ASSERT_MSG_EQ (processed, valid, "Walk not stopped at the truncated option");
+  NS_TEST_ASSERT_MSG_EQ ((bundle.GetMnIdentifier () == Identifier ("mn-000001@pmip6.example.net")), true, "Truncated option dispatched");
+
+  /* a last option type without its length byte */
+  Ipv6MobilityOptionBundle bundle2;
+  processed = mobility->ProcessOptions (options.Begin (), valid + 1, bundle2);
+
+  NS_TEST_ASSERT_MSG_EQ (processed, valid, "Walk not stopped at the option without length");
+
+  Simulator::Destroy ();
+}
+
+class LongOptionTestCase : public TestCase
+{
+public:
+  LongOptionTestCase ();
+  virtual void DoRun (void);
+};
+
+LongOptionTestCase::LongOptionTestCase ()
+  : TestCase ("Check mobility options of 256 bytes and more are walked")
+{
+}
+
+void
+LongOptionTestCase::DoRun (void)
+{
+  Ptr<Ipv6Mobility> mobility = CreateBindingUpdateHandler ();
+
+  /* PadN options with length bytes of 254 and 255, then an MN identifier */
+  Buffer options;
+  options.AddAtEnd (256 + 257);
+  Buffer::Iterator i = options.Begin ();
+  i.WriteU8 (Ipv6MobilityHeader::IPV6_MOBILITY_OPT_PADN);
+  i.WriteU8 (254);
+  i.WriteU8 (0, 254);
+  i.WriteU8 (Ipv6MobilityHeader::IPV6_MOBILITY_OPT_PADN);
+  i.WriteU8 (255);
+  i.WriteU8 (0, 255);
+
+  Ipv6MobilityOptionMobileNodeIdentifierHeader mnidh;
+  mnidh.SetSubtype (1);
+  mnidh.SetNodeIdentifier (Identifier ("mn-000001@pmip6.example.net"));
+  options.AddAtEnd (mnidh.GetSerializedSize ());
+  i = options.Begin ();
+  i.Next (256 + 257);
+  mnidh.Serialize (i);
+
+  Ipv6MobilityOptionBundle bundle;
+  uint32_t processed = mobility->ProcessOptions (options.Begin (), options.GetSize (), bundle);
+
+  NS_TEST_ASSERT_MSG_EQ (processed, options.GetSize (), "Long options not fully walked");
+  NS_TEST_ASSERT_MSG_EQ ((bundle.GetMnIdentifier () == Identifier ("mn-000001@pmip6.example.net")), true, "Option after the long ones");
+
+  Simulator::Destroy ();
+}
+
+class PbuParsingCostTestCase : public TestCase
+{
+public:
+  PbuParsingCostTestCase ();
+  virtual void DoRun (void);
+};
+
+PbuParsingCostTestCase::PbuParsingCostTestCase ()
+  : TestCase ("Measure PBU option parsing rate")
+{
+}
+
+void
+PbuParsingCostTestCase::DoRun (void)
+{
+  const uint32_t nPbu = 200000;
+
+  Ptr<Ipv6Mobility> mobility = CreateBindingUpdateHandler ();
+  Ptr<Packet> packet = BuildPbu ();
+
+  Ipv6MobilityBindingUpdateHeader pbu;
+  packet->PeekHeader (pbu);
+  uint8_t offset = pbu.GetOptionsOffset ();
+  uint8_t length = GetOptionsLength (pbu);
+
+  SystemWallClockMs clock;
+  uint32_t legacyBytes = 0;
+  uint32_t currentBytes = 0;
+
+  clock.Start ();
+  for (uint32_t i = 0; i < nPbu; i++)
+    {
+      Ipv6MobilityBindingUpdateHeader h;
+      Ipv6MobilityOptionBundle bundle;
+      Ptr<Packet> p = packet->Copy ();
+
+      p->RemoveHeader (h);
+      legacyBytes += LegacyProcessOptions (packet, offset, length, bundle);
+    }
+  int64_t legacyMs = clock.End ();
+
+  clock.Start ();
+  for (uint32_t i = 0; i < nPbu; i++)
+    {
+      Ipv6MobilityBindingUpdateHeader h;
+      Ipv6MobilityOptionBundle bundle;
+
+      packet->PeekHeader (h);
+      Buffer options = h.GetOptionBuffer ();
+      currentBytes += mobility->ProcessOptions (options.Begin (), options.GetSize (), bundle);
+    }
+  int64_t currentMs = clock.End ();
+
+  std::cout << "PBU parsing for " << nPbu << " PBUs: legacy "
+            << legacyMs << " ms (" << (legacyMs * 1e6 / nPbu) << " ns/PBU), single pass "
+            << currentMs << " ms (" << (currentMs * 1e6 / nPbu) << " ns/PBU)" << std::endl;
+
+  NS_TEST_ASSERT_MSG_EQ (currentBytes, legacyBytes, "Walks disagree on the options length");
+
+  Simulator::Destroy ();
+}
+
+static class PbuParsingTestSuite : public TestSuite
+{
+public:
+  PbuParsingTestSuite ()
+    : TestSuite ("pmip6-pbu-parsing", UNIT)
+  {
+    AddTestCase (new PbuParsingTestCase ());
+    AddTestCase (new TruncatedOptionTestCase ());
+    AddTestCase (new LongOptionTestCase ());
+  }
+} g_pbuParsingTestSuite;
+
+static class PbuParsingPerfTestSuite : public TestSuite
+{
+public:
+  PbuParsingPerfTestSuite ()
+    : TestSuite ("pmip6-pbu-parsing-perf", PERFORMANCE)
+  {
+    AddTestCase (new PbuParsingCostTestCase ());
+  }
+} g_pbuParsingPerfTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,85 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pmip6-test-helper.h"
+
+#include "ns3/simple-net-device.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/ipv6.h"
+#include "ns3/packet.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/ipv6-mobility-header.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+void
+InstallIpv6Stack (NodeContainer nodes, NodeContainer mags)
+{
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (nodes);
+
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (mags);
+}
+
+uint32_t
+AddSimpleLink (Ptr<Node> node, Ptr<SimpleChannel> channel, const char *address)
+{
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  device->SetChannel (channel);
+  node->AddDevice (device);
+
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+  uint32_t ifIndex = ipv6->AddInterface (device);
+  ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (Ipv6Address (address), Ipv6Prefix (64)));
+  ipv6->SetForwarding (ifIndex, true);
+  ipv6->SetUp (ifIndex);
+  return ifIndex;
+}
+
+void
+NotifyMagAttach (Ptr<Pmipv6MagNotifier> notifier, Ptr<Ipv6Interface> interface, Mac48Address mn, uint8_t att)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  Pmipv6MagNotifyHeader header;
+
+  header.SetMacAddress (mn);
+  header.SetAccessTechnologyType (att);
+  packet->AddHeader (header);
+
+  notifier->Receive (packet, Ipv6Address::GetAny (), Ipv6Address::GetAny (), interface);
+}
+
+static void
+Probe (void)
+{
+}
+
+uint64_t
+GetEventUid (void)
+{
+  EventId probe = Simulator::ScheduleNow (&Probe);
+  Simulator::Cancel (probe);
+  return probe.GetUid ();
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,69 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PMIP6_TEST_HELPER_H
+#define PMIP6_TEST_HELPER_H
+
+#include <stdint.h>
+
+#include "ns3/ptr.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/pmipv6-mag-notifier.h"
+
+namespace ns3 {
+
+/**
+ * \brief Install an IPv6-only internet stack on the nodes of a test topology.
+ * \param nodes all the nodes
+ * \param mags the MAGs among them, which also get packet sockets to send
+ * their router advertisements on
+ */
+void InstallIpv6Stack (NodeContainer nodes, NodeContainer mags = NodeContainer ());
+
+/**
+ * \brief Connect a node to a channel with a forwarding /64 interface.
+ * \param node the node
+ * \param channel the channel
+ * \param address the address of the interface
+ * \returns the interface index
+ */
+uint32_t AddSimpleLink (Ptr<Node> node, Ptr<SimpleChannel> channel, const char *address);
+
+/**
+ * \brief Notify a MAG that an MN came up on one of its access links, as
+ * a remote AP would.
+ * \param notifier the notifier of the MAG
+ * \param interface the access interface
+ * \param mn the MAC address of the MN
+ * \param att the access technology type
+ */
+void NotifyMagAttach (Ptr<Pmipv6MagNotifier> notifier, Ptr<Ipv6Interface> interface, Mac48Address mn, uint8_t att);
+
+/**
+ * \brief Get the uid of a probe event, scheduled now and cancelled.
+ * \returns the uid, which grows by one with every event scheduled
+ */
+uint64_t GetEventUid (void);
+
+} /* namespace ns3 */
+
+#endif /* PMIP6_TEST_HELPER_H */
@@ -0,0 +1,266 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <set>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/identifier.h"
+#include "ns3/ipv6-mobility-header.h"
+#include "ns3/ipv6-mobility-l4-protocol.h"
+#include "ns3/pmipv6-lma.h"
+#include "ns3/pmipv6-mag.h"
+#include "ns3/pmipv6-mag-notifier.h"
+#include "ns3/pmipv6-prefix-pool.h"
+#include "ns3/pmipv6-profile.h"
+#include "ns3/pmip6-helper.h"
+
+#include "pmip6-test-helper.h"
+
+#include <stdio.h>
+
+namespace ns3 {
+
+class PrefixPoolTestCase : public TestCase
+{
+public:
+  PrefixPoolTestCase ();
+  virtual void DoRun (void);
+};
+
+PrefixPoolTestCase::PrefixPoolTestCase ()
+  : TestCase ("Check prefix assignment, release and reuse")
+{
+}
+
+void
+PrefixPoolTestCase::DoRun (void)
+{
+  Ipv6Address base ("3ffe:1:4::");
+
+  //the whole base starts with the same first prefix as before
+  Pmipv6PrefixPool all (base, 48);
+  NS_TEST_ASSERT_MSG_EQ (all.Assign (), Ipv6Address ("3ffe:1:4:1::"), "First prefix of the base");
+  NS_TEST_ASSERT_MSG_EQ (all.GetCapacity (), 65535, "Capacity of a /48 base");
+
+  Pmipv6PrefixPool pool (base, 48, 1, 4);
+
+  for (uint32_t i = 1; i <= 4; i++)
+    {
+      char prefix[32];
+
+      sprintf (prefix, "3ffe:1:4:%u::", i);
+      NS_TEST_ASSERT_MSG_EQ (pool.Assign (), Ipv6Address (prefix), "Prefix " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (pool.Assign (), Ipv6Address::GetAny (), "Exhausted pool assigned a prefix");
+  NS_TEST_ASSERT_MSG_EQ (pool.GetNExhausted (), 1, "Exhaustion not counted");
+  NS_TEST_ASSERT_MSG_EQ (pool.GetNAssigned (), 4, "Assigned count");
+
+  NS_TEST_ASSERT_MSG_EQ (pool.Release (Ipv6Address ("3ffe:1:4:2::")), true, "Release");
+  NS_TEST_ASSERT_MSG_EQ (pool.Release (Ipv6Address ("3ffe:1:4:2::")), false, "Double release");
+  NS_TEST_ASSERT_MSG_EQ (pool.Release (Ipv6Address ("3ffe:1:5:1::")), false, "Release of another base");
+  NS_TEST_ASSERT_MSG_EQ (pool.Release (Ipv6Address ("3ffe:1:4:9::")), false, "Release outside of the range");
+  NS_TEST_ASSERT_MSG_EQ (pool.IsAssigned (Ipv6Address ("3ffe:1:4:2::")), false, "Released prefix still assigned");
+  NS_TEST_ASSERT_MSG_EQ (pool.Assign (), Ipv6Address ("3ffe:1:4:2::"), "Released prefix not reused");
+
+  //oldest release first
+  pool.Release (Ipv6Address ("3ffe:1:4:3::"));
+  pool.Release (Ipv6Address ("3ffe:1:4:1::"));
+  NS_TEST_ASSERT_MSG_EQ (pool.Assign (), Ipv6Address ("3ffe:1:4:3::"), "Reuse order");
+  NS_TEST_ASSERT_MSG_EQ (pool.Assign (), Ipv6Address ("3ffe:1:4:1::"), "Reuse order");
+  NS_TEST_ASSERT_MSG_EQ (pool.GetMaxAssigned (), 4, "Peak occupation");
+
+  //disjoint ranges of one base
+  Pmipv6PrefixPool first (base, 48, 1, 100);
+  Pmipv6PrefixPool second (base, 48, 101, 100);
+
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Ipv6Address a = first.Assign ();
+      Ipv6Address b = second.Assign ();
+
+      NS_TEST_ASSERT_MSG_EQ (second.IsAssigned (a), false, "Pools overlap");
+      NS_TEST_ASSERT_MSG_EQ (first.IsAssigned (b), false, "Pools overlap");
+      NS_TEST_ASSERT_MSG_EQ (second.Release (a), false, "Release to the wrong pool");
+    }
+  NS_TEST_ASSERT_MSG_EQ (first.Assign (), Ipv6Address::GetAny (), "First pool not exhausted");
+  NS_TEST_ASSERT_MSG_EQ (second.Assign (), Ipv6Address::GetAny (), "Second pool not exhausted");
+
+  //churn never hands out a prefix twice
+  Pmipv6PrefixPool churn (base, 48, 1, 16);
+  std::set<Ipv6Address> live;
+  bool duplicate = false;
+
+  for (uint32_t i = 0; i < 10000; i++)
+    {
+      if (live.size () < 16 && (i % 3) != 2)
+        {
+          duplicate |= !live.insert (churn.Assign ()).second;
+        }
+      else if (!live.empty ())
+        {
+          churn.Release (*live.begin ());
+          live.erase (live.begin ());
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (duplicate, false, "Prefix assigned twice");
+  NS_TEST_ASSERT_MSG_EQ (churn.GetNAssigned (), live.size (), "Assigned count drifted");
+}
+
+/*
+ * LMA -- MAG -- (MNs)
+ *
+ * More MNs attach than the LMA pool holds, then the MAG bindings are
+ * either cleared or left to expire behind a failed backhaul: the pool
+ * must give every prefix back.
+ */
+class LmaPrefixReleaseTestCase : public TestCase
+{
+public:
+  LmaPrefixReleaseTestCase (bool expire);
+  virtual void DoRun (void);
+
+private:
+  void Check (Ptr<Pmipv6Lma> lma);
+
+  bool m_expire;
+  uint32_t m_nMns;
+  uint64_t m_poolSize;
+  uint64_t m_assigned;
+  uint64_t m_exhausted;
+};
+
+LmaPrefixReleaseTestCase::LmaPrefixReleaseTestCase (bool expire)
+  : TestCase (expire ? "Check the LMA releases pool prefixes of expired bindings"
+                     : "Check the LMA releases pool prefixes of cleared bindings"),
+    m_expire (expire),
+    m_nMns (10),
+    m_poolSize (8)
+{
+}
+
+void
+LmaPrefixReleaseTestCase::Check (Ptr<Pmipv6Lma> lma)
+{
+  m_assigned = lma->GetPrefixPool ()->GetNAssigned ();
+  m_exhausted = lma->GetPrefixPool ()->GetNExhausted ();
+}
+
+void
+LmaPrefixReleaseTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<Node> lma = nodes.Get (0);
+  Ptr<Node> mag = nodes.Get (1);
+
+  InstallIpv6Stack (nodes, mag);
+
+  Ptr<SimpleChannel> backhaul = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> access = CreateObject<SimpleChannel> ();
+
+  AddSimpleLink (lma, backhaul, "2001:2::1");
+  uint32_t backhaulIf = AddSimpleLink (mag, backhaul, "2001:2::2");
+  uint32_t accessIf = AddSimpleLink (mag, access, "2001:3::1");
+
+  Pmip6ProfileHelper profile;
+  std::list<Ipv6Address> hnps;
+  std::list<Identifier> nais;
+  std::list<Mac48Address> mns;
+
+  for (uint32_t i = 0; i < m_nMns; i++)
+    {
+      char nai[32];
+      Mac48Address mn = Mac48Address::Allocate ();
+
+      sprintf (nai, "mn%u@example.com", i);
+      profile.AddProfile (Identifier (nai), Identifier (mn), Ipv6Address ("2001:2::1"), hnps);
+      nais.push_back (Identifier (nai));
+      mns.push_back (mn);
+    }
+
+  Pmip6LmaHelper lmaHelper;
+  lmaHelper.SetProfileHelper (&profile);
+  lmaHelper.SetPrefixPoolRange (1, m_poolSize);
+  lmaHelper.Install (lma);
+
+  Pmip6MagHelper magHelper;
+  magHelper.SetProfileHelper (&profile);
+  magHelper.Install (mag, Ipv6Address ("2001:2::2"), NodeContainer ());
+
+  Ptr<Pmipv6Lma> lmaAgent = lma->GetObject<Pmipv6Lma> ();
+  Ptr<Pmipv6MagNotifier> notifier = mag->GetObject<Pmipv6MagNotifier> ();
+  Ptr<Ipv6Interface> interface = mag->GetObject<Ipv6L3Protocol> ()->GetInterface (accessIf);
+  Time at = Seconds (2.0);
+
+  for (std::list<Mac48Address>::iterator i = mns.begin (); i != mns.end (); i++)
+    {
+      Simulator::Schedule (at, &NotifyMagAttach, notifier, interface, (*i),
+                           (uint8_t) Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+      at += MilliSeconds (10);
+    }
+
+  Simulator::Schedule (Seconds (3.0), &LmaPrefixReleaseTestCase::Check, this, lmaAgent);
+  Simulator::Stop (Seconds (3.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_assigned, m_poolSize, "Pool not filled by the attachments");
+  NS_TEST_ASSERT_MSG_EQ ((m_exhausted >= m_nMns - m_poolSize), true, "Exhaustion not counted");
+
+  if (m_expire)
+    {
+      //the MAG can no longer refresh its bindings
+      mag->GetObject<Ipv6> ()->SetDown (backhaulIf);
+      Simulator::Stop (Seconds (Ipv6MobilityL4Protocol::MAX_BINDING_LIFETIME));
+      Simulator::Run ();
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (lmaAgent->ClearBindings (Ipv6Address ("2001:2::2")), m_poolSize, "Bindings not cleared");
+    }
+  NS_TEST_ASSERT_MSG_EQ (lmaAgent->GetPrefixPool ()->GetNAssigned (), 0, "Prefixes not released");
+
+  for (std::list<Identifier>::iterator i = nais.begin (); i != nais.end (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (profile.GetProfile ()->Lookup (*i)->GetHomeNetworkPrefixes ().size (), 0, "Profile keeps a released prefix");
+    }
+
+  Simulator::Destroy ();
+}
+
+static class PrefixPoolTestSuite : public TestSuite
+{
+public:
+  PrefixPoolTestSuite ()
+    : TestSuite ("pmip6-prefix-pool", UNIT)
+  {
+    AddTestCase (new PrefixPoolTestCase ());
+    AddTestCase (new LmaPrefixReleaseTestCase (false));
+    AddTestCase (new LmaPrefixReleaseTestCase (true));
+  }
+} g_prefixPoolTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,219 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <stdio.h>
+#include <fstream>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/ptr.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/identifier.h"
+#include "ns3/pmipv6-profile.h"
+#include "ns3/pmip6-helper.h"
+
+namespace ns3 {
+
+static void
+AddSubscribers (Pmip6ProfileHelper &helper, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      char nai[64];
+      char prefix[32];
+      uint8_t mac[6] = { 0x00, 0x02, (uint8_t)(i >> 24), (uint8_t)(i >> 16), (uint8_t)(i >> 8), (uint8_t)i };
+      std::list<Ipv6Address> hnps;
+
+      sprintf (nai, "mn%u@subscriber.pmip6.example.org", i);
+      sprintf (prefix, "3ffe:%x:%x::", i >> 16, i & 0xffff);
+
+      //every other subscriber gets its prefix from the LMA pool
+      if (i % 2 == 0)
+        {
+          hnps.push_back (Ipv6Address (prefix));
+        }
+
+      helper.AddProfile (Identifier (nai), Identifier (mac, 6), Ipv6Address ("2001:2::1"), hnps);
+    }
+}
+
+class ProfileStoreTestCase : public TestCase
+{
+public:
+  ProfileStoreTestCase ();
+  virtual void DoRun (void);
+};
+
+ProfileStoreTestCase::ProfileStoreTestCase ()
+  : TestCase ("Check profile indexing and binary file round trip")
+{
+}
+
+void
+ProfileStoreTestCase::DoRun (void)
+{
+  Pmip6ProfileHelper helper;
+  Ptr<Pmipv6Profile> profile = helper.GetProfile ();
+
+  AddSubscribers (helper, 100);
+  NS_TEST_ASSERT_MSG_EQ (profile->GetN (), 100, "One entry per subscriber");
+
+  uint8_t mac[6] = { 0x00, 0x02, 0, 0, 0, 42 };
+  Pmipv6Profile::Entry *entry = profile->Lookup (Identifier ("mn42@subscriber.pmip6.example.org"));
+
+  NS_TEST_ASSERT_MSG_NE (entry, 0, "Lookup by MN identifier");
+  NS_TEST_ASSERT_MSG_EQ (profile->Lookup (Identifier (mac, 6)), entry, "Both identifiers reach the same entry");
+
+  //an update made through one identifier is seen through the other
+  entry->SetHomeNetworkPrefixes (std::list<Ipv6Address> ());
+  NS_TEST_ASSERT_MSG_EQ (profile->Lookup (Identifier (mac, 6))->GetHomeNetworkPrefixes ().size (), 0, "Shared entry");
+  entry->AddHomeNetworkPrefix (Ipv6Address ("3ffe:0:2a::"));
+
+  std::string filename = CreateTempDirFilename ("pmip6-profiles.bin");
+  NS_TEST_ASSERT_MSG_EQ (profile->Save (filename), true, "Save the store");
+
+  Pmip6ProfileHelper loader;
+  Ptr<Pmipv6Profile> loaded = loader.GetProfile ();
+
+  NS_TEST_ASSERT_MSG_EQ (loader.LoadProfiles (filename), true, "Load the store");
+  NS_TEST_ASSERT_MSG_EQ (loaded->GetN (), 100, "All the subscribers are loaded");
+
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      char nai[64];
+      uint8_t id[6] = { 0x00, 0x02, 0, 0, 0, (uint8_t)i };
+
+      sprintf (nai, "mn%u@subscriber.pmip6.example.org", i);
+
+      Pmipv6Profile::Entry *a = profile->Lookup (Identifier (nai));
+      Pmipv6Profile::Entry *b = loaded->Lookup (Identifier (nai));
+
+      NS_TEST_ASSERT_MSG_NE (b, 0, "Loaded subscriber " << nai);
+      NS_TEST_ASSERT_MSG_EQ (loaded->Lookup (Identifier (id, 6)), b, "Loaded link identifier");
+      NS_TEST_ASSERT_MSG_EQ (b->GetMnIdentifier (), a->GetMnIdentifier (), "MN identifier");
+      NS_TEST_ASSERT_MSG_EQ (b->GetMnLinkIdentifier (), a->GetMnLinkIdentifier (), "MN link identifier");
+      NS_TEST_ASSERT_MSG_EQ (b->GetLmaAddress (), a->GetLmaAddress (), "LMA address");
+      NS_TEST_ASSERT_MSG_EQ ((b->GetHomeNetworkPrefixes () == a->GetHomeNetworkPrefixes ()), true, "Home network prefixes");
+    }
+
+  //a truncated or duplicated image leaves the store as it was
+  std::vector<uint8_t> image;
+  {
+    std::ifstream is (filename.c_str (), std::ios::binary);
+    image.assign (std::istreambuf_iterator<char> (is), std::istreambuf_iterator<char> ());
+  }
+  NS_TEST_ASSERT_MSG_EQ (CreateObject<Pmipv6Profile> ()->Load (&image[0], image.size ()), true, "Image in memory");
+
+  Ptr<Pmipv6Profile> other = CreateObject<Pmipv6Profile> ();
+  NS_TEST_ASSERT_MSG_EQ (other->Load (&image[0], image.size () - 4), false, "Truncated image");
+  NS_TEST_ASSERT_MSG_EQ (other->GetN (), 0, "Nothing kept from a truncated image");
+  NS_TEST_ASSERT_MSG_EQ (loaded->Load (&image[0], image.size ()), false, "Subscribers already there");
+  NS_TEST_ASSERT_MSG_EQ (loaded->GetN (), 100, "Store unchanged");
+
+  image[0] = 'X';
+  NS_TEST_ASSERT_MSG_EQ (other->Load (&image[0], image.size ()), false, "Bad magic");
+  NS_TEST_ASSERT_MSG_EQ (other->Load ("/nonexistent/pmip6-profiles.bin"), false, "Missing file");
+
+  //removing a subscriber drops both of its identifiers
+  loaded->Remove (loaded->Lookup (Identifier ("mn7@subscriber.pmip6.example.org")));
+  uint8_t mac7[6] = { 0x00, 0x02, 0, 0, 0, 7 };
+  NS_TEST_ASSERT_MSG_EQ (loaded->Lookup (Identifier (mac7, 6)), 0, "Link identifier removed");
+  NS_TEST_ASSERT_MSG_EQ (loaded->GetN (), 99, "Subscriber removed");
+
+  //link identifiers not indexed apart are saved too, and load back
+  Ptr<Pmipv6Profile> unindexed = CreateObject<Pmipv6Profile> ();
+  Identifier same ("same@subscriber.pmip6.example.org");
+  Identifier late ("late@subscriber.pmip6.example.org");
+
+  unindexed->Add (same, same);
+  unindexed->Add (late)->SetMnLinkIdentifier (Identifier (mac, 6));
+  NS_TEST_ASSERT_MSG_EQ (unindexed->Save (filename), true, "Save link identifiers");
+
+  Ptr<Pmipv6Profile> reloaded = CreateObject<Pmipv6Profile> ();
+  NS_TEST_ASSERT_MSG_EQ (reloaded->Load (filename), true, "Link identifier equal to the MN identifier");
+  NS_TEST_ASSERT_MSG_EQ (reloaded->GetN (), 2, "Both subscribers loaded");
+  NS_TEST_ASSERT_MSG_EQ (reloaded->Lookup (same)->GetMnLinkIdentifier (), same, "Link identifier equal to the MN identifier kept");
+  NS_TEST_ASSERT_MSG_EQ (reloaded->Lookup (late)->GetMnLinkIdentifier (), Identifier (mac, 6), "Link identifier set after Add kept");
+
+  remove (filename.c_str ());
+}
+
+class ProfileLoadCostTestCase : public TestCase
+{
+public:
+  ProfileLoadCostTestCase ();
+  virtual void DoRun (void);
+};
+
+ProfileLoadCostTestCase::ProfileLoadCostTestCase ()
+  : TestCase ("Measure subscriber profile loading rate")
+{
+}
+
+void
+ProfileLoadCostTestCase::DoRun (void)
+{
+  const uint32_t nSubscribers = 500000;
+
+  SystemWallClockMs clock;
+
+  clock.Start ();
+  Pmip6ProfileHelper helper;
+  AddSubscribers (helper, nSubscribers);
+  int64_t addMs = clock.End ();
+
+  std::string filename = CreateTempDirFilename ("pmip6-profiles-perf.bin");
+  NS_TEST_ASSERT_MSG_EQ (helper.GetProfile ()->Save (filename), true, "Save the store");
+
+  clock.Start ();
+  Pmip6ProfileHelper loader;
+  bool loaded = loader.LoadProfiles (filename);
+  int64_t loadMs = clock.End ();
+
+  std::cout << "Profiles for " << nSubscribers << " subscribers: AddProfile "
+            << addMs << " ms (" << (addMs * 1e6 / nSubscribers) << " ns/subscriber), file load "
+            << loadMs << " ms (" << (loadMs * 1e6 / nSubscribers) << " ns/subscriber)" << std::endl;
+
+  NS_TEST_ASSERT_MSG_EQ (loaded, true, "Load the store");
+  NS_TEST_ASSERT_MSG_EQ (loader.GetProfile ()->GetN (), nSubscribers, "All the subscribers are loaded");
+
+  remove (filename.c_str ());
+}
+
+static class ProfileStoreTestSuite : public TestSuite
+{
+public:
+  ProfileStoreTestSuite ()
+    : TestSuite ("pmip6-profile-store", UNIT)
+  {
+    AddTestCase (new ProfileStoreTestCase ());
+  }
+} g_profileStoreTestSuite;
+
+static class ProfileStorePerfTestSuite : public TestSuite
+{
+public:
+  ProfileStorePerfTestSuite ()
+    : TestSuite ("pmip6-profile-store-perf", PERFORMANCE)
+  {
+    AddTestCase (new ProfileLoadCostTestCase ());
+  }
+} g_profileStorePerfTestSuite;
+
+} // namespace ns3
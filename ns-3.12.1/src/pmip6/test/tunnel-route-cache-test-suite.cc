@@ -0,0 +1,237 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-list-routing.h"
+#include "ns3/ipv6-static-routing.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/udp-header.h"
+#include "ns3/ipv6-tunnel-l4-protocol.h"
+
+#include "pmip6-test-helper.h"
+
+namespace ns3 {
+
+static void
+SendPacket (Ptr<Ipv6L3Protocol> ipv6, Ipv6Address src, Ipv6Address dst)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  UdpHeader udp;
+  udp.SetSourcePort (9);
+  udp.SetDestinationPort (9);
+  packet->AddHeader (udp);
+  ipv6->Send (packet, src, dst, 17, 0);
+}
+
+static void
+AddHostRoute (Ptr<Ipv6StaticRouting> routing, Ipv6Address dst, uint32_t interface)
+{
+  routing->AddHostRouteTo (dst, interface);
+}
+
+/*
+ * LMA ==tunnel== MAG, the MAG with two access links. A host route added
+ * on the MAG moves the next decapsulated packet to the other link.
+ */
+class TunnelDecapsulationRouteTestCase : public TestCase
+{
+public:
+  TunnelDecapsulationRouteTestCase ();
+  virtual void DoRun (void);
+
+private:
+  void Tx (Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface);
+
+  std::vector<uint32_t> m_interfaces;
+};
+
+TunnelDecapsulationRouteTestCase::TunnelDecapsulationRouteTestCase ()
+  : TestCase ("Check the route of decapsulated packets follows a route change")
+{
+}
+
+void
+TunnelDecapsulationRouteTestCase::Tx (Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  Ipv6Header header;
+  packet->PeekHeader (header);
+
+  if (header.GetNextHeader () == 17)
+    {
+      m_interfaces.push_back (interface);
+    }
+}
+
+void
+TunnelDecapsulationRouteTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<Node> lma = nodes.Get (0);
+  Ptr<Node> mag = nodes.Get (1);
+
+  InstallIpv6Stack (nodes);
+
+  Ptr<SimpleChannel> backhaul = CreateObject<SimpleChannel> ();
+  AddSimpleLink (lma, backhaul, "2001:2::1");
+  AddSimpleLink (mag, backhaul, "2001:2::2");
+  uint32_t accessIf1 = AddSimpleLink (mag, CreateObject<SimpleChannel> (), "3ffe:1:4:1::1");
+  uint32_t accessIf2 = AddSimpleLink (mag, CreateObject<SimpleChannel> (), "3ffe:1:4:2::1");
+
+  Ptr<Ipv6TunnelL4Protocol> lmaTunnel = CreateObject<Ipv6TunnelL4Protocol> ();
+  lma->AggregateObject (lmaTunnel);
+  Ptr<Ipv6TunnelL4Protocol> magTunnel = CreateObject<Ipv6TunnelL4Protocol> ();
+  mag->AggregateObject (magTunnel);
+
+  uint32_t tunnelIf = lmaTunnel->AddTunnel (Ipv6Address ("2001:2::2"), Ipv6Address ("2001:2::1"));
+  magTunnel->AddTunnel (Ipv6Address ("2001:2::1"), Ipv6Address ("2001:2::2"));
+
+  Ipv6StaticRoutingHelper routingHelper;
+  routingHelper.GetStaticRouting (lma->GetObject<Ipv6> ())->AddNetworkRouteTo (Ipv6Address ("3ffe:1:4:1::"), Ipv6Prefix (64), tunnelIf);
+  Ptr<Ipv6StaticRouting> magRouting = routingHelper.GetStaticRouting (mag->GetObject<Ipv6> ());
+
+  mag->GetObject<Ipv6L3Protocol> ()->TraceConnectWithoutContext ("Tx", MakeCallback (&TunnelDecapsulationRouteTestCase::Tx, this));
+
+  Ipv6Address src ("2001:2::1");
+  Ipv6Address dst ("3ffe:1:4:1::100");
+  Simulator::Schedule (Seconds (2.0), &SendPacket, lma->GetObject<Ipv6L3Protocol> (), src, dst);
+  Simulator::Schedule (Seconds (3.0), &AddHostRoute, magRouting, dst, accessIf2);
+  Simulator::Schedule (Seconds (4.0), &SendPacket, lma->GetObject<Ipv6L3Protocol> (), src, dst);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_interfaces.size (), 2, "decapsulated packets not sent on");
+  NS_TEST_ASSERT_MSG_EQ (m_interfaces[0], accessIf1, "first packet not on the network route");
+  NS_TEST_ASSERT_MSG_EQ (m_interfaces[1], accessIf2, "cached route used after the host route was added");
+}
+
+/*
+ * LMA ==tunnel== MAG over two backhaul links, the tunnel without local
+ * address. A routing protocol of higher priority added on the LMA moves
+ * the outer packets to the other link.
+ */
+class TunnelOuterRouteTestCase : public TestCase
+{
+public:
+  TunnelOuterRouteTestCase ();
+  virtual void DoRun (void);
+
+private:
+  void Tx (Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface);
+  void AddRoutingProtocol (Ptr<Node> node, uint32_t interface);
+
+  std::vector<uint32_t> m_interfaces;
+};
+
+TunnelOuterRouteTestCase::TunnelOuterRouteTestCase ()
+  : TestCase ("Check the outer route of a tunnel follows a change in list routing")
+{
+}
+
+void
+TunnelOuterRouteTestCase::Tx (Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  Ptr<Packet> copy = packet->Copy ();
+  Ipv6Header header;
+  copy->RemoveHeader (header);
+
+  /* the neighbor discovery of the tunnel interface is encapsulated as well */
+  if (header.GetNextHeader () == Ipv6TunnelL4Protocol::PROT_NUMBER)
+    {
+      copy->PeekHeader (header);
+      if (header.GetNextHeader () == 17)
+        {
+          m_interfaces.push_back (interface);
+        }
+    }
+}
+
+void
+TunnelOuterRouteTestCase::AddRoutingProtocol (Ptr<Node> node, uint32_t interface)
+{
+  Ptr<Ipv6ListRouting> listRouting = DynamicCast<Ipv6ListRouting> (node->GetObject<Ipv6> ()->GetRoutingProtocol ());
+  NS_ASSERT (listRouting);
+
+  Ptr<Ipv6StaticRouting> routing = CreateObject<Ipv6StaticRouting> ();
+  listRouting->AddRoutingProtocol (routing, 10);
+  routing->AddHostRouteTo (Ipv6Address ("2001:2::2"), Ipv6Address ("2001:3::2"), interface);
+}
+
+void
+TunnelOuterRouteTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<Node> lma = nodes.Get (0);
+  Ptr<Node> mag = nodes.Get (1);
+
+  InstallIpv6Stack (nodes);
+
+  Ptr<SimpleChannel> backhaul1 = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> backhaul2 = CreateObject<SimpleChannel> ();
+  uint32_t backhaulIf1 = AddSimpleLink (lma, backhaul1, "2001:2::1");
+  uint32_t backhaulIf2 = AddSimpleLink (lma, backhaul2, "2001:3::1");
+  AddSimpleLink (mag, backhaul1, "2001:2::2");
+  AddSimpleLink (mag, backhaul2, "2001:3::2");
+
+  Ptr<Ipv6TunnelL4Protocol> lmaTunnel = CreateObject<Ipv6TunnelL4Protocol> ();
+  lma->AggregateObject (lmaTunnel);
+
+  /* no local address: the tunnel device looks up and caches its outer route */
+  uint32_t tunnelIf = lmaTunnel->AddTunnel (Ipv6Address ("2001:2::2"));
+
+  Ipv6StaticRoutingHelper routingHelper;
+  routingHelper.GetStaticRouting (lma->GetObject<Ipv6> ())->AddNetworkRouteTo (Ipv6Address ("3ffe:1:4:1::"), Ipv6Prefix (64), tunnelIf);
+
+  lma->GetObject<Ipv6L3Protocol> ()->TraceConnectWithoutContext ("Tx", MakeCallback (&TunnelOuterRouteTestCase::Tx, this));
+
+  Ipv6Address src ("2001:2::1");
+  Ipv6Address dst ("3ffe:1:4:1::100");
+  Simulator::Schedule (Seconds (2.0), &SendPacket, lma->GetObject<Ipv6L3Protocol> (), src, dst);
+  Simulator::Schedule (Seconds (3.0), &TunnelOuterRouteTestCase::AddRoutingProtocol, this, lma, backhaulIf2);
+  Simulator::Schedule (Seconds (4.0), &SendPacket, lma->GetObject<Ipv6L3Protocol> (), src, dst);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_interfaces.size (), 2, "packets not encapsulated");
+  NS_TEST_ASSERT_MSG_EQ (m_interfaces[0], backhaulIf1, "first packet not on the on-link route");
+  NS_TEST_ASSERT_MSG_EQ (m_interfaces[1], backhaulIf2, "cached outer route used after the routing changed");
+}
+
+static class TunnelRouteCacheTestSuite : public TestSuite
+{
+public:
+  TunnelRouteCacheTestSuite ()
+    : TestSuite ("pmip6-tunnel-route-cache", UNIT)
+  {
+    AddTestCase (new TunnelDecapsulationRouteTestCase ());
+    AddTestCase (new TunnelOuterRouteTestCase ());
+  }
+} g_tunnelRouteCacheTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,201 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Proxy Mobile IPv6 (PMIPv6) (RFC5213) Implementation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/ipv6.h"
+#include "ns3/radvd-prefix.h"
+#include "ns3/unicast-radvd.h"
+#include "ns3/unicast-radvd-interface.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * One router unicasting RAs to many MNs on the same interface. The RAs
+ * of a configuration are the cached ones until the configuration or one
+ * of its prefixes changes, and the RAs due close together share a send
+ * event.
+ */
+class UnicastRadvdTestCase : public TestCase
+{
+public:
+  UnicastRadvdTestCase ();
+  virtual void DoRun (void);
+
+private:
+  struct Tx
+  {
+    Time m_time;
+    uint64_t m_uid;
+    uint32_t m_size;
+  };
+
+  void TxRa (Ptr<const Packet> p, Address to);
+
+  uint32_t m_nMns;
+  std::map<Mac48Address, std::vector<Tx> > m_txs;
+};
+
+UnicastRadvdTestCase::UnicastRadvdTestCase ()
+  : TestCase ("Check cached and batched unicast RAs"),
+    m_nMns (50)
+{
+}
+
+void
+UnicastRadvdTestCase::TxRa (Ptr<const Packet> p, Address to)
+{
+  Tx tx;
+
+  tx.m_time = Simulator::Now ();
+  tx.m_uid = p->GetUid ();
+  tx.m_size = p->GetSize ();
+  m_txs[Mac48Address::ConvertFrom (to)].push_back (tx);
+}
+
+void
+UnicastRadvdTestCase::DoRun (void)
+{
+  Ptr<Node> router = CreateObject<Node> ();
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (router);
+
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (router);
+
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  device->SetChannel (CreateObject<SimpleChannel> ());
+  router->AddDevice (device);
+
+  Ptr<Ipv6> ipv6 = router->GetObject<Ipv6> ();
+  uint32_t ifIndex = ipv6->AddInterface (device);
+  ipv6->SetUp (ifIndex);
+
+  Ptr<UnicastRadvd> radvd = CreateObject<UnicastRadvd> ();
+  router->AddApplication (radvd);
+  radvd->SetStartTime (Seconds (1.0));
+  radvd->SetAttribute ("CoalescingWindow", TimeValue (MilliSeconds (100)));
+  radvd->TraceConnectWithoutContext ("Tx", MakeCallback (&UnicastRadvdTestCase::TxRa, this));
+
+  std::vector<Ptr<UnicastRadvdInterface> > configs;
+  std::vector<Ptr<RadvdPrefix> > prefixes;
+  std::vector<Mac48Address> mns;
+
+  for (uint32_t i = 0; i < m_nMns; i++)
+    {
+      Ptr<UnicastRadvdInterface> config = Create<UnicastRadvdInterface> (ifIndex, 5000, 1000);
+      Mac48Address mn = Mac48Address::Allocate ();
+
+      Ptr<RadvdPrefix> prefix = Create<RadvdPrefix> (Ipv6Address ("2001:100::"), 64, 3, 5);
+
+      config->SetPhysicalAddress (mn);
+      config->AddPrefix (prefix);
+      radvd->AddConfiguration (config);
+      configs.push_back (config);
+      prefixes.push_back (prefix);
+      mns.push_back (mn);
+    }
+
+  /* changes through the base class and the prefixes are seen as well */
+  Ptr<RadvdInterface> base = configs[0];
+  Simulator::Schedule (Seconds (4.0), &RadvdInterface::AddPrefix, base,
+                       Create<RadvdPrefix> (Ipv6Address ("2001:200::"), 64, 3, 5));
+  Simulator::Schedule (Seconds (4.0), &RadvdPrefix::SetValidLifeTime, prefixes[2], 10);
+  Simulator::Schedule (Seconds (4.0), &RadvdInterface::SetCurHopLimit, configs[3], 32);
+  Simulator::Schedule (Seconds (4.0), static_cast<void (UnicastRadvd::*) (Ptr<UnicastRadvdInterface>)> (&UnicastRadvd::RemoveConfiguration),
+                       radvd, configs[1]);
+
+  Simulator::Stop (Seconds (20.0));
+  Simulator::Run ();
+
+  /* every MN got its RA at start, the ones still configured periodically */
+  for (uint32_t i = 0; i < m_nMns; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((m_txs[mns[i]].size () > 0), true, "MN " << i << " not advertised");
+      NS_TEST_ASSERT_MSG_EQ (m_txs[mns[i]][0].m_time, Seconds (1.0), "first RA not sent at start");
+      if (i != 1)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((m_txs[mns[i]].size () > 1), true, "MN " << i << " not advertised periodically");
+        }
+      /* joining a batch only delays an RA */
+      for (uint32_t j = 1; j < m_txs[mns[i]].size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((m_txs[mns[i]][j].m_time - m_txs[mns[i]][j - 1].m_time >= Seconds (1.0)), true,
+                                 "RAs of MN " << i << " closer than MinRtrAdvInterval");
+        }
+    }
+
+  /* 50 RAs every 1 to 5 s, many due within 100 ms after another one */
+  NS_TEST_ASSERT_MSG_EQ ((radvd->GetNBatches () * 3 < radvd->GetNRas () * 2), true, "RAs due close together are not batched");
+
+  /* the RAs of an unchanged configuration are copies of the same packet */
+  for (uint32_t i = 4; i < m_nMns; i++)
+    {
+      std::vector<Tx> &txs = m_txs[mns[i]];
+      for (uint32_t j = 1; j < txs.size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (txs[j].m_uid, txs[0].m_uid, "RA of MN " << i << " rebuilt");
+        }
+    }
+
+  /* adding a prefix invalidates the cached RA */
+  std::vector<Tx> &changed = m_txs[mns[0]];
+  NS_TEST_ASSERT_MSG_EQ ((changed.back ().m_time > Seconds (4.0)), true, "no RA after the prefix change");
+  NS_TEST_ASSERT_MSG_EQ ((changed.back ().m_size > changed[0].m_size), true, "new prefix not advertised");
+  NS_TEST_ASSERT_MSG_EQ ((changed.back ().m_uid != changed[0].m_uid), true, "stale RA sent");
+
+  /* so does changing a prefix or another setting */
+  for (uint32_t i = 2; i < 4; i++)
+    {
+      std::vector<Tx> &txs = m_txs[mns[i]];
+      NS_TEST_ASSERT_MSG_EQ ((txs.back ().m_time > Seconds (4.0)), true, "no RA after the change of MN " << i);
+      NS_TEST_ASSERT_MSG_EQ ((txs.back ().m_uid != txs[0].m_uid), true, "stale RA sent to MN " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (radvd->GetNRasBuilt (), m_nMns + 3, "RAs built more than once per change");
+
+  /* a removed configuration is no longer advertised */
+  NS_TEST_ASSERT_MSG_EQ ((m_txs[mns[1]].back ().m_time <= Seconds (4.0)), true, "removed configuration advertised");
+
+  Simulator::Destroy ();
+}
+
+static class UnicastRadvdTestSuite : public TestSuite
+{
+public:
+  UnicastRadvdTestSuite ()
+    : TestSuite ("pmip6-unicast-radvd", UNIT)
+  {
+    AddTestCase (new UnicastRadvdTestCase ());
+  }
+} g_unicastRadvdTestSuite;
+
+} // namespace ns3
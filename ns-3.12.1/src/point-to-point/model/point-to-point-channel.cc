@@ -21,6 +21,9 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/thread-local.h"
+#include "ns3/node.h"
+#include "ns3/tag.h"
 #include "ns3/log.h"
 
 NS_LOG_COMPONENT_DEFINE ("PointToPointChannel");
@@ -29,6 +32,46 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (PointToPointChannel);
 
+//
+// A copy of a packet which shares no buffer with the original, nor with any
+// other packet: the copy may go to another thread. The tags are copied one
+// by one, like the packets which cross an MPI link they are not serialized,
+// and the byte tags keep the bytes they cover.
+//
+static Ptr<Packet>
+CopyForAnotherThread (Ptr<const Packet> p)
+{
+  uint32_t size = p->GetSerializedSize ();
+  uint8_t *buffer = new uint8_t[size];
+  p->Serialize (buffer, size);
+  Ptr<Packet> copy = Create<Packet> (buffer, size, true);
+  delete [] buffer;
+
+  PacketTagIterator packetTags = p->GetPacketTagIterator ();
+  while (packetTags.HasNext ())
+    {
+      PacketTagIterator::Item item = packetTags.Next ();
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      NS_ASSERT (tag != 0);
+      item.GetTag (*tag);
+      copy->AddPacketTag (*tag);
+      delete tag;
+    }
+  ByteTagIterator byteTags = p->GetByteTagIterator ();
+  while (byteTags.HasNext ())
+    {
+      ByteTagIterator::Item item = byteTags.Next ();
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      NS_ASSERT (tag != 0);
+      item.GetTag (*tag);
+      copy->AddByteTag (*tag, item.GetStart (), item.GetEnd ());
+      delete tag;
+    }
+  return copy;
+}
+
 TypeId 
 PointToPointChannel::GetTypeId (void)
 {
@@ -76,6 +119,14 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
       m_link[1].m_dst = m_link[0].m_src;
       m_link[0].m_state = IDLE;
       m_link[1].m_state = IDLE;
+      for (uint32_t i = 0; i < N_DEVICES; i++)
+        {
+          Ptr<Node> node = m_link[i].m_dst->GetNode ();
+          if (node != 0)
+            {
+              m_link[i].m_dstNodeId = node->GetId ();
+            }
+        }
     }
 }
 
@@ -93,7 +144,31 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+  if (m_link[wire].m_dstNodeId == 0xffffffff)
+    {
+      // the devices were attached before being added to their nodes
+      m_link[wire].m_dstNodeId = m_link[wire].m_dst->GetNode ()->GetId ();
+    }
+  uint32_t dstNodeId = m_link[wire].m_dstNodeId;
+
+  if (IsOtherThreadContext (dstNodeId))
+    {
+      // the receiving node is simulated by another thread: its objects
+      // must not be referenced from this one
+      Simulator::ScheduleWithContext (dstNodeId,
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      PeekPointer (m_link[wire].m_dst), CopyForAnotherThread (p));
+      if (!m_txrxPointToPoint.IsEmpty ())
+        {
+          // nor may the trace reference both devices while their threads
+          // run: the events of no node run while all the nodes wait
+          Simulator::ScheduleWithContext (0xffffffff, m_delay, &PointToPointChannel::TraceTxRx,
+                                          this, p, wire, txTime);
+        }
+      return true;
+    }
+
+  Simulator::ScheduleWithContext (dstNodeId,
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
                                   m_link[wire].m_dst, p);
 
@@ -102,6 +177,13 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+void
+PointToPointChannel::TraceTxRx (Ptr<Packet> p, uint32_t wire, Time txTime)
+{
+  NS_LOG_FUNCTION (this << p << wire);
+  m_txrxPointToPoint (p, m_link[wire].m_src, m_link[wire].m_dst, txTime, txTime + m_delay);
+}
+
 uint32_t 
 PointToPointChannel::GetNDevices (void) const
 {
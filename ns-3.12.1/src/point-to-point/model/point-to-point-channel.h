@@ -122,6 +122,15 @@ protected:
   Ptr<PointToPointNetDevice> GetDestination (uint32_t i) const;
 
 private:
+  /*
+   * \brief Fire the animation trace of a transmission to a device
+   * simulated by another thread
+   * \param p the packet
+   * \param wire the wire it went on
+   * \param txTime its transmission time
+   */
+  void TraceTxRx (Ptr<Packet> p, uint32_t wire, Time txTime);
+
   // Each point to point link has exactly two net devices
   static const int N_DEVICES = 2;
 
@@ -133,7 +142,9 @@ private:
    * device can fire.
    * Arguments to the callback are the packet, transmitting
    * net device, receiving net device, transmission time and 
-   * packet receipt time.
+   * packet receipt time. When the receiving net device is simulated by
+   * another thread of a MultiThreadedSimulatorImpl, the trace fires once
+   * the first bit has arrived, from the events of no node.
    *
    * @see class CallBackTraceSource
    */
@@ -155,10 +166,13 @@ private:
   class Link
   {
 public:
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_dstNodeId (0xffffffff) {}
     WireState                  m_state;
     Ptr<PointToPointNetDevice> m_src;
     Ptr<PointToPointNetDevice> m_dst;
+    // known once the devices are added to their nodes: looking the node
+    // up from another thread than its own would race on its reference count
+    uint32_t                   m_dstNodeId;
   };
 
   Link    m_link[N_DEVICES];
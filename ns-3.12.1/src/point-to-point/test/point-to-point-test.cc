@@ -3,6 +3,12 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/thread-local.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/global-value.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
 
 namespace ns3 {
 
@@ -56,6 +62,196 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 //-----------------------------------------------------------------------------
+/**
+ * Forwards packets along a chain of point-to-point links, once with the
+ * default simulator and once with one thread per node, and checks that
+ * every node receives the same packets at the same time.
+ */
+class PointToPointMultiThreadedTest : public TestCase
+{
+public:
+  PointToPointMultiThreadedTest ();
+
+  virtual void DoRun (void);
+
+private:
+  struct Arrival
+  {
+    uint64_t m_ts;
+    uint32_t m_size;
+    uint32_t m_flowId;
+    uint32_t m_byteTagStart;
+    uint32_t m_byteTagEnd;
+  };
+
+  void Send (Ptr<PointToPointNetDevice> device, uint32_t size, uint32_t flowId);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+  void TxRx (Ptr<const Packet> packet, Ptr<NetDevice> tx, Ptr<NetDevice> rx, Time txTime, Time rxTime);
+  void RunChain (std::vector<std::vector<Arrival> > &arrivals);
+
+  enum { N_NODES = 4, N_PACKETS = 20 };
+
+  std::vector<Ptr<Node> > m_nodes;
+  std::vector<Ptr<PointToPointNetDevice> > m_forward;
+  std::vector<std::vector<Arrival> > *m_arrivals;
+  bool m_crossPartition;
+  std::vector<uint32_t> m_txrx;
+  bool m_txrxDevices;
+};
+
+PointToPointMultiThreadedTest::PointToPointMultiThreadedTest ()
+  : TestCase ("PointToPoint links between the threads of a MultiThreadedSimulatorImpl")
+{
+}
+
+void
+PointToPointMultiThreadedTest::Send (Ptr<PointToPointNetDevice> device, uint32_t size, uint32_t flowId)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  p->AddPacketTag (FlowIdTag (flowId));
+  p->AddByteTag (FlowIdTag (flowId), size / 2, size);
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointMultiThreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                        uint16_t protocol, const Address &from)
+{
+  // each node only touches its own entries: no locking is needed
+  uint32_t index = device->GetNode ()->GetId () - m_nodes[0]->GetId ();
+  FlowIdTag tag;
+  Arrival arrival;
+  arrival.m_ts = Simulator::Now ().GetTimeStep ();
+  arrival.m_size = packet->GetSize ();
+  arrival.m_flowId = packet->PeekPacketTag (tag) ? tag.GetFlowId () : 0;
+  arrival.m_byteTagStart = 0;
+  arrival.m_byteTagEnd = 0;
+  ByteTagIterator byteTags = packet->GetByteTagIterator ();
+  while (byteTags.HasNext ())
+    {
+      ByteTagIterator::Item item = byteTags.Next ();
+      if (item.GetTypeId () == FlowIdTag::GetTypeId ())
+        {
+          arrival.m_byteTagStart = item.GetStart ();
+          arrival.m_byteTagEnd = item.GetEnd ();
+        }
+    }
+  (*m_arrivals)[index].push_back (arrival);
+
+  if (index + 1 < N_NODES)
+    {
+      m_forward[index]->Send (packet->Copy (), m_forward[index]->GetBroadcast (), protocol);
+    }
+  else
+    {
+      m_crossPartition = IsOtherThreadContext (m_nodes[0]->GetId ());
+    }
+  return true;
+}
+
+void
+PointToPointMultiThreadedTest::TxRx (Ptr<const Packet> packet, Ptr<NetDevice> tx, Ptr<NetDevice> rx,
+                                     Time txTime, Time rxTime)
+{
+  // a link is traced by one thread at a time: from the thread of its
+  // nodes, or from the events of no node when it crosses threads
+  if (tx == 0 || rx == 0)
+    {
+      m_txrxDevices = false;
+      return;
+    }
+  uint32_t link = tx->GetNode ()->GetId () - m_nodes[0]->GetId ();
+  if (rx->GetNode () != m_nodes[link + 1])
+    {
+      m_txrxDevices = false;
+    }
+  m_txrx[link]++;
+}
+
+void
+PointToPointMultiThreadedTest::RunChain (std::vector<std::vector<Arrival> > &arrivals)
+{
+  m_nodes.clear ();
+  m_forward.clear ();
+  arrivals.clear ();
+  arrivals.resize (N_NODES);
+  m_arrivals = &arrivals;
+  m_crossPartition = false;
+  m_txrx.assign (N_NODES - 1, 0);
+  m_txrxDevices = true;
+
+  for (uint32_t i = 0; i < N_NODES; i++)
+    {
+      m_nodes.push_back (CreateObject<Node> ());
+    }
+  for (uint32_t i = 0; i + 1 < N_NODES; i++)
+    {
+      Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+      Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+      Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+      channel->SetAttribute ("Delay", StringValue ("2ms"));
+
+      devA->SetAddress (Mac48Address::Allocate ());
+      devA->SetQueue (CreateObject<DropTailQueue> ());
+      devA->SetDataRate (DataRate ("5Mbps"));
+      devB->SetAddress (Mac48Address::Allocate ());
+      devB->SetQueue (CreateObject<DropTailQueue> ());
+      devB->SetDataRate (DataRate ("5Mbps"));
+      m_nodes[i]->AddDevice (devA);
+      m_nodes[i + 1]->AddDevice (devB);
+      devA->Attach (channel);
+      devB->Attach (channel);
+
+      devB->SetReceiveCallback (MakeCallback (&PointToPointMultiThreadedTest::Receive, this));
+      channel->TraceConnectWithoutContext ("TxRxPointToPoint", MakeCallback (&PointToPointMultiThreadedTest::TxRx, this));
+      m_forward.push_back (devA);
+    }
+  for (uint32_t i = 0; i < N_PACKETS; i++)
+    {
+      Simulator::ScheduleWithContext (m_nodes[0]->GetId (), Seconds (1.0) + MicroSeconds (500 * i),
+                                      &PointToPointMultiThreadedTest::Send, this,
+                                      m_forward[0], 100 + 50 * i, i + 1);
+    }
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+PointToPointMultiThreadedTest::DoRun (void)
+{
+  std::vector<std::vector<Arrival> > expected;
+  RunChain (expected);
+  NS_TEST_ASSERT_MSG_EQ (m_crossPartition, false, "no partition without a MultiThreadedSimulatorImpl");
+
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MultiThreadedSimulatorImpl"));
+  Config::SetDefault ("ns3::MultiThreadedSimulatorImpl::ThreadCount", UintegerValue (N_NODES));
+  std::vector<std::vector<Arrival> > arrivals;
+  RunChain (arrivals);
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::SetDefault ("ns3::MultiThreadedSimulatorImpl::ThreadCount", UintegerValue (0));
+
+  NS_TEST_ASSERT_MSG_EQ (m_crossPartition, true, "the last node should be simulated by another thread");
+  NS_TEST_ASSERT_MSG_EQ (m_txrxDevices, true, "TxRxPointToPoint fired without its devices");
+  for (uint32_t i = 0; i + 1 < N_NODES; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_txrx[i], N_PACKETS, "TxRxPointToPoint not fired for each packet of link " << i);
+    }
+  for (uint32_t i = 1; i < N_NODES; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (expected[i].size (), N_PACKETS, "packets lost along the chain");
+      NS_TEST_ASSERT_MSG_EQ (arrivals[i].size (), expected[i].size (), "different number of packets at node " << i);
+      for (uint32_t j = 0; j < arrivals[i].size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (arrivals[i][j].m_ts, expected[i][j].m_ts, "different arrival time at node " << i);
+          NS_TEST_ASSERT_MSG_EQ (arrivals[i][j].m_size, expected[i][j].m_size, "different packet at node " << i);
+          NS_TEST_ASSERT_MSG_EQ (arrivals[i][j].m_flowId, j + 1, "packet tag lost at node " << i);
+          NS_TEST_ASSERT_MSG_EQ (arrivals[i][j].m_byteTagStart, arrivals[i][j].m_size / 2, "byte tag moved at node " << i);
+          NS_TEST_ASSERT_MSG_EQ (arrivals[i][j].m_byteTagEnd, arrivals[i][j].m_size, "byte tag moved at node " << i);
+        }
+    }
+}
+//-----------------------------------------------------------------------------
 class PointToPointTestSuite : public TestSuite
 {
 public:
@@ -66,6 +262,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest);
+  AddTestCase (new PointToPointMultiThreadedTest);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite;
@@ -383,7 +383,7 @@ ApWifiMac::TxOk (const WifiMacHeader &hdr)
 	  //PMIPv6 Implementatio by CHY {
 	  if (!m_newHostCallback.IsNull ())
 	    {
-		  m_newHostCallback (hdr.GetAddr1 (), GetAddress (), 4 /* WIFI */);
+		  m_newHostCallback (hdr.GetAddr1 (), GetAddress (), ACCESS_TECHNOLOGY_TYPE);
 		}
 	  //}
     }
@@ -533,6 +533,12 @@ ApWifiMac::Receive (Ptr<Packet> packet, const WifiMacHeader *hdr)
             }
           else if (hdr->IsDisassociation ())
             {
+              //PMIPv6 Implementation by CHY {
+              if (m_stationManager->IsAssociated (from) && !m_delHostCallback.IsNull ())
+                {
+                  m_delHostCallback (from, GetAddress (), ACCESS_TECHNOLOGY_TYPE);
+                }
+              //}
               m_stationManager->RecordDisassociated (from);
               return;
             }
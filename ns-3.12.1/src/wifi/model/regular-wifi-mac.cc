@@ -40,6 +40,8 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (RegularWifiMac);
 
+const uint8_t RegularWifiMac::ACCESS_TECHNOLOGY_TYPE = 4;
+
 RegularWifiMac::RegularWifiMac ()
 {
   NS_LOG_FUNCTION (this);
@@ -720,6 +722,13 @@ void RegularWifiMac::SetNewPoaCallback (Callback<void, Mac48Address, Mac48Addres
   
   m_newPoaCallback = newPoa;
 }
+
+void RegularWifiMac::SetDelHostCallback (Callback<void, Mac48Address, Mac48Address, uint8_t> delHost)
+{
+  NS_LOG_FUNCTION (this);
+  
+  m_delHostCallback = delHost;
+}
 //}
 
 } // namespace ns3
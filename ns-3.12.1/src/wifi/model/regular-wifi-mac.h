@@ -211,8 +211,11 @@ public:
   virtual Time GetCompressedBlockAckTimeout (void) const;
 
   // PMIPv6 Implementation by CHY {
+  // access technology type passed to the host callbacks, IEEE 802.11a/b/g (RFC 5213)
+  static const uint8_t ACCESS_TECHNOLOGY_TYPE;
   virtual void SetNewHostCallback (Callback<void, Mac48Address, Mac48Address, uint8_t> newHost);
   virtual void SetNewPoaCallback (Callback<void, Mac48Address, Mac48Address, uint8_t> newPoa);
+  virtual void SetDelHostCallback (Callback<void, Mac48Address, Mac48Address, uint8_t> delHost);
   //}
 
 protected:
@@ -234,6 +237,7 @@ protected:
   // PMIPv6 Implementation by CHY {
   Callback<void, Mac48Address, Mac48Address, uint8_t> m_newHostCallback;
   Callback<void, Mac48Address, Mac48Address, uint8_t> m_newPoaCallback;
+  Callback<void, Mac48Address, Mac48Address, uint8_t> m_delHostCallback;
   //}
   
   Ssid m_ssid;
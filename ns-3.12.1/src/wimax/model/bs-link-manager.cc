@@ -267,6 +267,12 @@ BSLinkManager::AbortRanging (Cid cid, RngRsp *rngrsp, SSRecord *ssRecord, bool i
 
   if (isOldSS)
     {
+      // PMIPv6 Implementation by CHY {
+      if (ssRecord->GetRangingStatus () == WimaxNetDevice::RANGING_STATUS_SUCCESS)
+        {
+          m_bs->NotifyDelHost (ssRecord->GetMacAddress ());
+        }
+      //}
       ssRecord->SetRangingStatus (WimaxNetDevice::RANGING_STATUS_ABORT);
     }
 
@@ -283,9 +289,19 @@ BSLinkManager::AcceptRanging (Cid cid, RngRsp *rngrsp, SSRecord *ssRecord)
   /*Shall not be set until the SS receives the RNG-RSP, as it may be lost etc. may be state field
    is also added to SSRecord which then set to SS_STATE_REGISTERED once confirmed that SS has received
    this RNG-RSP, but how to determine that, may be as a data packet is received by the SS*/
+  // PMIPv6 Implementation by CHY {
+  bool isNewHost = ssRecord->GetRangingStatus () != WimaxNetDevice::RANGING_STATUS_SUCCESS;
+  //}
   ssRecord->SetRangingStatus (WimaxNetDevice::RANGING_STATUS_SUCCESS);
 
   ssRecord->DisablePollForRanging ();
+
+  // PMIPv6 Implementation by CHY {
+  if (isNewHost)
+    {
+      m_bs->NotifyNewHost (ssRecord->GetMacAddress ());
+    }
+  //}
 }
 
 void
@@ -50,6 +50,8 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (BaseStationNetDevice);
 
+const uint8_t BaseStationNetDevice::ACCESS_TECHNOLOGY_TYPE = 5;
+
 TypeId BaseStationNetDevice::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::BaseStationNetDevice")
@@ -255,6 +257,8 @@ BaseStationNetDevice::DoDispose (void)
   m_ssManager = 0;
   m_uplinkScheduler = 0;
   m_scheduler = 0;
+  m_newHostCallback = MakeNullCallback<void, Mac48Address, Mac48Address, uint8_t> ();
+  m_delHostCallback = MakeNullCallback<void, Mac48Address, Mac48Address, uint8_t> ();
 
   WimaxNetDevice::DoDispose ();
 }
@@ -445,6 +449,42 @@ BaseStationNetDevice::SetServiceFlowManager (Ptr<BsServiceFlowManager> sfm)
   m_serviceFlowManager = sfm;
 }
 
+// PMIPv6 Implementation by CHY {
+void
+BaseStationNetDevice::SetNewHostCallback (Callback<void, Mac48Address, Mac48Address, uint8_t> newHost)
+{
+  m_newHostCallback = newHost;
+}
+
+void
+BaseStationNetDevice::SetDelHostCallback (Callback<void, Mac48Address, Mac48Address, uint8_t> delHost)
+{
+  m_delHostCallback = delHost;
+}
+
+void
+BaseStationNetDevice::NotifyNewHost (Mac48Address ss)
+{
+  NS_LOG_INFO ("SS " << ss << " registered");
+
+  if (!m_newHostCallback.IsNull ())
+    {
+      m_newHostCallback (ss, GetMacAddress (), ACCESS_TECHNOLOGY_TYPE);
+    }
+}
+
+void
+BaseStationNetDevice::NotifyDelHost (Mac48Address ss)
+{
+  NS_LOG_INFO ("SS " << ss << " deregistered");
+
+  if (!m_delHostCallback.IsNull ())
+    {
+      m_delHostCallback (ss, GetMacAddress (), ACCESS_TECHNOLOGY_TYPE);
+    }
+}
+//}
+
 Ptr<UplinkScheduler>
 BaseStationNetDevice::GetUplinkScheduler (void) const
 {
@@ -225,6 +225,25 @@ public:
 
   Ptr<BsServiceFlowManager> GetServiceFlowManager (void) const;
   void SetServiceFlowManager (Ptr<BsServiceFlowManager> );
+
+  // PMIPv6 Implementation by CHY {
+  /**
+   * \brief Access technology type passed to the host callbacks, IEEE 802.16e (RFC 5213)
+   */
+  static const uint8_t ACCESS_TECHNOLOGY_TYPE;
+  /**
+   * \param newHost called with the SS address, the BS address and the access
+   *        technology type once an SS has completed its initial ranging
+   */
+  void SetNewHostCallback (Callback<void, Mac48Address, Mac48Address, uint8_t> newHost);
+  /**
+   * \param delHost called with the same arguments when the ranging of a
+   *        registered SS is aborted
+   */
+  void SetDelHostCallback (Callback<void, Mac48Address, Mac48Address, uint8_t> delHost);
+  void NotifyNewHost (Mac48Address ss);
+  void NotifyDelHost (Mac48Address ss);
+  //}
 private:
   void DoDispose (void);
   void StartFrame (void);
@@ -318,6 +337,11 @@ private:
 
   TracedCallback<Ptr<const Packet>, Mac48Address, Cid> m_traceBSRx;
 
+  // PMIPv6 Implementation by CHY {
+  Callback<void, Mac48Address, Mac48Address, uint8_t> m_newHostCallback;
+  Callback<void, Mac48Address, Mac48Address, uint8_t> m_delHostCallback;
+  //}
+
   /**
    * The trace source fired when packets come into the "top" of the device
    * at the L3/L2 transition, before being queued for transmission.
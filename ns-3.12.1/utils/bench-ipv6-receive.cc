@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measures the Ipv6L3Protocol receive path against the number of
+ * interfaces of a node, as on a PMIPv6 LMA with one tunnel interface
+ * per MAG: packets arrive on the last interface and are delivered
+ * locally, in packets per second.
+ */
+
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ipv6-interface-address.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-l4-protocol.h"
+#include "ns3/simulator.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/* experimental protocol number, RFC 3692 */
+static const uint8_t PROT_NUMBER = 253;
+
+class SinkProtocol : public Ipv6L4Protocol
+{
+public:
+  SinkProtocol ()
+    : m_received (0)
+  {
+  }
+  virtual int GetProtocolNumber () const
+  {
+    return PROT_NUMBER;
+  }
+  virtual enum RxStatus_e Receive (Ptr<Packet> p, Ipv6Address const &src,
+                                   Ipv6Address const &dst,
+                                   Ptr<Ipv6Interface> incomingInterface)
+  {
+    m_received++;
+    return RX_OK;
+  }
+  uint32_t m_received;
+};
+
+static Ipv6Address
+MakeAddress (uint32_t i)
+{
+  uint8_t buf[16];
+  memset (buf, 0, 16);
+  buf[0] = 0x20;
+  buf[1] = 0x01;
+  buf[2] = 0x0d;
+  buf[3] = 0xb8;
+  buf[4] = (i >> 24) & 0xff;
+  buf[5] = (i >> 16) & 0xff;
+  buf[6] = (i >> 8) & 0xff;
+  buf[7] = i & 0xff;
+  buf[15] = 1;
+  return Ipv6Address (buf);
+}
+
+static void
+RunBench (uint32_t nInterfaces, uint32_t packets)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (node);
+
+  Ptr<Ipv6L3Protocol> ipv6 = node->GetObject<Ipv6L3Protocol> ();
+  Ptr<SinkProtocol> sink = CreateObject<SinkProtocol> ();
+  ipv6->Insert (sink);
+
+  Ptr<SimpleNetDevice> device;
+  for (uint32_t i = 0; i < nInterfaces; i++)
+    {
+      device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      uint32_t ifIndex = ipv6->AddInterface (device);
+      ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (MakeAddress (i), Ipv6Prefix (64)));
+      ipv6->SetUp (ifIndex);
+    }
+
+  Ptr<Packet> p = Create<Packet> (64);
+  Ipv6Header header;
+  header.SetSourceAddress (Ipv6Address ("2001:db8:ffff::1"));
+  header.SetDestinationAddress (MakeAddress (nInterfaces - 1));
+  header.SetNextHeader (PROT_NUMBER);
+  header.SetPayloadLength (p->GetSize ());
+  header.SetHopLimit (64);
+  p->AddHeader (header);
+
+  Address from = Mac48Address::Allocate ();
+  Address to = device->GetAddress ();
+  SystemWallClockMs time;
+
+  time.Start ();
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      ipv6->Receive (device, p, Ipv6L3Protocol::PROT_NUMBER, from, to, NetDevice::PACKET_HOST);
+    }
+  uint64_t deltaMs = time.End ();
+
+  if (sink->m_received != packets)
+    {
+      std::cerr << "Error-- " << packets - sink->m_received << " packets not delivered" << std::endl;
+      exit (1);
+    }
+
+  double pps = packets;
+  pps *= 1000;
+  pps /= deltaMs ? deltaMs : 1;
+  std::cout << "interfaces=" << nInterfaces << " packets/s=" << pps << std::endl;
+
+  node->Dispose ();
+  Simulator::Destroy ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t maxInterfaces = 1000;
+  uint32_t packets = 200000;
+  while (argc > 0) {
+      if (strncmp ("--max-interfaces=", argv[0],strlen ("--max-interfaces=")) == 0) 
+        {
+          std::istringstream iss (argv[0] + strlen ("--max-interfaces="));
+          iss >> maxInterfaces;
+        }
+      if (strncmp ("--packets=", argv[0],strlen ("--packets=")) == 0) 
+        {
+          std::istringstream iss (argv[0] + strlen ("--packets="));
+          iss >> packets;
+        }
+      argc--;
+      argv++;
+  }
+  if (maxInterfaces == 0 || packets == 0)
+    {
+      std::cerr << "Error-- number of interfaces and packets must be positive" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-ipv6-receive with max-interfaces=" << maxInterfaces << " packets=" << packets << std::endl;
+
+  for (uint32_t n = 1; n < maxInterfaces; n *= 10)
+    {
+      RunBench (n, packets);
+    }
+  RunBench (maxInterfaces, packets);
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measures Ipv6StaticRouting with one /64 route per home network
+ * prefix, as installed by a PMIPv6 LMA: route insertion, downlink
+ * lookups and route removal, in operations per second.
+ */
+
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/ipv6-static-routing.h"
+#include "ns3/simulator.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+static Ipv6Address
+MakeHnp (uint32_t i)
+{
+  uint8_t buf[16];
+  memset (buf, 0, 16);
+  buf[0] = 0x3f;
+  buf[1] = 0xfe;
+  buf[2] = (i >> 24) & 0xff;
+  buf[3] = (i >> 16) & 0xff;
+  buf[4] = (i >> 8) & 0xff;
+  buf[5] = i & 0xff;
+  return Ipv6Address (buf);
+}
+
+static Ipv6Address
+MakeHost (uint32_t i)
+{
+  uint8_t buf[16];
+  MakeHnp (i).GetBytes (buf);
+  buf[15] = 1;
+  return Ipv6Address (buf);
+}
+
+static void
+PrintRate (char const *name, uint32_t n, uint64_t deltaMs)
+{
+  double ops = n;
+  ops *= 1000;
+  ops /= deltaMs ? deltaMs : 1;
+  std::cout << name << "=" << ops << " " << name << "/s" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 100000;
+  uint32_t lookups = 1000000;
+  while (argc > 0) {
+      if (strncmp ("--n=", argv[0],strlen ("--n=")) == 0) 
+        {
+          std::istringstream iss (argv[0] + strlen ("--n="));
+          iss >> n;
+        }
+      if (strncmp ("--lookups=", argv[0],strlen ("--lookups=")) == 0) 
+        {
+          std::istringstream iss (argv[0] + strlen ("--lookups="));
+          iss >> lookups;
+        }
+      argc--;
+      argv++;
+  }
+  if (n == 0 || lookups == 0)
+    {
+      std::cerr << "Error-- number of routes and lookups must be positive" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-ipv6-routing with n=" << n << " lookups=" << lookups << std::endl;
+
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (node);
+
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (device);
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+  uint32_t tunnelIf = ipv6->AddInterface (device);
+  ipv6->SetUp (tunnelIf);
+
+  Ptr<Ipv6StaticRouting> routing = CreateObject<Ipv6StaticRouting> ();
+  routing->SetIpv6 (ipv6);
+
+  SystemWallClockMs time;
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      routing->AddNetworkRouteTo (MakeHnp (i), Ipv6Prefix (64), tunnelIf);
+    }
+  PrintRate ("inserts", n, time.End ());
+
+  Ipv6Header header;
+  Socket::SocketErrno sockerr;
+  Ptr<Packet> p = Create<Packet> ();
+  uint32_t found = 0;
+
+  time.Start ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      header.SetDestinationAddress (MakeHost ((i * 2654435761u) % n));
+      if (routing->RouteOutput (p, header, 0, sockerr) != 0)
+        {
+          found++;
+        }
+    }
+  PrintRate ("lookups", lookups, time.End ());
+
+  if (found != lookups)
+    {
+      std::cerr << "Error-- " << lookups - found << " lookups found no route" << std::endl;
+      exit (1);
+    }
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ipv6Address hnp = MakeHnp (i);
+      routing->RemoveRoute (hnp, Ipv6Prefix (64), tunnelIf, hnp);
+    }
+  PrintRate ("removes", n, time.End ());
+
+  routing = 0;
+  Simulator::Destroy ();
+
+  return 0;
+}
@@ -0,0 +1,538 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Scale benchmark of a PMIPv6 domain: K LMAs and N MAGs hang off one
+ * router by point-to-point links, and M MNs per MAG attach through the
+ * MAG notifier, so no radio layer is simulated. Once every MN is
+ * registered, random handovers between MAGs run at a fixed rate.
+ *
+ * The results are printed as one line of key=value pairs:
+ *   pbu/s             PBUs handled by the LMAs per second of wall clock
+ *   events/s          events scheduled per second of wall clock
+ *   peak-rss-kb       peak resident set size of the process
+ *   binding-bytes     resident memory growth per registered MN
+ *   handover-ms-pNN   handover latency percentiles in simulated time,
+ *                     from the attach at the new MAG to its PBA
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/pmip6-module.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h> // for exit ()
+#include <unistd.h>
+#include <sys/resource.h>
+
+using namespace ns3;
+
+struct Mn
+{
+  Mac48Address m_mac;
+  uint32_t m_mag;
+  Time m_handoverStart; /* zero when no handover is pending */
+};
+
+class Bench
+{
+public:
+  Bench (uint32_t nMags, uint32_t nMns, uint32_t nLmas);
+  void SetChurn (double handoversPerSecond, double duration);
+  void SetLinkDelay (Time delay);
+  void SetLmaCluster (bool cluster);
+  void RunBench (void);
+
+private:
+  Ipv6Address LinkAddress (uint16_t net, uint16_t subnet, uint8_t host) const;
+  uint32_t AddLink (Ptr<Node> a, Ptr<Node> b, uint16_t net, uint16_t subnet);
+  void Build (void);
+  void Attach (uint32_t mn, uint32_t mag);
+  void Handover (void);
+  void SampleMemory (void);
+  void PbaReceived (uint32_t mag, Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t ifIndex);
+
+  uint32_t m_nMags;
+  uint32_t m_nMns;
+  uint32_t m_nLmas;
+  double m_handoversPerSecond;
+  double m_duration;
+  Time m_delay;
+  bool m_cluster;
+
+  NodeContainer m_lmas;
+  NodeContainer m_mags;
+  std::vector<uint32_t> m_accessIf;
+  std::vector<Mn> m_mn;
+  sgi::hash_map<Identifier, uint32_t, IdentifierHash> m_mnIndex;
+  UniformVariable m_random;
+
+  uint32_t m_registered;
+  uint32_t m_rejected;
+  std::vector<double> m_latency;
+  uint64_t m_rssBeforeAttach;
+  uint64_t m_rssAfterAttach;
+};
+
+static uint64_t
+GetResidentBytes (void)
+{
+  /* Linux only, the memory figures read 0 elsewhere */
+  FILE *f = fopen ("/proc/self/statm", "r");
+  unsigned long size = 0;
+  unsigned long resident = 0;
+
+  if (f == 0)
+    {
+      return 0;
+    }
+  if (fscanf (f, "%lu %lu", &size, &resident) != 2)
+    {
+      resident = 0;
+    }
+  fclose (f);
+  return (uint64_t)resident * sysconf (_SC_PAGESIZE);
+}
+
+static void
+Probe (void)
+{
+}
+
+static uint64_t
+GetEventUid (void)
+{
+  /* uids are handed out in sequence to every scheduled event */
+  EventId probe = Simulator::ScheduleNow (&Probe);
+  Simulator::Cancel (probe);
+  return probe.GetUid ();
+}
+
+static double
+Percentile (const std::vector<double> &sorted, double p)
+{
+  if (sorted.empty ())
+    {
+      return 0;
+    }
+  return sorted[(size_t)(p * (sorted.size () - 1) + 0.5)];
+}
+
+Bench::Bench (uint32_t nMags, uint32_t nMns, uint32_t nLmas)
+  : m_nMags (nMags),
+    m_nMns (nMns),
+    m_nLmas (nLmas),
+    m_handoversPerSecond (100),
+    m_duration (10),
+    m_delay (MilliSeconds (2)),
+    m_cluster (false),
+    m_registered (0),
+    m_rejected (0),
+    m_rssBeforeAttach (0),
+    m_rssAfterAttach (0)
+{
+}
+
+void
+Bench::SetChurn (double handoversPerSecond, double duration)
+{
+  m_handoversPerSecond = handoversPerSecond;
+  m_duration = duration;
+}
+
+void
+Bench::SetLinkDelay (Time delay)
+{
+  m_delay = delay;
+}
+
+void
+Bench::SetLmaCluster (bool cluster)
+{
+  m_cluster = cluster;
+}
+
+Ipv6Address
+Bench::LinkAddress (uint16_t net, uint16_t subnet, uint8_t host) const
+{
+  uint8_t buf[16];
+  memset (buf, 0, 16);
+  buf[0] = 0x20;
+  buf[1] = 0x01;
+  buf[2] = 0x0d;
+  buf[3] = 0xb8;
+  buf[4] = net >> 8;
+  buf[5] = net & 0xff;
+  buf[6] = subnet >> 8;
+  buf[7] = subnet & 0xff;
+  buf[15] = host;
+  return Ipv6Address (buf);
+}
+
+/* a = router side (host 1), b = agent side (host 2) with a default route through a */
+uint32_t
+Bench::AddLink (Ptr<Node> a, Ptr<Node> b, uint16_t net, uint16_t subnet)
+{
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  p2p.SetChannelAttribute ("Delay", TimeValue (m_delay));
+  NetDeviceContainer devices = p2p.Install (a, b);
+
+  uint32_t ifIndex = 0;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<Ipv6> ipv6 = devices.Get (i)->GetNode ()->GetObject<Ipv6> ();
+      ifIndex = ipv6->AddInterface (devices.Get (i));
+      ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (LinkAddress (net, subnet, i + 1), Ipv6Prefix (64)));
+      ipv6->SetForwarding (ifIndex, true);
+      ipv6->SetUp (ifIndex);
+    }
+
+  Ipv6StaticRoutingHelper routingHelper;
+  Ptr<Ipv6StaticRouting> routing = routingHelper.GetStaticRouting (b->GetObject<Ipv6> ());
+  routing->SetDefaultRoute (LinkAddress (net, subnet, 1), ifIndex);
+  return ifIndex;
+}
+
+void
+Bench::Build (void)
+{
+  Ptr<Node> router = CreateObject<Node> ();
+  m_lmas.Create (m_nLmas);
+  m_mags.Create (m_nMags);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (router);
+  internet.Install (m_lmas);
+  internet.Install (m_mags);
+
+  /* the MAGs send router advertisements on packet sockets */
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (m_mags);
+
+  for (uint32_t j = 0; j < m_nLmas; j++)
+    {
+      AddLink (router, m_lmas.Get (j), 1, j);
+    }
+
+  for (uint32_t i = 0; i < m_nMags; i++)
+    {
+      Ptr<Node> mag = m_mags.Get (i);
+      AddLink (router, mag, 2, i);
+
+      /* access link, the MNs only exist in the MAG notifications */
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (CreateObject<SimpleChannel> ());
+      mag->AddDevice (device);
+
+      Ptr<Ipv6> ipv6 = mag->GetObject<Ipv6> ();
+      uint32_t ifIndex = ipv6->AddInterface (device);
+      ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (LinkAddress (3, i, 1), Ipv6Prefix (64)));
+      ipv6->SetForwarding (ifIndex, true);
+      ipv6->SetUp (ifIndex);
+      m_accessIf.push_back (ifIndex);
+    }
+
+  Pmip6ProfileHelper profile;
+  std::list<Ipv6Address> hnps;
+  uint32_t nTotal = m_nMags * m_nMns;
+
+  profile.GetProfile ()->Reserve (nTotal);
+  for (uint32_t n = 0; n < nTotal; n++)
+    {
+      char nai[64];
+      Mn mn;
+
+      mn.m_mac = Mac48Address::Allocate ();
+      mn.m_mag = n / m_nMns;
+      sprintf (nai, "mn%u@pmip6.example.org", n);
+      profile.AddProfile (Identifier (nai), Identifier (mn.m_mac), LinkAddress (1, n % m_nLmas, 2), hnps);
+      m_mnIndex[Identifier (nai)] = n;
+      m_mn.push_back (mn);
+    }
+
+  Pmip6LmaHelper lmaHelper;
+  lmaHelper.SetProfileHelper (&profile);
+  for (uint32_t j = 0; j < m_nLmas; j++)
+    {
+      /* disjoint /32 bases, the pools never run out */
+      uint8_t buf[16];
+      memset (buf, 0, 16);
+      buf[0] = 0x3f;
+      buf[1] = 0xfe;
+      buf[2] = (j + 1) >> 8;
+      buf[3] = (j + 1) & 0xff;
+      lmaHelper.SetPrefixPoolBase (Ipv6Address (buf), 32);
+      lmaHelper.Install (m_lmas.Get (j));
+    }
+
+  Pmip6MagHelper magHelper;
+  magHelper.SetProfileHelper (&profile);
+  if (m_cluster)
+    {
+      /* the MAGs ignore the LMA of the profiles and hash the MN identifiers */
+      Ptr<Pmipv6LmaCluster> cluster = CreateObject<Pmipv6LmaCluster> ();
+      for (uint32_t j = 0; j < m_nLmas; j++)
+        {
+          cluster->AddLma (LinkAddress (1, j, 2));
+        }
+      magHelper.SetLmaCluster (cluster);
+    }
+  for (uint32_t i = 0; i < m_nMags; i++)
+    {
+      Ptr<Node> mag = m_mags.Get (i);
+      magHelper.Install (mag, LinkAddress (2, i, 2), NodeContainer ());
+      mag->GetObject<Ipv6L3Protocol> ()->TraceConnectWithoutContext ("Rx", MakeCallback (&Bench::PbaReceived, this).Bind (i));
+    }
+}
+
+void
+Bench::Attach (uint32_t mn, uint32_t mag)
+{
+  Ptr<Node> node = m_mags.Get (mag);
+  Ptr<Packet> packet = Create<Packet> ();
+  Pmipv6MagNotifyHeader header;
+
+  header.SetMacAddress (m_mn[mn].m_mac);
+  header.SetAccessTechnologyType (Ipv6MobilityHeader::OPT_ATT_IEEE_802_11ABG);
+  packet->AddHeader (header);
+
+  m_mn[mn].m_mag = mag;
+  node->GetObject<Pmipv6MagNotifier> ()->Receive (packet, Ipv6Address::GetAny (), Ipv6Address::GetAny (),
+                                                   node->GetObject<Ipv6L3Protocol> ()->GetInterface (m_accessIf[mag]));
+}
+
+void
+Bench::Handover (void)
+{
+  uint32_t mn = m_random.GetInteger (0, m_mn.size () - 1);
+
+  if (m_nMags > 1 && m_mn[mn].m_handoverStart.IsZero ())
+    {
+      uint32_t mag = (m_mn[mn].m_mag + m_random.GetInteger (1, m_nMags - 1)) % m_nMags;
+
+      m_mn[mn].m_handoverStart = Simulator::Now ();
+      Attach (mn, mag);
+    }
+
+  Simulator::Schedule (Seconds (1.0 / m_handoversPerSecond), &Bench::Handover, this);
+}
+
+void
+Bench::SampleMemory (void)
+{
+  m_rssAfterAttach = GetResidentBytes ();
+}
+
+void
+Bench::PbaReceived (uint32_t mag, Ptr<const Packet> packet, Ptr<Ipv6> ipv6, uint32_t ifIndex)
+{
+  Ptr<Packet> p = packet->Copy ();
+  Ipv6Header ip;
+  p->RemoveHeader (ip);
+  if (ip.GetNextHeader () != Ipv6MobilityL4Protocol::PROT_NUMBER)
+    {
+      return;
+    }
+
+  Ipv6MobilityBindingAckHeader pba;
+  p->PeekHeader (pba);
+  if (pba.GetMhType () != Ipv6MobilityHeader::IPV6_MOBILITY_BINDING_ACKNOWLEDGEMENT)
+    {
+      return;
+    }
+
+  Ptr<Ipv6Mobility> mobility = m_mags.Get (mag)->GetObject<Ipv6MobilityDemux> ()->GetMobility (pba.GetMhType ());
+  Ipv6MobilityOptionBundle bundle;
+  Buffer o = pba.GetOptionBuffer ();
+  mobility->ProcessOptions (o.Begin (), o.GetSize (), bundle);
+
+  sgi::hash_map<Identifier, uint32_t, IdentifierHash>::iterator i = m_mnIndex.find (bundle.GetMnIdentifier ());
+  if (i == m_mnIndex.end ())
+    {
+      return;
+    }
+
+  Mn &mn = m_mn[(*i).second];
+  if (pba.GetStatus () >= Ipv6MobilityHeader::BA_STATUS_REASON_UNSPECIFIED)
+    {
+      m_rejected++;
+    }
+  else if (!mn.m_handoverStart.IsZero ())
+    {
+      m_latency.push_back ((Simulator::Now () - mn.m_handoverStart).GetSeconds () * 1000);
+    }
+  else
+    {
+      m_registered++;
+    }
+  mn.m_handoverStart = Seconds (0);
+}
+
+void
+Bench::RunBench (void)
+{
+  Build ();
+
+  /* all the MNs attach within one second, once DAD is over on the links */
+  Time attachStart = Seconds (2.0);
+  Time attachEnd = attachStart + Seconds (1.0);
+  for (uint32_t n = 0; n < m_mn.size (); n++)
+    {
+      Simulator::Schedule (attachStart + Seconds ((double)n / m_mn.size ()),
+                           &Bench::Attach, this, n, m_mn[n].m_mag);
+    }
+  Simulator::Schedule (attachEnd + Seconds (1.0), &Bench::SampleMemory, this);
+  Time churnStart = attachEnd + Seconds (1.0);
+  if (m_handoversPerSecond > 0)
+    {
+      Simulator::Schedule (churnStart, &Bench::Handover, this);
+    }
+  Simulator::Stop (churnStart + Seconds (m_duration));
+
+  m_rssBeforeAttach = GetResidentBytes ();
+  uint64_t firstUid = GetEventUid ();
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  double seconds = time.End () / 1000.0;
+  uint64_t events = GetEventUid () - firstUid;
+  if (seconds <= 0)
+    {
+      seconds = 0.001;
+    }
+
+  uint64_t pbus = 0;
+  uint32_t minBindings = 0xffffffff;
+  uint32_t maxBindings = 0;
+  for (uint32_t j = 0; j < m_nLmas; j++)
+    {
+      Ptr<Pmipv6Lma> lma = m_lmas.Get (j)->GetObject<Pmipv6Lma> ();
+      pbus += lma->GetRxMessages ();
+      minBindings = std::min (minBindings, lma->GetNBindings ());
+      maxBindings = std::max (maxBindings, lma->GetNBindings ());
+    }
+
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+
+  std::sort (m_latency.begin (), m_latency.end ());
+  double bindingBytes = 0;
+  if (m_registered > 0 && m_rssAfterAttach > m_rssBeforeAttach)
+    {
+      bindingBytes = (double)(m_rssAfterAttach - m_rssBeforeAttach) / m_registered;
+    }
+
+  std::cout << "mags=" << m_nMags << " mns-per-mag=" << m_nMns << " lmas=" << m_nLmas
+            << " registered=" << m_registered << " rejected=" << m_rejected
+            << " handovers=" << m_latency.size ()
+            << " pbus=" << pbus << " lma-bindings-min=" << minBindings
+            << " lma-bindings-max=" << maxBindings << " wall-s=" << seconds
+            << " pbu/s=" << pbus / seconds
+            << " events/s=" << events / seconds
+            << " peak-rss-kb=" << usage.ru_maxrss
+            << " binding-bytes=" << bindingBytes
+            << " handover-ms-p50=" << Percentile (m_latency, 0.5)
+            << " handover-ms-p90=" << Percentile (m_latency, 0.9)
+            << " handover-ms-p99=" << Percentile (m_latency, 0.99)
+            << " handover-ms-max=" << (m_latency.empty () ? 0 : m_latency.back ())
+            << std::endl;
+
+  Simulator::Destroy ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nMags = 10;
+  uint32_t nMns = 100;
+  uint32_t nLmas = 1;
+  double handovers = 100;
+  double duration = 10;
+  double delayMs = 2;
+  bool cluster = false;
+  argc--;
+  argv++;
+  while (argc > 0) {
+      if (strncmp ("--mags=", argv[0], strlen ("--mags=")) == 0)
+        {
+          std::istringstream iss (argv[0] + strlen ("--mags="));
+          iss >> nMags;
+        }
+      else if (strncmp ("--mns=", argv[0], strlen ("--mns=")) == 0)
+        {
+          std::istringstream iss (argv[0] + strlen ("--mns="));
+          iss >> nMns;
+        }
+      else if (strncmp ("--lmas=", argv[0], strlen ("--lmas=")) == 0)
+        {
+          std::istringstream iss (argv[0] + strlen ("--lmas="));
+          iss >> nLmas;
+        }
+      else if (strncmp ("--handovers=", argv[0], strlen ("--handovers=")) == 0)
+        {
+          std::istringstream iss (argv[0] + strlen ("--handovers="));
+          iss >> handovers;
+        }
+      else if (strncmp ("--duration=", argv[0], strlen ("--duration=")) == 0)
+        {
+          std::istringstream iss (argv[0] + strlen ("--duration="));
+          iss >> duration;
+        }
+      else if (strncmp ("--delay-ms=", argv[0], strlen ("--delay-ms=")) == 0)
+        {
+          std::istringstream iss (argv[0] + strlen ("--delay-ms="));
+          iss >> delayMs;
+        }
+      else if (strcmp ("--cluster", argv[0]) == 0)
+        {
+          cluster = true;
+        }
+      else
+        {
+          std::cerr << "Usage: bench-pmip6 [--mags=N] [--mns=M] [--lmas=K] [--handovers=per-second]"
+                    << " [--duration=seconds] [--delay-ms=link-delay] [--cluster]" << std::endl;
+          exit (1);
+        }
+      argc--;
+      argv++;
+  }
+  if (nMags == 0 || nMns == 0 || nLmas == 0 || nLmas > 0xffff || nMags > 0xffff || handovers < 0)
+    {
+      std::cerr << "Error-- numbers of MAGs, MNs and LMAs must be positive" << std::endl;
+      exit (1);
+    }
+  std::cerr << "Running bench-pmip6 with mags=" << nMags << " mns=" << nMns << " lmas=" << nLmas
+            << " handovers=" << handovers << " duration=" << duration
+            << (cluster ? " cluster" : "") << std::endl;
+
+  Bench bench (nMags, nMns, nLmas);
+  bench.SetChurn (handovers, duration);
+  bench.SetLinkDelay (MicroSeconds ((uint64_t)(delayMs * 1000)));
+  bench.SetLmaCluster (cluster);
+  bench.RunBench ();
+
+  return 0;
+}
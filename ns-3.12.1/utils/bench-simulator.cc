@@ -34,19 +34,25 @@ class Bench
 public:
   Bench ();
   void ReadDistribution (std::istream &istream);
+  bool GenerateDistribution (std::string kind, uint32_t size);
   void SetTotal (uint32_t total);
+  void SetCancel (uint32_t cancel);
   void RunBench (void);
 private:
   void Cb (void);
+  void Timeout (void);
   std::vector<uint64_t> m_distribution;
   std::vector<uint64_t>::const_iterator m_current;
   uint32_t m_n;
   uint32_t m_total;
+  uint32_t m_cancel;
+  std::vector<EventId> m_timers;
 };
 
 Bench::Bench ()
   : m_n (0),
-    m_total (0)
+    m_total (0),
+    m_cancel (0)
 {}
 
 void 
@@ -55,6 +61,12 @@ Bench::SetTotal (uint32_t total)
   m_total = total;
 }
 
+void
+Bench::SetCancel (uint32_t cancel)
+{
+  m_cancel = cancel;
+}
+
 void
 Bench::ReadDistribution (std::istream &input)
 {
@@ -75,11 +87,52 @@ Bench::ReadDistribution (std::istream &input)
     }
 }
 
+bool
+Bench::GenerateDistribution (std::string kind, uint32_t size)
+{
+  ExponentialVariable exponential (100000);
+  UniformVariable uniform;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      uint64_t ns;
+      if (kind == "exponential")
+        {
+          ns = exponential.GetInteger ();
+        }
+      else if (kind == "bimodal")
+        {
+          // mostly short timers, a few long ones
+          if (uniform.GetValue () < 0.9)
+            {
+              ns = uniform.GetInteger (0, 20000);
+            }
+          else
+            {
+              ns = 10000000 + uniform.GetInteger (0, 20000);
+            }
+        }
+      else if (kind == "slot")
+        {
+          // whole 1ms subframes: every event of a subframe has the same timestamp
+          ns = uniform.GetInteger (1, 20) * (uint64_t)1000000;
+        }
+      else
+        {
+          return false;
+        }
+      m_distribution.push_back (ns);
+    }
+  return true;
+}
+
 void
 Bench::RunBench (void) 
 {
   SystemWallClockMs time;
   double init, simu;
+  m_n = 0;
+  m_timers.clear ();
+  m_timers.resize (m_cancel);
   time.Start ();
   for (std::vector<uint64_t>::const_iterator i = m_distribution.begin ();
        i != m_distribution.end (); i++) 
@@ -122,40 +175,74 @@ Bench::Cb (void)
       std::cerr << "event at " << Simulator::Now ().GetSeconds () << "s" << std::endl;
     }
   Simulator::Schedule (NanoSeconds (*m_current), &Bench::Cb, this);
+  if (m_cancel > 0)
+    {
+      // restart one of the timers, like a retransmission timer which
+      // rarely expires: the event it had pending is cancelled
+      EventId &timer = m_timers[m_n % m_cancel];
+      timer.Cancel ();
+      timer = Simulator::Schedule (NanoSeconds (*m_current * 10), &Bench::Timeout, this);
+    }
   m_current++;
   m_n++;
 }
 
+void
+Bench::Timeout (void)
+{
+}
+
 void
 PrintHelp (void)
 {
-  std::cout << "bench-simulator filename [options]"<<std::endl;
+  std::cout << "bench-simulator [filename] [options]"<<std::endl;
   std::cout << "  filename: a string which identifies the input distribution. \"-\" represents stdin." << std::endl;
+  std::cout << "    It can be left out when --dist is given." << std::endl;
   std::cout << "  Options:"<<std::endl;
   std::cout << "      --list: use std::list scheduler"<<std::endl;
   std::cout << "      --map: use std::map cheduler"<<std::endl;
   std::cout << "      --heap: use Binary Heap scheduler"<<std::endl;
+  std::cout << "      --calendar: use Calendar Queue scheduler"<<std::endl;
+  std::cout << "      --ns2calendar: use ns-2 Calendar Queue scheduler"<<std::endl;
+  std::cout << "      --dary: use 4-ary Heap scheduler"<<std::endl;
+  std::cout << "      --ladder: use Ladder Queue scheduler"<<std::endl;
+  std::cout << "      --all: run the bench with each scheduler in turn"<<std::endl;
+  std::cout << "      --cancel=n: restart one of n timers on each event, cancelling its pending event"<<std::endl;
+  std::cout << "      --dist=exponential|bimodal|slot: generate the input distribution"<<std::endl;
+  std::cout << "      --size=n: number of events pending with --dist"<<std::endl;
+  std::cout << "      --total=n: number of events of a run"<<std::endl;
+  std::cout << "      --n=n: number of runs"<<std::endl;
   std::cout << "      --debug: enable some debugging"<<std::endl;
 }
 
 int main (int argc, char *argv[])
 {
-  char const *filename = argv[1];
-  std::istream *input;
+  char const *filename = 0;
+  std::istream *input = 0;
   uint32_t n = 1;
   uint32_t total = 20000;
+  uint32_t cancel = 0;
+  std::string dist;
+  uint32_t size = 10000;
+  std::vector<std::string> schedulers;
   if (argc == 1)
     {
       PrintHelp ();
       return 0;
     }
-  argc-=2;
-  argv+= 2;
-  if (strcmp (filename, "-") == 0) 
+  argc--;
+  argv++;
+  if (strncmp ("--", argv[0], 2) != 0)
+    {
+      filename = argv[0];
+      argc--;
+      argv++;
+    }
+  if (filename != 0 && strcmp (filename, "-") == 0) 
     {
       input = &std::cin;
     } 
-  else 
+  else if (filename != 0)
     {
       input = new std::ifstream (filename);
     }
@@ -174,7 +261,7 @@ int main (int argc, char *argv[])
         } 
       else if (strcmp ("--map", argv[0]) == 0) 
         {
-          factory.SetTypeId ("ns3::HeapScheduler");
+          factory.SetTypeId ("ns3::MapScheduler");
           Simulator::SetScheduler (factory);
         } 
       else if (strcmp ("--calendar", argv[0]) == 0)
@@ -182,6 +269,29 @@ int main (int argc, char *argv[])
           factory.SetTypeId ("ns3::CalendarScheduler");
           Simulator::SetScheduler (factory);
         }
+      else if (strcmp ("--ns2calendar", argv[0]) == 0)
+        {
+          factory.SetTypeId ("ns3::Ns2CalendarScheduler");
+          Simulator::SetScheduler (factory);
+        }
+      else if (strcmp ("--dary", argv[0]) == 0)
+        {
+          factory.SetTypeId ("ns3::DaryHeapScheduler");
+          Simulator::SetScheduler (factory);
+        }
+      else if (strcmp ("--ladder", argv[0]) == 0)
+        {
+          factory.SetTypeId ("ns3::LadderScheduler");
+          Simulator::SetScheduler (factory);
+        }
+      else if (strcmp ("--all", argv[0]) == 0)
+        {
+          schedulers.push_back ("ns3::MapScheduler");
+          schedulers.push_back ("ns3::HeapScheduler");
+          schedulers.push_back ("ns3::CalendarScheduler");
+          schedulers.push_back ("ns3::DaryHeapScheduler");
+          schedulers.push_back ("ns3::LadderScheduler");
+        }
       else if (strcmp ("--debug", argv[0]) == 0) 
         {
           g_debug = true;
@@ -194,16 +304,51 @@ int main (int argc, char *argv[])
         {
           n = atoi (argv[0]+strlen ("--n="));
         } 
+      else if (strncmp ("--cancel=", argv[0], strlen("--cancel=")) == 0)
+        {
+          cancel = atoi (argv[0]+strlen ("--cancel="));
+        }
+      else if (strncmp ("--dist=", argv[0], strlen("--dist=")) == 0)
+        {
+          dist = argv[0]+strlen ("--dist=");
+        }
+      else if (strncmp ("--size=", argv[0], strlen("--size=")) == 0)
+        {
+          size = atoi (argv[0]+strlen ("--size="));
+        }
 
       argc--;
       argv++;
   }
   Bench *bench = new Bench ();
-  bench->ReadDistribution (*input);
+  if (input != 0)
+    {
+      bench->ReadDistribution (*input);
+    }
+  if (!dist.empty () && !bench->GenerateDistribution (dist, size))
+    {
+      std::cerr << "unknown distribution " << dist << std::endl;
+      return 1;
+    }
   bench->SetTotal (total);
-  for (uint32_t i = 0; i < n; i++)
+  bench->SetCancel (cancel);
+  if (schedulers.empty ())
     {
-      bench->RunBench ();
+      for (uint32_t i = 0; i < n; i++)
+        {
+          bench->RunBench ();
+        }
+    }
+  for (std::vector<std::string>::const_iterator s = schedulers.begin (); s != schedulers.end (); s++)
+    {
+      ObjectFactory factory;
+      factory.SetTypeId (*s);
+      Simulator::SetScheduler (factory);
+      std::cout << *s << std::endl;
+      for (uint32_t i = 0; i < n; i++)
+        {
+          bench->RunBench ();
+        }
     }
 
   return 0;